@@ -16,11 +16,9 @@
 #ifndef AIHDR_ENHANCER_VIDEO_IMPL_H
 #define AIHDR_ENHANCER_VIDEO_IMPL_H
 
-#include <functional>
-#include <limits>
-#include <map>
+#include <atomic>
+#include <memory>
 #include <mutex>
-#include <queue>
 
 #include "native_window.h"
 #include "surface.h"
@@ -30,6 +28,7 @@
 #include "aihdr_enhancer_video.h"
 #include "aihdr_enhancer_video_common.h"
 #include "algorithm_video_common.h"
+#include "vpe_video_engine.h"
 
 namespace OHOS {
 namespace Media {
@@ -55,79 +54,31 @@ public:
     int32_t ReleaseOutputBuffer(uint32_t index, bool render) override;
     int32_t Flush() override;
 
-    GSError OnConsumerBufferAvailable();
+    // The released output buffers are reclaimed by the engine, this is kept for compatibility.
     GSError OnProducerBufferReleased();
+    // Get the processing of this object as a stage of VpeVideoPipeline. This object must outlive the pipeline and
+    // it must be configured before the pipeline starts.
+    std::shared_ptr<VpeVideoImpl> GetPipelineStage();
 private:
-    struct SurfaceBufferWrapper {
-    public:
-        SurfaceBufferWrapper() = default;
-        ~SurfaceBufferWrapper() = default;
+    using EngineCallback = VpeVideoEngineCallback<AihdrEnhancerVideoCallback, AihdrEnhancerBufferFlag>;
+
+    int32_t InitEngine();
+    VPEAlgoErrCode Process(const sptr<SurfaceBuffer> &inputBuffer, sptr<SurfaceBuffer> &outputBuffer);
 
-        sptr<SurfaceBuffer> memory{nullptr};
-        AihdrEnhancerBufferFlag bufferFlag{AIHDR_ENHANCER_BUFFER_FLAG_NONE};
-        sptr<SyncFence> fence{nullptr};
-        int64_t timestamp;
-    };
-    void InitBuffers();
-    bool WaitProcessing();
-    bool AcquireInputOutputBuffers(
-        std::shared_ptr<SurfaceBufferWrapper> &inputBuffer, std::shared_ptr<SurfaceBufferWrapper> &outputBuffer);
-    void DoTask();
-    void OnTriggered();
-    void Process(std::shared_ptr<SurfaceBufferWrapper> inputBuffer, std::shared_ptr<SurfaceBufferWrapper> outputBuffer);
-    int32_t AttachToNewSurface(sptr<Surface> newSurface);
-    int32_t SetOutputSurfaceConfig(sptr<Surface> surface);
-    int32_t SetOutputSurfaceRunning(sptr<Surface> newSurface);
-    int32_t GetReleaseOutBuffer();
     std::atomic<VPEAlgoState> state_{VPEAlgoState::UNINITIALIZED};
     std::shared_ptr<AihdrEnhancerVideoCallback> cb_{nullptr};
-    std::shared_ptr<AihdrEnhancer> csc_{nullptr};
+    std::shared_ptr<VpeVideoEngine> engine_{nullptr};
     std::mutex mutex_;
-    bool getUsage_{false};
-    std::atomic<bool> initBuffer_{false};
-
-    // task相关
-    std::mutex mtxTaskDone_;
-    std::condition_variable cvTaskDone_;
-    std::shared_ptr<std::thread> taskThread_{nullptr};
-    std::condition_variable cvTaskStart_;
-    std::mutex mtxTaskStart_;
-    std::atomic<bool> isRunning_{false};
-    std::atomic<bool> isProcessing_{false};
     std::atomic<bool> isEos_{false};
-
-    // surface相关
-    std::queue<std::shared_ptr<SurfaceBufferWrapper>> outputBufferAvilQue_;
-    std::queue<std::shared_ptr<SurfaceBufferWrapper>> inputBufferAvilQue_;
-    std::queue<std::shared_ptr<SurfaceBufferWrapper>> renderBufferAvilQue_;
-    using RenderBufferAvilMapType = std::map<uint64_t, std::shared_ptr<SurfaceBufferWrapper>>;
-    RenderBufferAvilMapType renderBufferAvilMap_;
-    RenderBufferAvilMapType renderBufferMapBak_;
-    RenderBufferAvilMapType outputBufferAvilQueBak_;
-    std::mutex onBqMutex_;       // inputsruface buffer
-    std::mutex renderQueMutex_;  // outputsruface buffer
-    std::mutex surfaceChangeMutex_;
-    std::mutex surfaceChangeMutex2_;
     sptr<Surface> inputSurface_{nullptr};
     sptr<Surface> outputSurface_{nullptr};
-    static constexpr size_t MAX_BUFFER_CNT{5};
-    uint32_t outBufferCnt_{MAX_BUFFER_CNT};
-    uint32_t inBufferCnt_{MAX_BUFFER_CNT};
-    static constexpr size_t MAX_SURFACE_SEQUENCE{std::numeric_limits<uint32_t>::max()};
-    uint32_t lastSurfaceSequence_{MAX_SURFACE_SEQUENCE};
-    BufferRequestConfig requestCfg_{};
-    BufferFlushConfig flushCfg_{};
-};
 
-class AihdrEnhancerBufferConsumerListener : public OHOS::IBufferConsumerListener {
-public:
-    explicit AihdrEnhancerBufferConsumerListener(AihdrEnhancerVideoImpl *process) : process_(process) {}
-    void OnBufferAvailable() override;
-
-private:
-    AihdrEnhancerVideoImpl *process_;
+    // [WARNING] Do NOT call engine_ while holding processLock_, the engine calls Process with its locks held.
+    std::mutex processLock_;
+    // Guarded by processLock_ begin
+    std::shared_ptr<AihdrEnhancer> csc_{nullptr};
+    // Guarded by processLock_ end
 };
-
 } // namespace VideoProcessingEngine
 } // namespace Media
 } // namespace OHOS
@@ -14,6 +14,8 @@
  */
 
 #include <dlfcn.h>
+#include <map>
+#include <tuple>
 #include "colorspace_converter_fwk.h"
 #include "extension_manager.h"
 #include "native_buffer.h"
@@ -138,6 +140,54 @@ VPEAlgoErrCode ColorSpaceConverterFwk::Process(const sptr<SurfaceBuffer> &input,
     return VPE_ALGO_ERR_OK;
 }
 
+VPEAlgoErrCode ColorSpaceConverterFwk::ProcessBatch(
+    const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>> &images,
+    std::vector<VPEAlgoErrCode> &results)
+{
+    results.assign(images.size(), VPE_ALGO_ERR_INVALID_VAL);
+    CHECK_AND_RETURN_RET_LOG(parameter_ != std::nullopt, VPE_ALGO_ERR_INVALID_VAL, "Parameter is not set");
+    // The images of the same conversion share one lookup and one SetParameter of the extension.
+    using ConversionKey = std::tuple<ColorSpaceDescription, GraphicPixelFormat, ColorSpaceDescription,
+        GraphicPixelFormat>;
+    std::map<ConversionKey, std::vector<size_t>> groups;
+    std::vector<std::pair<FrameInfo, FrameInfo>> frameInfos(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        const auto& [input, output] = images[i];
+        if (input == nullptr || output == nullptr) {
+            VPE_LOGE("Input or output %{public}zu is nullptr", i);
+            continue;
+        }
+        frameInfos[i] = { FrameInfo(input), FrameInfo(output) };
+        const auto& [inputInfo, outputInfo] = frameInfos[i];
+        groups[std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat, outputInfo.colorSpace,
+            outputInfo.pixelFormat)].push_back(i);
+    }
+    for (const auto& [key, indexes] : groups) {
+        const auto& [inputInfo, outputInfo] = frameInfos[indexes.front()];
+        VPEAlgoErrCode ret = Init(inputInfo, outputInfo, context);
+        if (ret == VPE_ALGO_ERR_OK && impl_->SetParameter(*parameter_) != VPE_ALGO_ERR_OK) {
+            ret = VPE_ALGO_ERR_OPERATION_NOT_SUPPORTED;
+        }
+        if (ret != VPE_ALGO_ERR_OK) {
+            VPE_LOGE("Prepare %{public}zu images failed, ret: %{public}d", indexes.size(), ret);
+            for (auto index : indexes) {
+                results[index] = ret;
+            }
+            continue;
+        }
+        // The extensions run on one OpenGL or OpenCL context, so the images are converted one by one.
+        VPE_SYNC_TRACE;
+        for (auto index : indexes) {
+            results[index] = impl_->Process(images[index].first, images[index].second);
+        }
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+        CHECK_AND_RETURN_RET_LOG(results[i] == VPE_ALGO_ERR_OK, results[i],
+            "Process %{public}zu failed, ret: %{public}d", i, results[i]);
+    }
+    return VPE_ALGO_ERR_OK;
+}
+
 VPEAlgoErrCode ColorSpaceConverterFwk::ComposeImage(const sptr<SurfaceBuffer> &inputSdrImage,
     const sptr<SurfaceBuffer> &inputGainmap, const sptr<SurfaceBuffer> &outputHdrImage, bool legacy)
 {
@@ -183,13 +233,16 @@ VPEAlgoErrCode ColorSpaceConverterFwk::DecomposeImage(const sptr<SurfaceBuffer>
 
 VPEAlgoErrCode ColorSpaceConverterFwk::Init(const sptr<SurfaceBuffer> &input, const sptr<SurfaceBuffer> &output,
     VPEContext ctx)
+{
+    VPE_SYNC_TRACE;
+    return Init(FrameInfo(input), FrameInfo(output), ctx);
+}
+
+VPEAlgoErrCode ColorSpaceConverterFwk::Init(const FrameInfo &inputInfo, const FrameInfo &outputInfo, VPEContext ctx)
 {
     CHECK_AND_RETURN_RET_LOG(context.clContext != nullptr || context.glDisplay != EGL_NO_DISPLAY,
         VPE_ALGO_ERR_OPERATION_NOT_SUPPORTED, "opencl or opengl is not initialized!");
     auto &manager = Extension::ExtensionManager::GetInstance();
-    VPE_SYNC_TRACE;
-    FrameInfo inputInfo(input);
-    FrameInfo outputInfo(output);
     auto currentKey =
         std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat, outputInfo.colorSpace, outputInfo.pixelFormat);
     auto it = impls_.find(currentKey);
@@ -226,6 +279,21 @@ std::shared_ptr<ColorSpaceConverter> ColorSpaceConverter::Create(std::shared_ptr
     return std::static_pointer_cast<ColorSpaceConverter>(p);
 }
 
+VPEAlgoErrCode ColorSpaceConverter::ProcessBatch(
+    const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>> &images,
+    std::vector<VPEAlgoErrCode> &results)
+{
+    results.assign(images.size(), VPE_ALGO_ERR_INVALID_VAL);
+    for (size_t i = 0; i < images.size(); i++) {
+        results[i] = Process(images[i].first, images[i].second);
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+        CHECK_AND_RETURN_RET_LOG(results[i] == VPE_ALGO_ERR_OK, results[i],
+            "Process %{public}zu failed, ret: %{public}d", i, results[i]);
+    }
+    return VPE_ALGO_ERR_OK;
+}
+
 int32_t ColorSpaceConverterCreate(int32_t* instance)
 {
     CHECK_AND_RETURN_RET_LOG(instance != nullptr, VPE_ALGO_ERR_INVALID_VAL, "invalid instance");
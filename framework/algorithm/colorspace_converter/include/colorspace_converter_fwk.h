@@ -53,9 +53,12 @@ public:
         const sptr<SurfaceBuffer> &outputHdrImage, bool legacy) override;
     VPEAlgoErrCode DecomposeImage(const sptr<SurfaceBuffer> &inputImage, const sptr<SurfaceBuffer> &outputSdrImage,
         const sptr<SurfaceBuffer> &outputGainmap) override;
+    VPEAlgoErrCode ProcessBatch(const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>> &images,
+        std::vector<VPEAlgoErrCode> &results) override;
 
 private:
     VPEAlgoErrCode Init(const sptr<SurfaceBuffer> &input, const sptr<SurfaceBuffer> &output, VPEContext context);
+    VPEAlgoErrCode Init(const FrameInfo &inputInfo, const FrameInfo &outputInfo, VPEContext context);
     void OpenGLInit();
     void OpenCLInit();
 
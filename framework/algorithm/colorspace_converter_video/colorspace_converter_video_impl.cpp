@@ -49,22 +49,7 @@ std::shared_ptr<ColorSpaceConverterVideo> ColorSpaceConverterVideo::Create(std::
     return impl;
 }
 
-ColorSpaceConverterVideoImpl::ColorSpaceConverterVideoImpl()
-{
-    requestCfg_.timeout = 0;
-    requestCfg_.strideAlignment = 32;  // 32 byte alignment
-    requestCfg_.usage =
-        BUFFER_USAGE_CPU_READ | BUFFER_USAGE_CPU_WRITE | BUFFER_USAGE_HW_RENDER | BUFFER_USAGE_HW_TEXTURE;
-    requestCfg_.format = 0;
-    requestCfg_.width = 0;
-    requestCfg_.height = 0;
-
-    flushCfg_.timestamp = 0;
-    flushCfg_.damage.x = 0;
-    flushCfg_.damage.y = 0;
-    flushCfg_.damage.w = 0;
-    flushCfg_.damage.h = 0;
-}
+ColorSpaceConverterVideoImpl::ColorSpaceConverterVideoImpl() = default;
 
 ColorSpaceConverterVideoImpl::~ColorSpaceConverterVideoImpl()
 {
@@ -79,13 +64,7 @@ int32_t ColorSpaceConverterVideoImpl::Init()
 
     csc_ = ColorSpaceConverter::Create();
     CHECK_AND_RETURN_RET_LOG(csc_ != nullptr, VPE_ALGO_ERR_UNKNOWN, "ColorSpaceConverter Create failed");
-
-    isRunning_.store(true);
-    taskThread_ = std::make_shared<std::thread>(&ColorSpaceConverterVideoImpl::OnTriggered, this);
-    CHECK_AND_RETURN_RET_LOG(taskThread_ != nullptr, VPE_ALGO_ERR_UNKNOWN, "Fatal: No memory");
-
-    state_ = VPEAlgoState::INITIALIZED;
-    return VPE_ALGO_ERR_OK;
+    return InitEngine();
 }
 
 int32_t ColorSpaceConverterVideoImpl::Init(std::shared_ptr<OpenGLContext> openglContext)
@@ -95,11 +74,23 @@ int32_t ColorSpaceConverterVideoImpl::Init(std::shared_ptr<OpenGLContext> opengl
         state_ == VPEAlgoState::UNINITIALIZED, VPE_ALGO_ERR_INVALID_STATE, "Init failed: not in UNINITIALIZED state");
 
     csc_ = ColorSpaceConverter::Create(openglContext);
+    openglContext_ = openglContext;
     CHECK_AND_RETURN_RET_LOG(csc_ != nullptr, VPE_ALGO_ERR_UNKNOWN, "ColorSpaceConverter Create failed");
+    return InitEngine();
+}
 
-    isRunning_.store(true);
-    taskThread_ = std::make_shared<std::thread>(&ColorSpaceConverterVideoImpl::OnTriggered, this);
-    CHECK_AND_RETURN_RET_LOG(taskThread_ != nullptr, VPE_ALGO_ERR_UNKNOWN, "Fatal: No memory");
+int32_t ColorSpaceConverterVideoImpl::InitEngine()
+{
+    auto engine = VpeVideoEngine::Create(VIDEO_TYPE_COLORSPACE_CONVERTER,
+        [this](const sptr<SurfaceBuffer> &inputBuffer, sptr<SurfaceBuffer> &outputBuffer) {
+            return Process(inputBuffer, outputBuffer);
+        },
+        [this](const sptr<SurfaceBuffer> &, BufferRequestConfig &requestCfg) { UpdateRequestCfg(requestCfg); });
+    CHECK_AND_RETURN_RET_LOG(engine != nullptr, VPE_ALGO_ERR_UNKNOWN, "VpeVideoEngine Create failed");
+    {
+        std::lock_guard<std::mutex> processLock(processLock_);
+        engine_ = engine;
+    }
 
     state_ = VPEAlgoState::INITIALIZED;
     return VPE_ALGO_ERR_OK;
@@ -111,102 +102,28 @@ int32_t ColorSpaceConverterVideoImpl::SetCallback(const std::shared_ptr<ColorSpa
     CHECK_AND_RETURN_RET_LOG(callback != nullptr, VPE_ALGO_ERR_INVALID_VAL, "Set callback failed: callback is NULL");
     CHECK_AND_RETURN_RET_LOG(state_ == VPEAlgoState::INITIALIZED || state_ == VPEAlgoState::CONFIGURING,
         VPE_ALGO_ERR_INVALID_STATE, "SetCallback failed: not in INITIALIZED or CONFIGURING state");
+    int32_t ret = engine_->RegisterCallback(std::make_shared<EngineCallback>(callback));
+    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, ret, "SetCallback failed: register callback failed");
     cb_ = callback;
     state_ = VPEAlgoState::CONFIGURING;
     return VPE_ALGO_ERR_OK;
 }
 
-int32_t ColorSpaceConverterVideoImpl::AttachToNewSurface(sptr<Surface> newSurface)
-{
-    std::lock_guard<std::mutex> lockrender(renderQueMutex_);
-    for (auto it = outputBufferAvilQueBak_.begin(); it != outputBufferAvilQueBak_.end(); ++it) {
-        auto buffer = it->second;
-        GSError err = newSurface->AttachBufferToQueue(buffer->memory);
-        CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "outputbuffer AttachToNewSurface fail");
-    }
-    return VPE_ALGO_ERR_OK;
-}
-
-int32_t ColorSpaceConverterVideoImpl::GetReleaseOutBuffer()
-{
-    std::lock_guard<std::mutex> mapLock(renderQueMutex_);
-    for (RenderBufferAvilMapType::iterator it = renderBufferMapBak_.begin(); it != renderBufferMapBak_.end(); ++it) {
-        outputBufferAvilQue_.push(it->second);
-    }
-    renderBufferMapBak_.clear();
-    return VPE_ALGO_ERR_OK;
-}
-
-int32_t ColorSpaceConverterVideoImpl::SetOutputSurfaceConfig(sptr<Surface> surface)
-{
-    GSError err = surface->RegisterReleaseListener([this](sptr<SurfaceBuffer> &buffer) {
-        (void)buffer;
-        return OnProducerBufferReleased();
-    });
-    CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "RegisterReleaseListener fail");
-    surface->SetQueueSize(outBufferCnt_);
-    outputSurface_ = surface;
-    state_ = VPEAlgoState::CONFIGURING;
-    return VPE_ALGO_ERR_OK;
-}
-
-int32_t ColorSpaceConverterVideoImpl::SetOutputSurfaceRunning(sptr<Surface> newSurface)
-{
-    std::lock_guard<std::mutex> lockSurface(surfaceChangeMutex_);
-    std::lock_guard<std::mutex> lockSurface2(surfaceChangeMutex2_);
-    uint64_t oldId = outputSurface_->GetUniqueId();
-    uint64_t newId = newSurface->GetUniqueId();
-    if (oldId == newId) {
-        VPE_LOGD("SetOutputSurfaceRunning same surface");
-        return VPE_ALGO_ERR_OK;
-    }
-
-    outputSurface_->UnRegisterReleaseListener();
-    outputSurface_->CleanCache(true);
-    GSError err = newSurface->RegisterReleaseListener([this](sptr<SurfaceBuffer> &buffer) {
-        (void)buffer;
-        return OnProducerBufferReleased();
-    });
-    CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "RegisterReleaseListener fail");
-    newSurface->SetQueueSize(outBufferCnt_);
-    newSurface->Connect();
-    newSurface->CleanCache();
-    GetReleaseOutBuffer();
-    int32_t ret = AttachToNewSurface(newSurface);
-    if (ret != VPE_ALGO_ERR_OK) {
-        return ret;
-    }
-
-    GraphicTransformType inTransform;
-    ScalingMode inScaleMode;
-    inTransform = inputSurface_->GetTransform();
-    outputSurface_ = newSurface;
-    err = outputSurface_->SetTransform(inTransform);
-    CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "SetTransform fail");
-    if (lastSurfaceSequence_ != MAX_SURFACE_SEQUENCE) {
-        err = inputSurface_->GetScalingMode(lastSurfaceSequence_, inScaleMode);
-        CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "GetScalingMode fail");
-        err = outputSurface_->SetScalingMode(inScaleMode);
-        CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "SetScalingMode fail");
-    }
-    return VPE_ALGO_ERR_OK;
-}
-
 int32_t ColorSpaceConverterVideoImpl::SetOutputSurface(sptr<Surface> surface)
 {
     std::lock_guard<std::mutex> lock(mutex_);
     CHECK_AND_RETURN_RET_LOG(surface != nullptr, VPE_ALGO_ERR_INVALID_VAL, "surface is nullptr");
     CHECK_AND_RETURN_RET_LOG(surface->IsConsumer() == false, VPE_ALGO_ERR_INVALID_VAL, "surface is not producer");
-    if (state_ == VPEAlgoState::INITIALIZED || state_ == VPEAlgoState::CONFIGURING) {
-        int32_t ret = SetOutputSurfaceConfig(surface);
-        CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, VPE_ALGO_ERR_INVALID_STATE, "SetOutputSurface config fail");
-    } else if (state_ == VPEAlgoState::RUNNING || state_ == VPEAlgoState::EOS || state_ == VPEAlgoState::FLUSHED) {
-        int32_t ret = SetOutputSurfaceRunning(surface);
-        CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, VPE_ALGO_ERR_INVALID_STATE, "SetOutputSurface Running fail");
-    } else {
-        CHECK_AND_RETURN_RET_LOG(false, VPE_ALGO_ERR_INVALID_STATE, "surface state not support SetOutputSurface");
+    CHECK_AND_RETURN_RET_LOG(state_ == VPEAlgoState::INITIALIZED || state_ == VPEAlgoState::CONFIGURING ||
+        state_ == VPEAlgoState::RUNNING || state_ == VPEAlgoState::EOS || state_ == VPEAlgoState::FLUSHED,
+        VPE_ALGO_ERR_INVALID_STATE, "surface state not support SetOutputSurface");
+    // The engine attaches the output buffers to the new surface when it is switched during running.
+    int32_t ret = engine_->SetOutputSurface(surface);
+    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, VPE_ALGO_ERR_INVALID_STATE, "SetOutputSurface fail");
+    outputSurface_ = surface;
+    if (state_ == VPEAlgoState::INITIALIZED) {
+        state_ = VPEAlgoState::CONFIGURING;
     }
-
     return VPE_ALGO_ERR_OK;
 }
 
@@ -217,20 +134,10 @@ sptr<Surface> ColorSpaceConverterVideoImpl::CreateInputSurface()
         "CreateInputSurface failed: not in INITIALIZED or CONFIGURING state");
     CHECK_AND_RETURN_RET_LOG(inputSurface_ == nullptr, nullptr, "inputSurface already exists");
 
-    inputSurface_ = Surface::CreateSurfaceAsConsumer("ConvertInputSurface");
-    CHECK_AND_RETURN_RET_LOG(inputSurface_ != nullptr, nullptr, "CreateSurfaceAsConsumer fail");
-    sptr<IBufferConsumerListener> listener = new ImageProcessBufferConsumerListener(this);
-    GSError err = inputSurface_->RegisterConsumerListener(listener);
-    CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, nullptr, "RegisterConsumerListener fail");
-
-    sptr<IBufferProducer> producer = inputSurface_->GetProducer();
-    sptr<Surface> producerSurface = Surface::CreateSurfaceAsProducer(producer);
-    CHECK_AND_RETURN_RET_LOG(producerSurface != nullptr, nullptr, "CreateSurfaceAsProducer fail");
-    producerSurface->SetDefaultUsage(BUFFER_USAGE_CPU_READ);
-    inputSurface_->SetQueueSize(inBufferCnt_);
+    inputSurface_ = engine_->GetInputSurface();
+    CHECK_AND_RETURN_RET_LOG(inputSurface_ != nullptr, nullptr, "CreateInputSurface fail");
     state_ = VPEAlgoState::CONFIGURING;
-
-    return producerSurface;
+    return inputSurface_;
 }
 
 int32_t ColorSpaceConverterVideoImpl::ConfigureColorSpace(const Format &format)
@@ -289,11 +196,12 @@ int32_t ColorSpaceConverterVideoImpl::Configure(const Format &format)
         VPE_LOGE("format should contain output pixel_format");
         return VPE_ALGO_ERR_INVALID_VAL;
     }
+    std::lock_guard<std::mutex> processLock(processLock_);
     int32_t outputColorSpace = 0;
     if (format.GetIntValue(Media::Tag::VIDEO_DECODER_OUTPUT_COLOR_SPACE, outputColorSpace)) {
         outputFormat_.PutIntValue(Media::Tag::VIDEO_DECODER_OUTPUT_COLOR_SPACE, outputColorSpace);
     }
-    requestCfg_.format = surfacePixelFmt;
+    pixelFormat_ = surfacePixelFmt;
     format_.PutIntValue(CscVDescriptionKey::CSCV_KEY_PIXEL_FORMAT, int(surfacePixelFmt));
     // 指定色彩空间
     if (format.GetIntValue(CscVDescriptionKey::CSCV_KEY_HDR_METADATA_TYPE, hdrType_)) {
@@ -330,11 +238,15 @@ int32_t ColorSpaceConverterVideoImpl::GetParameter(Format &parameter)
     CHECK_AND_RETURN_RET_LOG(state_ >= VPEAlgoState::CONFIGURED && state_ < VPEAlgoState::EOS,
         VPE_ALGO_ERR_INVALID_STATE, "GetParameter failed: not in right state");
     ColorSpaceConverterParameter param;
-    csc_->GetParameter(param);
+    {
+        std::lock_guard<std::mutex> processLock(processLock_);
+        csc_->GetParameter(param);
+    }
     if (param.sdrUIBrightnessRatio.has_value()) {
         format_.PutDoubleValue(CscVDescriptionKey::CSCV_KEY_SDRUI_BRIGHTNESS_RATIO, param.sdrUIBrightnessRatio.value());
     }
     format_.PutIntValue(CscVDescriptionKey::CSCV_KEY_RENDER_INTENT, int(param.renderIntent));
+    engine_->GetCommonParameter(format_);
     parameter = format_;
     return VPE_ALGO_ERR_OK;
 }
@@ -345,15 +257,24 @@ int32_t ColorSpaceConverterVideoImpl::SetParameter(const Format &parameter)
     CHECK_AND_RETURN_RET_LOG(state_ >= VPEAlgoState::CONFIGURED && state_ <= VPEAlgoState::RUNNING,
         VPE_ALGO_ERR_INVALID_STATE, "SetParameter failed: not in right state");
 
+    int32_t setCount = engine_->SetCommonParameter(parameter);
+    CHECK_AND_RETURN_RET_LOG(setCount >= 0, VPE_ALGO_ERR_INVALID_VAL, "SetParameter failed: invalid video parameter");
     int32_t renderIntent;
-    if (parameter.GetIntValue(CscVDescriptionKey::CSCV_KEY_RENDER_INTENT, renderIntent)) {
+    bool hasRenderIntent = parameter.GetIntValue(CscVDescriptionKey::CSCV_KEY_RENDER_INTENT, renderIntent);
+    if (hasRenderIntent) {
         format_.PutIntValue(CscVDescriptionKey::CSCV_KEY_RENDER_INTENT, renderIntent);
     }
     double sdruiBrightnessRatio;
-    if (parameter.GetDoubleValue(CscVDescriptionKey::CSCV_KEY_SDRUI_BRIGHTNESS_RATIO, sdruiBrightnessRatio)) {
+    bool hasBrightnessRatio =
+        parameter.GetDoubleValue(CscVDescriptionKey::CSCV_KEY_SDRUI_BRIGHTNESS_RATIO, sdruiBrightnessRatio);
+    if (hasBrightnessRatio) {
         format_.PutDoubleValue(CscVDescriptionKey::CSCV_KEY_SDRUI_BRIGHTNESS_RATIO, sdruiBrightnessRatio);
     }
+    if (setCount > 0 && !hasRenderIntent && !hasBrightnessRatio) {
+        return VPE_ALGO_ERR_OK;
+    }
     ColorSpaceConverterParameter param = {RenderIntent(renderIntent), sdruiBrightnessRatio};
+    std::lock_guard<std::mutex> processLock(processLock_);
     int32_t ret = csc_->SetParameter(param);
     if (ret != VPE_ALGO_ERR_OK) {
         state_ = VPEAlgoState::ERROR;
@@ -412,32 +333,12 @@ void GetFormatFromSurfaceBuffer(Format &outputFormat, sptr<SurfaceBuffer> &buffe
     outputFormat.PutIntValue(Media::Tag::VIDEO_SLICE_HEIGHT, sliceHeight);
 }
 
-void ColorSpaceConverterVideoImpl::InitBuffers()
+void ColorSpaceConverterVideoImpl::UpdateRequestCfg(BufferRequestConfig &requestCfg)
 {
-    if (!isRunning_.load()) {
-        VPE_LOGD("Skip when died.");
-        return;
-    }
-    CHECK_AND_RETURN_LOG(outputSurface_ != nullptr, "outputSurface_ is nullptr");
-    flushCfg_.damage.x = 0;
-    flushCfg_.damage.y = 0;
-    flushCfg_.damage.w = requestCfg_.width;
-    flushCfg_.damage.h = requestCfg_.height;
-    bool firstBuffer = true;
-    for (uint32_t i = 0; i < outBufferCnt_; ++i) {
-        std::shared_ptr<SurfaceBufferWrapper> buffer = std::make_shared<SurfaceBufferWrapper>();
-        GSError err = outputSurface_->RequestBuffer(buffer->memory, buffer->fence, requestCfg_);
-        if (err != GSERROR_OK || buffer->memory == nullptr) {
-            VPE_LOGW("RequestBuffer %{public}u failed, GSError=%{public}d", i, err);
-            continue;
-        }
-        outputBufferAvilQue_.push(buffer);
-        outputBufferAvilQueBak_.insert(std::make_pair(buffer->memory->GetSeqNum(), buffer));
-        if (firstBuffer) {
-            GetFormatFromSurfaceBuffer(outputFormat_, buffer->memory);
-            firstBuffer = false;
-        }
-    }
+    std::lock_guard<std::mutex> processLock(processLock_);
+    requestCfg.usage |=
+        BUFFER_USAGE_CPU_READ | BUFFER_USAGE_CPU_WRITE | BUFFER_USAGE_HW_RENDER | BUFFER_USAGE_HW_TEXTURE;
+    requestCfg.format = pixelFormat_;
 }
 
 int32_t ColorSpaceConverterVideoImpl::Start()
@@ -447,12 +348,13 @@ int32_t ColorSpaceConverterVideoImpl::Start()
         (state_ == VPEAlgoState::CONFIGURED || state_ == VPEAlgoState::STOPPED || state_ == VPEAlgoState::FLUSHED),
         VPE_ALGO_ERR_INVALID_STATE,
         "Start failed: not in CONFIGURED or STOPPED state");
+    int32_t ret = engine_->StartIfStopped();
+    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, ret, "Start failed: start engine failed");
     if (isEos_.load()) {
         state_ = VPEAlgoState::EOS;
     } else {
         state_ = VPEAlgoState::RUNNING;
     }
-    cvTaskStart_.notify_all();
     cb_->OnState(static_cast<int32_t>(state_.load()));
     return VPE_ALGO_ERR_OK;
 }
@@ -464,11 +366,11 @@ int32_t ColorSpaceConverterVideoImpl::Stop()
         state_ == VPEAlgoState::RUNNING || state_ == VPEAlgoState::EOS || state_ == VPEAlgoState::FLUSHED,
         VPE_ALGO_ERR_INVALID_STATE,
         "Stop failed: not in RUNNING or EOS state");
+    int32_t ret = engine_->StopIfRunning();
+    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, ret, "Stop failed: stop engine failed");
 
     state_ = VPEAlgoState::STOPPED;
-    if (!isProcessing_) {
-        cb_->OnState(static_cast<int32_t>(state_.load()));
-    }
+    cb_->OnState(static_cast<int32_t>(state_.load()));
     return VPE_ALGO_ERR_OK;
 }
 
@@ -477,11 +379,13 @@ int32_t ColorSpaceConverterVideoImpl::Reset()
     std::lock_guard<std::mutex> lock(mutex_);
     CHECK_AND_RETURN_RET_LOG(
         state_ != VPEAlgoState::UNINITIALIZED, VPE_ALGO_ERR_INVALID_STATE, "Start failed: not in right state");
-    std::unique_lock<std::mutex> lockTask(mtxTaskDone_);
+    engine_->StopIfRunning();
+    // Like the legacy implementation, Reset returns after the processing ends, so it can be configured at once.
+    CHECK_AND_RETURN_RET_LOG(engine_->WaitForStop(), VPE_ALGO_ERR_INVALID_STATE, "Reset failed: still stopping");
     state_ = VPEAlgoState::INITIALIZED;
-    cvTaskDone_.wait(lockTask, [this]() { return isProcessing_.load() == false; });
 
-    csc_ = ColorSpaceConverter::Create();
+    std::lock_guard<std::mutex> processLock(processLock_);
+    csc_ = (openglContext_ != nullptr) ? ColorSpaceConverter::Create(openglContext_) : ColorSpaceConverter::Create();
     CHECK_AND_RETURN_RET_LOG(csc_ != nullptr, VPE_ALGO_ERR_UNKNOWN, "ColorSpaceConverter Create failed");
     format_ = Format();
     colorSpaceVec_.clear();
@@ -493,65 +397,39 @@ int32_t ColorSpaceConverterVideoImpl::Reset()
 
 int32_t ColorSpaceConverterVideoImpl::Release()
 {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::unique_lock<std::mutex> lockTask(mtxTaskDone_);
-        state_ = VPEAlgoState::UNINITIALIZED;
-        cvTaskDone_.wait(lockTask, [this]() { return isProcessing_.load() == false; });
-
-        inputSurface_ = nullptr;
-        std::unique_lock<std::mutex> lockSurface(surfaceChangeMutex_);
-        std::unique_lock<std::mutex> lockSurface2(surfaceChangeMutex2_);
-        if (outputSurface_ != nullptr) {
-            outputSurface_->UnRegisterReleaseListener();
-            outputSurface_->CleanCache(true);
-            outputSurface_ = nullptr;
-        }
-        lockSurface2.unlock();
-        lockSurface.unlock();
-        cb_ = nullptr;
-        csc_ = nullptr;
-        isRunning_.store(false);
-    }
-    if (taskThread_ != nullptr && taskThread_->joinable()) {
-        cvTaskStart_.notify_all();
-        taskThread_->join();
-    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = VPEAlgoState::UNINITIALIZED;
+    if (engine_ != nullptr) {
+        // Wait for the processing thread to end before the converter is destroyed.
+        engine_->Release();
+    }
+    cb_ = nullptr;
+    inputSurface_ = nullptr;
+    outputSurface_ = nullptr;
+    std::lock_guard<std::mutex> processLock(processLock_);
+    engine_ = nullptr;
+    csc_ = nullptr;
     return VPE_ALGO_ERR_OK;
 }
 
 int32_t ColorSpaceConverterVideoImpl::Flush()
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    {
-        std::unique_lock<std::mutex> lockTask(mtxTaskDone_);
-        cvTaskDone_.wait(lockTask, [this]() { return isProcessing_.load() == false; });
-    }
-
-    {
-        std::unique_lock<std::mutex> lockInQue(onBqMutex_);
-        std::queue<std::shared_ptr<SurfaceBufferWrapper>> tempQueue;
-        inputBufferAvilQue_.swap(tempQueue);
-        for (; tempQueue.size() != 0;) {
-            auto buffer = tempQueue.front();
-            tempQueue.pop();
-            CHECK_AND_RETURN_RET_LOG(buffer && buffer->memory != nullptr, VPE_ALGO_ERR_UNKNOWN, "Invalid memory");
-            GSError err = inputSurface_->ReleaseBuffer(buffer->memory, -1);
-            CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "Release buffer failed");
-        }
-    }
-
-    std::lock_guard<std::mutex> mapLock(renderQueMutex_);
-    for (auto &[id, buffer] : renderBufferAvilMap_) {
-        VPE_LOGD("Reclaim buffer %{public}" PRIu64, id);
-        outputBufferAvilQue_.push(buffer);
-    }
-    renderBufferAvilMap_.clear();
+    CHECK_AND_RETURN_RET_LOG(engine_ != nullptr, VPE_ALGO_ERR_INVALID_STATE, "Flush failed: not initialized");
+    int32_t ret = engine_->Flush();
+    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, ret, "Flush failed");
     state_ = VPEAlgoState::FLUSHED;
     return VPE_ALGO_ERR_OK;
 }
 
 int32_t ColorSpaceConverterVideoImpl::GetOutputFormat(Format &format)
+{
+    std::lock_guard<std::mutex> processLock(processLock_);
+    GetOutputFormatLocked(format);
+    return VPE_ALGO_ERR_OK;
+}
+
+void ColorSpaceConverterVideoImpl::GetOutputFormatLocked(Format &format)
 {
     int32_t width = 0;
     if (outputFormat_.GetIntValue(Media::Tag::VIDEO_WIDTH, width)) {
@@ -575,281 +453,83 @@ int32_t ColorSpaceConverterVideoImpl::GetOutputFormat(Format &format)
     if (outputFormat_.GetIntValue(Media::Tag::VIDEO_DECODER_OUTPUT_COLOR_SPACE, outputColorSpace)) {
         format.PutIntValue(Media::Tag::VIDEO_DECODER_OUTPUT_COLOR_SPACE, outputColorSpace);
     }
-    return VPE_ALGO_ERR_OK;
-}
-
-void ColorSpaceConverterVideoImpl::Process(
-    std::shared_ptr<SurfaceBufferWrapper> inputBuffer, std::shared_ptr<SurfaceBufferWrapper> outputBuffer)
-{
-    int32_t ret = 0;
-    outputBuffer->timestamp = inputBuffer->timestamp;
-    sptr<SurfaceBuffer> surfaceInputBuffer = inputBuffer->memory;
-    sptr<SurfaceBuffer> surfaceOutputBuffer = outputBuffer->memory;
-    int32_t currentWidth = surfaceInputBuffer->GetWidth();
-    int32_t currentHeight = surfaceInputBuffer->GetHeight();
-    if ((currentWidth != surfaceOutputBuffer->GetWidth()) || (currentHeight != surfaceOutputBuffer->GetHeight())) {
-        requestCfg_.width = currentWidth;
-        requestCfg_.height = currentHeight;
-        surfaceOutputBuffer->EraseMetadataKey(ATTRKEY_COLORSPACE_INFO);
-        surfaceOutputBuffer->EraseMetadataKey(ATTRKEY_HDR_METADATA_TYPE);
-        surfaceOutputBuffer->Alloc(requestCfg_);
-    }
-    if (colorSpaceVec_.size() > 0) {
-        surfaceOutputBuffer->SetMetadata(ATTRKEY_COLORSPACE_INFO, colorSpaceVec_);
-    }
-    if (hdrVec_.size() > 0) {
-        surfaceOutputBuffer->SetMetadata(ATTRKEY_HDR_METADATA_TYPE, hdrVec_);
-    }
-    if ((currentWidth != lastOutputWidth_) || (currentHeight != lastOutputHeight_)) {
-        Format outputFormat;
-        GetFormatFromSurfaceBuffer(outputFormat_, surfaceOutputBuffer);
-        GetOutputFormat(outputFormat);
-        cb_->OnOutputFormatChanged(outputFormat);
-        lastOutputWidth_ = currentWidth;
-        lastOutputHeight_ = currentHeight;
-    }
-    {
-        VPETrace cscTrace("ColorSpaceConverterVideoImpl::csc_->Process");
-        ret = csc_->Process(surfaceInputBuffer, surfaceOutputBuffer);
-        if (ret != 0 && cb_) {
-            cb_->OnError(ret);
-        }
-    }
-    inputSurface_->ReleaseBuffer(surfaceInputBuffer, -1);
-    if (!ret) {
-        std::unique_lock<std::mutex> lockOnBq(renderQueMutex_);
-        renderBufferAvilMap_.emplace(outputBuffer->memory->GetSeqNum(), outputBuffer);
-    } else {
-        std::lock_guard<std::mutex> renderLock(renderQueMutex_);
-        outputBufferAvilQue_.push(outputBuffer);
-    }
-    if (!ret && cb_) {
-        cb_->OnOutputBufferAvailable(surfaceOutputBuffer->GetSeqNum(), outputBuffer->bufferFlag);
-    }
 }
 
-bool ColorSpaceConverterVideoImpl::WaitProcessing()
+VPEAlgoErrCode ColorSpaceConverterVideoImpl::Process(const sptr<SurfaceBuffer> &inputBuffer,
+    sptr<SurfaceBuffer> &outputBuffer)
 {
-    if (!isRunning_.load()) {
-        return false;
-    }
+    std::shared_ptr<VpeVideoEngine> engine{nullptr};
+    Format outputFormat;
+    VPEAlgoErrCode ret = VPE_ALGO_ERR_OK;
     {
-        std::unique_lock<std::mutex> lock(mtxTaskStart_);
-        cvTaskStart_.wait(lock, [this]() {
-            std::lock_guard<std::mutex> lock(mutex_);
-            std::lock_guard<std::mutex> inQueueLock(onBqMutex_);
-            std::lock_guard<std::mutex> outQueueLock(renderQueMutex_);
-            if (initBuffer_.load()) {
-                InitBuffers();
-                initBuffer_.store(false);
-            }
-            return ((inputBufferAvilQue_.size() > 0 && outputBufferAvilQue_.size() > 0) || !isRunning_.load());
-        });
-    }
-
-    return true;
-}
-
-bool ColorSpaceConverterVideoImpl::AcquireInputOutputBuffers(
-    std::shared_ptr<SurfaceBufferWrapper> &inputBuffer, std::shared_ptr<SurfaceBufferWrapper> &outputBuffer)
-{
-    std::lock_guard<std::mutex> lockOnBq(onBqMutex_);
-    std::lock_guard<std::mutex> mapLock(renderQueMutex_);
-    if (inputBufferAvilQue_.size() == 0 || outputBufferAvilQue_.size() == 0) {
-        if (state_ == VPEAlgoState::STOPPED) {
-            cb_->OnState(static_cast<int32_t>(state_.load()));
+        std::lock_guard<std::mutex> processLock(processLock_);
+        CHECK_AND_RETURN_RET_LOG(csc_ != nullptr, VPE_ALGO_ERR_INVALID_STATE, "ColorSpaceConverter is released");
+        int32_t currentWidth = inputBuffer->GetWidth();
+        int32_t currentHeight = inputBuffer->GetHeight();
+        if ((currentWidth != outputBuffer->GetWidth()) || (currentHeight != outputBuffer->GetHeight())) {
+            BufferRequestConfig requestCfg{};
+            requestCfg.width = currentWidth;
+            requestCfg.height = currentHeight;
+            requestCfg.strideAlignment = 32; // 32 byte alignment
+            requestCfg.format = outputBuffer->GetFormat();
+            requestCfg.usage = outputBuffer->GetUsage();
+            outputBuffer->EraseMetadataKey(ATTRKEY_COLORSPACE_INFO);
+            outputBuffer->EraseMetadataKey(ATTRKEY_HDR_METADATA_TYPE);
+            outputBuffer->Alloc(requestCfg);
         }
-        return false;
-    }
-    inputBuffer = inputBufferAvilQue_.front();
-    outputBuffer = outputBufferAvilQue_.front();
-    inputBufferAvilQue_.pop();
-    outputBufferAvilQue_.pop();
-    return inputBuffer && outputBuffer;
-}
-
-void ColorSpaceConverterVideoImpl::DoTask()
-{
-    std::shared_ptr<SurfaceBufferWrapper> inputBuffer = nullptr;
-    std::shared_ptr<SurfaceBufferWrapper> outputBuffer = nullptr;
-    while (true) {
-        std::lock_guard<std::mutex> lockTask(mtxTaskDone_);
-        if (!isRunning_.load()) {
-            return;
+        if (colorSpaceVec_.size() > 0) {
+            outputBuffer->SetMetadata(ATTRKEY_COLORSPACE_INFO, colorSpaceVec_);
         }
-        isProcessing_.store(true);
-
-        if (!AcquireInputOutputBuffers(inputBuffer, outputBuffer)) {
-            break;
+        if (hdrVec_.size() > 0) {
+            outputBuffer->SetMetadata(ATTRKEY_HDR_METADATA_TYPE, hdrVec_);
         }
-
-        if (inputBuffer->bufferFlag == CSCV_BUFFER_FLAG_EOS) {
-            {
-                std::unique_lock<std::mutex> lockOnBq(renderQueMutex_);
-                outputBuffer->bufferFlag = CSCV_BUFFER_FLAG_EOS;
-                renderBufferAvilMap_.emplace(outputBuffer->memory->GetSeqNum(), outputBuffer);
-            }
-
-            if (cb_) {
-                cb_->OnOutputBufferAvailable(outputBuffer->memory->GetSeqNum(), CSCV_BUFFER_FLAG_EOS);
-            }
-            break;
+        if ((currentWidth != lastOutputWidth_) || (currentHeight != lastOutputHeight_)) {
+            GetFormatFromSurfaceBuffer(outputFormat_, outputBuffer);
+            GetOutputFormatLocked(outputFormat);
+            engine = engine_;
+            lastOutputWidth_ = currentWidth;
+            lastOutputHeight_ = currentHeight;
         }
-
-        Process(inputBuffer, outputBuffer);
+        VPETrace cscTrace("ColorSpaceConverterVideoImpl::csc_->Process");
+        ret = static_cast<VPEAlgoErrCode>(csc_->Process(inputBuffer, outputBuffer));
     }
-    isProcessing_.store(false);
-    cvTaskDone_.notify_all();
-}
-
-void ColorSpaceConverterVideoImpl::OnTriggered()
-{
-    while (true) {
-        if (!WaitProcessing()) {
-            break;
-        }
-
-        DoTask();
+    // Report through the engine after processLock_ is released, so the format reaches the pipeline as well when
+    // this object is a pipeline stage, and the callback is checked by the engine.
+    if (engine != nullptr) {
+        engine->OnOutputFormatChanged(outputFormat);
     }
+    return ret;
 }
 
 int32_t ColorSpaceConverterVideoImpl::ReleaseOutputBuffer(uint32_t index, bool render)
 {
     CHECK_AND_RETURN_RET_LOG(state_ == VPEAlgoState::RUNNING || state_ == VPEAlgoState::EOS,
         VPE_ALGO_ERR_INVALID_STATE, "ReleaseOutputBuffer failed: not in RUNNING or EOS state");
-
-    std::unique_lock<std::mutex> lockRenderQue(renderQueMutex_);
-    auto search = renderBufferAvilMap_.find(index);
-    if (search == renderBufferAvilMap_.end()) {
-        VPE_LOGE("ReleaseOutputBuffer invalid index %{public}d ", index);
-        return VPE_ALGO_ERR_INVALID_PARAM;
-    }
-    auto buffer = search->second;
-    renderBufferAvilMap_.erase(search);
-    lockRenderQue.unlock();
-
-    CHECK_AND_RETURN_RET_LOG(buffer, VPE_ALGO_ERR_INVALID_VAL, "Buffer is nullptr");
-    if (buffer->bufferFlag == CSCV_BUFFER_FLAG_EOS) {
-        return VPE_ALGO_ERR_OK;
-    }
-
-    if (render) {
-        flushCfg_.timestamp = buffer->timestamp;
-        flushCfg_.damage.w = buffer->memory->GetWidth();
-        flushCfg_.damage.h = buffer->memory->GetHeight();
-        {
-            std::lock_guard<std::mutex> lockSurface(surfaceChangeMutex_);
-            CHECK_AND_RETURN_RET_LOG(outputSurface_ != nullptr, GSERROR_OK, "outputSurface_ is nullptr");
-            auto ret = outputSurface_->FlushBuffer(buffer->memory, -1, flushCfg_);
-            if (ret != 0) {
-                VPE_LOGE("ReleaseOutputBuffer flushbuffer err %{public}d ", (int)ret);
-                return VPE_ALGO_ERR_UNKNOWN;
-            }
-        }
-        std::lock_guard<std::mutex> renderLock(renderQueMutex_);
-        renderBufferMapBak_.emplace(buffer->memory->GetSeqNum(), buffer);
-    } else {
-        std::lock_guard<std::mutex> renderLock(renderQueMutex_);
-        outputBufferAvilQue_.push(buffer);
-    }
-
-    return VPE_ALGO_ERR_OK;
+    return engine_->ReleaseOutputBuffer(index, render);
 }
 
 int32_t ColorSpaceConverterVideoImpl::NotifyEos()
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::lock_guard<std::mutex> lockOnBq(onBqMutex_);
     CHECK_AND_RETURN_RET_LOG(
         state_ == VPEAlgoState::RUNNING, VPE_ALGO_ERR_INVALID_STATE, "NotifyEos failed: not in RUNNING state");
+    int32_t ret = engine_->NotifyEos();
+    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, ret, "NotifyEos failed");
     state_ = VPEAlgoState::EOS;
     isEos_.store(true);
-    std::shared_ptr<SurfaceBufferWrapper> buf = std::make_shared<SurfaceBufferWrapper>();
-    buf->bufferFlag = CSCV_BUFFER_FLAG_EOS;
-    inputBufferAvilQue_.push(buf);
     VPE_LOGI("Push EOS frame");
-
-    cvTaskStart_.notify_all();
-
     return VPE_ALGO_ERR_OK;
 }
 
-GSError ColorSpaceConverterVideoImpl::OnProducerBufferReleased()
-{
-    {
-        std::unique_lock<std::mutex> lockSurface(surfaceChangeMutex2_);
-        std::lock_guard<std::mutex> outQueLock(renderQueMutex_);
-        std::shared_ptr<SurfaceBufferWrapper> buf = std::make_shared<SurfaceBufferWrapper>();
-        CHECK_AND_RETURN_RET_LOG(outputSurface_ != nullptr, GSERROR_OK, "outputSurface_ is nullptr");
-        if (renderBufferMapBak_.empty()) {
-            return GSERROR_OK;
-        }
-        GSError err = outputSurface_->RequestBuffer(buf->memory, buf->fence, requestCfg_);
-        if (err != GSERROR_OK || buf->memory == nullptr) {
-            VPE_LOGE("RequestBuffer failed, GSError=%{public}d", err);
-            return err;
-        }
-        lockSurface.unlock();
-        outputBufferAvilQue_.push(buf);
-        auto bufSeqNum = buf->memory->GetSeqNum();
-        lastSurfaceSequence_ = bufSeqNum;
-        renderBufferMapBak_.erase(bufSeqNum);
-        auto it = outputBufferAvilQueBak_.find(bufSeqNum);
-        if (it == outputBufferAvilQueBak_.end()) {
-            outputBufferAvilQueBak_.insert(std::make_pair(bufSeqNum, buf));
-            auto firstSeqNum = renderBufferMapBak_.begin();
-            if (firstSeqNum != renderBufferMapBak_.end()) {
-                outputBufferAvilQueBak_.erase(firstSeqNum->first);
-                renderBufferMapBak_.erase(firstSeqNum->first);
-            }
-        }
-    }
-    if (state_ == VPEAlgoState::RUNNING || state_ == VPEAlgoState::EOS) {
-        cvTaskStart_.notify_all();
-    }
-
-    return GSERROR_OK;
-}
-
-GSError ColorSpaceConverterVideoImpl::OnConsumerBufferAvailable()
+std::shared_ptr<VpeVideoImpl> ColorSpaceConverterVideoImpl::GetPipelineStage()
 {
-    if (!isRunning_.load()) {
-        VPE_LOGD("Skip when died.");
-        return GSERROR_OK;
-    }
     std::lock_guard<std::mutex> lock(mutex_);
-    std::lock_guard<std::mutex> lockInQue(onBqMutex_);
-    CHECK_AND_RETURN_RET_LOG(inputSurface_ != nullptr, GSERROR_OK, "inputSurface is nullptr");
-    CHECK_AND_RETURN_RET_LOG(state_ != VPEAlgoState::STOPPED, GSERROR_OK, "state change to stop");
-    std::shared_ptr<SurfaceBufferWrapper> buffer = std::make_shared<SurfaceBufferWrapper>();
-    OHOS::Rect damage;
-    GSError err = inputSurface_->AcquireBuffer(buffer->memory, buffer->fence, buffer->timestamp, damage);
-    if (err != GSERROR_OK || buffer->memory == nullptr) {
-        VPE_LOGW("AcquireBuffer failed, GSError=%{public}d", err);
-        return err;
-    }
-    inputBufferAvilQue_.push(buffer);
-
-    if (!getUsage_) {
-        requestCfg_.usage = (buffer->memory->GetUsage() | requestCfg_.usage);
-        getUsage_ = true;
-        requestCfg_.width = buffer->memory->GetWidth();
-        requestCfg_.height = buffer->memory->GetHeight();
-        initBuffer_.store(true);
-    }
-
-    if (state_ == VPEAlgoState::RUNNING) {
-        cvTaskStart_.notify_all();
-    }
-
-    return GSERROR_OK;
+    return engine_;
 }
 
-void ImageProcessBufferConsumerListener::OnBufferAvailable()
+GSError ColorSpaceConverterVideoImpl::OnProducerBufferReleased()
 {
-    if (process_ != nullptr) {
-        process_->OnConsumerBufferAvailable();
-    }
+    return GSERROR_OK;
 }
 
 ColorSpaceConverterVideoCallbackImpl::ColorSpaceConverterVideoCallbackImpl(Callback *callback, ArgumentType *userData)
@@ -17,10 +17,8 @@
 #define COLORSPACE_CONVERTER_VIDEO_IMPL_H
 
 #include <functional>
-#include <queue>
 #include <mutex>
-#include <limits>
-#include <map>
+#include <vector>
 #include "colorspace_converter_video.h"
 #include "meta/format.h"
 #include "surface.h"
@@ -28,6 +26,7 @@
 #include "colorspace_converter_video_common.h"
 #include "colorspace_converter.h"
 #include "algorithm_video_common.h"
+#include "vpe_video_engine.h"
 namespace OHOS {
 namespace Media {
 namespace VideoProcessingEngine {
@@ -52,90 +51,63 @@ public:
     int32_t GetParameter(Format &parameter) override;
     int32_t Flush() override;
     int32_t GetOutputFormat(Format &format) override;
-    GSError OnConsumerBufferAvailable();
+    // The released output buffers are reclaimed by the engine, this is kept for compatibility.
     GSError OnProducerBufferReleased();
+    // Get the processing of this object as a stage of VpeVideoPipeline. This object must outlive the pipeline and
+    // it must be configured before the pipeline starts.
+    std::shared_ptr<VpeVideoImpl> GetPipelineStage();
 
 private:
-    struct SurfaceBufferWrapper {
+    class EngineCallback : public VpeVideoEngineCallback<ColorSpaceConverterVideoCallback, CscvBufferFlag> {
     public:
-        SurfaceBufferWrapper() = default;
-        ~SurfaceBufferWrapper() = default;
+        explicit EngineCallback(const std::shared_ptr<ColorSpaceConverterVideoCallback>& callback)
+            : VpeVideoEngineCallback(callback), callback_(callback) {}
+        ~EngineCallback() = default;
+        EngineCallback(const EngineCallback&) = delete;
+        EngineCallback& operator=(const EngineCallback&) = delete;
+        EngineCallback(EngineCallback&&) = delete;
+        EngineCallback& operator=(EngineCallback&&) = delete;
 
-        sptr<SurfaceBuffer> memory{nullptr};
-        CscvBufferFlag bufferFlag{CSCV_BUFFER_FLAG_NONE};
-        sptr<SyncFence> fence{nullptr};
-        int64_t timestamp;
+        void OnOutputFormatChanged(const Format& format) final
+        {
+            callback_->OnOutputFormatChanged(format);
+        }
+
+    private:
+        std::shared_ptr<ColorSpaceConverterVideoCallback> callback_{};
     };
-    void InitBuffers();
-    bool WaitProcessing();
-    bool AcquireInputOutputBuffers(
-        std::shared_ptr<SurfaceBufferWrapper> &inputBuffer, std::shared_ptr<SurfaceBufferWrapper> &outputBuffer);
-    void DoTask();
-    void OnTriggered();
-    void Process(std::shared_ptr<SurfaceBufferWrapper> inputBuffer, std::shared_ptr<SurfaceBufferWrapper> outputBuffer);
+
+    int32_t InitEngine();
+    VPEAlgoErrCode Process(const sptr<SurfaceBuffer> &inputBuffer, sptr<SurfaceBuffer> &outputBuffer);
+    void UpdateRequestCfg(BufferRequestConfig &requestCfg);
+    void GetOutputFormatLocked(Format &format);
     int32_t ConfigureColorSpace(const Format &format);
-    int32_t AttachToNewSurface(sptr<Surface> newSurface);
-    int32_t SetOutputSurfaceConfig(sptr<Surface> surface);
-    int32_t SetOutputSurfaceRunning(sptr<Surface> newSurface);
-    int32_t GetReleaseOutBuffer();
 
     std::atomic<VPEAlgoState> state_{VPEAlgoState::UNINITIALIZED};
     std::shared_ptr<ColorSpaceConverterVideoCallback> cb_{nullptr};
-    std::shared_ptr<ColorSpaceConverter> csc_{nullptr};
+    std::shared_ptr<EngineCallback> engineCb_{nullptr};
+    // Written with both mutex_ and processLock_ held, so it can be read with either of them.
+    std::shared_ptr<VpeVideoEngine> engine_{nullptr};
     std::mutex mutex_;
     Format format_;
-    Format outputFormat_;
-    bool getUsage_{false};
-    std::atomic<bool> initBuffer_{false};
-
-      // task
-    std::mutex mtxTaskDone_;
-    std::condition_variable cvTaskDone_;
-    std::shared_ptr<std::thread> taskThread_{nullptr};
-    std::condition_variable cvTaskStart_;
-    std::mutex mtxTaskStart_;
-    std::atomic<bool> isRunning_{false};
-    std::atomic<bool> isProcessing_{false};
     std::atomic<bool> isEos_{false};
-
-      // surface
-    std::queue<std::shared_ptr<SurfaceBufferWrapper>> outputBufferAvilQue_;
-    std::queue<std::shared_ptr<SurfaceBufferWrapper>> inputBufferAvilQue_;
-    std::queue<std::shared_ptr<SurfaceBufferWrapper>> renderBufferAvilQue_;
-    using RenderBufferAvilMapType = std::map<uint64_t, std::shared_ptr<SurfaceBufferWrapper>>;
-    RenderBufferAvilMapType renderBufferAvilMap_;
-    RenderBufferAvilMapType outputBufferAvilQueBak_;
-    RenderBufferAvilMapType renderBufferMapBak_;
-    std::mutex onBqMutex_;       // inputsruface buffer
-    std::mutex renderQueMutex_;  // outputsruface buffer
-    std::mutex surfaceChangeMutex_;
-    std::mutex surfaceChangeMutex2_;
     sptr<Surface> inputSurface_{nullptr};
     sptr<Surface> outputSurface_{nullptr};
-    static constexpr size_t MAX_BUFFER_CNT{5};
-    uint32_t outBufferCnt_{MAX_BUFFER_CNT};
-    uint32_t inBufferCnt_{MAX_BUFFER_CNT};
-    static constexpr size_t MAX_SURFACE_SEQUENCE{std::numeric_limits<uint32_t>::max()};
-    uint32_t lastSurfaceSequence_{MAX_SURFACE_SEQUENCE};
-    BufferRequestConfig requestCfg_{};
-    BufferFlushConfig flushCfg_{};
 
-      // colorsapce
+    // [WARNING] Do NOT call engine_ while holding processLock_, the engine calls Process with its locks held.
+    std::mutex processLock_;
+    // Guarded by processLock_ begin
+    std::shared_ptr<ColorSpaceConverter> csc_{nullptr};
+    // The context is kept to recreate the algorithm on Reset.
+    std::shared_ptr<OpenGLContext> openglContext_{nullptr};
+    Format outputFormat_;
+    int32_t pixelFormat_{0};
     std::vector<uint8_t> colorSpaceVec_;
     int32_t hdrType_{0};
     std::vector<uint8_t> hdrVec_;
     int32_t lastOutputWidth_ = 0;
     int32_t lastOutputHeight_ = 0;
-};
-
-class ImageProcessBufferConsumerListener : public OHOS::IBufferConsumerListener {
-public:
-    explicit ImageProcessBufferConsumerListener(ColorSpaceConverterVideoImpl *process) : process_(process)
-    {}
-    void OnBufferAvailable() override;
-
-private:
-    ColorSpaceConverterVideoImpl *process_;
+    // Guarded by processLock_ end
 };
 
 class ColorSpaceConverterVideoCallbackImpl : public ColorSpaceConverterVideoCallback {
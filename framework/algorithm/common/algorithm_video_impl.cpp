@@ -25,11 +25,18 @@
 
 using namespace OHOS;
 using namespace OHOS::Media::VideoProcessingEngine;
-using namespace std::chrono_literals;
 
 namespace {
 constexpr uint32_t WAIT_FOR_EVER = std::numeric_limits<uint32_t>::max();
-constexpr uint32_t BUFFER_QUEUE_SIZE = 5;
+constexpr int MIN_PIPELINE_DEPTH = 1;
+// Keep at least one output buffer for processing and one for rendering.
+constexpr int MAX_PIPELINE_DEPTH = 3;
+constexpr int MAX_LATENCY_BUDGET_MS = 1000;
+// Process a late frame anyway after dropping some frames in a row, so that the output never freezes.
+constexpr uint32_t MAX_CONSECUTIVE_LATE_DROPS = 2;
+// Weight of the history in the average processing time, the latest processing time takes 1/8.
+constexpr int PROCESS_TIME_HISTORY_WEIGHT = 7;
+constexpr int PROCESS_TIME_TOTAL_WEIGHT = 8;
 
 std::string ToString(const sptr<SurfaceBuffer>& buffer)
 {
@@ -50,6 +57,18 @@ std::string ToString(const BufferRequestConfig& requestCfg)
         " usage:0x" << std::hex << requestCfg.usage;
     return stream.str();
 }
+
+void WaitFence(const sptr<SurfaceBuffer>& buffer, const sptr<SyncFence>& fence)
+{
+    if (buffer == nullptr) {
+        return;
+    }
+    if (fence != nullptr) [[likely]] {
+        fence->Wait(WAIT_FOR_EVER);
+    } else [[unlikely]] {
+        VPE_LOGW("Fence is null for { %{public}s }", ToString(buffer).c_str());
+    }
+}
 } // namespace
 
 VpeVideoImpl::~VpeVideoImpl()
@@ -77,8 +96,8 @@ VPEAlgoErrCode VpeVideoImpl::SetOutputSurface(const sptr<Surface>& surface)
     CHECK_AND_RETURN_RET_LOG(IsProducerSurfaceValid(surface), VPE_ALGO_ERR_INVALID_VAL,
         "Invalid input: surface is invalid!");
 
-    std::lock_guard<std::mutex> lock(lock_);
-    std::lock_guard<std::mutex> producerLock(producerLock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> producerLock(producerLock_);
     if (producer_ != nullptr) {
         if (producer_->GetUniqueId() == surface->GetUniqueId()) {
             VPE_LOGD("Oops! The same surface(%" PRIu64 ")", surface->GetUniqueId());
@@ -90,14 +109,15 @@ VPEAlgoErrCode VpeVideoImpl::SetOutputSurface(const sptr<Surface>& surface)
     surface->UnRegisterReleaseListener();
     GSError err = surface->RegisterReleaseListener([this](sptr<SurfaceBuffer>&) { return OnProducerBufferReleased(); });
     CHECK_AND_RETURN_RET_LOG(err == GSERROR_OK, VPE_ALGO_ERR_UNKNOWN, "RegisterReleaseListener failed!");
-    VPE_LOGI("Set output(%" PRIu64 ") buffer queue size to %{public}u", surface->GetUniqueId(), BUFFER_QUEUE_SIZE);
-    surface->SetQueueSize(BUFFER_QUEUE_SIZE);
+    uint32_t queueSize = queueSizeController_.ResetSize(outputBufferSize_.load());
+    VPE_LOGI("Set output(%" PRIu64 ") buffer queue size to %{public}u", surface->GetUniqueId(), queueSize);
+    surface->SetQueueSize(queueSize);
     surface->Connect();
     surface->CleanCache();
     CHECK_AND_RETURN_RET_LOG(AttachAndRefreshProducerBuffers(surface), VPE_ALGO_ERR_UNKNOWN,
         "Failed to attach buffers to new output surface(%" PRIu64 ")!", surface->GetUniqueId());;
     if (state_.load() != VPEState::IDLE) {
-        cvTrigger_.notify_one();
+        Trigger();
     }
     producer_ = surface;
 
@@ -147,7 +167,7 @@ VPEAlgoErrCode VpeVideoImpl::Stop()
     VPE_LOGD("step in");
     auto err = ExecuteWhenRunning([this]() {
         state_ = VPEState::STOPPING;
-        cvTrigger_.notify_one();
+        Trigger();
         return VPE_ALGO_ERR_OK;
     }, "Already stop!", VPE_LOG_INFO);
     return err;
@@ -162,26 +182,27 @@ VPEAlgoErrCode VpeVideoImpl::Flush()
 {
     VPE_LOGD("step in");
     CHECK_AND_RETURN_RET_LOG(isRunning_.load(), VPE_ALGO_ERR_INVALID_OPERATION, "Flush must be called during running!");
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     {
         std::unique_lock<std::mutex> lockTask(taskLock_);
         cvDone_.wait(lockTask, [this]() { return !isProcessing_.load(); });
     }
 
     if (isEnable_.load()) {
-        std::queue<SurfaceBufferInfo> tempQueue1;
-        std::queue<SurfaceBufferInfo> tempQueue2;
+        BufferQueue tempQueue1;
+        BufferQueue tempQueue2;
         {
-            std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
-            std::lock_guard<std::mutex> bufferLock(bufferLock_);
-            consumerBufferQueue_.swap(tempQueue1);
-            for (auto& [index, bufferInfo] : renderBufferQueue_) {
-                producerBufferQueue_.push(bufferInfo);
-            }
-            renderBufferQueue_.clear();
-            attachBufferQueue_.swap(tempQueue2);
-            attachBufferIDs_.clear();
+            std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+            std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+            consumerBufferQueue_.Swap(tempQueue1);
+            renderBufferQueue_.ForEach([this](uint32_t, SurfaceBufferInfo& bufferInfo) {
+                PushBuffer(producerBufferQueue_, bufferInfo, VPE_LOG_INFO);
+            });
+            renderBufferQueue_.Clear();
+            attachBufferQueue_.Swap(tempQueue2);
+            attachBufferIDs_.Clear();
         }
+        ClearInputStageLocked();
         ClearConsumerLocked(tempQueue1);
         ClearConsumerLocked(tempQueue2);
     } else {
@@ -197,7 +218,7 @@ VPEAlgoErrCode VpeVideoImpl::Enable()
 {
     CHECK_AND_RETURN_RET_LOG(!isEnable_.load(), VPE_ALGO_ERR_INVALID_OPERATION, "Already enabled!");
 
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     isEnable_ = true;
     isEnableChange_ = true;
     if (producer_ == nullptr) {
@@ -206,6 +227,12 @@ VPEAlgoErrCode VpeVideoImpl::Enable()
 
     auto ret = UpdateRequestCfg(producer_, requestCfg_);
     VPE_LOGD("requestCfg_({ %{public}s })", ToString(requestCfg_).c_str());
+    if (isSeamlessToggle_.load() && SwapInWarmBuffersLocked()) {
+        if (state_.load() != VPEState::IDLE) {
+            Trigger();
+        }
+        return ret;
+    }
     if (requestCfg_.usage == orgRequestCfg_.usage &&
         requestCfg_.format == orgRequestCfg_.format &&
         requestCfg_.width == orgRequestCfg_.width &&
@@ -220,7 +247,7 @@ VPEAlgoErrCode VpeVideoImpl::Disable()
 {
     CHECK_AND_RETURN_RET_LOG(isEnable_.load(), VPE_ALGO_ERR_INVALID_OPERATION, "Already disabled!");
 
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     return DisableLocked();
 }
 
@@ -230,18 +257,9 @@ VPEAlgoErrCode VpeVideoImpl::NotifyEos()
     return ExecuteWhenNotIdle(
         [this]() {
             VPE_LOGD("Try to NotifyEos...");
-            {
-                std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
-                if (!isBufferQueueReady_.load()) {
-                    isBufferQueueReady_ = true;
-                    VPE_LOGD("Use requestCfg_({ %{public}s }) to prepare buffers.", ToString(requestCfg_).c_str());
-                    needPrepareBuffers_ = true;
-                }
-                SurfaceBufferInfo bufferInfo{};
-                bufferInfo.bufferFlag = VPE_BUFFER_FLAG_EOS;
-                consumerBufferQueue_.push(bufferInfo);
-            }
-            cvTrigger_.notify_one();
+            SurfaceBufferInfo bufferInfo{};
+            bufferInfo.bufferFlag = VPE_BUFFER_FLAG_EOS;
+            SubmitToInputStageLocked(bufferInfo);
             VPE_LOGD("NotifyEos done.");
             return VPE_ALGO_ERR_OK;
         }, "Notify EOS must be called during running!", VPE_LOG_INFO);
@@ -261,6 +279,11 @@ VPEAlgoErrCode VpeVideoImpl::RenderOutputBufferAtTime(uint32_t index, int64_t re
     return RenderOutputBuffer(index, renderTimestamp, true);
 }
 
+uint32_t VpeVideoImpl::GetType() const
+{
+    return type_;
+}
+
 bool VpeVideoImpl::IsInitialized() const
 {
     return isInitialized_.load();
@@ -269,22 +292,15 @@ bool VpeVideoImpl::IsInitialized() const
 VPEAlgoErrCode VpeVideoImpl::Initialize()
 {
     VPE_LOGD("Start to initializing... this:%p", this);
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     if (isInitialized_.load()) {
         VPE_LOGD("Already initialize!");
         return VPE_ALGO_ERR_OK;
     }
     isRunning_ = true;
-    worker_ = std::thread([this]() {
-        while (isRunning_.load()) {
-            if (!WaitTrigger()) {
-                continue;
-            }
-            VPE_LOGD("ProcessBuffers");
-            ProcessBuffers();
-            CheckStopping();
-        };
-    });
+    taskQueue_.Start();
+    inputTaskQueue_.Start();
+    outputTaskQueue_.Start();
     auto errorCode = OnInitialize();
     isInitialized_ = true;
     VPE_LOGD("OnInitialize() return %{public}d. this:%p", errorCode, this);
@@ -294,7 +310,7 @@ VPEAlgoErrCode VpeVideoImpl::Initialize()
 VPEAlgoErrCode VpeVideoImpl::Deinitialize()
 {
     VPE_LOGD("Start to deinitializing... this:%p", this);
-    std::unique_lock<std::mutex> lock(lock_);
+    std::unique_lock<VpeCountingMutex> lock(lock_);
     if (!isInitialized_.load()) {
         VPE_LOGD("Already deinitialize!");
         return VPE_ALGO_ERR_OK;
@@ -305,16 +321,17 @@ VPEAlgoErrCode VpeVideoImpl::Deinitialize()
         state_ = VPEState::STOPPING;
     }
     lock.unlock();
-    cvTrigger_.notify_one();
-    if (worker_.joinable()) {
-        VPE_LOGD("Wait for thread ending... this:%p", this);
-        worker_.join();
-    }
+    VPE_LOGD("Wait for task ending... this:%p", this);
+    inputTaskQueue_.Stop();
+    taskQueue_.Stop();
+    isTaskPending_ = false;
+    // The processing task waits for the output stage before it ends, so nothing is left in the output stage.
+    outputTaskQueue_.Stop();
     lock.lock();
     CheckStoppingLocked();
     VPEAlgoErrCode errorCode = OnDeinitialize();
     cb_ = nullptr;
-    std::lock_guard<std::mutex> producerLock(producerLock_);
+    std::lock_guard<VpeCountingMutex> producerLock(producerLock_);
     ClearBufferQueues();
     if (consumer_ != nullptr) {
         consumer_->UnregisterConsumerListener();
@@ -335,7 +352,7 @@ void VpeVideoImpl::RefreshBuffers()
         VPE_LOGI("Skip when died.");
         return;
     }
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     if (state_.load() != VPEState::RUNNING) {
         VPE_LOGD("Skip refreshing during Non-Running.");
         return;
@@ -360,13 +377,45 @@ void VpeVideoImpl::OnOutputFormatChanged(const Format& format)
         VPE_LOGI("Skip when died.");
         return;
     }
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     if (cb_ != nullptr) {
         VPE_LOGD("OnOutputFormatChanged()");
         cb_->OnOutputFormatChanged(format);
     }
 }
 
+int VpeVideoImpl::SetCommonParameter(const Format& parameter)
+{
+    std::vector<ParameterApplier> appliers;
+    int setCount = PrepareCommonParameter(parameter, appliers);
+    if (setCount < 0) {
+        return -1;
+    }
+    for (auto& applier : appliers) {
+        applier();
+    }
+    return setCount;
+}
+
+int VpeVideoImpl::CheckCommonParameter(const Format& parameter)
+{
+    std::vector<ParameterApplier> appliers;
+    return PrepareCommonParameter(parameter, appliers);
+}
+
+void VpeVideoImpl::GetCommonParameter(Format& parameter) const
+{
+    parameter.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, static_cast<int>(pipelineDepth_.load()));
+    parameter.PutIntValue(ParameterKey::VIDEO_ADAPTIVE_QUEUE_SIZE, queueSizeController_.IsAdaptive() ? 1 : 0);
+    parameter.PutLongValue(ParameterKey::VIDEO_BUFFER_MEMORY_LIMIT, queueSizeController_.GetMemoryLimit());
+    parameter.PutIntValue(ParameterKey::VIDEO_LATENCY_BUDGET, latencyBudgetMs_.load());
+    parameter.PutIntValue(ParameterKey::VIDEO_LATE_FRAME_ACTION, lateFrameAction_.load());
+    parameter.PutIntValue(ParameterKey::VIDEO_SEAMLESS_TOGGLE, isSeamlessToggle_.load() ? 1 : 0);
+    VpeVideoStatistics statistics{};
+    GetStatistics(statistics);
+    parameter.PutBuffer(ParameterKey::VIDEO_STATISTICS, reinterpret_cast<uint8_t*>(&statistics), sizeof(statistics));
+}
+
 VPEAlgoErrCode VpeVideoImpl::OnInitialize()
 {
     return VPE_ALGO_ERR_OK;
@@ -393,6 +442,16 @@ bool VpeVideoImpl::IsDisableAfterProcessFail()
     return true;
 }
 
+bool VpeVideoImpl::IsInPlaceSupported()
+{
+    return false;
+}
+
+bool VpeVideoImpl::IsEosBufferFlushed()
+{
+    return true;
+}
+
 bool VpeVideoImpl::IsProducerSurfaceValid([[maybe_unused]] const sptr<Surface>& surface)
 {
     return true;
@@ -414,6 +473,143 @@ void VpeVideoImpl::UpdateRequestCfg([[maybe_unused]] const sptr<SurfaceBuffer>&
 {
 }
 
+int VpeVideoImpl::PrepareCommonParameter(const Format& parameter, std::vector<ParameterApplier>& appliers)
+{
+    std::function<int(const Format&, ParameterApplier&)> preparers[] = {
+        [this] (const Format& parameter, ParameterApplier& applier) {
+            return PreparePipelineDepth(parameter, applier);
+        },
+        [this] (const Format& parameter, ParameterApplier& applier) {
+            return PrepareAdaptiveQueueSize(parameter, applier);
+        },
+        [this] (const Format& parameter, ParameterApplier& applier) {
+            return PrepareBufferMemoryLimit(parameter, applier);
+        },
+        [this] (const Format& parameter, ParameterApplier& applier) {
+            return PrepareLatencyBudget(parameter, applier);
+        },
+        [this] (const Format& parameter, ParameterApplier& applier) {
+            return PrepareLateFrameAction(parameter, applier);
+        },
+        [this] (const Format& parameter, ParameterApplier& applier) {
+            return PrepareSeamlessToggle(parameter, applier);
+        },
+    };
+
+    appliers.clear();
+    for (auto& preparer : preparers) {
+        ParameterApplier applier;
+        int ret = preparer(parameter, applier);
+        if (ret < 0) {
+            appliers.clear();
+            return -1;
+        }
+        if (ret > 0) {
+            appliers.push_back(std::move(applier));
+        }
+    }
+    return static_cast<int>(appliers.size());
+}
+
+int VpeVideoImpl::PreparePipelineDepth(const Format& parameter, ParameterApplier& applier)
+{
+    int depth;
+    if (!parameter.GetIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, depth)) {
+        return 0;
+    }
+    CHECK_AND_RETURN_RET_LOG(depth >= MIN_PIPELINE_DEPTH && depth <= MAX_PIPELINE_DEPTH, -1,
+        "Invalid input: pipeline depth=%{public}d(Expected:[%{public}d,%{public}d])!",
+        depth, MIN_PIPELINE_DEPTH, MAX_PIPELINE_DEPTH);
+    applier = [this, depth] { SetPipelineDepth(depth); };
+    return 1;
+}
+
+int VpeVideoImpl::PrepareAdaptiveQueueSize(const Format& parameter, ParameterApplier& applier)
+{
+    int isAdaptive;
+    if (!parameter.GetIntValue(ParameterKey::VIDEO_ADAPTIVE_QUEUE_SIZE, isAdaptive)) {
+        return 0;
+    }
+    CHECK_AND_RETURN_RET_LOG(isAdaptive == 0 || isAdaptive == 1, -1,
+        "Invalid input: adaptive queue size=%{public}d(Expected: 0 or 1)!", isAdaptive);
+    applier = [this, isAdaptive] { queueSizeController_.SetAdaptive(isAdaptive == 1); };
+    return 1;
+}
+
+int VpeVideoImpl::PrepareBufferMemoryLimit(const Format& parameter, ParameterApplier& applier)
+{
+    int64_t memoryLimit;
+    if (!parameter.GetLongValue(ParameterKey::VIDEO_BUFFER_MEMORY_LIMIT, memoryLimit)) {
+        return 0;
+    }
+    CHECK_AND_RETURN_RET_LOG(memoryLimit >= 0, -1, "Invalid input: memory limit=%{public}" PRId64 "!", memoryLimit);
+    applier = [this, memoryLimit] { queueSizeController_.SetMemoryLimit(memoryLimit); };
+    return 1;
+}
+
+int VpeVideoImpl::PrepareLatencyBudget(const Format& parameter, ParameterApplier& applier)
+{
+    int budget;
+    if (!parameter.GetIntValue(ParameterKey::VIDEO_LATENCY_BUDGET, budget)) {
+        return 0;
+    }
+    CHECK_AND_RETURN_RET_LOG(budget >= 0 && budget <= MAX_LATENCY_BUDGET_MS, -1,
+        "Invalid input: latency budget=%{public}d(Expected:[0,%{public}d])!", budget, MAX_LATENCY_BUDGET_MS);
+    applier = [this, budget] {
+        VPE_LOGI("latency budget:%{public}d->%{public}d ms", latencyBudgetMs_.load(), budget);
+        latencyBudgetMs_ = budget;
+    };
+    return 1;
+}
+
+int VpeVideoImpl::PrepareLateFrameAction(const Format& parameter, ParameterApplier& applier)
+{
+    int action;
+    if (!parameter.GetIntValue(ParameterKey::VIDEO_LATE_FRAME_ACTION, action)) {
+        return 0;
+    }
+    CHECK_AND_RETURN_RET_LOG(action == VPE_LATE_FRAME_BYPASS || action == VPE_LATE_FRAME_DROP, -1,
+        "Invalid input: late frame action=%{public}d!", action);
+    applier = [this, action] {
+        VPE_LOGI("late frame action:%{public}d->%{public}d", lateFrameAction_.load(), action);
+        lateFrameAction_ = action;
+    };
+    return 1;
+}
+
+int VpeVideoImpl::PrepareSeamlessToggle(const Format& parameter, ParameterApplier& applier)
+{
+    int isSeamless;
+    if (!parameter.GetIntValue(ParameterKey::VIDEO_SEAMLESS_TOGGLE, isSeamless)) {
+        return 0;
+    }
+    CHECK_AND_RETURN_RET_LOG(isSeamless == 0 || isSeamless == 1, -1,
+        "Invalid input: seamless toggle=%{public}d(Expected:0 or 1)!", isSeamless);
+    applier = [this, isSeamless] { SetSeamlessToggle(isSeamless == 1); };
+    return 1;
+}
+
+void VpeVideoImpl::SetPipelineDepth(int depth)
+{
+    {
+        std::lock_guard<std::mutex> outputLock(outputLock_);
+        VPE_LOGI("pipeline depth:%{public}u->%{public}d", pipelineDepth_.load(), depth);
+        pipelineDepth_ = static_cast<uint32_t>(depth);
+    }
+    cvOutput_.notify_all();
+}
+
+void VpeVideoImpl::SetSeamlessToggle(bool isSeamless)
+{
+    VPE_LOGI("seamless toggle:%{public}d->%{public}d", isSeamlessToggle_.load(), isSeamless);
+    isSeamlessToggle_ = isSeamless;
+    if (!isSeamless) {
+        // Free the kept buffers at once, the passthrough buffers are still tracked until they are detached.
+        std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+        warmBufferQueue_.Clear();
+    }
+}
+
 void VpeVideoImpl::OnError(VPEAlgoErrCode errorCode)
 {
     if (cb_ != nullptr) {
@@ -452,7 +648,7 @@ GSError VpeVideoImpl::OnConsumerBufferAvailable()
         VPE_LOGI("Skip when died.");
         return GSERROR_OK;
     }
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     CHECK_AND_RETURN_RET_LOG(consumer_ != nullptr, GSERROR_OK, "Input surface is null!");
     if (state_.load() != VPEState::RUNNING) {
         VPE_LOGD("NOT running now!");
@@ -466,33 +662,104 @@ GSError VpeVideoImpl::OnConsumerBufferAvailable()
         VPE_LOGE("Failed to acquire buffer, ret:%{public}s!", AlgorithmUtils::ToString(err).c_str());
         return err;
     }
-    if (bufferInfo.fence != nullptr) [[likely]] {
-        bufferInfo.fence->Wait(WAIT_FOR_EVER);
-    } else [[unlikely]] {
-        VPE_LOGW("Fence is null for { %{public}s }", ToString(bufferInfo.buffer).c_str());
-    }
     VPE_LOGD("consumer_->AcquireBuffer({ %{public}s })", ToString(bufferInfo.buffer).c_str());
-    if (!IsConsumerBufferValid(bufferInfo.buffer)) {
-        VPE_LOGD("Invalid buffer:{ %{public}s }", ToString(bufferInfo.buffer).c_str());
-        DisableLocked();
+    SubmitToInputStageLocked(bufferInfo);
+    return GSERROR_OK;
+}
+
+void VpeVideoImpl::SubmitToInputStageLocked(SurfaceBufferInfo& bufferInfo)
+{
+    {
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+        // Keep the order of the buffers left in the input stage after the pipeline depth is decreased to 1.
+        if (pipelineDepth_.load() > 1 || !inputStageQueue_.Empty()) {
+            PushBuffer(inputStageQueue_, bufferInfo, VPE_LOG_INFO);
+            if (!inputTaskQueue_.Post([this]() { InputTask(); })) {
+                VPE_LOGW("Input stage is stopped, the buffer is released when the buffer queues are cleared.");
+            }
+            return;
+        }
+    }
+    WaitFence(bufferInfo.buffer, bufferInfo.fence);
+    PushConsumerBufferLocked(bufferInfo);
+}
+
+void VpeVideoImpl::InputTask()
+{
+    // Each task takes the oldest buffer of the input stage, the buffers cleared before it starts are skipped.
+    SurfaceBufferInfo bufferInfo;
+    uint64_t generation;
+    {
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+        if (inputStageQueue_.Empty()) {
+            return;
+        }
+        bufferInfo = inputStageQueue_.Front();
+        generation = inputStageGeneration_;
+    }
+    // Wait without any lock, so the buffer being processed is NOT blocked by the fence of the next buffer.
+    WaitFence(bufferInfo.buffer, bufferInfo.fence);
+    if (!isRunning_.load()) {
+        VPE_LOGI("Skip when died.");
+        return;
+    }
+    std::lock_guard<VpeCountingMutex> lock(lock_);
+    {
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+        if (generation != inputStageGeneration_) {
+            VPE_LOGD("Skip the cleared buffer { %{public}s }", ToString(bufferInfo.buffer).c_str());
+            return;
+        }
+        inputStageQueue_.Pop();
+    }
+    PushConsumerBufferLocked(bufferInfo);
+}
+
+void VpeVideoImpl::ClearInputStageLocked()
+{
+    BufferQueue tempQueue;
+    {
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+        inputStageQueue_.Swap(tempQueue);
+        inputStageGeneration_++;
+    }
+    if (tempQueue.Empty()) {
+        return;
+    }
+    ClearConsumerLocked(tempQueue);
+    // Stopping may be waiting for the cleared buffers, check it again.
+    if (state_.load() == VPEState::STOPPING) {
+        Trigger();
+    }
+}
+
+void VpeVideoImpl::PushConsumerBufferLocked(SurfaceBufferInfo& bufferInfo)
+{
+    if (bufferInfo.buffer != nullptr) {
+        if (!IsConsumerBufferValid(bufferInfo.buffer)) {
+            VPE_LOGD("Invalid buffer:{ %{public}s }", ToString(bufferInfo.buffer).c_str());
+            DisableLocked();
+        }
+        lastConsumerBufferId_ = bufferInfo.buffer->GetSeqNum();
     }
-    lastConsumerBufferId_ = bufferInfo.buffer->GetSeqNum();
 
     {
-        std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
         if (!isBufferQueueReady_.load()) {
             isBufferQueueReady_ = true;
-            requestCfg_.usage = bufferInfo.buffer->GetUsage();
-            requestCfg_.timeout = 0;
-            requestCfg_.strideAlignment = 32; // 32 bits align
-            UpdateRequestCfg(bufferInfo.buffer, requestCfg_);
+            if (bufferInfo.buffer != nullptr) {
+                requestCfg_.usage = bufferInfo.buffer->GetUsage();
+                requestCfg_.timeout = 0;
+                requestCfg_.strideAlignment = 32; // 32 bits align
+                UpdateRequestCfg(bufferInfo.buffer, requestCfg_);
+            }
             VPE_LOGD("Use requestCfg_({ %{public}s }) to prepare buffers.", ToString(requestCfg_).c_str());
             needPrepareBuffers_ = true;
         }
-        consumerBufferQueue_.push(bufferInfo);
+        bufferInfo.acquiredTime = std::chrono::steady_clock::now();
+        PushBuffer(consumerBufferQueue_, bufferInfo, VPE_LOG_INFO);
     }
-    cvTrigger_.notify_one();
-    return GSERROR_OK;
+    Trigger();
 }
 
 GSError VpeVideoImpl::OnProducerBufferReleased()
@@ -502,22 +769,22 @@ GSError VpeVideoImpl::OnProducerBufferReleased()
         VPE_LOGI("Skip when died.");
         return GSERROR_OK;
     }
-    std::lock_guard<std::mutex> producerLock(producerLock_);
+    std::lock_guard<VpeCountingMutex> producerLock(producerLock_);
     CHECK_AND_RETURN_RET_LOG(producer_ != nullptr, GSERROR_OK, "Output surface is null!");
 
     {
-        std::lock_guard<std::mutex> bufferLock(bufferLock_);
+        std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
         GSError err = GSERROR_OK;
         SurfaceBufferInfo bufferInfo{};
         CHECK_AND_RETURN_RET_LOG(RequestBuffer(bufferInfo, err, VPE_LOG_INFO_EX), err, "Failed to request buffer!");
         PopBuffer(flushBufferQueue_, bufferInfo.buffer->GetSeqNum(), bufferInfo,
             [this](sptr<SurfaceBuffer>& buffer) {
                 VPE_LOGD("OnProducerBufferReleased: Pop flush buffer { %{public}s } flushBQ=%{public}zu",
-                    ToString(buffer).c_str(), flushBufferQueue_.size());
+                    ToString(buffer).c_str(), flushBufferQueue_.Size());
             }, VPE_LOG_INFO_EX);
     }
     if (state_.load() != VPEState::IDLE) {
-        cvTrigger_.notify_one();
+        Trigger();
     }
     VPE_LOGD("step out");
     return GSERROR_OK;
@@ -529,7 +796,7 @@ bool VpeVideoImpl::CheckEnableNotifyStatus(bool isEnable, const std::string& sta
         VPE_LOGI("Skip when died.");
         return false;
     }
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     CHECK_AND_RETURN_RET_LOG(isEnableChange_.load(), false, "Oops! Keep enable:%{public}d", isEnable_.load());
     if (isEnable_.load() != isEnable) {
         VPE_LOGD("Try to notify '%{public}s' but enable:%{public}d", status.c_str(), isEnable_.load());
@@ -585,45 +852,57 @@ VPEAlgoErrCode VpeVideoImpl::RenderOutputBuffer(uint32_t index, int64_t renderTi
         VPE_LOGI("Skip when died.");
         return VPE_ALGO_ERR_INVALID_OPERATION;
     }
-    std::unique_lock<std::mutex> bufferLock(bufferLock_);
-    auto it = renderBufferQueue_.find(index);
-    CHECK_AND_RETURN_RET_LOG(it != renderBufferQueue_.end(), VPE_ALGO_ERR_INVALID_PARAM,
+    std::unique_lock<VpeCountingMutex> bufferLock(bufferLock_);
+    auto renderBufferInfo = renderBufferQueue_.Find(index);
+    CHECK_AND_RETURN_RET_LOG(renderBufferInfo != nullptr, VPE_ALGO_ERR_INVALID_PARAM,
         "Invalid input: index=%{public}u!", index);
-    SurfaceBufferInfo bufferInfo = it->second;
-    renderBufferQueue_.erase(it);
+    SurfaceBufferInfo bufferInfo = *renderBufferInfo;
+    renderBufferQueue_.Erase(index);
     bufferLock.unlock();
 
+    bool isEos = (bufferInfo.bufferFlag == VPE_BUFFER_FLAG_EOS);
+    // The flag belongs to the output of this time, the buffer is reused for the following frames.
+    bufferInfo.bufferFlag = VPE_BUFFER_FLAG_NONE;
+    if (render && isEos && !IsEosBufferFlushed()) {
+        VPE_LOGD("Skip flushing EOS buffer { %{public}s }", ToString(bufferInfo.buffer).c_str());
+        render = false;
+    }
     if (render) {
+        stats_.RecordDuration(VpeVideoStats::Stage::RENDER,
+            std::chrono::steady_clock::now() - bufferInfo.availableTime);
         BufferFlushConfig flushcfg{};
         flushcfg.damage.w = bufferInfo.buffer->GetWidth();
         flushcfg.damage.h = bufferInfo.buffer->GetHeight();
         flushcfg.timestamp = (renderTimestamp == -1) ? bufferInfo.timestamp : renderTimestamp;
         {
-            std::lock_guard<std::mutex> producerLock(producerLock_);
+            std::lock_guard<VpeCountingMutex> producerLock(producerLock_);
             CHECK_AND_RETURN_RET_LOG(producer_ != nullptr, VPE_ALGO_ERR_INVALID_OPERATION, "Output surface is null!");
             auto ret = producer_->FlushBuffer(bufferInfo.buffer, -1, flushcfg);
             VPE_LOGD("producer_(%" PRIu64 ")->FlushBuffer({ %{public}s })=%{public}s flushBQ=%{public}zu",
                 producer_->GetUniqueId(), ToString(bufferInfo.buffer).c_str(), AlgorithmUtils::ToString(ret).c_str(),
-                flushBufferQueue_.size() + 1);
+                flushBufferQueue_.Size() + 1);
             if (ret != GSERROR_OK) {
                 return VPE_ALGO_ERR_UNKNOWN;
             }
         }
         bufferLock.lock();
-        flushBufferQueue_.push(bufferInfo);
-        auto itCache = producerBufferCache_.find(bufferInfo.buffer->GetSeqNum());
-        if (itCache != producerBufferCache_.end()) {
-            itCache->second.isFlushed = true;
-            itCache->second.flushedTime = std::chrono::steady_clock::now();
+        PushBuffer(flushBufferQueue_, bufferInfo, VPE_LOG_INFO);
+        auto cacheInfo = producerBufferCache_.Find(bufferInfo.buffer->GetSeqNum());
+        if (cacheInfo != nullptr) {
+            cacheInfo->isFlushed = true;
+            cacheInfo->flushedTime = std::chrono::steady_clock::now();
         }
     } else {
+        if (!isEos) {
+            stats_.OnFrameDropped();
+        }
         VPE_LOGD("reback { %{public}s } producerBQ=%{public}zu",
-            ToString(bufferInfo.buffer).c_str(), producerBufferQueue_.size() + 1);
+            ToString(bufferInfo.buffer).c_str(), producerBufferQueue_.Size() + 1);
         bufferLock.lock();
-        producerBufferQueue_.push(bufferInfo);
+        PushBuffer(producerBufferQueue_, bufferInfo, VPE_LOG_INFO);
         bufferLock.unlock();
         if (state_.load() != VPEState::IDLE) {
-            cvTrigger_.notify_one();
+            Trigger();
         }
     }
     return VPE_ALGO_ERR_OK;
@@ -663,35 +942,40 @@ bool VpeVideoImpl::RequestBuffer(SurfaceBufferInfo& bufferInfo, GSError& errorCo
             ToString(requestCfg_).c_str(), AlgorithmUtils::ToString(errorCode).c_str());
         return false;
     }
-    producerBufferQueue_.push(bufferInfo);
-    AddBufferToCache(bufferInfo);
+    SurfaceBufferInfo freeBufferInfo = bufferInfo;
+    if (!isEnable_.load() || !SwapPassthroughBuffer(freeBufferInfo)) {
+        AddBufferToCache(freeBufferInfo);
+    }
+    if (freeBufferInfo.buffer != nullptr) {
+        PushBuffer(producerBufferQueue_, freeBufferInfo, VPE_LOG_INFO);
+    }
+    outputBufferSize_ = bufferInfo.buffer->GetSize();
     if (!isEnable_.load()) {
         VPE_EX_LOGD(logInfos, "producer_(%" PRIu64 ")->RequestBuffer({ %{public}s }) and try to release.",
             producer_->GetUniqueId(), ToString(bufferInfo.buffer).c_str());
-        auto it = attachBufferIDs_.find(bufferInfo.buffer->GetSeqNum());
-        if (it != attachBufferIDs_.end()) {
+        if (attachBufferIDs_.Contains(bufferInfo.buffer->GetSeqNum())) {
             PopBuffer(attachBufferQueue_, bufferInfo.buffer->GetSeqNum(), bufferInfo,
                 [this, &logInfos](sptr<SurfaceBuffer>& buffer) {
                     CHECK_AND_RETURN_LOG(buffer != nullptr, "Attach buffer is null!");
-                    attachBufferIDs_.erase(buffer->GetSeqNum());
+                    attachBufferIDs_.Erase(buffer->GetSeqNum());
                     auto ret = consumer_->ReleaseBuffer(buffer, -1);
                     VPE_EX_LOGD(logInfos, "consumer_->ReleaseBuffer({ %{public}s })=%{public}s cache=%{public}zu",
-                        ToString(buffer).c_str(), AlgorithmUtils::ToString(ret).c_str(), attachBufferQueue_.size());
+                        ToString(buffer).c_str(), AlgorithmUtils::ToString(ret).c_str(), attachBufferQueue_.Size());
                 }, ADD_VPE_LOG_INFO(logInfos));
         }
     } else {
         VPE_EX_LOGD(logInfos, "producer_(%" PRIu64 ")->RequestBuffer({ %{public}s })", producer_->GetUniqueId(),
             ToString(bufferInfo.buffer).c_str());
-        if (attachBufferQueue_.empty()) {
+        if (attachBufferQueue_.Empty()) {
             return true;
         }
-        bufferInfo = attachBufferQueue_.front();
-        attachBufferQueue_.pop();
+        bufferInfo = attachBufferQueue_.Front();
+        attachBufferQueue_.Pop();
         if (bufferInfo.buffer != nullptr) {
-            attachBufferIDs_.erase(bufferInfo.buffer->GetSeqNum());
+            attachBufferIDs_.Erase(bufferInfo.buffer->GetSeqNum());
             auto ret = consumer_->ReleaseBuffer(bufferInfo.buffer, -1);
             VPE_EX_LOGD(logInfos, "consumer_->ReleaseBuffer({ %{public}s })=%{public}s cache->%{public}zu",
-                ToString(bufferInfo.buffer).c_str(), AlgorithmUtils::ToString(ret).c_str(), attachBufferQueue_.size());
+                ToString(bufferInfo.buffer).c_str(), AlgorithmUtils::ToString(ret).c_str(), attachBufferQueue_.Size());
         }
     }
     return true;
@@ -704,7 +988,7 @@ void VpeVideoImpl::PrepareBuffers()
         return;
     }
     CHECK_AND_RETURN_LOG(producer_ != nullptr, "producer is null!");
-    uint32_t cacheSize = producerBufferCache_.size();
+    uint32_t cacheSize = producerBufferCache_.Size();
     VPE_LOGD("producerBufferCache_.size=%{public}u", cacheSize);
     for (uint32_t i = cacheSize; i < producer_->GetQueueSize(); i++) {
         GSError errorCode;
@@ -717,122 +1001,177 @@ void VpeVideoImpl::PrepareBuffers()
 
 bool VpeVideoImpl::AttachAndRefreshProducerBuffers(const sptr<Surface>& producer)
 {
-    std::lock_guard<std::mutex> bufferLock(bufferLock_);
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
     needPrepareBuffersForNewProducer_ = true;
     CheckAndUpdateProducerCache();
-    for (auto& [index, bufferInfo] : producerBufferCache_) {
+    bool isAttached = true;
+    producerBufferCache_.ForEach([&producer, &isAttached](uint32_t, SurfaceBufferInfo& bufferInfo) {
+        if (!isAttached) {
+            return;
+        }
         auto errorCode = producer->AttachBufferToQueue(bufferInfo.buffer);
-        CHECK_AND_RETURN_RET_LOG(errorCode == GSERROR_OK, false,
-            "Failed to producer(%" PRIu64 ")->AttachBufferToQueue({ %{public}s })=%{public}s", producer->GetUniqueId(),
-            ToString(bufferInfo.buffer).c_str(), AlgorithmUtils::ToString(errorCode).c_str());
+        if (errorCode != GSERROR_OK) {
+            VPE_LOGE("Failed to producer(%" PRIu64 ")->AttachBufferToQueue({ %{public}s })=%{public}s",
+                producer->GetUniqueId(), ToString(bufferInfo.buffer).c_str(),
+                AlgorithmUtils::ToString(errorCode).c_str());
+            isAttached = false;
+            return;
+        }
         VPE_LOGD("producer(%" PRIu64 ")->AttachBufferToQueue({ %{public}s })", producer->GetUniqueId(),
             ToString(bufferInfo.buffer).c_str());
+    });
+    if (!isAttached) {
+        return false;
     }
     std::set<uint32_t> producerBufferIDs{};
-    std::queue<SurfaceBufferInfo> tempQueue;
-    producerBufferQueue_.swap(tempQueue);
+    BufferQueue tempQueue;
+    producerBufferQueue_.Swap(tempQueue);
     AddProducerBuffers(tempQueue, producerBufferIDs);
     AddProducerBuffers(flushBufferQueue_, producerBufferIDs);
-    if (producerBufferQueue_.size() + renderBufferQueue_.size() >= producerBufferCache_.size()) {
+    if (producerBufferQueue_.Size() + renderBufferQueue_.Size() >= producerBufferCache_.Size()) {
         VPE_LOGD("producerBQ:%{public}zu renderBQ:%{public}zu flushBQ:%{public}zu attachBQ:%{public}zu "
             "producerBufferCache_:%{public}zu",
-            producerBufferQueue_.size(), renderBufferQueue_.size(), flushBufferQueue_.size(),
-            attachBufferQueue_.size(), producerBufferCache_.size());
+            producerBufferQueue_.Size(), renderBufferQueue_.Size(), flushBufferQueue_.Size(),
+            attachBufferQueue_.Size(), producerBufferCache_.Size());
         return true;
     }
     VPE_LOGD("Add cache buffers to producerBQ");
-    for (auto& [index, bufferInfo] : producerBufferCache_) {
+    producerBufferCache_.ForEach([this, &producerBufferIDs](uint32_t index, SurfaceBufferInfo& bufferInfo) {
         if (producerBufferIDs.count(index) > 0) {
-            continue;
+            return;
         }
         VPE_LOGD("Add { %{public}s } to producerBQ", ToString(bufferInfo.buffer).c_str());
-        producerBufferQueue_.push(bufferInfo);
-    }
+        PushBuffer(producerBufferQueue_, bufferInfo, VPE_LOG_INFO);
+    });
     return true;
 }
 
-void VpeVideoImpl::AddProducerBuffers(std::queue<SurfaceBufferInfo>& bufferQueue, std::set<uint32_t>& producerBufferIDs)
+void VpeVideoImpl::AddProducerBuffers(BufferQueue& bufferQueue, std::set<uint32_t>& producerBufferIDs)
 {
-    for (; !bufferQueue.empty(); bufferQueue.pop()) {
-        auto bufferInfo = bufferQueue.front();
+    for (; !bufferQueue.Empty(); bufferQueue.Pop()) {
+        auto bufferInfo = bufferQueue.Front();
         if (bufferInfo.buffer == nullptr) {
             VPE_LOGW("buffer is null!");
             continue;
         }
         producerBufferIDs.insert(bufferInfo.buffer->GetSeqNum());
-        producerBufferQueue_.push(bufferInfo);
+        PushBuffer(producerBufferQueue_, bufferInfo, VPE_LOG_INFO);
     }
 }
 
 void VpeVideoImpl::AddBufferToCache(const SurfaceBufferInfo& bufferInfo)
 {
     CHECK_AND_RETURN_LOG(bufferInfo.buffer != nullptr, "buffer is null!");
-    auto it = producerBufferCache_.find(bufferInfo.buffer->GetSeqNum());
-    if (it != producerBufferCache_.end()) {
-        it->second.isFlushed = false;
+    auto cacheInfo = producerBufferCache_.Find(bufferInfo.buffer->GetSeqNum());
+    if (cacheInfo != nullptr) {
+        cacheInfo->isFlushed = false;
         VPE_LOGD("Refresh { %{public}s } of producerBufferCache_.size:%{public}zu",
-            ToString(bufferInfo.buffer).c_str(), producerBufferCache_.size());
+            ToString(bufferInfo.buffer).c_str(), producerBufferCache_.Size());
         return;
     }
-    uint32_t size = producerBufferCache_.size();
-    producerBufferCache_[bufferInfo.buffer->GetSeqNum()] = bufferInfo;
+    uint32_t size = producerBufferCache_.Size();
+    CHECK_AND_RETURN_LOG(producerBufferCache_.Insert(bufferInfo.buffer->GetSeqNum(), bufferInfo),
+        "Failed to add { %{public}s } to producerBufferCache_: full!", ToString(bufferInfo.buffer).c_str());
     VPE_LOGD("Add { %{public}s } to producerBufferCache_.size:%{public}u->%{public}zu",
-        ToString(bufferInfo.buffer).c_str(), size, producerBufferCache_.size());
+        ToString(bufferInfo.buffer).c_str(), size, producerBufferCache_.Size());
     CheckAndUpdateProducerCache();
 }
 
 void VpeVideoImpl::DelBufferFromCache(const SurfaceBufferInfo& bufferInfo)
 {
     CHECK_AND_RETURN_LOG(bufferInfo.buffer != nullptr, "buffer is null!");
-    uint32_t size = producerBufferCache_.size();
-    producerBufferCache_.erase(bufferInfo.buffer->GetSeqNum());
+    uint32_t size = producerBufferCache_.Size();
+    producerBufferCache_.Erase(bufferInfo.buffer->GetSeqNum());
     VPE_LOGD("Del { %{public}s } from producerBufferCache_.size:%{public}u->%{public}zu",
-        ToString(bufferInfo.buffer).c_str(), size, producerBufferCache_.size());
+        ToString(bufferInfo.buffer).c_str(), size, producerBufferCache_.Size());
 }
 
 void VpeVideoImpl::CheckAndUpdateProducerCache()
 {
-    uint32_t size = producerBufferCache_.size();
-    if (size <= BUFFER_QUEUE_SIZE) {
+    uint32_t size = producerBufferCache_.Size();
+    uint32_t maxSize = queueSizeController_.GetSize();
+    if (size <= maxSize) {
         return;
     }
     std::list<SurfaceBufferInfo> toBeDel;
-    for (auto& [index, info] : producerBufferCache_) {
+    producerBufferCache_.ForEach([&toBeDel](uint32_t, SurfaceBufferInfo& info) {
         if (!info.isFlushed) {
-            continue;
+            return;
         }
-        for (auto it = toBeDel.begin(); it != toBeDel.end(); it++) {
-            if (info.flushedTime < it->flushedTime) {
-                toBeDel.insert(it, info);
-                continue;
-            }
+        auto it = toBeDel.begin();
+        while (it != toBeDel.end() && it->flushedTime <= info.flushedTime) {
+            it++;
         }
-        toBeDel.push_back(info);
-    }
+        toBeDel.insert(it, info);
+    });
     for (auto it = toBeDel.begin(); it != toBeDel.end(); it++) {
-        size = producerBufferCache_.size();
-        producerBufferCache_.erase(it->buffer->GetSeqNum());
+        size = producerBufferCache_.Size();
+        producerBufferCache_.Erase(it->buffer->GetSeqNum());
         VPE_LOGD("Del { %{public}s } from producerBufferCache_.size:%{public}u->%{public}zu",
-            ToString(it->buffer).c_str(), size, producerBufferCache_.size());
-        if (producerBufferCache_.size() <= BUFFER_QUEUE_SIZE) {
+            ToString(it->buffer).c_str(), size, producerBufferCache_.Size());
+        if (producerBufferCache_.Size() <= maxSize) {
             break;
         }
     }
 }
 
-void VpeVideoImpl::ProcessBuffers()
+bool VpeVideoImpl::GrowProducerQueue(uint32_t& producerSize)
+{
+    uint32_t queueSize = 0;
+    if (!isBufferQueueReady_.load() || !queueSizeController_.OnStall(outputBufferSize_.load(), queueSize)) {
+        return false;
+    }
+    std::lock_guard<VpeCountingMutex> lock(lock_);
+    CHECK_AND_RETURN_RET_LOG(producer_ != nullptr, false, "producer is null!");
+    {
+        std::lock_guard<VpeCountingMutex> producerLock(producerLock_);
+        VPE_LOGI("Set output(%" PRIu64 ") buffer queue size to %{public}u", producer_->GetUniqueId(), queueSize);
+        producer_->SetQueueSize(queueSize);
+    }
+    std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+    PrepareBuffers();
+    producerSize = producerBufferQueue_.Size();
+    return producerSize > 0;
+}
+
+void VpeVideoImpl::ShrinkProducerQueue()
+{
+    uint32_t queueSize = 0;
+    if (!isBufferQueueReady_.load() || !queueSizeController_.ShrinkToLimit(outputBufferSize_.load(), queueSize)) {
+        return;
+    }
+    std::lock_guard<VpeCountingMutex> lock(lock_);
+    CHECK_AND_RETURN_LOG(producer_ != nullptr, "producer is null!");
+    {
+        std::lock_guard<VpeCountingMutex> producerLock(producerLock_);
+        VPE_LOGI("Set output(%" PRIu64 ") buffer queue size to %{public}u", producer_->GetUniqueId(), queueSize);
+        producer_->SetQueueSize(queueSize);
+    }
+    // The buffers in use are dropped from the cache when they come back after being flushed.
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+    CheckAndUpdateProducerCache();
+}
+
+bool VpeVideoImpl::ProcessBuffers(bool& isYielded)
 {
     if (!isRunning_.load()) {
         VPE_LOGI("Skip when died.");
-        return;
+        return false;
     }
     {
-        std::lock_guard<std::mutex> lock(lock_);
-        CHECK_AND_RETURN_LOG(consumer_ != nullptr && producer_ != nullptr, "consumer or producer is null!");
+        std::lock_guard<VpeCountingMutex> lock(lock_);
+        CHECK_AND_RETURN_RET_LOG(consumer_ != nullptr && producer_ != nullptr, false, "consumer or producer is null!");
         UpdateProducerLocked();
     }
-    while (isRunning_.load()) {
+    for (bool isFirst = true; isRunning_.load(); isFirst = false) {
         isProcessing_ = true;
+        if (!isFirst && VpeTaskExecutor::GetInstance().HasWaitingQueues()) {
+            // Give the thread to the other objects between buffers, the next task goes on with the rest.
+            VPE_LOGD("Yield to the waiting queues.");
+            isYielded = true;
+            break;
+        }
 
         SurfaceBufferInfo srcBufferInfo;
         SurfaceBufferInfo dstBufferInfo;
@@ -841,9 +1180,13 @@ void VpeVideoImpl::ProcessBuffers()
         }
         if (srcBufferInfo.bufferFlag == VPE_BUFFER_FLAG_EOS) {
             VPE_LOGD("EOS frame.");
+            WaitOutputStageIdle();
             OutputBuffer(srcBufferInfo, dstBufferInfo, [] {}, VPE_LOG_INFO);
             break;
         }
+        if (isEnable_.load() && IsFrameLate(srcBufferInfo) && SkipLateFrame(srcBufferInfo, dstBufferInfo)) {
+            continue;
+        }
         if (isEnable_.load()) {
             if (!ProcessBuffer(srcBufferInfo, dstBufferInfo) && IsDisableAfterProcessFail()) {
                 VPE_LOGD("Dsiable because failed to process !");
@@ -851,59 +1194,121 @@ void VpeVideoImpl::ProcessBuffers()
                 continue;
             }
         } else {
+            WaitOutputStageIdle();
             BypassBuffer(srcBufferInfo, dstBufferInfo);
         }
     }
+    WaitOutputStageIdle();
     PrintBufferSize();
 
     isProcessing_ = false;
     cvDone_.notify_all();
+    return true;
 }
 
 bool VpeVideoImpl::GetConsumerAndProducerBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo)
 {
-    std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
-    std::lock_guard<std::mutex> bufferLock(bufferLock_);
-    if (producerBufferQueue_.empty() || consumerBufferQueue_.empty()) {
+    std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+    if (producerBufferQueue_.Empty() || consumerBufferQueue_.Empty()) {
         return false;
     }
-    srcBufferInfo = consumerBufferQueue_.front();
+    srcBufferInfo = consumerBufferQueue_.Front();
     if (srcBufferInfo.buffer == nullptr && srcBufferInfo.bufferFlag != VPE_BUFFER_FLAG_EOS) {
-        consumerBufferQueue_.pop();
+        consumerBufferQueue_.Pop();
         VPE_LOGW("input buffer is null!");
         return false;
     }
-    dstBufferInfo = producerBufferQueue_.front();
+    dstBufferInfo = producerBufferQueue_.Front();
     if (dstBufferInfo.buffer == nullptr) {
-        producerBufferQueue_.pop();
+        producerBufferQueue_.Pop();
         VPE_LOGW("output buffer is null!");
         return false;
     }
-    consumerBufferQueue_.pop();
-    producerBufferQueue_.pop();
+    consumerBufferQueue_.Pop();
+    producerBufferQueue_.Pop();
     return true;
 }
 
 bool VpeVideoImpl::ProcessBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo)
 {
     dstBufferInfo.timestamp = srcBufferInfo.timestamp;
+    auto startTime = std::chrono::steady_clock::now();
+    stats_.RecordDuration(VpeVideoStats::Stage::INPUT_WAIT, startTime - srcBufferInfo.acquiredTime);
     auto errorCode = Process(srcBufferInfo.buffer, dstBufferInfo.buffer);
-    auto ret = consumer_->ReleaseBuffer(srcBufferInfo.buffer, -1);
-    VPE_LOGD("consumer_->ReleaseBuffer({ %{public}s })=%{public}s", ToString(srcBufferInfo.buffer).c_str(),
-        AlgorithmUtils::ToString(ret).c_str());
+    auto processTime = std::chrono::steady_clock::now() - startTime;
+    stats_.RecordDuration(VpeVideoStats::Stage::PROCESS, processTime);
+    avgProcessTime_ = (avgProcessTime_ * PROCESS_TIME_HISTORY_WEIGHT + processTime) / PROCESS_TIME_TOTAL_WEIGHT;
+    consecutiveLateDrops_ = 0;
     if (errorCode != VPE_ALGO_ERR_OK) {
+        stats_.OnFrameDropped();
+        auto ret = consumer_->ReleaseBuffer(srcBufferInfo.buffer, -1);
+        VPE_LOGD("consumer_->ReleaseBuffer({ %{public}s })=%{public}s", ToString(srcBufferInfo.buffer).c_str(),
+            AlgorithmUtils::ToString(ret).c_str());
         OnError(errorCode);
-        std::lock_guard<std::mutex> bufferLock(bufferLock_);
-        producerBufferQueue_.push(dstBufferInfo);
+        std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+        PushBuffer(producerBufferQueue_, dstBufferInfo, VPE_LOG_INFO);
         VPE_LOGW("Failed to process({ %{public}s },{ %{public}s })=%{public}d",
             ToString(srcBufferInfo.buffer).c_str(), ToString(dstBufferInfo.buffer).c_str(), errorCode);
         return false;
     }
-    OutputBuffer(srcBufferInfo, dstBufferInfo, [] {}, VPE_LOG_INFO);
-    NotifyEnableStatus(type_, "enable");
+    if (pipelineDepth_.load() > 1) {
+        SubmitToOutputStage(srcBufferInfo, dstBufferInfo);
+        return true;
+    }
+    // Keep the output order when the pipeline depth is decreased to 1.
+    WaitOutputStageIdle();
+    OutputProcessedBuffer(srcBufferInfo, dstBufferInfo);
+    return true;
+}
+
+bool VpeVideoImpl::IsFrameLate(const SurfaceBufferInfo& srcBufferInfo) const
+{
+    int budget = latencyBudgetMs_.load();
+    if (budget == 0) {
+        return false;
+    }
+    auto expectedDoneTime = std::chrono::steady_clock::now() + avgProcessTime_;
+    return expectedDoneTime > srcBufferInfo.acquiredTime + std::chrono::milliseconds(budget);
+}
+
+bool VpeVideoImpl::SkipLateFrame(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo)
+{
+    // The late frame is copied to the requested output buffer, so neither the request config nor the output buffers
+    // are changed while it is enabled. It is dropped if it can not be copied.
+    if (lateFrameAction_.load() == VPE_LATE_FRAME_BYPASS && IsSameLayout(srcBufferInfo.buffer, dstBufferInfo.buffer) &&
+        AlgorithmUtils::CopySurfaceBufferToSurfaceBuffer(srcBufferInfo.buffer, dstBufferInfo.buffer)) {
+        VPE_LOGD("Bypass late frame { %{public}s }->{ %{public}s }", ToString(srcBufferInfo.buffer).c_str(),
+            ToString(dstBufferInfo.buffer).c_str());
+        consecutiveLateDrops_ = 0;
+        stats_.OnFrameBypassed();
+        dstBufferInfo.timestamp = srcBufferInfo.timestamp;
+        WaitOutputStageIdle();
+        OutputProcessedBuffer(srcBufferInfo, dstBufferInfo);
+        return true;
+    }
+    if (consecutiveLateDrops_ >= MAX_CONSECUTIVE_LATE_DROPS) {
+        VPE_LOGD("Process late frame { %{public}s } after %{public}u drops",
+            ToString(srcBufferInfo.buffer).c_str(), consecutiveLateDrops_);
+        return false;
+    }
+    consecutiveLateDrops_++;
+    auto ret = consumer_->ReleaseBuffer(srcBufferInfo.buffer, -1);
+    VPE_LOGD("Drop late frame: consumer_->ReleaseBuffer({ %{public}s })=%{public}s",
+        ToString(srcBufferInfo.buffer).c_str(), AlgorithmUtils::ToString(ret).c_str());
+    stats_.OnFrameDropped();
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+    PushBuffer(producerBufferQueue_, dstBufferInfo, VPE_LOG_INFO);
     return true;
 }
 
+bool VpeVideoImpl::IsSameLayout(const sptr<SurfaceBuffer>& buffer1, const sptr<SurfaceBuffer>& buffer2)
+{
+    return buffer1 != nullptr && buffer2 != nullptr && buffer1->GetFormat() == buffer2->GetFormat() &&
+        buffer1->GetWidth() == buffer2->GetWidth() && buffer1->GetHeight() == buffer2->GetHeight() &&
+        buffer1->GetStride() == buffer2->GetStride() && buffer1->GetSize() == buffer2->GetSize();
+}
+
 void VpeVideoImpl::BypassBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo)
 {
     GSError ret1;
@@ -913,7 +1318,8 @@ void VpeVideoImpl::BypassBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferI
             VPE_LOGI("Skip when died.");
             return;
         }
-        std::lock_guard<std::mutex> lock(lock_);
+        std::lock_guard<VpeCountingMutex> lock(lock_);
+        stats_.OnFrameBypassed();
         ret1 = producer_->DetachBufferFromQueue(dstBufferInfo.buffer);
         ret2 = producer_->AttachBufferToQueue(srcBufferInfo.buffer);
         SetRequestCfgLocked(srcBufferInfo.buffer);
@@ -924,34 +1330,199 @@ void VpeVideoImpl::BypassBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferI
             ToString(requestCfg_).c_str());
     }
     OutputBuffer(srcBufferInfo, srcBufferInfo, [this, &srcBufferInfo, &dstBufferInfo, &ret1, &ret2] {
-        attachBufferIDs_.insert(srcBufferInfo.buffer->GetSeqNum());
-        attachBufferQueue_.push(srcBufferInfo);
+        attachBufferIDs_.Insert(srcBufferInfo.buffer->GetSeqNum(), true);
+        PushBuffer(attachBufferQueue_, srcBufferInfo, VPE_LOG_INFO);
         if (ret1 == GSERROR_OK) {
             DelBufferFromCache(dstBufferInfo);
+            KeepWarmBuffer(dstBufferInfo);
         }
         if (ret2 == GSERROR_OK) {
             AddBufferToCache(srcBufferInfo);
+            if (isSeamlessToggle_.load()) {
+                passthroughBufferIDs_.Insert(srcBufferInfo.buffer->GetSeqNum(), true);
+            }
         }
     }, VPE_LOG_INFO);
     VPE_LOGD("cache(%{public}s)->%{public}zu/%{public}zu", ToString(srcBufferInfo.buffer).c_str(),
-        attachBufferIDs_.size(), attachBufferIDs_.size());
+        attachBufferIDs_.Size(), attachBufferIDs_.Size());
     NotifyEnableStatus(0, "disable");
 }
 
+void VpeVideoImpl::KeepWarmBuffer(const SurfaceBufferInfo& bufferInfo)
+{
+    if (bufferInfo.buffer == nullptr || passthroughBufferIDs_.Erase(bufferInfo.buffer->GetSeqNum())) {
+        // The input buffers belong to the input surface, only the output buffers are kept.
+        return;
+    }
+    if (!isSeamlessToggle_.load() || warmBufferQueue_.Size() >= queueSizeController_.GetSize()) {
+        return;
+    }
+    SurfaceBufferInfo warmBufferInfo{};
+    warmBufferInfo.buffer = bufferInfo.buffer;
+    PushBuffer(warmBufferQueue_, warmBufferInfo, VPE_LOG_INFO);
+}
+
+bool VpeVideoImpl::SwapInWarmBuffersLocked()
+{
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+    if (warmBufferQueue_.Empty()) {
+        return false;
+    }
+    const auto& warmBuffer = warmBufferQueue_.Front().buffer;
+    if (warmBuffer->GetWidth() != requestCfg_.width || warmBuffer->GetHeight() != requestCfg_.height ||
+        warmBuffer->GetFormat() != requestCfg_.format) {
+        VPE_LOGD("Drop warm buffers { %{public}s } for requestCfg_({ %{public}s })",
+            ToString(warmBuffer).c_str(), ToString(requestCfg_).c_str());
+        warmBufferQueue_.Clear();
+        return false;
+    }
+    // Swap the free passthrough buffers now, the others are swapped when they are released by the output surface.
+    // During bypass, an input buffer is put back to the free buffers each time the output surface releases it, so
+    // they may hold it more than once, or after it is detached. Only one entry of each attached buffer is kept,
+    // otherwise a frame would be processed into a buffer which is not in the output surface and get lost.
+    BufferQueue freeQueue;
+    BufferIdSet freeBufferIDs;
+    producerBufferQueue_.Swap(freeQueue);
+    while (!freeQueue.Empty()) {
+        SurfaceBufferInfo bufferInfo = freeQueue.Front();
+        freeQueue.Pop();
+        if (bufferInfo.buffer == nullptr || freeBufferIDs.Contains(bufferInfo.buffer->GetSeqNum()) ||
+            producerBufferCache_.Find(bufferInfo.buffer->GetSeqNum()) == nullptr) {
+            VPE_LOGD("Drop stale free buffer { %{public}s }", ToString(bufferInfo.buffer).c_str());
+            continue;
+        }
+        SwapPassthroughBuffer(bufferInfo);
+        if (bufferInfo.buffer != nullptr) {
+            freeBufferIDs.Insert(bufferInfo.buffer->GetSeqNum(), true);
+            PushBuffer(producerBufferQueue_, bufferInfo, VPE_LOG_INFO);
+        }
+    }
+    VPE_LOGD("Enable seamlessly: producerBQ:%{public}zu warmBQ:%{public}zu",
+        producerBufferQueue_.Size(), warmBufferQueue_.Size());
+    return true;
+}
+
+bool VpeVideoImpl::SwapPassthroughBuffer(SurfaceBufferInfo& bufferInfo)
+{
+    if (bufferInfo.buffer == nullptr || !passthroughBufferIDs_.Contains(bufferInfo.buffer->GetSeqNum())) {
+        return false;
+    }
+    // The input buffer may be written by the input surface again, so it must NOT be used as an output buffer.
+    auto ret = producer_->DetachBufferFromQueue(bufferInfo.buffer);
+    CHECK_AND_RETURN_RET_LOG(ret == GSERROR_OK, false, "Failed to DetachBufferFromQueue({ %{public}s }):%{public}s",
+        ToString(bufferInfo.buffer).c_str(), AlgorithmUtils::ToString(ret).c_str());
+    passthroughBufferIDs_.Erase(bufferInfo.buffer->GetSeqNum());
+    DelBufferFromCache(bufferInfo);
+    SurfaceBufferInfo warmBufferInfo{};
+    while (!warmBufferQueue_.Empty() && warmBufferInfo.buffer == nullptr) {
+        warmBufferInfo = warmBufferQueue_.Front();
+        warmBufferQueue_.Pop();
+        ret = producer_->AttachBufferToQueue(warmBufferInfo.buffer);
+        if (ret != GSERROR_OK) {
+            VPE_LOGW("Failed to AttachBufferToQueue({ %{public}s }):%{public}s",
+                ToString(warmBufferInfo.buffer).c_str(), AlgorithmUtils::ToString(ret).c_str());
+            warmBufferInfo.buffer = nullptr;
+        }
+    }
+    VPE_LOGD("Swap { %{public}s } for { %{public}s } warmBQ:%{public}zu", ToString(bufferInfo.buffer).c_str(),
+        ToString(warmBufferInfo.buffer).c_str(), warmBufferQueue_.Size());
+    bufferInfo = warmBufferInfo;
+    if (bufferInfo.buffer == nullptr) {
+        // No buffer is kept, the free slot is filled by requesting a new buffer.
+        needPrepareBuffers_ = true;
+        return true;
+    }
+    AddBufferToCache(bufferInfo);
+    return true;
+}
+
+void VpeVideoImpl::OutputProcessedBuffer(const SurfaceBufferInfo& srcBufferInfo,
+    const SurfaceBufferInfo& dstBufferInfo)
+{
+    sptr<SurfaceBuffer> srcBuffer = srcBufferInfo.buffer;
+    auto ret = consumer_->ReleaseBuffer(srcBuffer, -1);
+    VPE_LOGD("consumer_->ReleaseBuffer({ %{public}s })=%{public}s", ToString(srcBufferInfo.buffer).c_str(),
+        AlgorithmUtils::ToString(ret).c_str());
+    OutputBuffer(srcBufferInfo, dstBufferInfo, [] {}, VPE_LOG_INFO);
+    NotifyEnableStatus(type_, "enable");
+}
+
+void VpeVideoImpl::SubmitToOutputStage(const SurfaceBufferInfo& srcBufferInfo, const SurfaceBufferInfo& dstBufferInfo)
+{
+    {
+        std::unique_lock<std::mutex> outputLock(outputLock_);
+        // Keep the number of frames in the output stage less than the pipeline depth. Output the oldest frame here
+        // instead of waiting for the output task, which may have no thread to run on when the pool is busy.
+        while (outputQueue_.Size() + (isOutputBusy_ ? 1 : 0) >= pipelineDepth_.load()) {
+            if (!OutputFrontLocked(outputLock)) {
+                cvOutput_.wait(outputLock);
+            }
+        }
+        outputQueue_.Push({ srcBufferInfo, dstBufferInfo });
+        VPE_LOGD("outputQ.push({ %{public}s }) size:%{public}zu busy:%{public}d",
+            ToString(dstBufferInfo.buffer).c_str(), outputQueue_.Size(), isOutputBusy_);
+    }
+    if (!outputTaskQueue_.Post([this]() { OutputTask(); })) {
+        VPE_LOGW("Output stage is stopped, the frame is output when the output stage is waited.");
+    }
+}
+
+void VpeVideoImpl::OutputTask()
+{
+    std::unique_lock<std::mutex> outputLock(outputLock_);
+    while (OutputFrontLocked(outputLock)) {}
+}
+
+bool VpeVideoImpl::OutputFrontLocked(std::unique_lock<std::mutex>& outputLock)
+{
+    // Only one frame is output at a time to keep the output order.
+    if (isOutputBusy_ || outputQueue_.Empty()) {
+        return false;
+    }
+    OutputTaskInfo task = outputQueue_.Front();
+    outputQueue_.Pop();
+    isOutputBusy_ = true;
+    outputLock.unlock();
+    OutputProcessedBuffer(task.srcBufferInfo, task.dstBufferInfo);
+    outputLock.lock();
+    isOutputBusy_ = false;
+    cvOutput_.notify_all();
+    return true;
+}
+
+void VpeVideoImpl::WaitOutputStageIdle()
+{
+    std::unique_lock<std::mutex> outputLock(outputLock_);
+    while (!outputQueue_.Empty() || isOutputBusy_) {
+        if (!OutputFrontLocked(outputLock)) {
+            cvOutput_.wait(outputLock);
+        }
+    }
+}
+
 void VpeVideoImpl::OutputBuffer(const SurfaceBufferInfo& bufferInfo, const SurfaceBufferInfo& bufferImage,
     std::function<void(void)>&& getReadyToRender, const LogInfo& logInfo)
 {
+    SurfaceBufferInfo renderBufferInfo = bufferImage;
+    renderBufferInfo.bufferFlag = bufferInfo.bufferFlag;
+    renderBufferInfo.availableTime = std::chrono::steady_clock::now();
     {
-        std::lock_guard<std::mutex> bufferLock(bufferLock_);
-        renderBufferQueue_[bufferImage.buffer->GetSeqNum()] = bufferImage;
+        std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+        if (!renderBufferQueue_.Insert(bufferImage.buffer->GetSeqNum(), renderBufferInfo)) {
+            VPE_ORG_LOGE(logInfo, "renderBufferQueue_ is full, drop { %{public}s }",
+                ToString(bufferImage.buffer).c_str());
+        }
         VPE_ORG_LOGD(logInfo, "renderBufferQueue_.push({ %{public}s }) size:%{public}zu",
-            ToString(bufferImage.buffer).c_str(), renderBufferQueue_.size());
+            ToString(bufferImage.buffer).c_str(), renderBufferQueue_.Size());
         getReadyToRender();
     }
     VpeBufferInfo info {
         .flag = bufferInfo.bufferFlag,
         .presentationTimestamp = bufferInfo.timestamp,
     };
+    if (bufferInfo.bufferFlag != VPE_BUFFER_FLAG_EOS) {
+        stats_.OnFrameOutput();
+    }
     OnOutputBufferAvailable(bufferImage.buffer->GetSeqNum(), info);
 }
 
@@ -971,13 +1542,13 @@ void VpeVideoImpl::NotifyEnableStatus(uint32_t type, const std::string& status)
     }
 }
 
-bool VpeVideoImpl::PopBuffer(std::queue<SurfaceBufferInfo>& bufferQueue, uint32_t index, SurfaceBufferInfo& bufferInfo,
+bool VpeVideoImpl::PopBuffer(BufferQueue& bufferQueue, uint32_t index, SurfaceBufferInfo& bufferInfo,
     std::function<void(sptr<SurfaceBuffer>&)>&& func, const LogInfoEx& logInfos)
 {
     bool isFound = false;
-    while (!bufferQueue.empty()) {
-        bufferInfo = bufferQueue.front();
-        bufferQueue.pop();
+    while (!bufferQueue.Empty()) {
+        bufferInfo = bufferQueue.Front();
+        bufferQueue.Pop();
         func(bufferInfo.buffer);
         VPE_EX_LOGD(logInfos, "index:%{public}u buffer:{ %{public}s }", index, ToString(bufferInfo.buffer).c_str());
         if (bufferInfo.buffer != nullptr && bufferInfo.buffer->GetSeqNum() == index) {
@@ -990,11 +1561,23 @@ bool VpeVideoImpl::PopBuffer(std::queue<SurfaceBufferInfo>& bufferQueue, uint32_
 
 void VpeVideoImpl::PrintBufferSize() const
 {
-    std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
-    std::lock_guard<std::mutex> bufferLock(bufferLock_);
+    std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
     VPE_LOGD("consumerBQ:%{public}zu producerBQ:%{public}zu renderBQ:%{public}zu flushBQ:%{public}zu "
-        "attachBQ:%{public}zu", consumerBufferQueue_.size(), producerBufferQueue_.size(), renderBufferQueue_.size(),
-        flushBufferQueue_.size(), attachBufferQueue_.size());
+        "attachBQ:%{public}zu", consumerBufferQueue_.Size(), producerBufferQueue_.Size(), renderBufferQueue_.Size(),
+        flushBufferQueue_.Size(), attachBufferQueue_.Size());
+}
+
+void VpeVideoImpl::GetStatistics(VpeVideoStatistics& statistics) const
+{
+    stats_.GetStatistics(statistics);
+    std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+    std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+    statistics.inputQueueDepth = static_cast<uint32_t>(consumerBufferQueue_.Size());
+    statistics.outputQueueDepth = static_cast<uint32_t>(producerBufferQueue_.Size());
+    statistics.renderQueueDepth = static_cast<uint32_t>(renderBufferQueue_.Size());
+    statistics.lockContentions = lock_.GetContentions() + producerLock_.GetContentions() +
+        consumerBufferLock_.GetContentions() + bufferLock_.GetContentions();
 }
 
 void VpeVideoImpl::SetRequestCfgLocked(const sptr<SurfaceBuffer>& buffer)
@@ -1006,36 +1589,68 @@ void VpeVideoImpl::SetRequestCfgLocked(const sptr<SurfaceBuffer>& buffer)
     orgRequestCfg_ = requestCfg_;
 }
 
-bool VpeVideoImpl::WaitTrigger()
+void VpeVideoImpl::Trigger()
 {
+    // Only one task is pending at a time, the task checks all the buffers which are ready.
+    if (isTaskPending_.exchange(true)) {
+        return;
+    }
+    if (!taskQueue_.Post([this]() { ProcessTask(); })) {
+        isTaskPending_ = false;
+    }
+}
+
+void VpeVideoImpl::ProcessTask()
+{
+    // Clear the flag before checking the buffers, so that the buffers ready during processing trigger a new task.
+    isTaskPending_ = false;
+    if (!CheckTrigger()) {
+        return;
+    }
+    VPE_LOGD("ProcessBuffers");
+    bool isYielded = false;
+    bool isProcessed = ProcessBuffers(isYielded);
+    // The object stops after all the buffers queued before Stop are processed.
+    if (!isYielded) {
+        CheckStopping();
+    }
+    // Some buffers may be left, such as the buffers after EOS, check them again.
+    if (isProcessed) {
+        Trigger();
+    }
+}
+
+bool VpeVideoImpl::CheckTrigger()
+{
+    if (!isRunning_.load()) {
+        VPE_LOGI("Skip CheckTrigger when died.");
+        return false;
+    }
+    if (needPrepareBuffers_.load() || needPrepareBuffersForNewProducer_.load()) {
+        std::lock_guard<VpeCountingMutex> lock(lock_);
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+        std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+        PrepareBuffers();
+        needPrepareBuffers_ = false;
+        needPrepareBuffersForNewProducer_ = false;
+    }
     uint32_t consumerSize = 0;
     uint32_t producerSize = 0;
-    std::unique_lock<std::mutex> waitLock(waitLock_);
-    if (!cvTrigger_.wait_for(waitLock, 200s, [this, &consumerSize, &producerSize] {
-            if (!isRunning_.load()) {
-                VPE_LOGI("Skip WaitTrigger when died.");
-                return true;
-            }
-            if (needPrepareBuffers_.load() || needPrepareBuffersForNewProducer_.load()) {
-                std::lock_guard<std::mutex> lock(lock_);
-                std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
-                std::lock_guard<std::mutex> bufferLock(bufferLock_);
-                PrepareBuffers();
-                needPrepareBuffers_ = false;
-                needPrepareBuffersForNewProducer_ = false;
-            }
-            std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
-            std::lock_guard<std::mutex> bufferLock(bufferLock_);
-            consumerSize = consumerBufferQueue_.size();
-            producerSize = producerBufferQueue_.size();
-            VPE_LOGD("run:%{public}d stopping:%{public}d consumerBQ:%{public}u producerBQ:%{public}u "
-                "renderBQ:%{public}zu flushBQ:%{public}zu attachBQ:%{public}zu",
-                isRunning_.load(), state_.load() == VPEState::STOPPING, consumerSize, producerSize,
-                renderBufferQueue_.size(), flushBufferQueue_.size(), attachBufferQueue_.size());
-            return !isRunning_.load() || state_.load() == VPEState::STOPPING || (consumerSize > 0 && producerSize > 0);
-        })) {
-        VPE_LOGI("Video processing timeout.");
-        return false;
+    {
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+        std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
+        consumerSize = consumerBufferQueue_.Size();
+        producerSize = producerBufferQueue_.Size();
+        VPE_LOGD("run:%{public}d stopping:%{public}d consumerBQ:%{public}u producerBQ:%{public}u "
+            "renderBQ:%{public}zu flushBQ:%{public}zu attachBQ:%{public}zu",
+            isRunning_.load(), state_.load() == VPEState::STOPPING, consumerSize, producerSize,
+            renderBufferQueue_.Size(), flushBufferQueue_.Size(), attachBufferQueue_.Size());
+    }
+    // Keep the output queue within the memory limit, which may be lowered or exceeded by larger buffers.
+    ShrinkProducerQueue();
+    // The input is ready but all output buffers are in use, try to grow the output queue.
+    if (consumerSize > 0 && producerSize == 0) {
+        GrowProducerQueue(producerSize);
     }
 
     if (!isRunning_.load()) {
@@ -1063,13 +1678,21 @@ bool VpeVideoImpl::CheckStopping()
         VPE_LOGI("Skip when died.");
         return true;
     }
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     return CheckStoppingLocked();
 }
 
 bool VpeVideoImpl::CheckStoppingLocked()
 {
     if (state_.load() == VPEState::STOPPING) {
+        if (isRunning_.load()) {
+            // The buffers acquired before Stop are processed after they leave the input stage.
+            std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+            if (!inputStageQueue_.Empty()) {
+                VPE_LOGD("Wait for the input stage before stopping.");
+                return false;
+            }
+        }
         state_ = VPEState::IDLE;
         OnStateLocked(VPEAlgoState::STOPPED);
         return true;
@@ -1077,44 +1700,47 @@ bool VpeVideoImpl::CheckStoppingLocked()
     return false;
 }
 
-void VpeVideoImpl::ClearQueue(std::queue<SurfaceBufferInfo>& bufferQueue)
+void VpeVideoImpl::PushBuffer(BufferQueue& bufferQueue, const SurfaceBufferInfo& bufferInfo, const LogInfo& logInfo)
 {
-    if (bufferQueue.empty()) {
-        return;
+    if (!bufferQueue.Push(bufferInfo)) {
+        VPE_ORG_LOGE(logInfo, "Buffer queue is full(%{public}zu), drop { %{public}s }",
+            bufferQueue.Size(), ToString(bufferInfo.buffer).c_str());
     }
-    bufferQueue = std::queue<SurfaceBufferInfo>();
 }
 
-void VpeVideoImpl::ClearConsumerLocked(std::queue<SurfaceBufferInfo>& bufferQueue)
+void VpeVideoImpl::ClearConsumerLocked(BufferQueue& bufferQueue)
 {
     CHECK_AND_RETURN_LOG(consumer_ != nullptr, "input surface is null!");
-    while (!bufferQueue.empty()) {
-        auto bufferInfo = bufferQueue.front();
+    while (!bufferQueue.Empty()) {
+        auto bufferInfo = bufferQueue.Front();
         auto err = consumer_->ReleaseBuffer(bufferInfo.buffer, -1);
         if (err != GSERROR_OK) {
             VPE_LOGW("Failed to ReleaseBuffer({ %{public}s }):%{public}s", ToString(bufferInfo.buffer).c_str(),
                 AlgorithmUtils::ToString(err).c_str());
         }
-        bufferQueue.pop();
+        bufferQueue.Pop();
     }
 }
 
 void VpeVideoImpl::ClearBufferQueues()
 {
-    std::queue<SurfaceBufferInfo> tempQueue1;
-    std::queue<SurfaceBufferInfo> tempQueue2;
+    BufferQueue tempQueue1;
+    BufferQueue tempQueue2;
     {
-        std::lock_guard<std::mutex> consumerBufferLock(consumerBufferLock_);
-        std::lock_guard<std::mutex> bufferLock(bufferLock_);
+        std::lock_guard<VpeCountingMutex> consumerBufferLock(consumerBufferLock_);
+        std::lock_guard<VpeCountingMutex> bufferLock(bufferLock_);
         isBufferQueueReady_ = false;
-        consumerBufferQueue_.swap(tempQueue1);
-        ClearQueue(producerBufferQueue_);
-        renderBufferQueue_.clear();
-        ClearQueue(flushBufferQueue_);
-        producerBufferCache_.clear();
-        attachBufferQueue_.swap(tempQueue2);
-        attachBufferIDs_.clear();
-    }
+        consumerBufferQueue_.Swap(tempQueue1);
+        producerBufferQueue_.Clear();
+        renderBufferQueue_.Clear();
+        flushBufferQueue_.Clear();
+        producerBufferCache_.Clear();
+        attachBufferQueue_.Swap(tempQueue2);
+        attachBufferIDs_.Clear();
+        warmBufferQueue_.Clear();
+        passthroughBufferIDs_.Clear();
+    }
+    ClearInputStageLocked();
     ClearConsumerLocked(tempQueue1);
     ClearConsumerLocked(tempQueue2);
 }
@@ -1143,7 +1769,7 @@ VPEAlgoErrCode VpeVideoImpl::ExecuteWhenRunning(std::function<VPEAlgoErrCode(voi
 VPEAlgoErrCode VpeVideoImpl::ExecuteWithCheck(std::function<bool(void)>&& checker,
     std::function<VPEAlgoErrCode(void)>&& operation, const std::string& errorMessage, const LogInfo& logInfo)
 {
-    std::lock_guard<std::mutex> lock(lock_);
+    std::lock_guard<VpeCountingMutex> lock(lock_);
     if (checker()) {
         return operation();
     }
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "buffer_queue_size_controller.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <limits>
+
+#include "vpe_log.h"
+
+using namespace OHOS::Media::VideoProcessingEngine;
+using namespace std::chrono_literals;
+
+namespace {
+constexpr uint32_t MIN_ADAPTIVE_QUEUE_SIZE = 3;
+constexpr uint32_t MAX_ADAPTIVE_QUEUE_SIZE = 8;
+// Grow only if the stall happens repeatedly, and not more often than the interval, to avoid growing on one burst.
+constexpr uint32_t STALL_COUNT_TO_GROW = 2;
+constexpr auto MIN_GROW_INTERVAL = 500ms;
+} // namespace
+
+void BufferQueueSizeController::SetAdaptive(bool isAdaptive)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    VPE_LOGI("adaptive queue size:%{public}d->%{public}d", isAdaptive_, isAdaptive);
+    isAdaptive_ = isAdaptive;
+    stallCount_ = 0;
+}
+
+bool BufferQueueSizeController::IsAdaptive() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return isAdaptive_;
+}
+
+bool BufferQueueSizeController::SetMemoryLimit(int64_t memoryLimit)
+{
+    CHECK_AND_RETURN_RET_LOG(memoryLimit >= 0, false, "Invalid input: memory limit=%{public}" PRId64 "!",
+        memoryLimit);
+    std::lock_guard<std::mutex> lock(lock_);
+    VPE_LOGI("memory limit:%{public}" PRId64 "->%{public}" PRId64, memoryLimit_, memoryLimit);
+    memoryLimit_ = memoryLimit;
+    return true;
+}
+
+int64_t BufferQueueSizeController::GetMemoryLimit() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return memoryLimit_;
+}
+
+uint32_t BufferQueueSizeController::ResetSize(uint64_t bufferSize)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    currentSize_ = std::min(GetInitialSizeLocked(), GetLimitedSizeLocked(bufferSize));
+    stallCount_ = 0;
+    return currentSize_;
+}
+
+uint32_t BufferQueueSizeController::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return currentSize_;
+}
+
+bool BufferQueueSizeController::OnStall(uint64_t bufferSize, uint32_t& newSize)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!isAdaptive_) {
+        return false;
+    }
+    stallCount_++;
+    if (stallCount_ < STALL_COUNT_TO_GROW) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastGrowTime_ < MIN_GROW_INTERVAL) {
+        return false;
+    }
+    uint32_t maxSize = std::min(GetLimitedSizeLocked(bufferSize), MAX_ADAPTIVE_QUEUE_SIZE);
+    if (currentSize_ >= maxSize) {
+        VPE_LOGD("Keep queue size %{public}u, max:%{public}u bufferSize:%{public}" PRIu64 " limit:%{public}" PRId64,
+            currentSize_, maxSize, bufferSize, memoryLimit_);
+        return false;
+    }
+    VPE_LOGI("Grow queue size %{public}u->%{public}u after %{public}u stalls, max:%{public}u",
+        currentSize_, currentSize_ + 1, stallCount_, maxSize);
+    currentSize_++;
+    stallCount_ = 0;
+    lastGrowTime_ = now;
+    newSize = currentSize_;
+    return true;
+}
+
+bool BufferQueueSizeController::ShrinkToLimit(uint64_t bufferSize, uint32_t& newSize)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    uint32_t limitedSize = GetLimitedSizeLocked(bufferSize);
+    if (currentSize_ <= limitedSize) {
+        return false;
+    }
+    VPE_LOGI("Shrink queue size %{public}u->%{public}u, bufferSize:%{public}" PRIu64 " limit:%{public}" PRId64,
+        currentSize_, limitedSize, bufferSize, memoryLimit_);
+    currentSize_ = limitedSize;
+    stallCount_ = 0;
+    newSize = currentSize_;
+    return true;
+}
+
+uint32_t BufferQueueSizeController::GetInitialSizeLocked() const
+{
+    return isAdaptive_ ? std::min(MIN_ADAPTIVE_QUEUE_SIZE, defaultSize_) : defaultSize_;
+}
+
+uint32_t BufferQueueSizeController::GetLimitedSizeLocked(uint64_t bufferSize) const
+{
+    if (memoryLimit_ == 0 || bufferSize == 0) {
+        return std::numeric_limits<uint32_t>::max();
+    }
+    uint64_t limitedSize = static_cast<uint64_t>(memoryLimit_) / bufferSize;
+    // The output can not work without any buffer, so keep one even if it alone exceeds the limit.
+    return static_cast<uint32_t>(std::clamp<uint64_t>(limitedSize, 1, std::numeric_limits<uint32_t>::max()));
+}
@@ -23,11 +23,10 @@
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <set>
 #include <string>
 #include <thread>
-#include <unordered_map>
+#include <vector>
 
 #include "refbase.h"
 #include "surface.h"
@@ -36,7 +35,12 @@
 
 #include "algorithm_errors.h"
 #include "algorithm_video.h"
+#include "buffer_queue_size_controller.h"
+#include "vpe_counting_mutex.h"
 #include "vpe_log.h"
+#include "vpe_ring_buffer.h"
+#include "vpe_task_executor.h"
+#include "vpe_video_stats.h"
 
 namespace OHOS {
 namespace Media {
@@ -56,6 +60,8 @@ public:
     VPEAlgoErrCode ReleaseOutputBuffer(uint32_t index, bool render) override;
     VPEAlgoErrCode RenderOutputBufferAtTime(uint32_t index, int64_t renderTimestamp) override;
 
+    uint32_t GetType() const;
+
 protected:
     explicit VpeVideoImpl(uint32_t type) : type_(type) {}
     virtual ~VpeVideoImpl();
@@ -70,6 +76,13 @@ protected:
     VPEAlgoErrCode Deinitialize();
     void RefreshBuffers();
     void OnOutputFormatChanged(const Format& format);
+    // Set or get the parameters shared by all video features, such as pipeline depth.
+    // SetCommonParameter returns the number of parameters set, or -1 if any parameter is invalid. All the parameters
+    // are checked before any of them is applied, so nothing is changed if one of them is invalid.
+    int SetCommonParameter(const Format& parameter);
+    // CheckCommonParameter returns the same as SetCommonParameter but applies nothing.
+    int CheckCommonParameter(const Format& parameter);
+    void GetCommonParameter(Format& parameter) const;
 
     // These funcions may be overried by derived class as necessary.
     virtual VPEAlgoErrCode OnInitialize();
@@ -79,12 +92,21 @@ protected:
     // if you do NOT reset the protection status, the feature may not response properly when user call Enable() again.
     virtual VPEAlgoErrCode ResetAfterDisable();
     virtual bool IsDisableAfterProcessFail();
+    // Return true if Process supports the same buffer as the source and the destination, such as only generating
+    // metadata. VpeVideoPipeline uses it to skip the intermediate buffer of the stage.
+    virtual bool IsInPlaceSupported();
+    // Return false if the EOS buffer, which carries no frame, goes back to the free output buffers instead of being
+    // flushed to the output surface when it is rendered.
+    virtual bool IsEosBufferFlushed();
     virtual bool IsProducerSurfaceValid(const sptr<Surface>& surface);
     virtual bool IsConsumerBufferValid(const sptr<SurfaceBuffer>& buffer);
     virtual VPEAlgoErrCode UpdateRequestCfg(const sptr<Surface>& surface, BufferRequestConfig& requestCfg);
     virtual void UpdateRequestCfg(const sptr<SurfaceBuffer>& consumerBuffer, BufferRequestConfig& requestCfg);
 
 private:
+    // The pipeline calls Process and UpdateRequestCfg of its stages directly.
+    friend class VpeVideoPipeline;
+
     enum class VPEState : int {
         IDLE = 0,
         RUNNING,
@@ -98,8 +120,23 @@ private:
         int64_t timestamp{};
         bool isFlushed{};
         std::chrono::time_point<std::chrono::steady_clock> flushedTime{};
+        std::chrono::time_point<std::chrono::steady_clock> acquiredTime{};
+        std::chrono::time_point<std::chrono::steady_clock> availableTime{};
     };
 
+    struct OutputTaskInfo {
+        SurfaceBufferInfo srcBufferInfo{};
+        SurfaceBufferInfo dstBufferInfo{};
+    };
+
+    static constexpr uint32_t BUFFER_QUEUE_SIZE = 5;
+    // The capacity covers the maximum queue size of a surface, so the buffer containers never overflow in practice.
+    static constexpr size_t MAX_BUFFER_NUM = 64;
+    static constexpr size_t MAX_OUTPUT_TASK_NUM = 4;
+    using BufferQueue = RingQueue<SurfaceBufferInfo, MAX_BUFFER_NUM>;
+    using BufferMap = SeqNumMap<SurfaceBufferInfo, MAX_BUFFER_NUM>;
+    using BufferIdSet = SeqNumMap<bool, MAX_BUFFER_NUM>;
+
     class ConsumerListener : public IBufferConsumerListener {
     public:
         explicit ConsumerListener(const std::shared_ptr<VpeVideoImpl>& owner) : owner_(owner) {}
@@ -115,6 +152,20 @@ private:
         std::weak_ptr<VpeVideoImpl> owner_;
     };
 
+    using ParameterApplier = std::function<void(void)>;
+
+    // Return the number of the valid common parameters and the appliers of them, or -1 if any parameter is invalid.
+    int PrepareCommonParameter(const Format& parameter, std::vector<ParameterApplier>& appliers);
+    // Each of them returns 0 if the parameter is not set, 1 and its applier if it is valid, or -1 if it is invalid.
+    int PreparePipelineDepth(const Format& parameter, ParameterApplier& applier);
+    int PrepareAdaptiveQueueSize(const Format& parameter, ParameterApplier& applier);
+    int PrepareBufferMemoryLimit(const Format& parameter, ParameterApplier& applier);
+    int PrepareLatencyBudget(const Format& parameter, ParameterApplier& applier);
+    int PrepareLateFrameAction(const Format& parameter, ParameterApplier& applier);
+    int PrepareSeamlessToggle(const Format& parameter, ParameterApplier& applier);
+    void SetPipelineDepth(int depth);
+    void SetSeamlessToggle(bool isSeamless);
+
     void OnError(VPEAlgoErrCode errorCode);
     void OnStateLocked(VPEAlgoState state);
     void OnEffectChange(uint32_t type);
@@ -131,27 +182,49 @@ private:
     bool RequestBuffer(SurfaceBufferInfo& bufferInfo, GSError& errorCode, const LogInfoEx& logInfos);
     void PrepareBuffers();
     bool AttachAndRefreshProducerBuffers(const sptr<Surface>& producer);
-    void AddProducerBuffers(std::queue<SurfaceBufferInfo>& bufferQueue, std::set<uint32_t>& producerBufferIDs);
+    void AddProducerBuffers(BufferQueue& bufferQueue, std::set<uint32_t>& producerBufferIDs);
     void AddBufferToCache(const SurfaceBufferInfo& bufferInfo);
     void DelBufferFromCache(const SurfaceBufferInfo& bufferInfo);
     void CheckAndUpdateProducerCache();
-    void ProcessBuffers();
+    bool GrowProducerQueue(uint32_t& producerSize);
+    void ShrinkProducerQueue();
+    // Set isYielded to true if it returns with buffers left, to let the other objects use the thread.
+    bool ProcessBuffers(bool& isYielded);
     bool GetConsumerAndProducerBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo);
     bool ProcessBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo);
+    bool IsFrameLate(const SurfaceBufferInfo& srcBufferInfo) const;
+    bool SkipLateFrame(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo);
+    static bool IsSameLayout(const sptr<SurfaceBuffer>& buffer1, const sptr<SurfaceBuffer>& buffer2);
     void BypassBuffer(SurfaceBufferInfo& srcBufferInfo, SurfaceBufferInfo& dstBufferInfo);
+    void KeepWarmBuffer(const SurfaceBufferInfo& bufferInfo);
+    bool SwapInWarmBuffersLocked();
+    bool SwapPassthroughBuffer(SurfaceBufferInfo& bufferInfo);
+    void OutputProcessedBuffer(const SurfaceBufferInfo& srcBufferInfo, const SurfaceBufferInfo& dstBufferInfo);
+    void SubmitToOutputStage(const SurfaceBufferInfo& srcBufferInfo, const SurfaceBufferInfo& dstBufferInfo);
+    void OutputTask();
+    // Output the oldest frame of the output stage with outputLock unlocked, return false if nothing is output.
+    bool OutputFrontLocked(std::unique_lock<std::mutex>& outputLock);
+    void WaitOutputStageIdle();
     void OutputBuffer(const SurfaceBufferInfo& bufferInfo, const SurfaceBufferInfo& bufferImage,
         std::function<void(void)>&& getReadyToRender, const LogInfo& logInfo);
     void NotifyEnableStatus(uint32_t type, const std::string& status);
-    bool PopBuffer(std::queue<SurfaceBufferInfo>& bufferQueue, uint32_t index, SurfaceBufferInfo& bufferInfo,
+    bool PopBuffer(BufferQueue& bufferQueue, uint32_t index, SurfaceBufferInfo& bufferInfo,
         std::function<void(sptr<SurfaceBuffer>&)>&& func, const LogInfoEx& logInfos);
     void PrintBufferSize() const;
+    void GetStatistics(VpeVideoStatistics& statistics) const;
     void SetRequestCfgLocked(const sptr<SurfaceBuffer>& buffer);
-    bool WaitTrigger();
+    void SubmitToInputStageLocked(SurfaceBufferInfo& bufferInfo);
+    void InputTask();
+    void ClearInputStageLocked();
+    void PushConsumerBufferLocked(SurfaceBufferInfo& bufferInfo);
+    void Trigger();
+    void ProcessTask();
+    bool CheckTrigger();
     void CheckSpuriousWakeup();
     bool CheckStopping();
     bool CheckStoppingLocked();
-    void ClearQueue(std::queue<SurfaceBufferInfo>& bufferQueue);
-    void ClearConsumerLocked(std::queue<SurfaceBufferInfo>& bufferQueue);
+    void PushBuffer(BufferQueue& bufferQueue, const SurfaceBufferInfo& bufferInfo, const LogInfo& logInfo);
+    void ClearConsumerLocked(BufferQueue& bufferQueue);
     void ClearBufferQueues();
 
     VPEAlgoErrCode ExecuteWhenIdle(std::function<VPEAlgoErrCode(void)>&& operation, const std::string& errorMessage,
@@ -166,20 +239,21 @@ private:
     // Common
     uint32_t type_{};
 
-    // For thread control
-    std::condition_variable cvTrigger_{};
+    // For task control
+    // The buffers are processed by the tasks of taskQueue_, which are executed by the shared thread pool.
+    VpeSerialQueue taskQueue_{};
+    std::atomic<bool> isTaskPending_{false};
     std::condition_variable cvDone_{};
 
     // [WARNING]
     // The lock must be held in the following order:
-    //  waitLock_
     //  lock_
     //  taskLock_
     //  producerLock_
     //  consumerBufferLock_
     //  bufferLock_
-    mutable std::mutex waitLock_{};
-    mutable std::mutex lock_{};
+    // The contentions of these locks except taskLock_, which cvDone_ waits on, are counted for statistics.
+    mutable VpeCountingMutex lock_{};
     // Guarded by lock_ begin
     std::atomic<bool> isInitialized_{false};
     std::atomic<bool> isRunning_{false};
@@ -191,37 +265,70 @@ private:
     GraphicTransformType lastTransform_{};
     ScalingMode lastScalingMode_{};
     bool isForceUpdateProducer_{true};
-    std::thread worker_{};
     std::shared_ptr<VpeVideoCallback> cb_{};
     sptr<Surface> consumer_{};
     sptr<Surface> producer_{}; // Also guarded by producerLock_
     BufferRequestConfig requestCfg_{};
     BufferRequestConfig orgRequestCfg_{};
     // Guarded by lock_ end
-    mutable std::mutex producerLock_{};
+    mutable VpeCountingMutex producerLock_{};
 
     mutable std::mutex taskLock_{};
     // Guarded by taskLock_ begin
     std::atomic<bool> isProcessing_{false};
     // Guarded by taskLock_ end
 
-    mutable std::mutex consumerBufferLock_{};
+    mutable VpeCountingMutex consumerBufferLock_{};
     // Guarded by consumerBufferLock_ begin
     std::atomic<bool> isBufferQueueReady_{false};
     std::atomic<bool> needPrepareBuffers_{false};
-    std::queue<SurfaceBufferInfo> consumerBufferQueue_{};
+    BufferQueue consumerBufferQueue_{};
+    // The acquired buffers waiting for their fences in the input stage, and the number of times they are cleared.
+    BufferQueue inputStageQueue_{};
+    uint64_t inputStageGeneration_{};
     // Guarded by consumerBufferLock_ end
 
-    mutable std::mutex bufferLock_{};
+    mutable VpeCountingMutex bufferLock_{};
     // Guarded by bufferLock_ begin
     std::atomic<bool> needPrepareBuffersForNewProducer_{false};
-    std::queue<SurfaceBufferInfo> producerBufferQueue_{};
-    std::unordered_map<uint32_t, SurfaceBufferInfo> renderBufferQueue_{};
-    std::queue<SurfaceBufferInfo> flushBufferQueue_{};
-    std::unordered_map<uint32_t, SurfaceBufferInfo> producerBufferCache_{};
-    std::queue<SurfaceBufferInfo> attachBufferQueue_{};
-    std::set<uint32_t> attachBufferIDs_{};
+    std::atomic<uint64_t> outputBufferSize_{};
+    BufferQueue producerBufferQueue_{};
+    BufferMap renderBufferQueue_{};
+    BufferQueue flushBufferQueue_{};
+    BufferMap producerBufferCache_{};
+    BufferQueue attachBufferQueue_{};
+    BufferIdSet attachBufferIDs_{};
+    // For seamless toggling, the processed output buffers detached by bypass, and the input buffers attached to
+    // the output surface by bypass.
+    BufferQueue warmBufferQueue_{};
+    BufferIdSet passthroughBufferIDs_{};
     // Guarded by bufferLock_ end
+
+    // The input and output stages of the pipeline, they are enabled when the pipeline depth is greater than 1.
+    // The input stage waits for the fence of the next buffer and the output stage releases the input buffer and
+    // notifies the client of the last buffer, both run by the shared thread pool while a buffer is being processed.
+    VpeSerialQueue inputTaskQueue_{};
+    VpeSerialQueue outputTaskQueue_{};
+    // [WARNING] outputLock_ is a leaf lock, do NOT acquire any other lock while holding it.
+    mutable std::mutex outputLock_{};
+    std::condition_variable cvOutput_{};
+    std::atomic<uint32_t> pipelineDepth_{1};
+    // Guarded by outputLock_ begin
+    bool isOutputBusy_{false};
+    RingQueue<OutputTaskInfo, MAX_OUTPUT_TASK_NUM> outputQueue_{};
+    // Guarded by outputLock_ end
+
+    BufferQueueSizeController queueSizeController_{BUFFER_QUEUE_SIZE};
+    VpeVideoStats stats_{};
+    std::atomic<bool> isSeamlessToggle_{false};
+
+    // For deadline-aware processing
+    std::atomic<int> latencyBudgetMs_{0};
+    std::atomic<int> lateFrameAction_{VPE_LATE_FRAME_BYPASS};
+    // Used by the processing task only begin
+    std::chrono::steady_clock::duration avgProcessTime_{};
+    uint32_t consecutiveLateDrops_{};
+    // Used by the processing task only end
 };
 } // namespace VideoProcessingEngine
 } // namespace Media
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BUFFER_QUEUE_SIZE_CONTROLLER_H
+#define BUFFER_QUEUE_SIZE_CONTROLLER_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Decide the queue size of the output surface.
+ *
+ * In the default (fixed) mode, the queue size is always the default size.
+ * In the adaptive mode, the queue size starts shallow for low latency and grows one buffer at a time when the
+ * processing is stalled because there is no free output buffer.
+ * In both modes, the queue size is clamped so that the total buffer memory does not exceed the memory limit, and it
+ * shrinks if the buffers become larger or the limit becomes lower. At least one buffer is always kept.
+ */
+class BufferQueueSizeController {
+public:
+    explicit BufferQueueSizeController(uint32_t defaultSize) : defaultSize_(defaultSize), currentSize_(defaultSize) {}
+    ~BufferQueueSizeController() = default;
+    BufferQueueSizeController(const BufferQueueSizeController&) = delete;
+    BufferQueueSizeController& operator=(const BufferQueueSizeController&) = delete;
+    BufferQueueSizeController(BufferQueueSizeController&&) = delete;
+    BufferQueueSizeController& operator=(BufferQueueSizeController&&) = delete;
+
+    void SetAdaptive(bool isAdaptive);
+    bool IsAdaptive() const;
+    // The limit of the total memory of output buffers in bytes, 0 means no limit.
+    bool SetMemoryLimit(int64_t memoryLimit);
+    int64_t GetMemoryLimit() const;
+
+    // Return the queue size for a newly configured output surface and restart the adaption from it.
+    // bufferSize is the size of one output buffer in bytes, 0 means it is unknown yet.
+    uint32_t ResetSize(uint64_t bufferSize = 0);
+    uint32_t GetSize() const;
+    // Called when an input buffer is ready but there is no free output buffer. Return true if the queue should grow,
+    // and newSize is the new queue size.
+    bool OnStall(uint64_t bufferSize, uint32_t& newSize);
+    // Return true if the queue should shrink to fit the memory limit with buffers of bufferSize bytes,
+    // and newSize is the new queue size.
+    bool ShrinkToLimit(uint64_t bufferSize, uint32_t& newSize);
+
+private:
+    uint32_t GetInitialSizeLocked() const;
+    // The largest queue size whose buffers fit the memory limit, or UINT32_MAX if there is no limit.
+    uint32_t GetLimitedSizeLocked(uint64_t bufferSize) const;
+
+    mutable std::mutex lock_{};
+    // Guarded by lock_ begin
+    const uint32_t defaultSize_{};
+    bool isAdaptive_{false};
+    int64_t memoryLimit_{};
+    uint32_t currentSize_{};
+    uint32_t stallCount_{};
+    std::chrono::steady_clock::time_point lastGrowTime_{};
+    // Guarded by lock_ end
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // BUFFER_QUEUE_SIZE_CONTROLLER_H
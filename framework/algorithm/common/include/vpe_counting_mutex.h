@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPE_COUNTING_MUTEX_H
+#define VPE_COUNTING_MUTEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Mutex which counts how many times lock() has to wait for another thread.
+ * It meets the Lockable requirements, so it works with std::lock_guard and std::unique_lock.
+ * The uncontended path costs one extra try_lock only.
+ */
+class VpeCountingMutex {
+public:
+    VpeCountingMutex() = default;
+    ~VpeCountingMutex() = default;
+    VpeCountingMutex(const VpeCountingMutex&) = delete;
+    VpeCountingMutex& operator=(const VpeCountingMutex&) = delete;
+    VpeCountingMutex(VpeCountingMutex&&) = delete;
+    VpeCountingMutex& operator=(VpeCountingMutex&&) = delete;
+
+    void lock()
+    {
+        if (mutex_.try_lock()) {
+            return;
+        }
+        contentions_.fetch_add(1, std::memory_order_relaxed);
+        mutex_.lock();
+    }
+
+    bool try_lock()
+    {
+        return mutex_.try_lock();
+    }
+
+    void unlock()
+    {
+        mutex_.unlock();
+    }
+
+    uint64_t GetContentions() const
+    {
+        return contentions_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::mutex mutex_{};
+    std::atomic<uint64_t> contentions_{0};
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // VPE_COUNTING_MUTEX_H
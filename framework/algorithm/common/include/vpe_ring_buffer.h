@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPE_RING_BUFFER_H
+#define VPE_RING_BUFFER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Fixed-capacity FIFO queue without any memory allocation after construction.
+ * It is NOT thread safe, the caller should guard it as necessary.
+ */
+template <typename T, size_t N>
+class RingQueue {
+    static_assert(N > 0, "Capacity must be greater than 0!");
+
+public:
+    RingQueue() = default;
+    ~RingQueue() = default;
+    RingQueue(const RingQueue&) = default;
+    RingQueue& operator=(const RingQueue&) = default;
+    RingQueue(RingQueue&&) = default;
+    RingQueue& operator=(RingQueue&&) = default;
+
+    bool Empty() const
+    {
+        return size_ == 0;
+    }
+
+    bool Full() const
+    {
+        return size_ == N;
+    }
+
+    size_t Size() const
+    {
+        return size_;
+    }
+
+    static constexpr size_t Capacity()
+    {
+        return N;
+    }
+
+    T& Front()
+    {
+        return items_[head_];
+    }
+
+    const T& Front() const
+    {
+        return items_[head_];
+    }
+
+    // Return false if the queue is full.
+    bool Push(const T& item)
+    {
+        if (Full()) {
+            return false;
+        }
+        items_[(head_ + size_) % N] = item;
+        size_++;
+        return true;
+    }
+
+    void Pop()
+    {
+        if (Empty()) {
+            return;
+        }
+        // Reset the slot so that the resources held by the item are released in time.
+        items_[head_] = T{};
+        head_ = (head_ + 1) % N;
+        size_--;
+    }
+
+    void Clear()
+    {
+        while (!Empty()) {
+            Pop();
+        }
+        head_ = 0;
+    }
+
+    void Swap(RingQueue& other)
+    {
+        items_.swap(other.items_);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+    }
+
+    // Visit items from front to back.
+    template <typename Func>
+    void ForEach(Func&& func)
+    {
+        for (size_t i = 0; i < size_; i++) {
+            func(items_[(head_ + i) % N]);
+        }
+    }
+
+private:
+    std::array<T, N> items_{};
+    size_t head_{};
+    size_t size_{};
+};
+
+/**
+ * Fixed-capacity hash table keyed by buffer sequence number without any memory allocation after construction.
+ * Open addressing with linear probing is used, so the capacity should be larger than the number of buffers.
+ * It is NOT thread safe, the caller should guard it as necessary.
+ */
+template <typename T, size_t N>
+class SeqNumMap {
+    static_assert(N > 0, "Capacity must be greater than 0!");
+
+public:
+    SeqNumMap() = default;
+    ~SeqNumMap() = default;
+    SeqNumMap(const SeqNumMap&) = default;
+    SeqNumMap& operator=(const SeqNumMap&) = default;
+    SeqNumMap(SeqNumMap&&) = default;
+    SeqNumMap& operator=(SeqNumMap&&) = default;
+
+    bool Empty() const
+    {
+        return size_ == 0;
+    }
+
+    size_t Size() const
+    {
+        return size_;
+    }
+
+    T* Find(uint32_t seqNum)
+    {
+        size_t index = 0;
+        return Lookup(seqNum, index) ? &slots_[index].value : nullptr;
+    }
+
+    bool Contains(uint32_t seqNum) const
+    {
+        size_t index = 0;
+        return Lookup(seqNum, index);
+    }
+
+    // Insert or overwrite the value of the sequence number. Return false if the table is full.
+    bool Insert(uint32_t seqNum, const T& value)
+    {
+        size_t index = 0;
+        if (Lookup(seqNum, index)) {
+            slots_[index].value = value;
+            return true;
+        }
+        if (size_ == N) {
+            return false;
+        }
+        for (index = HomeOf(seqNum); slots_[index].isUsed; index = (index + 1) % N) {}
+        slots_[index].isUsed = true;
+        slots_[index].seqNum = seqNum;
+        slots_[index].value = value;
+        size_++;
+        return true;
+    }
+
+    bool Erase(uint32_t seqNum)
+    {
+        size_t hole = 0;
+        if (!Lookup(seqNum, hole)) {
+            return false;
+        }
+        slots_[hole] = Slot{};
+        size_--;
+        // Shift the following items of the probe sequence backward to keep them reachable.
+        for (size_t index = (hole + 1) % N; slots_[index].isUsed; index = (index + 1) % N) {
+            size_t home = HomeOf(slots_[index].seqNum);
+            bool isReachable = (hole <= index) ? (home > hole && home <= index) : (home > hole || home <= index);
+            if (isReachable) {
+                continue;
+            }
+            slots_[hole] = std::move(slots_[index]);
+            slots_[index] = Slot{};
+            hole = index;
+        }
+        return true;
+    }
+
+    void Clear()
+    {
+        if (size_ == 0) {
+            return;
+        }
+        slots_.fill(Slot{});
+        size_ = 0;
+    }
+
+    // Visit all items in unspecified order. Do NOT insert or erase items in the function.
+    template <typename Func>
+    void ForEach(Func&& func)
+    {
+        for (auto& slot : slots_) {
+            if (slot.isUsed) {
+                func(slot.seqNum, slot.value);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        bool isUsed{false};
+        uint32_t seqNum{};
+        T value{};
+    };
+
+    static size_t HomeOf(uint32_t seqNum)
+    {
+        return seqNum % N;
+    }
+
+    bool Lookup(uint32_t seqNum, size_t& index) const
+    {
+        index = HomeOf(seqNum);
+        for (size_t i = 0; i < N && slots_[index].isUsed; i++) {
+            if (slots_[index].seqNum == seqNum) {
+                return true;
+            }
+            index = (index + 1) % N;
+        }
+        return false;
+    }
+
+    std::array<Slot, N> slots_{};
+    size_t size_{};
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // VPE_RING_BUFFER_H
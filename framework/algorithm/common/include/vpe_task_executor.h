@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPE_TASK_EXECUTOR_H
+#define VPE_TASK_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Task queue whose tasks are executed one by one in posting order by {@link VpeTaskExecutor}.
+ * Different queues are executed in parallel, so each video processing object owns one queue
+ * instead of owning a thread.
+ */
+class VpeSerialQueue {
+public:
+    VpeSerialQueue() = default;
+    ~VpeSerialQueue();
+    VpeSerialQueue(const VpeSerialQueue&) = delete;
+    VpeSerialQueue& operator=(const VpeSerialQueue&) = delete;
+    VpeSerialQueue(VpeSerialQueue&&) = delete;
+    VpeSerialQueue& operator=(VpeSerialQueue&&) = delete;
+
+    // Accept the tasks posted after that.
+    void Start();
+    // Return false if the queue is NOT started.
+    bool Post(std::function<void(void)>&& task);
+    // Discard the pending tasks and wait for the running task to finish.
+    // The tasks posted after that are discarded until Start is called again.
+    void Stop();
+    // Return true if it is called by the task of this queue.
+    bool IsCurrent() const;
+
+private:
+    friend class VpeTaskExecutor;
+
+    // Called by VpeTaskExecutor to execute the first pending task.
+    // Return true if there are more pending tasks and the queue should be scheduled again.
+    bool RunOnce();
+    // Called by VpeTaskExecutor to discard the pending tasks when it can NOT execute them any more.
+    void Cancel();
+
+    // [WARNING] lock_ is a leaf lock, do NOT acquire any other lock while holding it.
+    mutable std::mutex lock_{};
+    std::condition_variable cvIdle_{};
+    // Guarded by lock_ begin
+    bool isStarted_{false};
+    bool isScheduled_{false};
+    std::thread::id runningThread_{};
+    std::deque<std::function<void(void)>> tasks_{};
+    // Guarded by lock_ end
+};
+
+/**
+ * Process-wide thread pool which executes the tasks of all {@link VpeSerialQueue} objects.
+ * The threads are created when the first task is posted, and the number of threads is limited
+ * by the number of CPU cores.
+ */
+class VpeTaskExecutor {
+public:
+    static VpeTaskExecutor& GetInstance();
+
+    // Schedule the queue to execute its first pending task.
+    void Schedule(VpeSerialQueue& queue);
+    // Call func(0) ... func(count - 1) by at most workerNum threads including the caller, and return after all of
+    // them finish. The caller executes the items which are not taken by the workers and only waits for the running
+    // ones, so it is safe to be called by a task of VpeSerialQueue.
+    void ParallelFor(size_t count, size_t workerNum, const std::function<void(size_t)>& func);
+    // Return true if some queues are waiting for a free thread, so a long running task may yield to them by
+    // posting the rest of its work as a new task.
+    bool HasWaitingQueues();
+
+private:
+    VpeTaskExecutor() = default;
+    ~VpeTaskExecutor();
+    VpeTaskExecutor(const VpeTaskExecutor&) = delete;
+    VpeTaskExecutor& operator=(const VpeTaskExecutor&) = delete;
+    VpeTaskExecutor(VpeTaskExecutor&&) = delete;
+    VpeTaskExecutor& operator=(VpeTaskExecutor&&) = delete;
+
+    void StartWorkersLocked();
+    void Run();
+
+    std::mutex lock_{};
+    std::condition_variable cvTask_{};
+    // Guarded by lock_ begin
+    bool isRunning_{true};
+    std::deque<VpeSerialQueue*> readyQueues_{};
+    std::vector<std::thread> workers_{};
+    // Guarded by lock_ end
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // VPE_TASK_EXECUTOR_H
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPE_VIDEO_ENGINE_H
+#define VPE_VIDEO_ENGINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "algorithm_video_impl.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+// Feature types of the video features which are NOT defined in VpeVideoType.
+enum VpeVideoEngineType : uint32_t {
+    VIDEO_TYPE_COLORSPACE_CONVERTER = 0x10000,
+    VIDEO_TYPE_METADATA_GENERATOR = 0x20000,
+};
+
+/**
+ * Buffer engine of the video features which have their own interfaces, such as ColorSpaceConverterVideo.
+ * The engine handles the input and output surfaces, and the feature only provides the processing of one frame.
+ */
+class VpeVideoEngine : public VpeVideoImpl {
+public:
+    using ProcessFunc = std::function<VPEAlgoErrCode(const sptr<SurfaceBuffer>&, sptr<SurfaceBuffer>&)>;
+    using RequestCfgFunc = std::function<void(const sptr<SurfaceBuffer>&, BufferRequestConfig&)>;
+
+    // Set isInPlace to true if process supports the same buffer as the source and the destination.
+    static std::shared_ptr<VpeVideoEngine> Create(uint32_t type, ProcessFunc&& process,
+        RequestCfgFunc&& updateRequestCfg, bool isInPlace = false);
+
+    VpeVideoEngine(uint32_t type, ProcessFunc&& process, RequestCfgFunc&& updateRequestCfg, bool isInPlace)
+        : VpeVideoImpl(type), process_(std::move(process)), updateRequestCfg_(std::move(updateRequestCfg)),
+        isInPlace_(isInPlace) {}
+    ~VpeVideoEngine() = default;
+    VpeVideoEngine(const VpeVideoEngine&) = delete;
+    VpeVideoEngine& operator=(const VpeVideoEngine&) = delete;
+    VpeVideoEngine(VpeVideoEngine&&) = delete;
+    VpeVideoEngine& operator=(VpeVideoEngine&&) = delete;
+
+    VPEAlgoErrCode RegisterCallback(const std::shared_ptr<VpeVideoCallback>& callback) final;
+    // The engine stops asynchronously. StartIfStopped waits for the previous StopIfRunning to finish, and does
+    // nothing if the engine is already running, such as after Flush.
+    VPEAlgoErrCode StartIfStopped();
+    VPEAlgoErrCode StopIfRunning();
+    // Wait for the previous StopIfRunning to finish. Return false if the engine is still stopping after the timeout.
+    bool WaitForStop();
+
+    using VpeVideoImpl::SetCommonParameter;
+    using VpeVideoImpl::GetCommonParameter;
+    // Report the output format to the registered callback, which is the pipeline if the engine is its stage.
+    using VpeVideoImpl::OnOutputFormatChanged;
+
+protected:
+    using VpeVideoImpl::UpdateRequestCfg;
+
+    VPEAlgoErrCode Process(const sptr<SurfaceBuffer>& sourceImage, sptr<SurfaceBuffer>& destinationImage) final;
+    bool IsDisableAfterProcessFail() final;
+    bool IsInPlaceSupported() final;
+    bool IsEosBufferFlushed() final;
+    void UpdateRequestCfg(const sptr<SurfaceBuffer>& consumerBuffer, BufferRequestConfig& requestCfg) final;
+
+private:
+    class StateCallback : public VpeVideoCallback {
+    public:
+        StateCallback(VpeVideoEngine& owner, const std::shared_ptr<VpeVideoCallback>& callback)
+            : owner_(owner), callback_(callback) {}
+        ~StateCallback() = default;
+        StateCallback(const StateCallback&) = delete;
+        StateCallback& operator=(const StateCallback&) = delete;
+        StateCallback(StateCallback&&) = delete;
+        StateCallback& operator=(StateCallback&&) = delete;
+
+        using VpeVideoCallback::OnOutputBufferAvailable;
+        void OnError(VPEAlgoErrCode errorCode) final;
+        void OnState(VPEAlgoState state) final;
+        void OnEffectChange(uint32_t type) final;
+        void OnOutputFormatChanged(const Format& format) final;
+        void OnOutputBufferAvailable(uint32_t index, const VpeBufferInfo& info) final;
+
+    private:
+        VpeVideoEngine& owner_;
+        std::shared_ptr<VpeVideoCallback> callback_{};
+    };
+
+    void OnState(VPEAlgoState state);
+
+    ProcessFunc process_{};
+    RequestCfgFunc updateRequestCfg_{};
+    const bool isInPlace_{};
+
+    // [WARNING] stateLock_ is a leaf lock, do NOT acquire any other lock while holding it.
+    std::mutex stateLock_{};
+    std::condition_variable cvState_{};
+    // Guarded by stateLock_ begin
+    bool isStarted_{false};
+    bool isStopping_{false};
+    // Guarded by stateLock_ end
+};
+
+/**
+ * Forward the callbacks of {@link VpeVideoEngine} to the callback of a video feature.
+ *
+ * @tparam Callback The callback type of the feature, which has OnError(int32_t) and
+ * OnOutputBufferAvailable(uint32_t, Flag).
+ * @tparam Flag The buffer flag type of the feature, whose value of EOS is the same as VPE_BUFFER_FLAG_EOS.
+ */
+template <typename Callback, typename Flag>
+class VpeVideoEngineCallback : public VpeVideoCallback {
+public:
+    explicit VpeVideoEngineCallback(const std::shared_ptr<Callback>& callback) : callback_(callback) {}
+    ~VpeVideoEngineCallback() = default;
+    VpeVideoEngineCallback(const VpeVideoEngineCallback&) = delete;
+    VpeVideoEngineCallback& operator=(const VpeVideoEngineCallback&) = delete;
+    VpeVideoEngineCallback(VpeVideoEngineCallback&&) = delete;
+    VpeVideoEngineCallback& operator=(VpeVideoEngineCallback&&) = delete;
+
+    using VpeVideoCallback::OnOutputBufferAvailable;
+    void OnError(VPEAlgoErrCode errorCode) final
+    {
+        callback_->OnError(static_cast<int32_t>(errorCode));
+    }
+
+    void OnOutputBufferAvailable(uint32_t index, VpeBufferFlag flag) final
+    {
+        callback_->OnOutputBufferAvailable(index, static_cast<Flag>(flag));
+    }
+
+private:
+    std::shared_ptr<Callback> callback_{};
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // VPE_VIDEO_ENGINE_H
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPE_VIDEO_PIPELINE_H
+#define VPE_VIDEO_PIPELINE_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "algorithm_video_impl.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Chain several video processing objects in one process, such as detail enhancement, color space conversion and
+ * metadata generation. Only the input surface and the output surface of the pipeline are used, the buffers are
+ * passed between the stages directly. The stages are configured by their own interfaces, and their surfaces,
+ * states and buffer queues are NOT used.
+ */
+class VpeVideoPipeline : public VpeVideoImpl {
+public:
+    static std::shared_ptr<VpeVideoPipeline> Create(const std::vector<std::shared_ptr<VpeVideoImpl>>& stages);
+
+    VpeVideoPipeline(uint32_t type, const std::vector<std::shared_ptr<VpeVideoImpl>>& stages);
+    ~VpeVideoPipeline() = default;
+    VpeVideoPipeline(const VpeVideoPipeline&) = delete;
+    VpeVideoPipeline& operator=(const VpeVideoPipeline&) = delete;
+    VpeVideoPipeline(VpeVideoPipeline&&) = delete;
+    VpeVideoPipeline& operator=(VpeVideoPipeline&&) = delete;
+
+    // Only the common parameters are supported, the parameters of the stages are set by the stages themselves.
+    VPEAlgoErrCode SetParameter(const Format& parameter) final;
+    VPEAlgoErrCode GetParameter(Format& parameter) final;
+
+protected:
+    using VpeVideoImpl::UpdateRequestCfg;
+
+    VPEAlgoErrCode Process(const sptr<SurfaceBuffer>& sourceImage, sptr<SurfaceBuffer>& destinationImage) final;
+    bool IsDisableAfterProcessFail() final;
+    void UpdateRequestCfg(const sptr<SurfaceBuffer>& consumerBuffer, BufferRequestConfig& requestCfg) final;
+
+private:
+    struct Stage {
+        std::shared_ptr<VpeVideoImpl> video{};
+        bool isInPlace{};
+        // The output of the stage if it writes neither to the destination nor in place.
+        sptr<SurfaceBuffer> buffer{};
+    };
+
+    // Forward the output format of the stages which write the output of the pipeline, the formats of the earlier
+    // stages only describe the intermediate buffers.
+    class StageCallback : public VpeVideoCallback {
+    public:
+        StageCallback(const std::shared_ptr<VpeVideoPipeline>& owner, size_t index) : owner_(owner), index_(index) {}
+        ~StageCallback() = default;
+        StageCallback(const StageCallback&) = delete;
+        StageCallback& operator=(const StageCallback&) = delete;
+        StageCallback(StageCallback&&) = delete;
+        StageCallback& operator=(StageCallback&&) = delete;
+
+        void OnOutputFormatChanged(const Format& format) final;
+
+    private:
+        std::weak_ptr<VpeVideoPipeline> owner_;
+        const size_t index_{};
+    };
+
+    bool IsInputChangedLocked(const sptr<SurfaceBuffer>& sourceImage) const;
+    void PrepareStagesLocked(const sptr<SurfaceBuffer>& sourceImage, uint64_t usage,
+        BufferRequestConfig& outputCfg);
+    bool PrepareStageBuffer(Stage& stage, const sptr<SurfaceBuffer>& input, uint64_t usage);
+
+    // The last stage which does NOT process in place, it writes to the destination buffer.
+    size_t lastCopyIndex_{};
+
+    std::mutex lock_{};
+    // Guarded by lock_ begin
+    std::vector<Stage> stages_{};
+    BufferRequestConfig inputCfg_{};
+    uint64_t usage_{};
+    // Guarded by lock_ end
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // VPE_VIDEO_PIPELINE_H
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPE_VIDEO_STATS_H
+#define VPE_VIDEO_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "algorithm_video_common.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Collect the per-frame latency and throughput statistics of a video processing object.
+ * The queue depths of {@link VpeVideoStatistics} are NOT collected here, the owner should fill them.
+ */
+class VpeVideoStats {
+public:
+    enum class Stage {
+        INPUT_WAIT,
+        PROCESS,
+        RENDER,
+    };
+
+    VpeVideoStats() = default;
+    ~VpeVideoStats() = default;
+    VpeVideoStats(const VpeVideoStats&) = delete;
+    VpeVideoStats& operator=(const VpeVideoStats&) = delete;
+    VpeVideoStats(VpeVideoStats&&) = delete;
+    VpeVideoStats& operator=(VpeVideoStats&&) = delete;
+
+    void RecordDuration(Stage stage, std::chrono::steady_clock::duration duration);
+    void OnFrameOutput();
+    void OnFrameDropped();
+    void OnFrameBypassed();
+    void GetStatistics(VpeVideoStatistics& statistics) const;
+
+private:
+    static void AddToHistogram(VpeDurationHistogram& histogram, uint64_t durationUs);
+
+    // [WARNING] lock_ is a leaf lock, do NOT acquire any other lock while holding it.
+    mutable std::mutex lock_{};
+    // Guarded by lock_ begin
+    VpeVideoStatistics statistics_{};
+    std::chrono::steady_clock::time_point fpsWindowStart_{};
+    uint64_t fpsWindowFrames_{};
+    // Guarded by lock_ end
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // VPE_VIDEO_STATS_H
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vpe_task_executor.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "vpe_log.h"
+
+using namespace OHOS::Media::VideoProcessingEngine;
+
+namespace {
+// Keep one more thread so that a slow frame of one object does NOT block all other objects on a single core.
+constexpr uint32_t MIN_WORKER_NUM = 2;
+// Most of the processing is done by GPU or NPU, more threads only increase the context switches.
+constexpr uint32_t MAX_WORKER_NUM = 4;
+
+// The items of a ParallelFor call, shared with the helper tasks which may run after the call returns.
+struct ParallelItems {
+    ParallelItems(size_t itemCount, const std::function<void(size_t)>& itemFunc) : count(itemCount), func(itemFunc) {}
+
+    // Return after no item is left, func is NOT touched after the last item is taken.
+    void Run()
+    {
+        for (size_t index = next.fetch_add(1); index < count; index = next.fetch_add(1)) {
+            func(index);
+            std::lock_guard<std::mutex> lock(finishedLock);
+            if (++finished == count) {
+                cvFinished.notify_all();
+            }
+        }
+    }
+
+    const size_t count;
+    // Valid until all the items finish, which is waited by the caller of ParallelFor.
+    const std::function<void(size_t)>& func;
+    std::atomic<size_t> next{0};
+    std::mutex finishedLock{};
+    std::condition_variable cvFinished{};
+    size_t finished{0}; // Guarded by finishedLock
+};
+
+// The queues which run the helper tasks of ParallelFor, one helper per queue.
+struct HelperQueues {
+    HelperQueues()
+    {
+        for (auto& queue : queues) {
+            queue.Start();
+        }
+    }
+
+    std::array<VpeSerialQueue, MAX_WORKER_NUM> queues{};
+};
+
+std::array<VpeSerialQueue, MAX_WORKER_NUM>& GetHelperQueues()
+{
+    static HelperQueues helperQueues;
+    return helperQueues.queues;
+}
+} // namespace
+
+VpeSerialQueue::~VpeSerialQueue()
+{
+    Stop();
+}
+
+void VpeSerialQueue::Start()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    isStarted_ = true;
+}
+
+bool VpeSerialQueue::Post(std::function<void(void)>&& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (!isStarted_) {
+            VPE_LOGD("Skip posting when the queue is stopped.");
+            return false;
+        }
+        tasks_.push_back(std::move(task));
+        if (isScheduled_) {
+            return true;
+        }
+        isScheduled_ = true;
+    }
+    VpeTaskExecutor::GetInstance().Schedule(*this);
+    return true;
+}
+
+void VpeSerialQueue::Stop()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    isStarted_ = false;
+    tasks_.clear();
+    if (runningThread_ == std::this_thread::get_id()) {
+        // The caller is the running task itself, the queue must outlive it.
+        VPE_LOGW("Stop the queue by its own task!");
+        return;
+    }
+    cvIdle_.wait(lock, [this]() { return !isScheduled_; });
+}
+
+bool VpeSerialQueue::IsCurrent() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return runningThread_ == std::this_thread::get_id();
+}
+
+bool VpeSerialQueue::RunOnce()
+{
+    std::function<void(void)> task;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (tasks_.empty()) {
+            isScheduled_ = false;
+            cvIdle_.notify_all();
+            return false;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+        runningThread_ = std::this_thread::get_id();
+    }
+    task();
+    std::lock_guard<std::mutex> lock(lock_);
+    runningThread_ = std::thread::id{};
+    if (tasks_.empty()) {
+        isScheduled_ = false;
+        cvIdle_.notify_all();
+        return false;
+    }
+    return true;
+}
+
+void VpeSerialQueue::Cancel()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    tasks_.clear();
+    isScheduled_ = false;
+    cvIdle_.notify_all();
+}
+
+VpeTaskExecutor& VpeTaskExecutor::GetInstance()
+{
+    static VpeTaskExecutor instance;
+    return instance;
+}
+
+void VpeTaskExecutor::Schedule(VpeSerialQueue& queue)
+{
+    bool isRunning = false;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        isRunning = isRunning_;
+        if (isRunning) {
+            if (workers_.empty()) {
+                StartWorkersLocked();
+            }
+            readyQueues_.push_back(&queue);
+        }
+    }
+    if (isRunning) {
+        cvTask_.notify_one();
+        return;
+    }
+    // The workers have exited, such as a task rescheduled during shutdown. Cancel the tasks, otherwise
+    // VpeSerialQueue::Stop waits for them forever.
+    VPE_LOGW("Cancel the tasks scheduled after the executor is stopped.");
+    queue.Cancel();
+}
+
+void VpeTaskExecutor::ParallelFor(size_t count, size_t workerNum, const std::function<void(size_t)>& func)
+{
+    if (count == 0) {
+        return;
+    }
+    auto items = std::make_shared<ParallelItems>(count, func);
+    auto& helperQueues = GetHelperQueues();
+    size_t helperNum = std::min({ workerNum > 0 ? workerNum - 1 : 0, count - 1, helperQueues.size() });
+    for (size_t i = 0; i < helperNum; i++) {
+        helperQueues[i].Post([items]() { items->Run(); });
+    }
+    items->Run();
+    std::unique_lock<std::mutex> lock(items->finishedLock);
+    items->cvFinished.wait(lock, [&items]() { return items->finished == items->count; });
+}
+
+bool VpeTaskExecutor::HasWaitingQueues()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return !readyQueues_.empty();
+}
+
+VpeTaskExecutor::~VpeTaskExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        isRunning_ = false;
+    }
+    cvTask_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    // The queues left are still scheduled, cancel them so that stopping them does NOT hang.
+    std::deque<VpeSerialQueue*> pendingQueues;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        pendingQueues.swap(readyQueues_);
+    }
+    for (auto queue : pendingQueues) {
+        queue->Cancel();
+    }
+}
+
+void VpeTaskExecutor::StartWorkersLocked()
+{
+    uint32_t workerNum = std::clamp(std::thread::hardware_concurrency(), MIN_WORKER_NUM, MAX_WORKER_NUM);
+    VPE_LOGI("Start %{public}u workers.", workerNum);
+    for (uint32_t i = 0; i < workerNum; i++) {
+        workers_.emplace_back([this]() { Run(); });
+    }
+}
+
+void VpeTaskExecutor::Run()
+{
+    while (true) {
+        VpeSerialQueue* queue = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            cvTask_.wait(lock, [this]() { return !isRunning_ || !readyQueues_.empty(); });
+            if (!isRunning_) {
+                break;
+            }
+            queue = readyQueues_.front();
+            readyQueues_.pop_front();
+        }
+        // Execute one task of each queue in turn, so that a busy object does NOT starve the others.
+        if (queue->RunOnce()) {
+            Schedule(*queue);
+        }
+    }
+}
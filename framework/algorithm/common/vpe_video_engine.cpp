@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vpe_video_engine.h"
+
+#include "vpe_log.h"
+
+using namespace OHOS;
+using namespace OHOS::Media::VideoProcessingEngine;
+using namespace std::chrono_literals;
+
+namespace {
+// The worker processes the queued frames before it stops, so it is enough to wait for several frames.
+constexpr auto STOP_TIMEOUT = 500ms;
+} // namespace
+
+std::shared_ptr<VpeVideoEngine> VpeVideoEngine::Create(uint32_t type, ProcessFunc&& process,
+    RequestCfgFunc&& updateRequestCfg, bool isInPlace)
+{
+    CHECK_AND_RETURN_RET_LOG(process != nullptr, nullptr, "Invalid input: process is null!");
+    auto obj = std::make_shared<VpeVideoEngine>(type, std::move(process), std::move(updateRequestCfg), isInPlace);
+    CHECK_AND_RETURN_RET_LOG(obj != nullptr, nullptr, "Failed to create video engine(0x%{public}x)!", type);
+    CHECK_AND_RETURN_RET_LOG(obj->Initialize() == VPE_ALGO_ERR_OK, nullptr,
+        "Failed to initialize video engine(0x%{public}x)!", type);
+    return obj;
+}
+
+VPEAlgoErrCode VpeVideoEngine::RegisterCallback(const std::shared_ptr<VpeVideoCallback>& callback)
+{
+    CHECK_AND_RETURN_RET_LOG(callback != nullptr, VPE_ALGO_ERR_INVALID_VAL, "Invalid input: callback is null!");
+    auto stateCallback = std::make_shared<StateCallback>(*this, callback);
+    CHECK_AND_RETURN_RET_LOG(stateCallback != nullptr, VPE_ALGO_ERR_NO_MEMORY, "Failed to create callback!");
+    return VpeVideoImpl::RegisterCallback(stateCallback);
+}
+
+VPEAlgoErrCode VpeVideoEngine::StartIfStopped()
+{
+    {
+        std::unique_lock<std::mutex> lock(stateLock_);
+        CHECK_AND_RETURN_RET_LOG(cvState_.wait_for(lock, STOP_TIMEOUT, [this] { return !isStopping_; }),
+            VPE_ALGO_ERR_INVALID_STATE, "The engine is still stopping!");
+        if (isStarted_) {
+            return VPE_ALGO_ERR_OK;
+        }
+    }
+    return Start();
+}
+
+VPEAlgoErrCode VpeVideoEngine::StopIfRunning()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateLock_);
+        if (!isStarted_ || isStopping_) {
+            return VPE_ALGO_ERR_OK;
+        }
+        isStopping_ = true;
+    }
+    auto ret = Stop();
+    if (ret != VPE_ALGO_ERR_OK) {
+        std::lock_guard<std::mutex> lock(stateLock_);
+        isStopping_ = false;
+    }
+    return ret;
+}
+
+bool VpeVideoEngine::WaitForStop()
+{
+    std::unique_lock<std::mutex> lock(stateLock_);
+    return cvState_.wait_for(lock, STOP_TIMEOUT, [this] { return !isStopping_; });
+}
+
+VPEAlgoErrCode VpeVideoEngine::Process(const sptr<SurfaceBuffer>& sourceImage, sptr<SurfaceBuffer>& destinationImage)
+{
+    // The engine may be used as a stage of VpeVideoPipeline after the feature is released.
+    CHECK_AND_RETURN_RET_LOG(IsInitialized(), VPE_ALGO_ERR_INVALID_OPERATION, "NOT initialized!");
+    return process_(sourceImage, destinationImage);
+}
+
+bool VpeVideoEngine::IsDisableAfterProcessFail()
+{
+    // The features report the error of the frame and go on processing the next one.
+    return false;
+}
+
+bool VpeVideoEngine::IsInPlaceSupported()
+{
+    return isInPlace_;
+}
+
+bool VpeVideoEngine::IsEosBufferFlushed()
+{
+    // The features never flushed the EOS buffer before they were ported onto the engine.
+    return false;
+}
+
+void VpeVideoEngine::UpdateRequestCfg(const sptr<SurfaceBuffer>& consumerBuffer, BufferRequestConfig& requestCfg)
+{
+    CHECK_AND_RETURN_LOG(consumerBuffer != nullptr, "surface buffer is null!");
+    requestCfg.width = consumerBuffer->GetWidth();
+    requestCfg.height = consumerBuffer->GetHeight();
+    requestCfg.format = consumerBuffer->GetFormat();
+    if (updateRequestCfg_ != nullptr) {
+        updateRequestCfg_(consumerBuffer, requestCfg);
+    }
+}
+
+void VpeVideoEngine::OnState(VPEAlgoState state)
+{
+    std::lock_guard<std::mutex> lock(stateLock_);
+    isStarted_ = (state == VPEAlgoState::RUNNING);
+    isStopping_ = false;
+    cvState_.notify_all();
+}
+
+void VpeVideoEngine::StateCallback::OnError(VPEAlgoErrCode errorCode)
+{
+    callback_->OnError(errorCode);
+}
+
+void VpeVideoEngine::StateCallback::OnState(VPEAlgoState state)
+{
+    owner_.OnState(state);
+    callback_->OnState(state);
+}
+
+void VpeVideoEngine::StateCallback::OnEffectChange(uint32_t type)
+{
+    callback_->OnEffectChange(type);
+}
+
+void VpeVideoEngine::StateCallback::OnOutputFormatChanged(const Format& format)
+{
+    callback_->OnOutputFormatChanged(format);
+}
+
+void VpeVideoEngine::StateCallback::OnOutputBufferAvailable(uint32_t index, const VpeBufferInfo& info)
+{
+    callback_->OnOutputBufferAvailable(index, info);
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vpe_video_pipeline.h"
+
+#include "vpe_log.h"
+#include "vpe_trace.h"
+
+using namespace OHOS;
+using namespace OHOS::Media::VideoProcessingEngine;
+
+namespace {
+constexpr int32_t STRIDE_ALIGNMENT = 32;
+
+uint32_t GetPipelineType(const std::vector<std::shared_ptr<VpeVideoImpl>>& stages, bool& isValid)
+{
+    uint32_t type = 0;
+    isValid = !stages.empty();
+    for (const auto& stage : stages) {
+        if (stage == nullptr) {
+            isValid = false;
+            break;
+        }
+        type |= stage->GetType();
+    }
+    return type;
+}
+} // namespace
+
+std::shared_ptr<VpeVideoPipeline> VpeVideoPipeline::Create(const std::vector<std::shared_ptr<VpeVideoImpl>>& stages)
+{
+    bool isValid = false;
+    uint32_t type = GetPipelineType(stages, isValid);
+    CHECK_AND_RETURN_RET_LOG(isValid, nullptr, "Invalid input: stages are empty or contain null!");
+    auto obj = std::make_shared<VpeVideoPipeline>(type, stages);
+    CHECK_AND_RETURN_RET_LOG(obj != nullptr, nullptr, "Failed to create video pipeline(0x%{public}x)!", type);
+    for (size_t i = 0; i < stages.size(); i++) {
+        auto cb = std::make_shared<StageCallback>(obj, i);
+        CHECK_AND_RETURN_RET_LOG(cb != nullptr, nullptr, "Failed to create stage callback!");
+        CHECK_AND_RETURN_RET_LOG(stages[i]->RegisterCallback(cb) == VPE_ALGO_ERR_OK, nullptr,
+            "Failed to register callback to stage(0x%{public}x)!", stages[i]->GetType());
+    }
+    CHECK_AND_RETURN_RET_LOG(obj->Initialize() == VPE_ALGO_ERR_OK, nullptr,
+        "Failed to initialize video pipeline(0x%{public}x)!", type);
+    return obj;
+}
+
+VpeVideoPipeline::VpeVideoPipeline(uint32_t type, const std::vector<std::shared_ptr<VpeVideoImpl>>& stages)
+    : VpeVideoImpl(type)
+{
+    for (size_t i = 0; i < stages.size(); i++) {
+        Stage stage{};
+        stage.video = stages[i];
+        stage.isInPlace = stages[i]->IsInPlaceSupported();
+        if (!stage.isInPlace) {
+            lastCopyIndex_ = i;
+        }
+        stages_.push_back(stage);
+    }
+}
+
+VPEAlgoErrCode VpeVideoPipeline::SetParameter(const Format& parameter)
+{
+    CHECK_AND_RETURN_RET_LOG(IsInitialized(), VPE_ALGO_ERR_INVALID_OPERATION, "NOT initialized!");
+    int setCount = SetCommonParameter(parameter);
+    CHECK_AND_RETURN_RET_LOG(setCount > 0, VPE_ALGO_ERR_INVALID_VAL, "Invalid input: NO valid parameters!");
+    return VPE_ALGO_ERR_OK;
+}
+
+VPEAlgoErrCode VpeVideoPipeline::GetParameter(Format& parameter)
+{
+    GetCommonParameter(parameter);
+    return VPE_ALGO_ERR_OK;
+}
+
+VPEAlgoErrCode VpeVideoPipeline::Process(const sptr<SurfaceBuffer>& sourceImage,
+    sptr<SurfaceBuffer>& destinationImage)
+{
+    CHECK_AND_RETURN_RET_LOG(sourceImage != nullptr && destinationImage != nullptr, VPE_ALGO_ERR_INVALID_VAL,
+        "Invalid input: source or destination image is null!");
+    VPETrace trace("VpeVideoPipeline::Process");
+    std::lock_guard<std::mutex> lock(lock_);
+    if (IsInputChangedLocked(sourceImage)) {
+        BufferRequestConfig outputCfg{};
+        PrepareStagesLocked(sourceImage, usage_, outputCfg);
+    }
+    sptr<SurfaceBuffer> input = sourceImage;
+    for (size_t i = 0; i < stages_.size(); i++) {
+        auto& stage = stages_[i];
+        VPEAlgoErrCode ret = VPE_ALGO_ERR_OK;
+        if (i == lastCopyIndex_) {
+            ret = stage.video->Process(input, destinationImage);
+            input = destinationImage;
+        } else if (stage.isInPlace && input != sourceImage) {
+            sptr<SurfaceBuffer> output = input;
+            ret = stage.video->Process(input, output);
+        } else {
+            CHECK_AND_RETURN_RET_LOG(stage.buffer != nullptr, VPE_ALGO_ERR_NO_MEMORY,
+                "Buffer of stage(0x%{public}x) is NOT ready!", stage.video->GetType());
+            ret = stage.video->Process(input, stage.buffer);
+            input = stage.buffer;
+        }
+        CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, ret, "Failed to process stage %{public}zu(0x%{public}x)!",
+            i, stage.video->GetType());
+    }
+    return VPE_ALGO_ERR_OK;
+}
+
+bool VpeVideoPipeline::IsDisableAfterProcessFail()
+{
+    return false;
+}
+
+void VpeVideoPipeline::UpdateRequestCfg(const sptr<SurfaceBuffer>& consumerBuffer, BufferRequestConfig& requestCfg)
+{
+    CHECK_AND_RETURN_LOG(consumerBuffer != nullptr, "surface buffer is null!");
+    std::lock_guard<std::mutex> lock(lock_);
+    // Prepare the intermediate buffers with the first input, so the output is requested as the last stage expects.
+    usage_ = requestCfg.usage;
+    BufferRequestConfig outputCfg = requestCfg;
+    PrepareStagesLocked(consumerBuffer, usage_, outputCfg);
+    requestCfg.width = outputCfg.width;
+    requestCfg.height = outputCfg.height;
+    requestCfg.format = outputCfg.format;
+    requestCfg.usage = outputCfg.usage;
+}
+
+bool VpeVideoPipeline::IsInputChangedLocked(const sptr<SurfaceBuffer>& sourceImage) const
+{
+    return inputCfg_.width != sourceImage->GetWidth() || inputCfg_.height != sourceImage->GetHeight() ||
+        inputCfg_.format != sourceImage->GetFormat();
+}
+
+void VpeVideoPipeline::PrepareStagesLocked(const sptr<SurfaceBuffer>& sourceImage, uint64_t usage,
+    BufferRequestConfig& outputCfg)
+{
+    inputCfg_.width = sourceImage->GetWidth();
+    inputCfg_.height = sourceImage->GetHeight();
+    inputCfg_.format = sourceImage->GetFormat();
+    sptr<SurfaceBuffer> input = sourceImage;
+    for (size_t i = 0; i < lastCopyIndex_; i++) {
+        auto& stage = stages_[i];
+        if (stage.isInPlace && input != sourceImage) {
+            stage.buffer = nullptr;
+            continue;
+        }
+        if (!PrepareStageBuffer(stage, input, usage)) {
+            // Prepare again with the next input.
+            inputCfg_ = {};
+            return;
+        }
+        input = stage.buffer;
+    }
+    outputCfg.width = input->GetWidth();
+    outputCfg.height = input->GetHeight();
+    outputCfg.format = input->GetFormat();
+    stages_[lastCopyIndex_].video->UpdateRequestCfg(input, outputCfg);
+    VPE_LOGD("%{public}dx%{public}d format:%{public}d -> %{public}dx%{public}d format:%{public}d",
+        inputCfg_.width, inputCfg_.height, inputCfg_.format, outputCfg.width, outputCfg.height, outputCfg.format);
+}
+
+bool VpeVideoPipeline::PrepareStageBuffer(Stage& stage, const sptr<SurfaceBuffer>& input, uint64_t usage)
+{
+    BufferRequestConfig requestCfg{};
+    requestCfg.width = input->GetWidth();
+    requestCfg.height = input->GetHeight();
+    requestCfg.format = input->GetFormat();
+    requestCfg.usage = usage;
+    requestCfg.strideAlignment = STRIDE_ALIGNMENT;
+    stage.video->UpdateRequestCfg(input, requestCfg);
+    // Reuse the intermediate buffer if it matches, only the resolution or format change reallocates it.
+    if (stage.buffer != nullptr && stage.buffer->GetWidth() == requestCfg.width &&
+        stage.buffer->GetHeight() == requestCfg.height && stage.buffer->GetFormat() == requestCfg.format &&
+        stage.buffer->GetUsage() == requestCfg.usage) {
+        return true;
+    }
+    if (stage.buffer == nullptr) {
+        stage.buffer = SurfaceBuffer::Create();
+        CHECK_AND_RETURN_RET_LOG(stage.buffer != nullptr, false, "Failed to create buffer of stage(0x%{public}x)!",
+            stage.video->GetType());
+    }
+    auto err = stage.buffer->Alloc(requestCfg);
+    if (err != GSERROR_OK) {
+        VPE_LOGE("Failed to allocate %{public}dx%{public}d format:%{public}d buffer of stage(0x%{public}x)!",
+            requestCfg.width, requestCfg.height, requestCfg.format, stage.video->GetType());
+        stage.buffer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void VpeVideoPipeline::StageCallback::OnOutputFormatChanged(const Format& format)
+{
+    auto owner = owner_.lock();
+    if (owner == nullptr) {
+        VPE_LOGD("Skip the output format of stage %{public}zu, the pipeline is released.", index_);
+        return;
+    }
+    if (index_ < owner->lastCopyIndex_) {
+        VPE_LOGD("Skip the output format of stage %{public}zu, it writes an intermediate buffer.", index_);
+        return;
+    }
+    // The pipeline checks its callback, which may NOT be registered yet.
+    owner->OnOutputFormatChanged(format);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vpe_video_stats.h"
+
+#include <algorithm>
+
+using namespace OHOS::Media::VideoProcessingEngine;
+using namespace std::chrono_literals;
+
+namespace {
+constexpr uint64_t US_PER_MS = 1000;
+constexpr auto FPS_WINDOW = 1s;
+} // namespace
+
+void VpeVideoStats::RecordDuration(Stage stage, std::chrono::steady_clock::duration duration)
+{
+    auto durationUs = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    uint64_t value = static_cast<uint64_t>(std::max<int64_t>(durationUs, 0));
+    std::lock_guard<std::mutex> lock(lock_);
+    switch (stage) {
+        case Stage::INPUT_WAIT:
+            AddToHistogram(statistics_.inputWait, value);
+            break;
+        case Stage::PROCESS:
+            AddToHistogram(statistics_.process, value);
+            break;
+        case Stage::RENDER:
+            AddToHistogram(statistics_.render, value);
+            break;
+        default:
+            break;
+    }
+}
+
+void VpeVideoStats::OnFrameOutput()
+{
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(lock_);
+    statistics_.outputFrames++;
+    if (fpsWindowStart_ == std::chrono::steady_clock::time_point{}) {
+        fpsWindowStart_ = now;
+    }
+    fpsWindowFrames_++;
+    auto elapsed = now - fpsWindowStart_;
+    if (elapsed >= FPS_WINDOW) {
+        statistics_.fps = static_cast<double>(fpsWindowFrames_) / std::chrono::duration<double>(elapsed).count();
+        fpsWindowStart_ = now;
+        fpsWindowFrames_ = 0;
+    }
+}
+
+void VpeVideoStats::OnFrameDropped()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    statistics_.droppedFrames++;
+}
+
+void VpeVideoStats::OnFrameBypassed()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    statistics_.bypassedFrames++;
+}
+
+void VpeVideoStats::GetStatistics(VpeVideoStatistics& statistics) const
+{
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(lock_);
+    statistics = statistics_;
+    // Decay the frame rate when the output stalls for longer than one window.
+    auto elapsed = now - fpsWindowStart_;
+    if (fpsWindowStart_ != std::chrono::steady_clock::time_point{} && elapsed >= FPS_WINDOW) {
+        statistics.fps = static_cast<double>(fpsWindowFrames_) / std::chrono::duration<double>(elapsed).count();
+    }
+}
+
+void VpeVideoStats::AddToHistogram(VpeDurationHistogram& histogram, uint64_t durationUs)
+{
+    uint32_t index = 0;
+    while (index < VpeDurationHistogram::BUCKET_COUNT - 1 && durationUs >= (US_PER_MS << index)) {
+        index++;
+    }
+    histogram.buckets[index]++;
+    histogram.count++;
+    histogram.totalUs += durationUs;
+    histogram.maxUs = std::max(histogram.maxUs, durationUs);
+}
@@ -18,6 +18,7 @@
 #include <dlfcn.h>
 
 #include "contrast_enhancer_common.h"
+#include "extension_instance_pool.h"
 #include "extension_manager.h"
 #include "native_buffer.h"
 #include "surface_buffer.h"
@@ -39,6 +40,17 @@ const std::unordered_set<int32_t> SUPPORTED_FORMATS = {
     OHOS::GRAPHIC_PIXEL_FMT_YCBCR_P010,
 };
 constexpr int MAX_FAILURE_NUM = 5;
+constexpr size_t ALGORITHM_POOL_CAPACITY = 2; // Idle initialized algorithms shared by all ContrastEnhancerImageFwk
+using ContrastEnhancerPool =
+    OHOS::Media::VideoProcessingEngine::Extension::ExtensionInstancePool<
+        OHOS::Media::VideoProcessingEngine::ContrastEnhancerType,
+        OHOS::Media::VideoProcessingEngine::ContrastEnhancerBase>;
+
+ContrastEnhancerPool& GetAlgorithmPool()
+{
+    static ContrastEnhancerPool pool(ALGORITHM_POOL_CAPACITY);
+    return pool;
+}
 }
 
 namespace OHOS {
@@ -53,6 +65,9 @@ ContrastEnhancerImageFwk::~ContrastEnhancerImageFwk()
 {
     {
         std::lock_guard<std::mutex> lock(lock_);
+        for (auto& [type, algo] : algorithms_) {
+            GetAlgorithmPool().Release(type, std::move(algo));
+        }
         algorithms_.clear();
     }
     Extension::ExtensionManager::GetInstance().DecreaseInstance();
@@ -96,18 +111,20 @@ std::shared_ptr<ContrastEnhancerBase> ContrastEnhancerImageFwk::GetAlgorithm(Con
 
 std::shared_ptr<ContrastEnhancerBase> ContrastEnhancerImageFwk::CreateAlgorithm(ContrastEnhancerType type)
 {
-    auto& manager = Extension::ExtensionManager::GetInstance();
-    VPE_SYNC_TRACE;
-    std::shared_ptr<ContrastEnhancerBase> algoImpl = manager.CreateContrastEnhancer(type);
-    if (algoImpl == nullptr) {
-        VPE_LOGE("Extension create failed, get a empty impl, type: %{public}d", type);
-        return nullptr;
-    }
-    if (algoImpl->Init() != VPE_ALGO_ERR_OK) {
-        VPE_LOGE("Init failed, extension type: %{public}d", type);
-        return nullptr;
-    }
-    return algoImpl;
+    return GetAlgorithmPool().Acquire(type, [type]() -> std::shared_ptr<ContrastEnhancerBase> {
+        auto& manager = Extension::ExtensionManager::GetInstance();
+        VPE_SYNC_TRACE;
+        std::shared_ptr<ContrastEnhancerBase> algoImpl = manager.CreateContrastEnhancer(type);
+        if (algoImpl == nullptr) {
+            VPE_LOGE("Extension create failed, get a empty impl, type: %{public}d", type);
+            return nullptr;
+        }
+        if (algoImpl->Init() != VPE_ALGO_ERR_OK) {
+            VPE_LOGE("Init failed, extension type: %{public}d", type);
+            return nullptr;
+        }
+        return algoImpl;
+    });
 }
 
 VPEAlgoErrCode ContrastEnhancerImageFwk::SetParameter(const ContrastEnhancerParameters& parameter)
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "detail_enhancer_circuit_breaker.h"
+
+#include <algorithm>
+
+#include "vpe_log.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+LevelCircuitBreaker::LevelCircuitBreaker(std::chrono::steady_clock::duration initialCoolDown,
+    std::chrono::steady_clock::duration maxCoolDown)
+    : initialCoolDown_(initialCoolDown), maxCoolDown_(std::max(initialCoolDown, maxCoolDown))
+{
+}
+
+bool LevelCircuitBreaker::IsAllowed(int level, uint32_t bucket)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = states_.find({ level, bucket });
+    if (it == states_.end() || it->second.failureNum < FAILURE_THRESHOLD) {
+        return true;
+    }
+    auto& state = it->second;
+    if (state.isProbing || std::chrono::steady_clock::now() < state.openUntil) {
+        return false;
+    }
+    state.isProbing = true;
+    return true;
+}
+
+void LevelCircuitBreaker::Report(int level, uint32_t bucket, VPEAlgoErrCode err)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = states_.find({ level, bucket });
+    if (err == VPE_ALGO_ERR_OK) {
+        if (it != states_.end()) {
+            VPE_LOGI("Level %{public}d of bucket %{public}u recovers", level, bucket);
+            states_.erase(it);
+        }
+        return;
+    }
+    if (static_cast<VPEAlgoErrExCode>(err) == VPE_ALGO_ERR_INVALID_CLIENT_ID) {
+        // The service died, it is restored instead of being blamed on the level.
+        if (it != states_.end()) {
+            it->second.isProbing = false;
+        }
+        return;
+    }
+    if (it == states_.end()) {
+        State newState;
+        newState.coolDown = initialCoolDown_;
+        it = states_.emplace(std::make_pair(level, bucket), newState).first;
+    }
+    auto& state = it->second;
+    bool wasProbing = state.isProbing;
+    state.isProbing = false;
+    state.failureNum++;
+    if (state.failureNum < FAILURE_THRESHOLD) {
+        return;
+    }
+    if (wasProbing) {
+        state.coolDown = std::min<std::chrono::steady_clock::duration>(state.coolDown * 2, maxCoolDown_);
+    }
+    state.openUntil = std::chrono::steady_clock::now() + state.coolDown;
+    VPE_LOGW("Skip level %{public}d of bucket %{public}u for %{public}lld ms after %{public}d failures",
+        level, bucket, static_cast<long long>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(state.coolDown).count()), state.failureNum);
+}
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
@@ -15,13 +15,22 @@
 
 #include "detail_enhancer_image_fwk.h"
 
+#include <algorithm>
+#include <chrono>
 #include <dlfcn.h>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
 
 #include "detail_enhancer_common.h"
+#include "extension_instance_pool.h"
 #include "extension_manager.h"
+#include "extension_rank_calibration.h"
 #include "native_buffer.h"
 #include "surface_buffer.h"
 #include "video_processing_client.h"
+#include "vpe_task_executor.h"
 #include "securec.h"
 #include "vpe_log.h"
 #include "vpe_sa_constants.h"
@@ -43,7 +52,6 @@ const int SUPPORTED_MIN_WIDTH = 32;
 const int SUPPORTED_MIN_HEIGHT = 32;
 const int SUPPORTED_MAX_WIDTH = 20000; // 20000 max support width
 const int SUPPORTED_MAX_HEIGHT = 20000; // 20000 max support height
-const int TIMEOUT_THRESHOLD = 10; // 10 millisecond
 const std::unordered_set<int32_t> SUPPORTED_FORMATS = {
     OHOS::GRAPHIC_PIXEL_FMT_BGRA_8888, // BGRA
     OHOS::GRAPHIC_PIXEL_FMT_RGBA_8888, // RGBA
@@ -52,6 +60,19 @@ const std::unordered_set<int32_t> SUPPORTED_FORMATS = {
     OHOS::GRAPHIC_PIXEL_FMT_YCBCR_420_P, // YU12
     OHOS::GRAPHIC_PIXEL_FMT_YCRCB_420_P, // YV12
     OHOS::GRAPHIC_PIXEL_FMT_RGBA_1010102, // RGBA_1010102
+    OHOS::GRAPHIC_PIXEL_FMT_YCBCR_P010, // NV12 10bit
+    OHOS::GRAPHIC_PIXEL_FMT_YCRCB_P010, // NV21 10bit
+};
+// The formats which the CPU fallback scales and converts in one pass, see skia_convert_scale.h.
+const std::unordered_set<int32_t> CONVERTIBLE_YUV_FORMATS = {
+    OHOS::GRAPHIC_PIXEL_FMT_YCBCR_420_SP, // NV12
+    OHOS::GRAPHIC_PIXEL_FMT_YCRCB_420_SP, // NV21
+    OHOS::GRAPHIC_PIXEL_FMT_YCBCR_420_P, // YU12
+    OHOS::GRAPHIC_PIXEL_FMT_YCRCB_420_P, // YV12
+};
+const std::unordered_set<int32_t> CONVERTIBLE_RGB_FORMATS = {
+    OHOS::GRAPHIC_PIXEL_FMT_BGRA_8888, // BGRA
+    OHOS::GRAPHIC_PIXEL_FMT_RGBA_8888, // RGBA
 };
 const std::vector<std::array<int, RECT_LEVEL_NUM>> SUPER_LEVEL_TARGET_RECT = {
     {1, 1104, 1, 848},
@@ -68,13 +89,187 @@ inline bool IsValidSurfaceBuffer(const OHOS::sptr<OHOS::SurfaceBuffer>& buffer)
         buffer->GetWidth() <= SUPPORTED_MAX_WIDTH && buffer->GetHeight() <= SUPPORTED_MAX_HEIGHT;
 }
 
-std::atomic<int32_t> g_instanceId = -1;
-std::timed_mutex g_externLock{};
+bool IsConvertibleFormat(int32_t inputFormat, int32_t outputFormat)
+{
+    return (CONVERTIBLE_YUV_FORMATS.count(inputFormat) > 0 && CONVERTIBLE_RGB_FORMATS.count(outputFormat) > 0) ||
+        (CONVERTIBLE_RGB_FORMATS.count(inputFormat) > 0 && CONVERTIBLE_YUV_FORMATS.count(outputFormat) > 0);
+}
+
+// The instance shared by the callers of DetailEnhancerCreate, the callers wait for the lock instead of failing.
+std::mutex g_instanceIdLock{};
+int32_t g_instanceId = -1; // Guarded by g_instanceIdLock
+
+constexpr size_t ALGORITHM_POOL_CAPACITY = 4; // Idle initialized algorithms shared by all DetailEnhancerImageFwk
+using DetailEnhancerPool =
+    OHOS::Media::VideoProcessingEngine::Extension::ExtensionInstancePool<std::pair<int, uint32_t>,
+        OHOS::Media::VideoProcessingEngine::DetailEnhancerBase>;
+
+DetailEnhancerPool& GetAlgorithmPool()
+{
+    static DetailEnhancerPool pool(ALGORITHM_POOL_CAPACITY);
+    return pool;
+}
 }
 
 namespace OHOS {
 namespace Media {
 namespace VideoProcessingEngine {
+namespace {
+constexpr size_t MAX_PLAN_NUM = 8; // The shapes which an instance usually processes in turn
+constexpr uint32_t COPY_WORKER_NUM = 4;
+constexpr uint32_t BATCH_WORKER_NUM = 4;
+constexpr size_t MIN_COPY_BAND_BYTES = 1024 * 1024; // A smaller band costs more to schedule than to copy
+constexpr int CHROMA_SUBSAMPLE = 2; // 420 halves the chroma in both directions
+constexpr int PLANE_U = 1;
+constexpr int PLANE_V = 2;
+constexpr int PLANE_NUM_YUV = 3;
+
+// The visible rows of one plane of the input and the output.
+struct CopyRegion {
+    const uint8_t* src;
+    uint8_t* dst;
+    size_t srcStride;
+    size_t dstStride;
+    size_t rowBytes;
+    int rows;
+};
+
+struct PlaneLayout {
+    uint64_t offset;
+    size_t stride;
+    size_t rowBytes;
+    int rows;
+};
+
+bool GetPlaneLayouts(const sptr<SurfaceBuffer>& buffer, std::vector<PlaneLayout>& layouts)
+{
+    int width = buffer->GetWidth();
+    int height = buffer->GetHeight();
+    int chromaWidth = (width + 1) / CHROMA_SUBSAMPLE;
+    int chromaHeight = (height + 1) / CHROMA_SUBSAMPLE;
+    int32_t format = buffer->GetFormat();
+    if (format == GRAPHIC_PIXEL_FMT_RGBA_8888 || format == GRAPHIC_PIXEL_FMT_BGRA_8888 ||
+        format == GRAPHIC_PIXEL_FMT_RGBA_1010102) {
+        constexpr size_t bytesPerPixel = 4;
+        layouts.push_back({ 0, static_cast<size_t>(buffer->GetStride()), width * bytesPerPixel, height });
+        return true;
+    }
+    void* planesInfoPtr = nullptr;
+    buffer->GetPlanesInfo(&planesInfoPtr);
+    auto planesInfo = static_cast<OH_NativeBuffer_Planes*>(planesInfoPtr);
+    CHECK_AND_RETURN_RET_LOG(planesInfo != nullptr && planesInfo->planeCount >= PLANE_NUM_YUV, false,
+        "Invalid planes info!");
+    const auto& planes = planesInfo->planes;
+    bool isSemiPlanar = format != GRAPHIC_PIXEL_FMT_YCBCR_420_P && format != GRAPHIC_PIXEL_FMT_YCRCB_420_P;
+    size_t bytesPerSample = (format == GRAPHIC_PIXEL_FMT_YCBCR_P010 || format == GRAPHIC_PIXEL_FMT_YCRCB_P010) ?
+        sizeof(uint16_t) : sizeof(uint8_t);
+    layouts.push_back({ planes[0].offset, planes[0].columnStride, width * bytesPerSample, height });
+    if (isSemiPlanar) {
+        // The interleaved plane starts at the first of U and V, which depends on NV12 or NV21.
+        layouts.push_back({ std::min(planes[PLANE_U].offset, planes[PLANE_V].offset), planes[PLANE_U].columnStride,
+            chromaWidth * CHROMA_SUBSAMPLE * bytesPerSample, chromaHeight });
+    } else {
+        layouts.push_back({ planes[PLANE_U].offset, planes[PLANE_U].columnStride, chromaWidth * bytesPerSample,
+            chromaHeight });
+        layouts.push_back({ planes[PLANE_V].offset, planes[PLANE_V].columnStride, chromaWidth * bytesPerSample,
+            chromaHeight });
+    }
+    return true;
+}
+
+bool IsInside(const sptr<SurfaceBuffer>& buffer, const PlaneLayout& layout)
+{
+    if (layout.rows <= 0 || layout.rowBytes > layout.stride) {
+        return false;
+    }
+    uint64_t end = layout.offset + static_cast<uint64_t>(layout.rows - 1) * layout.stride + layout.rowBytes;
+    return end <= buffer->GetSize();
+}
+
+bool GetCopyRegions(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output,
+    std::vector<CopyRegion>& regions)
+{
+    std::vector<PlaneLayout> inputLayouts;
+    std::vector<PlaneLayout> outputLayouts;
+    if (input->GetVirAddr() == nullptr || output->GetVirAddr() == nullptr ||
+        !GetPlaneLayouts(input, inputLayouts) || !GetPlaneLayouts(output, outputLayouts) ||
+        inputLayouts.size() != outputLayouts.size()) {
+        return false;
+    }
+    auto inputAddr = static_cast<const uint8_t*>(input->GetVirAddr());
+    auto outputAddr = static_cast<uint8_t*>(output->GetVirAddr());
+    for (size_t i = 0; i < inputLayouts.size(); i++) {
+        const auto& in = inputLayouts[i];
+        const auto& out = outputLayouts[i];
+        CHECK_AND_RETURN_RET_LOG(in.rowBytes == out.rowBytes && in.rows == out.rows && IsInside(input, in) &&
+            IsInside(output, out), false, "Invalid layout of plane %{public}zu", i);
+        regions.push_back({ inputAddr + in.offset, outputAddr + out.offset, in.stride, out.stride, in.rowBytes,
+            in.rows });
+    }
+    return true;
+}
+
+// Copy the visible rows only, the planes are split into bands which are copied in parallel.
+bool CopyVisibleRows(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+{
+    std::vector<CopyRegion> regions;
+    if (!GetCopyRegions(input, output, regions)) {
+        return false;
+    }
+    std::vector<CopyRegion> bands;
+    for (const auto& region : regions) {
+        size_t bytes = region.rowBytes * static_cast<size_t>(region.rows);
+        int bandNum = static_cast<int>(std::clamp<size_t>(bytes / MIN_COPY_BAND_BYTES, 1, COPY_WORKER_NUM));
+        for (int band = 0; band < bandNum; band++) {
+            int top = region.rows * band / bandNum;
+            int bottom = region.rows * (band + 1) / bandNum;
+            bands.push_back({ region.src + top * region.srcStride, region.dst + top * region.dstStride,
+                region.srcStride, region.dstStride, region.rowBytes, bottom - top });
+        }
+    }
+    VpeTaskExecutor::GetInstance().ParallelFor(bands.size(), COPY_WORKER_NUM, [&bands](size_t index) {
+        const auto& band = bands[index];
+        if (band.srcStride == band.rowBytes && band.dstStride == band.rowBytes) {
+            (void)memcpy_s(band.dst, band.rowBytes * band.rows, band.src, band.rowBytes * band.rows);
+            return;
+        }
+        for (int row = 0; row < band.rows; row++) {
+            (void)memcpy_s(band.dst + row * band.dstStride, band.rowBytes, band.src + row * band.srcStride,
+                band.rowBytes);
+        }
+    });
+    return true;
+}
+
+bool IsSameParameter(const DetailEnhancerParameters& lhs, const DetailEnhancerParameters& rhs)
+{
+    return lhs.level == rhs.level && lhs.contentId == rhs.contentId && lhs.memoryBudget == rhs.memoryBudget &&
+        lhs.uri == rhs.uri;
+}
+
+DetailEnhancerParameters GetLevelParameter(const DetailEnhancerParameters& parameter, int level)
+{
+    DetailEnhancerParameters levelParameter = parameter;
+    levelParameter.level = static_cast<DetailEnhancerLevel>((level == DETAIL_ENH_LEVEL_HIGH_AISR) ?
+        DETAIL_ENH_LEVEL_HIGH : level); // map level
+    return levelParameter;
+}
+
+VPEAlgoErrCode Passthrough(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+{
+    if (input == output || input->GetVirAddr() == output->GetVirAddr()) {
+        // Processing in place, the output already holds the input.
+        return VPE_ALGO_ERR_OK;
+    }
+    if (CopyVisibleRows(input, output)) {
+        return VPE_ALGO_ERR_OK;
+    }
+    VPE_LOGW("Unknown layout, copy the whole buffer.");
+    return (memcpy_s(output->GetVirAddr(), output->GetSize(), input->GetVirAddr(), input->GetSize()) == EOK) ?
+        VPE_ALGO_ERR_OK : VPE_ALGO_ERR_UNKNOWN;
+}
+} // namespace
+
 DetailEnhancerImageFwk::DetailEnhancerImageFwk(int type)
 {
     type_ = (type >= IMAGE && type <= VIDEO) ? type : IMAGE;
@@ -83,7 +278,7 @@ DetailEnhancerImageFwk::DetailEnhancerImageFwk(int type)
 
 DetailEnhancerImageFwk::~DetailEnhancerImageFwk()
 {
-    Clear();
+    RecycleAlgorithms();
     Extension::ExtensionManager::GetInstance().DecreaseInstance();
 }
 
@@ -95,18 +290,34 @@ std::shared_ptr<DetailEnhancerImage> DetailEnhancerImage::Create(int type)
     return impl;
 }
 
-std::shared_ptr<DetailEnhancerBase> DetailEnhancerImageFwk::GetAlgorithm(int level)
+VPEAlgoErrCode DetailEnhancerImage::ProcessBatch(
+    const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>>& images,
+    std::vector<VPEAlgoErrCode>& results)
+{
+    results.assign(images.size(), VPE_ALGO_ERR_INVALID_VAL);
+    for (size_t i = 0; i < images.size(); i++) {
+        results[i] = Process(images[i].first, images[i].second);
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+        CHECK_AND_RETURN_RET_LOG(results[i] == VPE_ALGO_ERR_OK, results[i],
+            "Process %{public}zu failed, ret: %{public}d", i, results[i]);
+    }
+    return VPE_ALGO_ERR_OK;
+}
+
+std::shared_ptr<DetailEnhancerBase> DetailEnhancerImageFwk::GetAlgorithm(int level, uint32_t rankBucket)
 {
     if (level < DETAIL_ENH_LEVEL_NONE || level > DETAIL_ENH_LEVEL_VIDEO) {
         VPE_LOGE("Invalid level:%{public}d", level);
         return nullptr;
     }
+    AlgorithmKey key = { level, rankBucket };
     std::lock_guard<std::mutex> lock(lock_);
-    auto createdImpl = algorithms_.find(level);
+    auto createdImpl = algorithms_.find(key);
     if (createdImpl != algorithms_.end()) [[likely]] {
         return createdImpl->second;
     }
-    auto algo = CreateAlgorithm(level);
+    auto algo = CreateAlgorithm(level, rankBucket);
     if (algo.get() == nullptr) {
         return nullptr;
     }
@@ -114,25 +325,28 @@ std::shared_ptr<DetailEnhancerBase> DetailEnhancerImageFwk::GetAlgorithm(int lev
     auto ret = algo->EnableProtection(enableProtection_);
     CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, nullptr,
         "Failed to EnableProtection(%{public}d) for level:%{pubcli}d ret:%{pubcli}d", enableProtection_, level, ret);
-    algorithms_[level] = algo;
-    return algorithms_[level];
+    algorithms_[key] = algo;
+    return algo;
 }
 
-std::shared_ptr<DetailEnhancerBase> DetailEnhancerImageFwk::CreateAlgorithm(int level)
+std::shared_ptr<DetailEnhancerBase> DetailEnhancerImageFwk::CreateAlgorithm(int level, uint32_t rankBucket)
 {
-    auto& manager = Extension::ExtensionManager::GetInstance();
-    VPE_SYNC_TRACE;
-    std::shared_ptr<DetailEnhancerBase> algoImpl = manager.CreateDetailEnhancer(level);
-    VPE_LOGE("level:%{public}d", level);
-    if (algoImpl == nullptr) {
-        VPE_LOGE("Extension create failed, get a empty impl, level: %{public}d", level);
-        return nullptr;
-    }
-    if (algoImpl->Init() != VPE_ALGO_ERR_OK) {
-        VPE_LOGE("Init failed, extension level: %{public}d", level);
-        return nullptr;
-    }
-    return algoImpl;
+    return GetAlgorithmPool().Acquire({ level, rankBucket },
+        [level, rankBucket]() -> std::shared_ptr<DetailEnhancerBase> {
+        auto& manager = Extension::ExtensionManager::GetInstance();
+        VPE_SYNC_TRACE;
+        std::shared_ptr<DetailEnhancerBase> algoImpl = manager.CreateDetailEnhancer(level, rankBucket);
+        VPE_LOGE("level:%{public}d", level);
+        if (algoImpl == nullptr) {
+            VPE_LOGE("Extension create failed, get a empty impl, level: %{public}d", level);
+            return nullptr;
+        }
+        if (algoImpl->Init() != VPE_ALGO_ERR_OK) {
+            VPE_LOGE("Init failed, extension level: %{public}d", level);
+            return nullptr;
+        }
+        return algoImpl;
+    });
 }
 
 VPEAlgoErrCode DetailEnhancerImageFwk::SetParameter(const DetailEnhancerParameters& parameter)
@@ -141,7 +355,6 @@ VPEAlgoErrCode DetailEnhancerImageFwk::SetParameter(const DetailEnhancerParamete
         parameter.uri.length() < MAX_URL_LENGTH, VPE_ALGO_ERR_INVALID_VAL, "Invalid parameter");
     std::lock_guard<std::mutex> lock(lock_);
     parameter_ = parameter;
-    parameterUpdated = true;
     hasParameter_ = true;
     VPE_LOGI("DetailEnhancerImageFwk SetParameter Succeed");
     return VPE_ALGO_ERR_OK;
@@ -160,17 +373,18 @@ bool DetailEnhancerImageFwk::IsValidProcessedObject(const sptr<SurfaceBuffer>& i
 {
     CHECK_AND_RETURN_RET_LOG((input != nullptr) && (output != nullptr),
         false, "Input or output is nullptr");
-    CHECK_AND_RETURN_RET_LOG(input->GetFormat() == output->GetFormat(), false,
-        "The input format and output format need to be consistent");
+    CHECK_AND_RETURN_RET_LOG(input->GetFormat() == output->GetFormat() ||
+        (type_ == IMAGE && IsConvertibleFormat(input->GetFormat(), output->GetFormat())), false,
+        "The input format and output format need to be consistent or convertible");
     CHECK_AND_RETURN_RET_LOG(IsValidSurfaceBuffer(input) && IsValidSurfaceBuffer(output), false, "Invalid buffer");
     return true;
 }
 
 int DetailEnhancerImageFwk::EvaluateTargetLevel(const sptr<SurfaceBuffer>& input,
-    const sptr<SurfaceBuffer>& output, float widthRatio, float heightRatio) const
+    const sptr<SurfaceBuffer>& output, float widthRatio, float heightRatio, int level) const
 {
     CHECK_AND_RETURN_RET_LOG((input != nullptr) && (output != nullptr), false, "Input or output is nullptr");
-    if (parameter_.level == DETAIL_ENH_LEVEL_HIGH) {
+    if (level == DETAIL_ENH_LEVEL_HIGH) {
         int inputW = input->GetWidth();
         int inputH = input->GetHeight();
         if (widthRatio < 1.0 && heightRatio < 1.0 && // 1.0 means zoom out
@@ -183,22 +397,28 @@ int DetailEnhancerImageFwk::EvaluateTargetLevel(const sptr<SurfaceBuffer>& input
         }
         return DETAIL_ENH_LEVEL_HIGH_AISR;
     }
-    return parameter_.level;
+    return level;
 }
 
 VPEAlgoErrCode DetailEnhancerImageFwk::ProcessVideo(const sptr<SurfaceBuffer>& input,
     const sptr<SurfaceBuffer>& output)
 {
-    auto algoImpl = GetAlgorithm(DETAIL_ENH_LEVEL_VIDEO);
+    AlgorithmKey key = { DETAIL_ENH_LEVEL_VIDEO, GetRankBucket(input) };
+    auto algoImpl = GetAlgorithm(key.first, key.second);
     if (algoImpl == nullptr) {
         VPE_LOGE("Get Algorithm impl for video failed!");
         return VPE_ALGO_ERR_UNKNOWN;
     }
-    if (parameterUpdated.load() && (algoImpl->SetParameter(parameter_) !=  VPE_ALGO_ERR_OK)) {
+    DetailEnhancerParameters parameter;
+    bool hasParameter = false;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        parameter = parameter_;
+        hasParameter = hasParameter_;
+    }
+    if (hasParameter && ApplyParameter(key, algoImpl, parameter) != VPE_ALGO_ERR_OK) {
         VPE_LOGE("set parameter failed!");
         return VPE_ALGO_ERR_UNKNOWN;
-    } else {
-        parameterUpdated = false;
     }
     UpdateLastAlgorithm(algoImpl);
     if (ProcessAlgorithm(algoImpl, input, output) != VPE_ALGO_ERR_OK) {
@@ -210,7 +430,28 @@ VPEAlgoErrCode DetailEnhancerImageFwk::ProcessVideo(const sptr<SurfaceBuffer>& i
 
 VPEAlgoErrCode DetailEnhancerImageFwk::Process(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
 {
-    auto err = DoProcess(input, output);
+    std::lock_guard<std::mutex> processLock(processLock_);
+    return ProcessLocked(input, output);
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::ProcessWithParameter(const DetailEnhancerParameters& parameter,
+    const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+{
+    std::lock_guard<std::mutex> processLock(processLock_);
+    auto err = SetParameter(parameter);
+    CHECK_AND_RETURN_RET_LOG(err == VPE_ALGO_ERR_OK, err, "Invalid parameter!");
+    return ProcessLocked(input, output);
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::ProcessLocked(const sptr<SurfaceBuffer>& input,
+    const sptr<SurfaceBuffer>& output)
+{
+    return RetryIfRestorable(DoProcess(input, output), input, output);
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::RetryIfRestorable(VPEAlgoErrCode err, const sptr<SurfaceBuffer>& input,
+    const sptr<SurfaceBuffer>& output)
+{
     if (err != VPE_ALGO_ERR_OK) {
         std::lock_guard<std::mutex> lock(restoreLock_);
         if (!needRestore_) {
@@ -226,39 +467,228 @@ VPEAlgoErrCode DetailEnhancerImageFwk::Process(const sptr<SurfaceBuffer>& input,
     return err;
 }
 
-VPEAlgoErrCode DetailEnhancerImageFwk::DoProcess(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+VPEAlgoErrCode DetailEnhancerImageFwk::ProcessBatch(
+    const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>>& images,
+    std::vector<VPEAlgoErrCode>& results)
 {
-    CHECK_AND_RETURN_RET_LOG(IsValidProcessedObject(input, output), VPE_ALGO_ERR_INVALID_VAL, "Invalid input!");
+    results.assign(images.size(), VPE_ALGO_ERR_INVALID_VAL);
+    std::lock_guard<std::mutex> processLock(processLock_);
+    // The images of the same shape share one validation and one plan.
+    using ShapeKey = std::tuple<int32_t, int32_t, int32_t, int32_t, int32_t, int32_t>;
+    std::map<ShapeKey, std::vector<size_t>> groups;
+    for (size_t i = 0; i < images.size(); i++) {
+        const auto& [input, output] = images[i];
+        if (input == nullptr || output == nullptr) {
+            VPE_LOGE("Input or output %{public}zu is nullptr", i);
+            continue;
+        }
+        groups[std::make_tuple(input->GetWidth(), input->GetHeight(), input->GetFormat(), output->GetWidth(),
+            output->GetHeight(), output->GetFormat())].push_back(i);
+    }
+    for (const auto& [key, indexes] : groups) {
+        ProcessBatchGroup(images, indexes, results);
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+        CHECK_AND_RETURN_RET_LOG(results[i] == VPE_ALGO_ERR_OK, results[i],
+            "Process %{public}zu failed, ret: %{public}d", i, results[i]);
+    }
+    return VPE_ALGO_ERR_OK;
+}
+
+void DetailEnhancerImageFwk::ProcessBatchGroup(
+    const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>>& images,
+    const std::vector<size_t>& indexes, std::vector<VPEAlgoErrCode>& results)
+{
+    const auto& [firstInput, firstOutput] = images[indexes.front()];
+    if (!IsValidProcessedObject(firstInput, firstOutput) || type_ == VIDEO) {
+        for (auto index : indexes) {
+            results[index] = ProcessLocked(images[index].first, images[index].second);
+        }
+        return;
+    }
+    // The first image finds the level which works for the shape, the others start from that level.
     VPE_SYNC_TRACE;
-    if (type_ == VIDEO) {
-        return ProcessVideo(input, output);
+    auto plan = GetPlan(firstInput, firstOutput);
+    plan.rankBucket = GetRankBucket(firstInput);
+    int processedLevel = -1;
+    results[indexes.front()] = RetryIfRestorable(ExecutePlan(plan, firstInput, firstOutput, processedLevel),
+        firstInput, firstOutput);
+    std::vector<size_t> rest(indexes.begin() + 1, indexes.end());
+    if (plan.isPassthrough) {
+        VpeTaskExecutor::GetInstance().ParallelFor(rest.size(), BATCH_WORKER_NUM,
+            [&images, &rest, &results](size_t i) {
+                results[rest[i]] = Passthrough(images[rest[i]].first, images[rest[i]].second);
+            });
+        return;
+    }
+    if (processedLevel < DETAIL_ENH_LEVEL_NONE || plan.isTiled) {
+        // The tiled images go one by one, so the batch keeps the memory budget too.
+        for (auto index : rest) {
+            results[index] = ProcessLocked(images[index].first, images[index].second);
+        }
+        return;
+    }
+    auto parameter = GetLevelParameter(plan.parameter, processedLevel);
+    AlgorithmKey key = { processedLevel, plan.rankBucket };
+    if (processedLevel <= DETAIL_ENH_LEVEL_MEDIUM && !enableProtection_) {
+        // The CPU scaling levels run the images in parallel, each worker checks out its own algorithm from the pool.
+        VpeTaskExecutor::GetInstance().ParallelFor(rest.size(), BATCH_WORKER_NUM,
+            [this, &images, &rest, &results, &parameter, &key](size_t i) {
+                results[rest[i]] = ProcessByPooledAlgorithm(key, parameter, images[rest[i]].first,
+                    images[rest[i]].second);
+            });
+    } else {
+        // The accelerators serialize the images anyway, so share the algorithm of this instance.
+        auto algoImpl = GetAlgorithm(key.first, key.second);
+        bool isReady = algoImpl != nullptr && ApplyParameter(key, algoImpl, parameter) == VPE_ALGO_ERR_OK;
+        for (auto index : rest) {
+            results[index] = isReady ? ProcessAlgorithm(algoImpl, images[index].first, images[index].second) :
+                VPE_ALGO_ERR_UNKNOWN;
+        }
+    }
+    for (auto index : rest) {
+        if (results[index] != VPE_ALGO_ERR_OK) {
+            // Fall back to the lower levels and the restoration, as a single Process does.
+            results[index] = ProcessLocked(images[index].first, images[index].second);
+        }
+    }
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::ProcessByPooledAlgorithm(const AlgorithmKey& key,
+    const DetailEnhancerParameters& parameter, const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+{
+    auto algoImpl = CreateAlgorithm(key.first, key.second);
+    CHECK_AND_RETURN_RET_LOG(algoImpl != nullptr, VPE_ALGO_ERR_UNKNOWN, "Get Algorithm impl for %{public}d failed!",
+        key.first);
+    auto err = algoImpl->EnableProtection(false);
+    if (err == VPE_ALGO_ERR_OK) {
+        err = algoImpl->SetParameter(parameter);
+    }
+    if (err == VPE_ALGO_ERR_OK) {
+        err = algoImpl->Process(input, output);
+    }
+    if (static_cast<VPEAlgoErrExCode>(err) != VPE_ALGO_ERR_INVALID_CLIENT_ID) {
+        GetAlgorithmPool().Release(key, std::move(algoImpl));
+    }
+    return err;
+}
+
+uint32_t DetailEnhancerImageFwk::GetRankBucket(const sptr<SurfaceBuffer>& input) const
+{
+    return Extension::ExtensionManager::GetInstance().GetRankBucket(static_cast<uint32_t>(input->GetWidth()),
+        static_cast<uint32_t>(input->GetHeight()));
+}
+
+DetailEnhancerImageFwk::ProcessPlan DetailEnhancerImageFwk::MakePlan(const sptr<SurfaceBuffer>& input,
+    const sptr<SurfaceBuffer>& output)
+{
+    ProcessPlan plan;
+    {
+        // A copy, so the level mapped for one call does not leak into the next one.
+        std::lock_guard<std::mutex> lock(lock_);
+        plan.parameter = parameter_;
     }
     float widthRatio = static_cast<float>(output->GetWidth()) / static_cast<float>(input->GetWidth());
     float heightRatio = static_cast<float>(output->GetHeight()) / static_cast<float>(input->GetHeight());
-    int targetLevel = EvaluateTargetLevel(input, output, widthRatio, heightRatio);
-    if (targetLevel < DETAIL_ENH_LEVEL_HIGH_AISR &&
-        std::fabs(widthRatio - 1.0f) < EPSILON && std::fabs(heightRatio - 1.0f) < EPSILON) {
+    plan.targetLevel = EvaluateTargetLevel(input, output, widthRatio, heightRatio, plan.parameter.level);
+    bool needConvert = input->GetFormat() != output->GetFormat();
+    if (needConvert) {
+        // Only the CPU fallback converts the pixel format, skip the levels which it does not serve.
+        plan.targetLevel = std::min(plan.targetLevel, static_cast<int>(DETAIL_ENH_LEVEL_MEDIUM));
+    }
+    plan.isPassthrough = !needConvert && plan.targetLevel < DETAIL_ENH_LEVEL_HIGH_AISR &&
+        std::fabs(widthRatio - 1.0f) < EPSILON && std::fabs(heightRatio - 1.0f) < EPSILON;
+    plan.isTiled = !plan.isPassthrough && plan.tiling.Plan(input, output, plan.parameter.memoryBudget);
+    return plan;
+}
+
+DetailEnhancerImageFwk::ProcessPlan DetailEnhancerImageFwk::GetPlan(const sptr<SurfaceBuffer>& input,
+    const sptr<SurfaceBuffer>& output)
+{
+    auto shape = std::make_tuple(input->GetWidth(), input->GetHeight(), input->GetFormat(), output->GetWidth(),
+        output->GetHeight(), output->GetFormat());
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        PlanKey key = std::tuple_cat(shape, std::make_tuple(static_cast<int>(parameter_.level)));
+        auto it = std::find_if(plans_.begin(), plans_.end(), [this, &key](const auto& entry) {
+            return entry.first == key && IsSameParameter(entry.second.parameter, parameter_);
+        });
+        if (it != plans_.end()) {
+            std::rotate(it, it + 1, plans_.end());
+            return plans_.back().second;
+        }
+    }
+    auto plan = MakePlan(input, output);
+    PlanKey key = std::tuple_cat(shape, std::make_tuple(static_cast<int>(plan.parameter.level)));
+    std::lock_guard<std::mutex> lock(lock_);
+    // The plan of the same key is made with an older parameter.
+    plans_.erase(std::remove_if(plans_.begin(), plans_.end(), [&key](const auto& entry) {
+        return entry.first == key;
+    }), plans_.end());
+    if (plans_.size() >= MAX_PLAN_NUM) {
+        plans_.erase(plans_.begin());
+    }
+    plans_.emplace_back(key, plan);
+    return plan;
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::ApplyParameter(const AlgorithmKey& key,
+    const std::shared_ptr<DetailEnhancerBase>& algorithm, const DetailEnhancerParameters& parameter)
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = appliedParameters_.find(key);
+        if (it != appliedParameters_.end() && IsSameParameter(it->second, parameter)) {
+            return VPE_ALGO_ERR_OK;
+        }
+    }
+    auto err = algorithm->SetParameter(parameter);
+    std::lock_guard<std::mutex> lock(lock_);
+    if (err == VPE_ALGO_ERR_OK) {
+        appliedParameters_[key] = parameter;
+    } else {
+        appliedParameters_.erase(key);
+    }
+    return err;
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::ExecutePlan(const ProcessPlan& plan, const sptr<SurfaceBuffer>& input,
+    const sptr<SurfaceBuffer>& output, int& processedLevel)
+{
+    processedLevel = -1;
+    if (plan.isPassthrough) {
         VPE_LOGI("The current scaling ratio is 1.0, and the algorithm is not AISR, so copy it directly.");
-        return (memcpy_s(output->GetVirAddr(), output->GetSize(), input->GetVirAddr(), input->GetSize()) == EOK) ?
-            VPE_ALGO_ERR_OK : VPE_ALGO_ERR_UNKNOWN;
+        return Passthrough(input, output);
     }
-    bool processSuccessfully = false;
-    for (int level = targetLevel; level >= DETAIL_ENH_LEVEL_NONE; level--) {
-        auto algoImpl = GetAlgorithm(level);
+    if (plan.isTiled) {
+        return ExecuteTiledPlan(plan, input, output, processedLevel);
+    }
+    auto& breaker = circuitBreaker_;
+    uint32_t bucket = Extension::ExtensionRankCalibration::GetResolutionBucket(input->GetWidth(), input->GetHeight());
+    for (int level = plan.targetLevel; level >= DETAIL_ENH_LEVEL_NONE; level--) {
+        // The lowest level is the last resort, it is never skipped.
+        if (level > DETAIL_ENH_LEVEL_NONE && !breaker.IsAllowed(level, bucket)) {
+            VPE_LOGD("Skip level %{public}d which keeps failing", level);
+            continue;
+        }
+        auto algoImpl = GetAlgorithm(level, plan.rankBucket);
         if (algoImpl == nullptr) {
             VPE_LOGE("Get Algorithm impl for %{public}d failed!", level);
+            breaker.Report(level, bucket, VPE_ALGO_ERR_UNKNOWN);
             continue;
         }
-        parameter_.level = static_cast<DetailEnhancerLevel>((level == DETAIL_ENH_LEVEL_HIGH_AISR) ?
-            DETAIL_ENH_LEVEL_HIGH : level); // map level
-        if (algoImpl->SetParameter(parameter_) !=  VPE_ALGO_ERR_OK) {
+        if (ApplyParameter({ level, plan.rankBucket }, algoImpl,
+            GetLevelParameter(plan.parameter, level)) != VPE_ALGO_ERR_OK) {
             VPE_LOGE("set parameter failed!");
+            breaker.Report(level, bucket, VPE_ALGO_ERR_UNKNOWN);
             return VPE_ALGO_ERR_UNKNOWN;
         }
         UpdateLastAlgorithm(algoImpl);
-        if (ProcessAlgorithm(algoImpl, input, output) == VPE_ALGO_ERR_OK) {
-            processSuccessfully = true;
-            break;
+        auto err = ProcessAlgorithm(algoImpl, input, output);
+        breaker.Report(level, bucket, err);
+        if (err == VPE_ALGO_ERR_OK) {
+            processedLevel = level;
+            return VPE_ALGO_ERR_OK;
         } else if (level == DETAIL_ENH_LEVEL_HIGH_AISR) {
             VPE_LOGD("AISR processed failed, try to process by EVE");
         } else if (level > DETAIL_ENH_LEVEL_NONE) {
@@ -268,14 +698,115 @@ VPEAlgoErrCode DetailEnhancerImageFwk::DoProcess(const sptr<SurfaceBuffer>& inpu
             return VPE_ALGO_ERR_UNKNOWN;
         }
     }
-    return processSuccessfully ? VPE_ALGO_ERR_OK : VPE_ALGO_ERR_INVALID_VAL;
+    return VPE_ALGO_ERR_INVALID_VAL;
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::ExecuteTiledPlan(const ProcessPlan& plan, const sptr<SurfaceBuffer>& input,
+    const sptr<SurfaceBuffer>& output, int& processedLevel)
+{
+    VPE_SYNC_TRACE;
+    ProcessPlan tilePlan = plan;
+    tilePlan.isTiled = false;
+    auto fallback = [this, &tilePlan](const sptr<SurfaceBuffer>& inputTile, const sptr<SurfaceBuffer>& outputTile) {
+        int level = -1;
+        return ExecutePlan(tilePlan, inputTile, outputTile, level);
+    };
+    const auto& tiling = plan.tiling;
+    auto columnNum = static_cast<size_t>(tiling.GetColumnNum());
+    std::shared_ptr<DetailEnhancerBase> algoImpl = nullptr;
+    for (int row = 0; row < tiling.GetRowNum(); row++) {
+        std::vector<sptr<SurfaceBuffer>> outputTiles(columnNum);
+        std::vector<VPEAlgoErrCode> results(columnNum, VPE_ALGO_ERR_OK);
+        size_t first = 0;
+        if (processedLevel < DETAIL_ENH_LEVEL_NONE) {
+            // The first tile finds the level which works, the others use the same level so the tiles look alike.
+            auto err = ProcessTile(tiling, row, 0, { input, output },
+                [this, &tilePlan, &processedLevel](const sptr<SurfaceBuffer>& inputTile,
+                    const sptr<SurfaceBuffer>& outputTile) {
+                    return ExecutePlan(tilePlan, inputTile, outputTile, processedLevel);
+                }, outputTiles[0]);
+            CHECK_AND_RETURN_RET_LOG(err == VPE_ALGO_ERR_OK && processedLevel >= DETAIL_ENH_LEVEL_NONE,
+                VPE_ALGO_ERR_UNKNOWN, "Failed to process the first tile, ret:%{public}d", err);
+            first = 1;
+        }
+        auto parameter = GetLevelParameter(plan.parameter, processedLevel);
+        AlgorithmKey key = { processedLevel, plan.rankBucket };
+        if (processedLevel <= DETAIL_ENH_LEVEL_MEDIUM && !enableProtection_ && tiling.GetWorkerNum() > 1) {
+            // As the batch does, the CPU scaling levels run the tiles in parallel on the algorithms of the pool.
+            VpeTaskExecutor::GetInstance().ParallelFor(columnNum - first, tiling.GetWorkerNum(),
+                [this, &tiling, &input, &output, &parameter, &outputTiles, &results, &key, row, first](size_t i) {
+                    results[first + i] = ProcessTile(tiling, row, static_cast<int>(first + i), { input, output },
+                        [this, &parameter, &key](const sptr<SurfaceBuffer>& inputTile,
+                            const sptr<SurfaceBuffer>& outputTile) {
+                            return ProcessByPooledAlgorithm(key, parameter, inputTile, outputTile);
+                        }, outputTiles[first + i]);
+                });
+        } else {
+            if (algoImpl == nullptr) {
+                algoImpl = GetAlgorithm(key.first, key.second);
+                CHECK_AND_RETURN_RET_LOG(algoImpl != nullptr &&
+                    ApplyParameter(key, algoImpl, parameter) == VPE_ALGO_ERR_OK,
+                    VPE_ALGO_ERR_UNKNOWN, "Failed to prepare the algorithm of level %{public}d", processedLevel);
+            }
+            for (size_t column = first; column < columnNum; column++) {
+                results[column] = ProcessTile(tiling, row, static_cast<int>(column), { input, output },
+                    [this, &algoImpl](const sptr<SurfaceBuffer>& inputTile, const sptr<SurfaceBuffer>& outputTile) {
+                        return ProcessAlgorithm(algoImpl, inputTile, outputTile);
+                    }, outputTiles[column]);
+            }
+        }
+        for (size_t column = first; column < columnNum; column++) {
+            if (results[column] != VPE_ALGO_ERR_OK) {
+                VPE_LOGW("Tile(%{public}d, %{public}zu) failed at level %{public}d, try the lower levels",
+                    row, column, processedLevel);
+                auto err = ProcessTile(tiling, row, static_cast<int>(column), { input, output }, fallback,
+                    outputTiles[column]);
+                CHECK_AND_RETURN_RET_LOG(err == VPE_ALGO_ERR_OK, err, "Failed to process tile(%{public}d, %{public}zu)",
+                    row, column);
+            }
+        }
+        auto err = tiling.ComposeRow(row, outputTiles, output);
+        CHECK_AND_RETURN_RET_LOG(err == VPE_ALGO_ERR_OK, err, "Failed to compose row %{public}d", row);
+    }
+    return VPE_ALGO_ERR_OK;
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::ProcessTile(const DetailEnhancerTiling& tiling, int row, int column,
+    const std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>& image,
+    const std::function<VPEAlgoErrCode(const sptr<SurfaceBuffer>&, const sptr<SurfaceBuffer>&)>& processor,
+    sptr<SurfaceBuffer>& outputTile)
+{
+    // The input tile is dropped once it is processed, only the output tiles of the row are kept.
+    auto inputTile = tiling.CreateInputTile(image.first, row, column);
+    outputTile = tiling.CreateOutputTile(image.second, row, column);
+    CHECK_AND_RETURN_RET_LOG(inputTile != nullptr && outputTile != nullptr, VPE_ALGO_ERR_NO_MEMORY,
+        "Failed to create tile(%{public}d, %{public}d)", row, column);
+    auto err = processor(inputTile, outputTile);
+    if (err != VPE_ALGO_ERR_OK) {
+        outputTile = nullptr;
+    }
+    return err;
+}
+
+VPEAlgoErrCode DetailEnhancerImageFwk::DoProcess(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+{
+    CHECK_AND_RETURN_RET_LOG(IsValidProcessedObject(input, output), VPE_ALGO_ERR_INVALID_VAL, "Invalid input!");
+    VPE_SYNC_TRACE;
+    if (type_ == VIDEO) {
+        return ProcessVideo(input, output);
+    }
+    int processedLevel = -1;
+    auto plan = GetPlan(input, output);
+    plan.rankBucket = GetRankBucket(input);
+    return ExecutePlan(plan, input, output, processedLevel);
 }
 
 VPEAlgoErrCode DetailEnhancerImageFwk::EnableProtection(bool enable)
 {
     std::lock_guard<std::mutex> lock(lock_);
     VPEAlgoErrCode ret = VPE_ALGO_ERR_OK;
-    for (auto& [level, algo] : algorithms_) {
+    for (auto& [key, algo] : algorithms_) {
+        int level = key.first;
         if (algo == nullptr) {
             VPE_LOGW("Algorithm for level:%{pubcli}d is null!", level);
             continue;
@@ -310,9 +841,22 @@ void DetailEnhancerImageFwk::Clear()
     std::lock_guard<std::mutex> lock(lock_);
     lastAlgorithm_ = nullptr;
     algorithms_.clear();
-    if (hasParameter_) {
-        parameterUpdated = true;
+    appliedParameters_.clear();
+}
+
+void DetailEnhancerImageFwk::RecycleAlgorithms()
+{
+    std::lock_guard<std::mutex> restoreLock(restoreLock_);
+    std::lock_guard<std::mutex> lock(lock_);
+    lastAlgorithm_ = nullptr;
+    if (!needRestore_) {
+        // The algorithms which need to be restored are dropped instead of being reused by others.
+        for (auto& [key, algo] : algorithms_) {
+            GetAlgorithmPool().Release(key, std::move(algo));
+        }
     }
+    algorithms_.clear();
+    appliedParameters_.clear();
 }
 
 VPEAlgoErrCode DetailEnhancerImageFwk::ProcessAlgorithm(const std::shared_ptr<DetailEnhancerBase>& algo,
@@ -330,35 +874,29 @@ VPEAlgoErrCode DetailEnhancerImageFwk::ProcessAlgorithm(const std::shared_ptr<De
 
 int32_t DetailEnhancerCreate(int32_t* instance)
 {
-    CHECK_AND_RETURN_RET_LOG(g_externLock.try_lock_for(std::chrono::milliseconds(TIMEOUT_THRESHOLD)),
-        VPE_ALGO_ERR_INVALID_VAL, "get lock timeout");
-    if (instance == nullptr) {
-        VPE_LOGE("invalid instance");
-        g_externLock.unlock();
-        return VPE_ALGO_ERR_INVALID_VAL;
-    }
+    CHECK_AND_RETURN_RET_LOG(instance != nullptr, VPE_ALGO_ERR_INVALID_VAL, "invalid instance");
+    std::lock_guard<std::mutex> lock(g_instanceIdLock);
     if (g_instanceId != -1) {
         // if there is an instance, return it
         *instance = g_instanceId;
-        g_externLock.unlock();
         return VPE_ALGO_ERR_OK;
     }
-    auto detailEnh = DetailEnhancerImage::Create();
-    if (detailEnh == nullptr) {
-        VPE_LOGE("cannot create instance");
-        g_externLock.unlock();
-        return VPE_ALGO_ERR_INVALID_VAL;
+    int32_t ret = DetailEnhancerCreateExclusive(instance);
+    if (ret == VPE_ALGO_ERR_OK) {
+        g_instanceId = *instance;
     }
+    return ret;
+}
+
+int32_t DetailEnhancerCreateExclusive(int32_t* instance)
+{
+    CHECK_AND_RETURN_RET_LOG(instance != nullptr, VPE_ALGO_ERR_INVALID_VAL, "invalid instance");
+    auto detailEnh = DetailEnhancerImage::Create();
+    CHECK_AND_RETURN_RET_LOG(detailEnh != nullptr, VPE_ALGO_ERR_INVALID_VAL, "cannot create instance");
     Extension::ExtensionManager::InstanceVariableType instanceVar { detailEnh };
     int32_t newId = Extension::ExtensionManager::GetInstance().NewInstanceId(instanceVar);
-    if (newId == -1) {
-        VPE_LOGE("cannot create more instance");
-        g_externLock.unlock();
-        return VPE_ALGO_ERR_NO_MEMORY;
-    }
+    CHECK_AND_RETURN_RET_LOG(newId != -1, VPE_ALGO_ERR_NO_MEMORY, "cannot create more instance");
     *instance = newId;
-    g_instanceId = newId;
-    g_externLock.unlock();
     return VPE_ALGO_ERR_OK;
 }
 
@@ -374,19 +912,11 @@ sptr<SurfaceBuffer> CreateSurfaceBufFromNativeWindow(OHNativeWindowBuffer* image
 int32_t DetailEnhancerProcessImage(int32_t instance, OHNativeWindowBuffer* inputImage,
     OHNativeWindowBuffer* outputImage, int32_t level)
 {
-    CHECK_AND_RETURN_RET_LOG(g_externLock.try_lock_for(std::chrono::milliseconds(TIMEOUT_THRESHOLD)),
-        VPE_ALGO_ERR_INVALID_VAL, "get lock timeout");
-    if (inputImage == nullptr || outputImage == nullptr) {
-        VPE_LOGE("invalid parameters");
-        g_externLock.unlock();
-        return VPE_ALGO_ERR_INVALID_VAL;
-    }
+    CHECK_AND_RETURN_RET_LOG(inputImage != nullptr && outputImage != nullptr, VPE_ALGO_ERR_INVALID_VAL,
+        "invalid parameters");
+    // The copy keeps the instance alive even if it is destroyed by another thread meanwhile.
     auto someInstance = Extension::ExtensionManager::GetInstance().GetInstance(instance);
-    if (someInstance == std::nullopt) {
-        VPE_LOGE("invalid instance");
-        g_externLock.unlock();
-        return VPE_ALGO_ERR_INVALID_VAL;
-    }
+    CHECK_AND_RETURN_RET_LOG(someInstance != std::nullopt, VPE_ALGO_ERR_INVALID_VAL, "invalid instance");
     VPEAlgoErrCode ret = VPE_ALGO_ERR_INVALID_VAL;
     auto visitFunc = [inputImage, outputImage, &ret, &level](auto&& var) {
         using VarType = std::decay_t<decltype(var)>;
@@ -397,6 +927,11 @@ int32_t DetailEnhancerProcessImage(int32_t instance, OHNativeWindowBuffer* input
                 .uri = "",
                 .level = static_cast<DetailEnhancerLevel>(level),
             };
+            auto fwk = std::dynamic_pointer_cast<DetailEnhancerImageFwk>(var);
+            if (fwk != nullptr) {
+                ret = fwk->ProcessWithParameter(param, inputImageSurfaceBuffer, outputImageSurfaceBuffer);
+                return;
+            }
             var->SetParameter(param);
             ret = var->Process(inputImageSurfaceBuffer, outputImageSurfaceBuffer);
         } else {
@@ -404,15 +939,18 @@ int32_t DetailEnhancerProcessImage(int32_t instance, OHNativeWindowBuffer* input
         }
     };
     std::visit(visitFunc, *someInstance);
-    g_externLock.unlock();
     return ret;
 }
 
 int32_t DetailEnhancerDestroy(int32_t* instance)
 {
     CHECK_AND_RETURN_RET_LOG(instance != nullptr, VPE_ALGO_ERR_INVALID_VAL, "instance is null");
+    // RemoveInstanceReference resets the ID, so keep it to tell if the shared instance is destroyed.
+    int32_t id = *instance;
+    std::lock_guard<std::mutex> lock(g_instanceIdLock);
     int ret = Extension::ExtensionManager::GetInstance().RemoveInstanceReference(*instance);
-    if (ret == VPE_ALGO_ERR_OK) {
+    if (ret == VPE_ALGO_ERR_OK && id == g_instanceId) {
+        // Only the shared instance is returned by DetailEnhancerCreate, the exclusive ones are not.
         g_instanceId = -1;
     }
     return ret;
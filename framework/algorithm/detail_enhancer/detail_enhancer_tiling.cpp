@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "detail_enhancer_tiling.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "native_buffer.h"
+#include "securec.h"
+
+#include "algorithm_common.h"
+#include "vpe_log.h"
+#include "vpe_task_executor.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+using namespace HDI::Display::Graphic::Common::V1_0;
+namespace {
+constexpr uint32_t TILE_WORKER_NUM = 4;
+constexpr int OVERLAP_MARGIN = 16; // Output pixels on each side of a tile boundary, blended by both tiles
+constexpr int MIN_TILE_LENGTH = 128; // Output pixels, smaller tiles cost more to schedule than they save
+constexpr int MIN_TILE_INPUT_LENGTH = 64;
+constexpr int MAX_ALIGNED_STEP = 64; // Larger steps of exactly aligned positions make the tiles too uneven
+constexpr int TILE_SHRINK_NUMERATOR = 3;
+constexpr int TILE_SHRINK_DENOMINATOR = 4;
+constexpr int32_t STRIDE_ALIGNMENT = 32;
+constexpr int CHROMA_SUBSAMPLE = 2; // 420 halves the chroma in both directions
+constexpr int PLANE_U = 1;
+constexpr int PLANE_V = 2;
+constexpr int PLANE_NUM_YUV = 3;
+constexpr int BYTES_PER_PIXEL_RGBA = 4;
+constexpr int WEIGHT_BITS = 8;
+constexpr int WEIGHT_ONE = 1 << WEIGHT_BITS;
+
+// One plane of an 8-bit buffer. A unit is the smallest group of bytes which covers whole pixels,
+// e.g. 2 bytes of UV for 2 pixels of a NV12 chroma row.
+struct TilePlane {
+    uint8_t* addr;
+    size_t stride;
+    int bytesPerUnit;
+    int unitWidth;
+    int rowSubsample;
+};
+
+// The region of the output which one tile writes, in output pixels.
+struct ComposeRegion {
+    int left;
+    int right;
+    int blendLeft; // [blendLeft, right) is blended with the next tile of the row
+    int top;
+    int bottom;
+    int blendBottom; // [top, blendBottom) is blended with the previous row which the output holds
+};
+
+bool IsRgbFormat(int32_t format)
+{
+    return format == GRAPHIC_PIXEL_FMT_RGBA_8888 || format == GRAPHIC_PIXEL_FMT_BGRA_8888;
+}
+
+bool IsYuvFormat(int32_t format)
+{
+    return format == GRAPHIC_PIXEL_FMT_YCBCR_420_SP || format == GRAPHIC_PIXEL_FMT_YCRCB_420_SP ||
+        format == GRAPHIC_PIXEL_FMT_YCBCR_420_P || format == GRAPHIC_PIXEL_FMT_YCRCB_420_P;
+}
+
+uint64_t GetFrameBytes(int32_t format, int width, int height)
+{
+    uint64_t pixels = static_cast<uint64_t>(width) * static_cast<uint64_t>(height);
+    return IsRgbFormat(format) ? pixels * BYTES_PER_PIXEL_RGBA : pixels * 3 / 2; // 3 / 2: 420 size of 8-bit
+}
+
+// The tile buffers of a row are kept until the row is written back. Besides that, each running tile needs
+// its input copy and the intermediates of the algorithm, which are assumed to be one input and one output.
+uint64_t GetWorkingMemory(size_t columnNum, uint64_t tileInputBytes, uint64_t tileOutputBytes,
+    uint32_t workerNum)
+{
+    return columnNum * tileOutputBytes + workerNum * (tileInputBytes * 2 + tileOutputBytes); // 2: copy and algo
+}
+
+int GetMaxLength(const std::vector<DetailEnhancerTiling::Span>& spans, bool isInput)
+{
+    int maxLength = 0;
+    for (const auto& span : spans) {
+        int length = isInput ? span.inputEnd - span.inputBegin : span.outputEnd - span.outputBegin;
+        maxLength = std::max(maxLength, length);
+    }
+    return maxLength;
+}
+
+bool SplitAxis(int inputLength, int outputLength, int count, std::vector<DetailEnhancerTiling::Span>& spans)
+{
+    // The output positions which are multiples of outputStep map to the even input positions exactly,
+    // so the tiles are scaled with the same phase as the whole image.
+    int divisor = std::gcd(inputLength, outputLength);
+    int outputStep = outputLength / divisor;
+    int inputStep = inputLength / divisor;
+    if (outputStep % CHROMA_SUBSAMPLE != 0 || inputStep % CHROMA_SUBSAMPLE != 0) {
+        outputStep *= CHROMA_SUBSAMPLE;
+        inputStep *= CHROMA_SUBSAMPLE;
+    }
+    bool isAligned = outputStep <= MAX_ALIGNED_STEP;
+    if (!isAligned) {
+        outputStep = CHROMA_SUBSAMPLE;
+    }
+    auto toInput = [=](int position, bool isEnd) {
+        if (position >= outputLength) {
+            return inputLength;
+        }
+        if (isAligned) {
+            return position / outputStep * inputStep;
+        }
+        int64_t scaled = static_cast<int64_t>(position) * inputLength;
+        int64_t inputPosition = isEnd ? (scaled + outputLength - 1) / outputLength : scaled / outputLength;
+        inputPosition = isEnd ? inputPosition + inputPosition % CHROMA_SUBSAMPLE :
+            inputPosition - inputPosition % CHROMA_SUBSAMPLE;
+        return static_cast<int>(std::min<int64_t>(inputPosition, inputLength));
+    };
+    std::vector<int> boundaries = { 0 };
+    for (int i = 1; i < count; i++) {
+        int position = static_cast<int>(static_cast<int64_t>(outputLength) * i / count);
+        boundaries.push_back(position - position % outputStep);
+    }
+    boundaries.push_back(outputLength);
+    spans.clear();
+    for (int i = 0; i < count; i++) {
+        // The overlaps of both sides must not meet, otherwise a pixel is blended by three tiles.
+        if (boundaries[i + 1] - boundaries[i] < (OVERLAP_MARGIN + outputStep) * 2) { // 2: both sides
+            return false;
+        }
+        int outputBegin = 0;
+        if (i > 0) {
+            outputBegin = boundaries[i] - OVERLAP_MARGIN;
+            outputBegin -= outputBegin % outputStep;
+        }
+        int outputEnd = outputLength;
+        if (i + 1 < count) {
+            outputEnd = boundaries[i + 1] + OVERLAP_MARGIN + outputStep - 1;
+            outputEnd = std::min(outputEnd - outputEnd % outputStep, outputLength);
+        }
+        DetailEnhancerTiling::Span span = { toInput(outputBegin, false), toInput(outputEnd, true), outputBegin,
+            outputEnd };
+        if (span.inputEnd - span.inputBegin < MIN_TILE_INPUT_LENGTH) {
+            return false;
+        }
+        spans.push_back(span);
+    }
+    return true;
+}
+
+bool GetTilePlanes(const sptr<SurfaceBuffer>& buffer, std::vector<TilePlane>& planes)
+{
+    auto addr = static_cast<uint8_t*>(buffer->GetVirAddr());
+    CHECK_AND_RETURN_RET_LOG(addr != nullptr, false, "Buffer is not mapped!");
+    int32_t format = buffer->GetFormat();
+    if (IsRgbFormat(format)) {
+        planes.push_back({ addr, static_cast<size_t>(buffer->GetStride()), BYTES_PER_PIXEL_RGBA, 1, 1 });
+        return true;
+    }
+    void* planesInfoPtr = nullptr;
+    buffer->GetPlanesInfo(&planesInfoPtr);
+    auto planesInfo = static_cast<OH_NativeBuffer_Planes*>(planesInfoPtr);
+    CHECK_AND_RETURN_RET_LOG(planesInfo != nullptr && planesInfo->planeCount >= PLANE_NUM_YUV, false,
+        "Invalid planes info!");
+    const auto& info = planesInfo->planes;
+    planes.push_back({ addr + info[0].offset, info[0].columnStride, 1, 1, 1 });
+    if (format == GRAPHIC_PIXEL_FMT_YCBCR_420_SP || format == GRAPHIC_PIXEL_FMT_YCRCB_420_SP) {
+        // The interleaved plane starts at the first of U and V, which depends on NV12 or NV21.
+        planes.push_back({ addr + std::min(info[PLANE_U].offset, info[PLANE_V].offset), info[PLANE_U].columnStride,
+            CHROMA_SUBSAMPLE, CHROMA_SUBSAMPLE, CHROMA_SUBSAMPLE });
+    } else {
+        planes.push_back({ addr + info[PLANE_U].offset, info[PLANE_U].columnStride, 1, CHROMA_SUBSAMPLE,
+            CHROMA_SUBSAMPLE });
+        planes.push_back({ addr + info[PLANE_V].offset, info[PLANE_V].columnStride, 1, CHROMA_SUBSAMPLE,
+            CHROMA_SUBSAMPLE });
+    }
+    return true;
+}
+
+int CeilDiv(int value, int divisor)
+{
+    return (value + divisor - 1) / divisor;
+}
+
+sptr<SurfaceBuffer> AllocTile(const sptr<SurfaceBuffer>& buffer, int width, int height)
+{
+    auto tile = SurfaceBuffer::Create();
+    CHECK_AND_RETURN_RET_LOG(tile != nullptr, nullptr, "Failed to create tile!");
+    BufferRequestConfig requestCfg{};
+    requestCfg.width = width;
+    requestCfg.height = height;
+    requestCfg.format = buffer->GetFormat();
+    requestCfg.usage = buffer->GetUsage();
+    requestCfg.strideAlignment = STRIDE_ALIGNMENT;
+    requestCfg.timeout = 0;
+    CHECK_AND_RETURN_RET_LOG(tile->Alloc(requestCfg) == GSERROR_OK, nullptr,
+        "Failed to allocate %{public}dx%{public}d tile!", width, height);
+    // The algorithms read the color space of the buffers, the tiles keep the one of the whole image.
+    std::vector<uint8_t> colorSpaceInfo;
+    if (buffer->GetMetadata(ATTRKEY_COLORSPACE_INFO, colorSpaceInfo) == GSERROR_OK) {
+        (void)tile->SetMetadata(ATTRKEY_COLORSPACE_INFO, colorSpaceInfo);
+    }
+    return tile;
+}
+
+inline uint8_t Blend(int base, int value, int weight)
+{
+    return static_cast<uint8_t>((base * (WEIGHT_ONE - weight) + value * weight + WEIGHT_ONE / 2) >> WEIGHT_BITS);
+}
+
+// The weight of the later tile at the center of [position, position + length), it rises from 0 to WEIGHT_ONE
+// across [begin, end).
+inline int GetBlendWeight(int position, int length, int begin, int end)
+{
+    int weight = (position * 2 + length - begin * 2) * WEIGHT_ONE / ((end - begin) * 2); // 2: center of the unit
+    return std::clamp(weight, 0, WEIGHT_ONE);
+}
+
+void ComposePlane(const TilePlane& dst, const TilePlane& tile, const TilePlane* nextTile,
+    const DetailEnhancerTiling::Span& column, const DetailEnhancerTiling::Span* nextColumn,
+    const ComposeRegion& region)
+{
+    int unitWidth = tile.unitWidth;
+    int bytesPerUnit = tile.bytesPerUnit;
+    int unitBegin = region.left / unitWidth;
+    int unitEnd = CeilDiv(region.right, unitWidth);
+    int blendUnit = (nextTile != nullptr) ? region.blendLeft / unitWidth : unitEnd;
+    int tileUnitOrigin = column.outputBegin / unitWidth;
+    int nextUnitOrigin = (nextColumn != nullptr) ? nextColumn->outputBegin / unitWidth : 0;
+    int tileRowOrigin = region.top / tile.rowSubsample;
+    for (int row = tileRowOrigin; row < CeilDiv(region.bottom, tile.rowSubsample); row++) {
+        uint8_t* dstRow = dst.addr + row * dst.stride;
+        const uint8_t* tileRow = tile.addr + (row - tileRowOrigin) * tile.stride;
+        const uint8_t* nextRow = (nextTile != nullptr) ? nextTile->addr + (row - tileRowOrigin) * nextTile->stride :
+            nullptr;
+        int verticalWeight = WEIGHT_ONE;
+        if (row * tile.rowSubsample < region.blendBottom) {
+            verticalWeight = GetBlendWeight(row * tile.rowSubsample, tile.rowSubsample, region.top,
+                region.blendBottom);
+        }
+        int copyEnd = (verticalWeight == WEIGHT_ONE) ? blendUnit : unitBegin;
+        if (copyEnd > unitBegin) {
+            (void)memcpy_s(dstRow + unitBegin * bytesPerUnit, (copyEnd - unitBegin) * bytesPerUnit,
+                tileRow + (unitBegin - tileUnitOrigin) * bytesPerUnit, (copyEnd - unitBegin) * bytesPerUnit);
+        }
+        for (int unit = copyEnd; unit < unitEnd; unit++) {
+            int horizontalWeight = 0;
+            if (unit >= blendUnit) {
+                horizontalWeight = GetBlendWeight(unit * unitWidth, unitWidth, region.blendLeft, region.right);
+            }
+            for (int i = 0; i < bytesPerUnit; i++) {
+                int value = tileRow[(unit - tileUnitOrigin) * bytesPerUnit + i];
+                if (horizontalWeight > 0) {
+                    value = Blend(value, nextRow[(unit - nextUnitOrigin) * bytesPerUnit + i], horizontalWeight);
+                }
+                if (verticalWeight < WEIGHT_ONE) {
+                    value = Blend(dstRow[unit * bytesPerUnit + i], value, verticalWeight);
+                }
+                dstRow[unit * bytesPerUnit + i] = static_cast<uint8_t>(value);
+            }
+        }
+    }
+}
+
+void CopyToTile(const std::vector<TilePlane>& src, const std::vector<TilePlane>& dst, int left, int top,
+    int width, int height)
+{
+    for (size_t i = 0; i < src.size(); i++) {
+        const auto& plane = src[i];
+        int unitBegin = left / plane.unitWidth;
+        size_t rowBytes = static_cast<size_t>(CeilDiv(left + width, plane.unitWidth) - unitBegin) *
+            plane.bytesPerUnit;
+        int rowBegin = top / plane.rowSubsample;
+        int rowEnd = CeilDiv(top + height, plane.rowSubsample);
+        for (int row = rowBegin; row < rowEnd; row++) {
+            (void)memcpy_s(dst[i].addr + (row - rowBegin) * dst[i].stride, rowBytes,
+                plane.addr + row * plane.stride + unitBegin * plane.bytesPerUnit, rowBytes);
+        }
+    }
+}
+} // namespace
+
+bool DetailEnhancerTiling::IsSupported(int32_t inputFormat, int32_t outputFormat)
+{
+    return inputFormat == outputFormat && (IsRgbFormat(inputFormat) || IsYuvFormat(inputFormat));
+}
+
+bool DetailEnhancerTiling::Plan(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output,
+    uint64_t memoryBudget)
+{
+    rows_.clear();
+    columns_.clear();
+    workerNum_ = 1;
+    // The later rows read the input after the earlier rows are written, so processing in place is not split.
+    if (memoryBudget == 0 || !IsSupported(input->GetFormat(), output->GetFormat()) ||
+        input->GetVirAddr() == output->GetVirAddr()) {
+        return false;
+    }
+    int32_t format = output->GetFormat();
+    int inputWidth = input->GetWidth();
+    int inputHeight = input->GetHeight();
+    int outputWidth = output->GetWidth();
+    int outputHeight = output->GetHeight();
+    // As a whole, the algorithm is assumed to need one more input and output.
+    if (GetFrameBytes(format, inputWidth, inputHeight) + GetFrameBytes(format, outputWidth, outputHeight) <=
+        memoryBudget) {
+        return false;
+    }
+    uint64_t workingMemory = 0;
+    std::vector<Span> rows;
+    std::vector<Span> columns;
+    for (int length = std::max(outputWidth, outputHeight) * TILE_SHRINK_NUMERATOR / TILE_SHRINK_DENOMINATOR;
+        length >= MIN_TILE_LENGTH; length = length * TILE_SHRINK_NUMERATOR / TILE_SHRINK_DENOMINATOR) {
+        if (!SplitAxis(inputWidth, outputWidth, CeilDiv(outputWidth, length), columns) ||
+            !SplitAxis(inputHeight, outputHeight, CeilDiv(outputHeight, length), rows)) {
+            break;
+        }
+        rows_ = rows;
+        columns_ = columns;
+        workingMemory = GetWorkingMemory(columns_.size(),
+            GetFrameBytes(format, GetMaxLength(columns_, true), GetMaxLength(rows_, true)),
+            GetFrameBytes(format, GetMaxLength(columns_, false), GetMaxLength(rows_, false)), 1);
+        if (workingMemory <= memoryBudget) {
+            break;
+        }
+    }
+    if (columns_.empty()) {
+        VPE_LOGW("%{public}dx%{public}d->%{public}dx%{public}d is too small to split", inputWidth, inputHeight,
+            outputWidth, outputHeight);
+        return false;
+    }
+    uint64_t tileInputBytes = GetFrameBytes(format, GetMaxLength(columns_, true), GetMaxLength(rows_, true));
+    uint64_t tileOutputBytes = GetFrameBytes(format, GetMaxLength(columns_, false), GetMaxLength(rows_, false));
+    if (workingMemory > memoryBudget) {
+        VPE_LOGW("The smallest tiles need %{public}llu bytes, more than the budget %{public}llu",
+            static_cast<unsigned long long>(workingMemory), static_cast<unsigned long long>(memoryBudget));
+    }
+    while (workerNum_ < TILE_WORKER_NUM && workerNum_ < columns_.size() &&
+        GetWorkingMemory(columns_.size(), tileInputBytes, tileOutputBytes, workerNum_ + 1) <= memoryBudget) {
+        workerNum_++;
+    }
+    VPE_LOGI("Split %{public}dx%{public}d->%{public}dx%{public}d into %{public}zux%{public}zu tiles by %{public}u",
+        inputWidth, inputHeight, outputWidth, outputHeight, columns_.size(), rows_.size(), workerNum_);
+    return true;
+}
+
+int DetailEnhancerTiling::GetRowNum() const
+{
+    return static_cast<int>(rows_.size());
+}
+
+int DetailEnhancerTiling::GetColumnNum() const
+{
+    return static_cast<int>(columns_.size());
+}
+
+uint32_t DetailEnhancerTiling::GetWorkerNum() const
+{
+    return workerNum_;
+}
+
+sptr<SurfaceBuffer> DetailEnhancerTiling::CreateInputTile(const sptr<SurfaceBuffer>& input, int row,
+    int column) const
+{
+    CHECK_AND_RETURN_RET_LOG(row >= 0 && row < GetRowNum() && column >= 0 && column < GetColumnNum(), nullptr,
+        "Invalid tile(%{public}d, %{public}d)", row, column);
+    const auto& rowSpan = rows_[row];
+    const auto& columnSpan = columns_[column];
+    int width = columnSpan.inputEnd - columnSpan.inputBegin;
+    int height = rowSpan.inputEnd - rowSpan.inputBegin;
+    auto tile = AllocTile(input, width, height);
+    CHECK_AND_RETURN_RET_LOG(tile != nullptr, nullptr, "Failed to create input tile!");
+    std::vector<TilePlane> inputPlanes;
+    std::vector<TilePlane> tilePlanes;
+    CHECK_AND_RETURN_RET_LOG(GetTilePlanes(input, inputPlanes) && GetTilePlanes(tile, tilePlanes) &&
+        inputPlanes.size() == tilePlanes.size(), nullptr, "Invalid planes of input tile!");
+    CopyToTile(inputPlanes, tilePlanes, columnSpan.inputBegin, rowSpan.inputBegin, width, height);
+    return tile;
+}
+
+sptr<SurfaceBuffer> DetailEnhancerTiling::CreateOutputTile(const sptr<SurfaceBuffer>& output, int row,
+    int column) const
+{
+    CHECK_AND_RETURN_RET_LOG(row >= 0 && row < GetRowNum() && column >= 0 && column < GetColumnNum(), nullptr,
+        "Invalid tile(%{public}d, %{public}d)", row, column);
+    return AllocTile(output, columns_[column].outputEnd - columns_[column].outputBegin,
+        rows_[row].outputEnd - rows_[row].outputBegin);
+}
+
+VPEAlgoErrCode DetailEnhancerTiling::ComposeRow(int row, const std::vector<sptr<SurfaceBuffer>>& tiles,
+    const sptr<SurfaceBuffer>& output) const
+{
+    CHECK_AND_RETURN_RET_LOG(row >= 0 && row < GetRowNum() && tiles.size() == columns_.size(),
+        VPE_ALGO_ERR_INVALID_VAL, "Invalid row:%{public}d of %{public}zu tiles", row, tiles.size());
+    std::vector<TilePlane> outputPlanes;
+    CHECK_AND_RETURN_RET_LOG(GetTilePlanes(output, outputPlanes), VPE_ALGO_ERR_INVALID_VAL, "Invalid output!");
+    std::vector<std::vector<TilePlane>> tilePlanes(tiles.size());
+    for (size_t i = 0; i < tiles.size(); i++) {
+        CHECK_AND_RETURN_RET_LOG(tiles[i] != nullptr && GetTilePlanes(tiles[i], tilePlanes[i]) &&
+            tilePlanes[i].size() == outputPlanes.size(), VPE_ALGO_ERR_INVALID_VAL, "Invalid tile %{public}zu", i);
+    }
+    const auto& rowSpan = rows_[row];
+    // The tiles write different columns, the overlap of two tiles is written by the left one.
+    VpeTaskExecutor::GetInstance().ParallelFor(tiles.size(), workerNum_,
+        [this, row, &rowSpan, &outputPlanes, &tilePlanes](size_t column) {
+        bool hasNext = column + 1 < columns_.size();
+        ComposeRegion region = {
+            .left = (column > 0) ? columns_[column - 1].outputEnd : 0,
+            .right = columns_[column].outputEnd,
+            .blendLeft = hasNext ? columns_[column + 1].outputBegin : columns_[column].outputEnd,
+            .top = rowSpan.outputBegin,
+            .bottom = rowSpan.outputEnd,
+            .blendBottom = (row > 0) ? rows_[row - 1].outputEnd : rowSpan.outputBegin,
+        };
+        for (size_t plane = 0; plane < outputPlanes.size(); plane++) {
+            ComposePlane(outputPlanes[plane], tilePlanes[column][plane],
+                hasNext ? &tilePlanes[column + 1][plane] : nullptr, columns_[column],
+                hasNext ? &columns_[column + 1] : nullptr, region);
+        }
+    });
+    return VPE_ALGO_ERR_OK;
+}
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DETAIL_ENHANCER_CIRCUIT_BREAKER_H
+#define DETAIL_ENHANCER_CIRCUIT_BREAKER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "algorithm_errors.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Skip the levels which keep failing for a resolution, so the images do not pay for the failed attempts
+ * before the fallback. Each DetailEnhancerImageFwk has its own, so the failures of one caller, e.g. with
+ * a protected buffer, do not make the other callers skip the level.
+ *
+ * A level is skipped for a cool-down after FAILURE_THRESHOLD consecutive failures. Then one image tries it
+ * again, a success closes the breaker and a failure skips the level for twice as long, up to the maximum.
+ */
+class LevelCircuitBreaker {
+public:
+    static constexpr int FAILURE_THRESHOLD = 3; // Consecutive failures which open the breaker of a level
+
+    explicit LevelCircuitBreaker(std::chrono::steady_clock::duration initialCoolDown = std::chrono::seconds(10),
+        std::chrono::steady_clock::duration maxCoolDown = std::chrono::seconds(300));
+
+    // Return false if the level should be skipped. If it returns true, Report must be called with the result.
+    bool IsAllowed(int level, uint32_t bucket);
+    void Report(int level, uint32_t bucket, VPEAlgoErrCode err);
+
+private:
+    struct State {
+        int failureNum{};
+        std::chrono::steady_clock::duration coolDown{};
+        std::chrono::steady_clock::time_point openUntil{};
+        bool isProbing{};
+    };
+
+    const std::chrono::steady_clock::duration initialCoolDown_;
+    const std::chrono::steady_clock::duration maxCoolDown_;
+    std::mutex lock_{};
+    std::map<std::pair<int, uint32_t>, State> states_{}; // Guarded by lock_
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // DETAIL_ENHANCER_CIRCUIT_BREAKER_H
@@ -16,10 +16,17 @@
 #ifndef DETAIL_ENHANCER_IMAGE_FWK_H
 #define DETAIL_ENHANCER_IMAGE_FWK_H
 
+#include <functional>
+#include <map>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "detail_enhancer_image.h"
 #include "detail_enhancer_base.h"
+#include "detail_enhancer_circuit_breaker.h"
+#include "detail_enhancer_tiling.h"
 
 namespace OHOS {
 namespace Media {
@@ -38,30 +45,83 @@ public:
     VPEAlgoErrCode Process(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output) override;
     VPEAlgoErrCode EnableProtection(bool enable) final;
     VPEAlgoErrCode ResetProtectionStatus() final;
+    VPEAlgoErrCode ProcessBatch(const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>>& images,
+        std::vector<VPEAlgoErrCode>& results) override;
+    // Set the parameter and process as one step, so the callers which share the instance keep their own level.
+    VPEAlgoErrCode ProcessWithParameter(const DetailEnhancerParameters& parameter, const sptr<SurfaceBuffer>& input,
+        const sptr<SurfaceBuffer>& output);
 
 private:
-    std::shared_ptr<DetailEnhancerBase> GetAlgorithm(int feature);
-    std::shared_ptr<DetailEnhancerBase> CreateAlgorithm(int feature);
+    // (level, resolution bucket), the calibrated ranks may pick another extension for another resolution.
+    using AlgorithmKey = std::pair<int, uint32_t>;
+
+    // What DoProcess does for a shape, decided before any algorithm runs.
+    struct ProcessPlan {
+        DetailEnhancerParameters parameter{};
+        int targetLevel{DETAIL_ENH_LEVEL_NONE};
+        // The resolution bucket of the whole image, set on each run since the ranks may be loaded meanwhile.
+        uint32_t rankBucket{0};
+        bool isPassthrough{false};
+        // The image is larger than the memory budget, so it is processed tile by tile.
+        bool isTiled{false};
+        DetailEnhancerTiling tiling{};
+    };
+
+    // (input width, height, format, output width, height, format, level)
+    using PlanKey = std::tuple<int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int>;
+
+    std::shared_ptr<DetailEnhancerBase> GetAlgorithm(int feature, uint32_t rankBucket);
+    std::shared_ptr<DetailEnhancerBase> CreateAlgorithm(int feature, uint32_t rankBucket);
+    uint32_t GetRankBucket(const sptr<SurfaceBuffer>& input) const;
     bool IsValidProcessedObject(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output);
     int EvaluateTargetLevel(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output,
-        float widthRatio, float heightRatio) const;
+        float widthRatio, float heightRatio, int level) const;
+    VPEAlgoErrCode ProcessLocked(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output);
+    VPEAlgoErrCode RetryIfRestorable(VPEAlgoErrCode err, const sptr<SurfaceBuffer>& input,
+        const sptr<SurfaceBuffer>& output);
+    ProcessPlan MakePlan(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output);
+    // Return the cached plan of the shape if the parameter is not changed since it was made.
+    ProcessPlan GetPlan(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output);
+    // Set the parameter to the algorithm of the level only if it differs from the one set last time.
+    VPEAlgoErrCode ApplyParameter(const AlgorithmKey& key, const std::shared_ptr<DetailEnhancerBase>& algorithm,
+        const DetailEnhancerParameters& parameter);
+    // processedLevel is the level which succeeded, -1 if none or the input is copied.
+    VPEAlgoErrCode ExecutePlan(const ProcessPlan& plan, const sptr<SurfaceBuffer>& input,
+        const sptr<SurfaceBuffer>& output, int& processedLevel);
+    VPEAlgoErrCode ExecuteTiledPlan(const ProcessPlan& plan, const sptr<SurfaceBuffer>& input,
+        const sptr<SurfaceBuffer>& output, int& processedLevel);
+    VPEAlgoErrCode ProcessTile(const DetailEnhancerTiling& tiling, int row, int column,
+        const std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>& image,
+        const std::function<VPEAlgoErrCode(const sptr<SurfaceBuffer>&, const sptr<SurfaceBuffer>&)>& processor,
+        sptr<SurfaceBuffer>& outputTile);
+    void ProcessBatchGroup(const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>>& images,
+        const std::vector<size_t>& indexes, std::vector<VPEAlgoErrCode>& results);
+    VPEAlgoErrCode ProcessByPooledAlgorithm(const AlgorithmKey& key, const DetailEnhancerParameters& parameter,
+        const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output);
     VPEAlgoErrCode DoProcess(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output);
     VPEAlgoErrCode ProcessVideo(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output);
     void UpdateLastAlgorithm(const std::shared_ptr<DetailEnhancerBase>& algorithm);
     void Clear();
+    void RecycleAlgorithms();
     VPEAlgoErrCode ProcessAlgorithm(const std::shared_ptr<DetailEnhancerBase>& algo, const sptr<SurfaceBuffer>& input,
         const sptr<SurfaceBuffer>& output);
 
+    // Serialize the processing of this instance, the callers wait instead of failing. The instances run
+    // concurrently since they share nothing but the thread-safe algorithm pool.
+    std::mutex processLock_{};
     DetailEnhancerParameters parameter_{};
     mutable std::mutex lock_{};
-    std::unordered_map<int, std::shared_ptr<DetailEnhancerBase>> algorithms_{};
+    std::map<AlgorithmKey, std::shared_ptr<DetailEnhancerBase>> algorithms_{};
     std::shared_ptr<DetailEnhancerBase> lastAlgorithm_{};
+    // Guarded by lock_, the most recently used plan is at the back.
+    std::vector<std::pair<PlanKey, ProcessPlan>> plans_{};
+    std::map<AlgorithmKey, DetailEnhancerParameters> appliedParameters_{}; // Guarded by lock_
     int type_;
-    std::atomic<bool> parameterUpdated{};
     bool hasParameter_{};
     bool enableProtection_{};
     mutable std::mutex restoreLock_{};
     bool needRestore_{}; // Guarded by restoreLock_
+    LevelCircuitBreaker circuitBreaker_{};
 };
 } // namespace VideoProcessingEngine
 } // namespace Media
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DETAIL_ENHANCER_TILING_H
+#define DETAIL_ENHANCER_TILING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "surface_buffer.h"
+
+#include "algorithm_errors.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+/**
+ * Split of a large image into overlapping tiles, so the algorithm works on one tile at a time and the
+ * working memory of a Process stays under a budget.
+ *
+ * The neighbouring tiles overlap in the output, the overlap is blended linearly when the tiles are written
+ * back, which hides the seams. The rows of tiles are written back one by one, so only the processed tiles
+ * of one row are kept at a time. The tile boundaries are snapped to the positions where the input and the
+ * output pixels line up, if the scaling ratio allows it within a reasonable step.
+ */
+class DetailEnhancerTiling {
+public:
+    // One axis of a tile, [begin, end) in the input and in the output.
+    struct Span {
+        int inputBegin;
+        int inputEnd;
+        int outputBegin;
+        int outputEnd;
+    };
+
+    // Return true if the tiles of the formats can be copied and blended, the 8-bit RGBA and YUV420 formats.
+    static bool IsSupported(int32_t inputFormat, int32_t outputFormat);
+
+    // Split the image if processing it at once needs more than memoryBudget bytes. Return false if it does
+    // not need to be split, or it can not be split. The smallest tiles are used if none fits the budget.
+    bool Plan(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output, uint64_t memoryBudget);
+    int GetRowNum() const;
+    int GetColumnNum() const;
+    // The number of tiles which fit the budget at the same time.
+    uint32_t GetWorkerNum() const;
+    // Allocate a buffer and copy the input region of the tile to it.
+    sptr<SurfaceBuffer> CreateInputTile(const sptr<SurfaceBuffer>& input, int row, int column) const;
+    // Allocate a buffer for the output region of the tile.
+    sptr<SurfaceBuffer> CreateOutputTile(const sptr<SurfaceBuffer>& output, int row, int column) const;
+    // Write the processed tiles of a row to the output and blend the overlaps. The rows must be written in
+    // order, since the overlap with the previous row is blended with what the output already holds.
+    VPEAlgoErrCode ComposeRow(int row, const std::vector<sptr<SurfaceBuffer>>& tiles,
+        const sptr<SurfaceBuffer>& output) const;
+
+private:
+    std::vector<Span> rows_{};
+    std::vector<Span> columns_{};
+    uint32_t workerNum_{1};
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // DETAIL_ENHANCER_TILING_H
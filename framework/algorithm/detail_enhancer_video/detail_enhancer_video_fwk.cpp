@@ -54,21 +54,29 @@ VPEAlgoErrCode DetailEnhancerVideoFwk::SetParameter(const Format& parameter)
 
     CHECK_AND_RETURN_RET_LOG(IsInitialized(), VPE_ALGO_ERR_INVALID_OPERATION, "NOT initialized!");
 
-    std::lock_guard<std::mutex> lock(lock_);
-    int setCount = 0;
-    for (auto& setter : setters) {
-        int err = setter(parameter);
-        if (err == PARAM_ERR_INVALID) {
-            return VPE_ALGO_ERR_INVALID_VAL;
+    // The common parameters are applied only after the others are set, so none of them is changed on failure.
+    int setCount = CheckCommonParameter(parameter);
+    if (setCount < 0) {
+        return VPE_ALGO_ERR_INVALID_VAL;
+    }
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        for (auto& setter : setters) {
+            int err = setter(parameter);
+            if (err == PARAM_ERR_INVALID) {
+                return VPE_ALGO_ERR_INVALID_VAL;
+            }
+            setCount += err;
         }
-        setCount += err;
     }
     CHECK_AND_RETURN_RET_LOG(setCount > 0, VPE_ALGO_ERR_INVALID_VAL, "Invalid input: NO valid parameters!");
+    SetCommonParameter(parameter);
     return VPE_ALGO_ERR_OK;
 }
 
-VPEAlgoErrCode DetailEnhancerVideoFwk::GetParameter([[maybe_unused]] Format& parameter)
+VPEAlgoErrCode DetailEnhancerVideoFwk::GetParameter(Format& parameter)
 {
+    GetCommonParameter(parameter);
     return VPE_ALGO_ERR_OK;
 }
 
@@ -14,30 +14,85 @@
  */
 
 #include "extension_manager.h"
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <dlfcn.h>
 #include <functional>
+#include <future>
 #include <string>
 #include <unordered_map>
+#include "securec.h"
 #include "static_extension_list.h"
 #include "vpe_log.h"
 #include "extension_base.h"
 namespace {
     using LibFunctionGetRegisters = std::unordered_map<std::string,
         OHOS::Media::VideoProcessingEngine::Extension::RegisterExtensionFunc>* (*)();
-    LibFunctionGetRegisters GetRegisterExtensionFuncs{nullptr};
-    LibFunctionGetRegisters GetRegisterMetdataGenExtensionFuncs{nullptr};
-    LibFunctionGetRegisters GetRegisterComposeExtensionFuncs{nullptr};
-    LibFunctionGetRegisters GetRegisterDecomposeExtensionFuncs{nullptr};
     using LibFunctionGetRegisterFunction = OHOS::Media::VideoProcessingEngine::Extension::RegisterExtensionFunc (*)();
     LibFunctionGetRegisterFunction GetRegisterVRRExtensionFuncs{nullptr};
     void* g_algoHandle{nullptr};
+    constexpr const char* ALGO_LIBRARY_NAME = "libvideoprocessingengine_ext.z.so";
+    constexpr const char* LOAD_PHASE_NAMES[] = {
+        "dlopen", "static", "dynamic", "compose", "decompose", "metadataGen", "vrr", "buildCaps",
+    };
+    constexpr size_t CALIBRATION_RUNS = 3;
+    constexpr uint8_t SYNTHETIC_FRAME_VALUE = 0x80;
 } // namespace
 
 namespace OHOS {
 namespace Media {
 namespace VideoProcessingEngine {
 namespace Extension {
+namespace {
+std::string DetailEnhancerRankKey(uint32_t level)
+{
+    return "DetailEnhancer/level=" + std::to_string(level);
+}
+
+std::string AihdrEnhancerRankKey(const ColorSpaceDescription& colorSpace, GraphicPixelFormat pixelFormat)
+{
+    return "AihdrEnhancer/colorSpace=" + std::to_string(GetColorSpaceType(colorSpace.colorSpaceInfo)) +
+        ",metadata=" + std::to_string(colorSpace.metadataType) + ",format=" + std::to_string(pixelFormat);
+}
+
+sptr<SurfaceBuffer> CreateSyntheticFrame(uint32_t width, uint32_t height, GraphicPixelFormat format)
+{
+    auto buffer = SurfaceBuffer::Create();
+    CHECK_AND_RETURN_RET_LOG(buffer != nullptr, nullptr, "Create surface buffer failed");
+    BufferRequestConfig requestCfg {};
+    requestCfg.width = static_cast<int32_t>(width);
+    requestCfg.height = static_cast<int32_t>(height);
+    requestCfg.format = format;
+    requestCfg.usage = BUFFER_USAGE_CPU_READ | BUFFER_USAGE_CPU_WRITE | BUFFER_USAGE_MEM_DMA;
+    requestCfg.strideAlignment = 32; // 32: stride alignment
+    requestCfg.timeout = 0;
+    CHECK_AND_RETURN_RET_LOG(buffer->Alloc(requestCfg) == GSERROR_OK, nullptr,
+        "Alloc %{public}ux%{public}u format:%{public}d failed", width, height, format);
+    // The content does not change the cost of the extensions, a gray frame avoids any fast path of black frames.
+    if (buffer->GetVirAddr() != nullptr) {
+        (void)memset_s(buffer->GetVirAddr(), buffer->GetSize(), SYNTHETIC_FRAME_VALUE, buffer->GetSize());
+    }
+    return buffer;
+}
+
+// Return the median latency in microseconds of the process after a warm-up run, nullopt if any run fails.
+template<typename ProcessFunc>
+std::optional<int64_t> MeasureLatency(ProcessFunc&& process)
+{
+    CHECK_AND_RETURN_RET_LOG(process() == VPE_ALGO_ERR_OK, std::nullopt, "Warm up failed");
+    std::array<int64_t, CALIBRATION_RUNS> latencies {};
+    for (auto& latency : latencies) {
+        auto startTime = std::chrono::steady_clock::now();
+        CHECK_AND_RETURN_RET_LOG(process() == VPE_ALGO_ERR_OK, std::nullopt, "Process failed");
+        latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime).count();
+    }
+    auto median = latencies.begin() + CALIBRATION_RUNS / 2;
+    std::nth_element(latencies.begin(), median, latencies.end());
+    return *median;
+}
+} // namespace
 
 ExtensionManager& ExtensionManager::GetInstance()
 {
@@ -48,18 +103,13 @@ ExtensionManager& ExtensionManager::GetInstance()
 ExtensionManager::ExtensionManager()
 {
     (void)Init();
-    g_algoHandle = dlopen("libvideoprocessingengine_ext.z.so", RTLD_NOW);
-    if (g_algoHandle == nullptr) {
-        VPE_LOGE("dlopen libvideoprocessingengine_ext failed %{public}s", dlerror());
-    }
 }
 
 ExtensionManager::~ExtensionManager()
 {
-    if (g_algoHandle != nullptr) {
-        dlclose(g_algoHandle);
-        g_algoHandle = nullptr;
-    }
+    std::lock_guard<std::mutex> indexLock(extensionIndexMtx_);
+    ReleaseExtensionIndexesLocked(false);
+    UnloadLibrary();
 }
 
 VPEAlgoErrCode ExtensionManager::Init()
@@ -73,10 +123,8 @@ VPEAlgoErrCode ExtensionManager::Init()
 
 void ExtensionManager::IncreaseInstance()
 {
+    // The dynamic library is loaded on the first use of the dynamic extensions instead of here.
     std::lock_guard<std::mutex> lock(instanceCountMtx_);
-    if (usedInstance_ == 0 && g_algoHandle == nullptr) {
-        g_algoHandle = dlopen("libvideoprocessingengine_ext.z.so", RTLD_NOW);
-    }
     usedInstance_++;
 }
 
@@ -84,12 +132,218 @@ void ExtensionManager::DecreaseInstance()
 {
     std::lock_guard<std::mutex> lock(instanceCountMtx_);
     usedInstance_--;
-    if ((usedInstance_ == 0) && (g_algoHandle != nullptr)) {
+    if ((usedInstance_ == 0) && IsLibraryLoaded()) {
+        // The extensions are created by the dynamic library, so they must be released before it is unloaded.
+        std::lock_guard<std::mutex> indexLock(extensionIndexMtx_);
+        ReleaseExtensionIndexesLocked(true);
+        isLibraryInUse_ = false;
+        UnloadLibrary();
+    }
+}
+
+int64_t ExtensionManager::GetLoadTime(ExtensionLoadPhase phase) const
+{
+    CHECK_AND_RETURN_RET_LOG(phase < ExtensionLoadPhase::NUM, -1, "Invalid load phase:%{public}zu",
+        static_cast<size_t>(phase));
+    return loadTimeUs_[static_cast<size_t>(phase)].load();
+}
+
+void ExtensionManager::RecordLoadTime(ExtensionLoadPhase phase,
+    const std::chrono::steady_clock::time_point& startTime) const
+{
+    auto loadTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    loadTimeUs_[static_cast<size_t>(phase)] = loadTime;
+    VPE_LOGI("Load phase %{public}s took %{public}lld us", LOAD_PHASE_NAMES[static_cast<size_t>(phase)],
+        static_cast<long long>(loadTime));
+}
+
+void* ExtensionManager::LoadLibrary() const
+{
+    std::lock_guard<std::mutex> lock(libraryMtx_);
+    if (g_algoHandle != nullptr) {
+        return g_algoHandle;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    g_algoHandle = dlopen(ALGO_LIBRARY_NAME, RTLD_NOW);
+    CHECK_AND_RETURN_RET_LOG(g_algoHandle != nullptr, nullptr, "dlopen %{public}s failed %{public}s",
+        ALGO_LIBRARY_NAME, dlerror());
+    isLibraryLoaded_ = true;
+    RecordLoadTime(ExtensionLoadPhase::DLOPEN, startTime);
+    return g_algoHandle;
+}
+
+void ExtensionManager::UnloadLibrary() const
+{
+    std::lock_guard<std::mutex> lock(libraryMtx_);
+    if (g_algoHandle != nullptr) {
+        isLibraryLoaded_ = false;
         dlclose(g_algoHandle);
         g_algoHandle = nullptr;
     }
 }
 
+bool ExtensionManager::IsLibraryLoaded() const
+{
+    return isLibraryLoaded_.load();
+}
+
+VPEAlgoErrCode ExtensionManager::CalibrateExtensionRanks(const std::string& path)
+{
+    CHECK_AND_RETURN_RET_LOG(initialized_ == true, VPE_ALGO_ERR_INVALID_STATE, "Not initialized");
+    // Keep the dynamic library loaded while its extensions are measured.
+    IncreaseInstance();
+    auto index = GetExtensionIndex(ExtensionSet::ALL, true);
+    if (index == nullptr || index->extensionList.empty()) {
+        index = nullptr;
+        DecreaseInstance();
+        VPE_LOGE("No extension found");
+        return VPE_ALGO_ERR_EXTENSION_NOT_FOUND;
+    }
+    auto calibration = std::make_shared<ExtensionRankCalibration>();
+    auto startTime = std::chrono::steady_clock::now();
+    CalibrateDetailEnhancers(*index, *calibration);
+    CalibrateAihdrEnhancers(*index, *calibration);
+    VPE_LOGI("Calibrate extension ranks took %{public}lld ms", static_cast<long long>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count()));
+    // The extensions must be released before the library may be unloaded.
+    index = nullptr;
+    DecreaseInstance();
+    std::atomic_store(&rankCalibration_, std::shared_ptr<const ExtensionRankCalibration>(calibration));
+    NotifyRankChange();
+    return calibration->Save(path);
+}
+
+VPEAlgoErrCode ExtensionManager::LoadExtensionRanks(const std::string& path)
+{
+    auto calibration = std::make_shared<ExtensionRankCalibration>();
+    VPEAlgoErrCode ret = calibration->Load(path);
+    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, ret, "Load extension ranks failed");
+    std::atomic_store(&rankCalibration_, std::shared_ptr<const ExtensionRankCalibration>(calibration));
+    NotifyRankChange();
+    return VPE_ALGO_ERR_OK;
+}
+
+uint32_t ExtensionManager::GetRankBucket(uint32_t width, uint32_t height) const
+{
+    auto calibration = std::atomic_load(&rankCalibration_);
+    if (calibration == nullptr || calibration->IsEmpty()) {
+        return ExtensionRankCalibration::RESOLUTION_BUCKET_ANY;
+    }
+    return ExtensionRankCalibration::GetResolutionBucket(width, height);
+}
+
+int32_t ExtensionManager::AddRankChangeListener(const std::function<void()>& listener)
+{
+    std::lock_guard<std::mutex> lock(rankListenerMtx_);
+    int32_t id = nextRankListenerId_++;
+    rankListeners_[id] = listener;
+    return id;
+}
+
+void ExtensionManager::RemoveRankChangeListener(int32_t id)
+{
+    std::lock_guard<std::mutex> lock(rankListenerMtx_);
+    rankListeners_.erase(id);
+}
+
+void ExtensionManager::NotifyRankChange() const
+{
+    std::vector<std::function<void()>> listeners;
+    {
+        std::lock_guard<std::mutex> lock(rankListenerMtx_);
+        for (const auto& [id, listener] : rankListeners_) {
+            listeners.push_back(listener);
+        }
+    }
+    // Out of the lock, since the listeners may release the instances and the reference of the manager.
+    for (const auto& listener : listeners) {
+        if (listener != nullptr) {
+            listener();
+        }
+    }
+}
+
+void ExtensionManager::CalibrateDetailEnhancers(const ExtensionIndex& index,
+    ExtensionRankCalibration& calibration) const
+{
+    for (const auto& [level, candidates] : index.detailEnhancerCaps) {
+        if (candidates.size() < 2) { // 2: nothing to choose from a single candidate
+            continue;
+        }
+        auto capabilityKey = DetailEnhancerRankKey(level);
+        for (uint32_t bucket = 0; bucket < ExtensionRankCalibration::RESOLUTION_BUCKETS.size(); bucket++) {
+            const auto& [width, height] = ExtensionRankCalibration::RESOLUTION_BUCKETS[bucket];
+            // Downscale by half, which is the common use of the detail enhancer.
+            auto input = CreateSyntheticFrame(width, height, GRAPHIC_PIXEL_FMT_RGBA_8888);
+            auto output = CreateSyntheticFrame(width / 2, height / 2, GRAPHIC_PIXEL_FMT_RGBA_8888); // 2: half
+            CHECK_AND_RETURN_LOG(input != nullptr && output != nullptr, "Create synthetic frames failed");
+            for (const auto& candidate : candidates) {
+                auto extension =
+                    std::static_pointer_cast<DetailEnhancerExtension>(index.extensionList[std::get<2>(candidate)]);
+                auto impl = extension->creator();
+                CHECK_AND_CONTINUE_LOG(impl != nullptr && impl->Init() == VPE_ALGO_ERR_OK,
+                    "Init %{public}s failed", extension->info.name.c_str());
+                DetailEnhancerParameters parameter {};
+                parameter.level = static_cast<DetailEnhancerLevel>(level);
+                parameter.contentId = 0;
+                auto latency = impl->SetParameter(parameter) == VPE_ALGO_ERR_OK ?
+                    MeasureLatency([&impl, &input, &output]() { return impl->Process(input, output); }) :
+                    std::nullopt;
+                impl->Deinit();
+                CHECK_AND_CONTINUE_LOG(latency.has_value(), "%{public}s does not qualify for level %{public}u "
+                    "bucket %{public}u", extension->info.name.c_str(), level, bucket);
+                calibration.Record(capabilityKey, bucket, extension->info.name, *latency);
+            }
+        }
+    }
+}
+
+void ExtensionManager::CalibrateAihdrEnhancers(const ExtensionIndex& index,
+    ExtensionRankCalibration& calibration) const
+{
+    for (const auto& [key, candidates] : index.aihdrEnhancerCaps) {
+        if (candidates.size() < 2) { // 2: nothing to choose from a single candidate
+            continue;
+        }
+        const auto& [colorSpace, pixelFormat] = key;
+        auto capabilityKey = AihdrEnhancerRankKey(colorSpace, pixelFormat);
+        for (uint32_t bucket = 0; bucket < ExtensionRankCalibration::RESOLUTION_BUCKETS.size(); bucket++) {
+            const auto& [width, height] = ExtensionRankCalibration::RESOLUTION_BUCKETS[bucket];
+            auto input = CreateSyntheticFrame(width, height, pixelFormat);
+            CHECK_AND_CONTINUE_LOG(input != nullptr, "Create synthetic frame failed");
+            for (const auto& candidate : candidates) {
+                auto extension =
+                    std::static_pointer_cast<AihdrEnhancerExtension>(index.extensionList[std::get<2>(candidate)]);
+                auto impl = extension->creator();
+                CHECK_AND_CONTINUE_LOG(impl != nullptr && impl->Init() == VPE_ALGO_ERR_OK,
+                    "Init %{public}s failed", extension->info.name.c_str());
+                auto latency = MeasureLatency([&impl, &input]() { return impl->Process(input); });
+                impl->Deinit();
+                CHECK_AND_CONTINUE_LOG(latency.has_value(), "%{public}s does not qualify for bucket %{public}u",
+                    extension->info.name.c_str(), bucket);
+                calibration.Record(capabilityKey, bucket, extension->info.name, *latency);
+            }
+        }
+    }
+}
+
+size_t ExtensionManager::SelectCandidate(const ExtensionIndex& index, const std::string& capabilityKey,
+    uint32_t bucket, const CandidateList& candidates, size_t defaultIdx) const
+{
+    auto calibration = std::atomic_load(&rankCalibration_);
+    if (calibration == nullptr || calibration->IsEmpty() || candidates.size() < 2) { // 2: more than one candidate
+        return defaultIdx;
+    }
+    std::vector<std::string> candidateNames;
+    candidateNames.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        candidateNames.push_back(index.extensionList[std::get<2>(candidate)]->info.name);
+    }
+    auto selected = calibration->SelectFastest(capabilityKey, bucket, candidateNames);
+    return selected.has_value() ? std::get<2>(candidates[*selected]) : defaultIdx;
+}
+
 bool ExtensionManager::IsColorSpaceConversionSupported(const FrameInfo &inputInfo, const FrameInfo &outputInfo) const
 {
     if (!initialized_) {
@@ -114,14 +368,24 @@ std::shared_ptr<ColorSpaceConverterBase> ExtensionManager::CreateColorSpaceConve
 std::shared_ptr<VideoRefreshRatePredictionBase> ExtensionManager::CreateVideoRefreshRatePredictor() const
 {
     std::shared_ptr<ExtensionBase> extension;
-    CHECK_AND_RETURN_RET_LOG(g_algoHandle != nullptr, {}, "dlopen ext fail!");
+    void* handle = nullptr;
+    {
+        // The predictor is created by the dynamic library, so it must not be unloaded by a support query.
+        std::lock_guard<std::mutex> indexLock(extensionIndexMtx_);
+        handle = LoadLibrary();
+        CHECK_AND_RETURN_RET_LOG(handle != nullptr, {}, "dlopen ext fail!");
+        isLibraryInUse_ = true;
+    }
+    auto startTime = std::chrono::steady_clock::now();
     GetRegisterVRRExtensionFuncs = reinterpret_cast<LibFunctionGetRegisterFunction>
-        (dlsym(g_algoHandle, "GetRegisterVRRExtensionFuncs"));
+        (dlsym(handle, "GetRegisterVRRExtensionFuncs"));
     CHECK_AND_RETURN_RET_LOG(GetRegisterVRRExtensionFuncs != nullptr, {}, "dlsym Get VRR Extension fail!");
-    
+
     auto registerFunctionPtr = GetRegisterVRRExtensionFuncs();
     CHECK_AND_RETURN_RET_LOG(registerFunctionPtr != nullptr, {}, "get GetRegisterVRRExtensionFuncs fail!!");
     registerFunctionPtr(reinterpret_cast<uintptr_t>(&extension));
+    RecordLoadTime(ExtensionLoadPhase::VRR_REGISTER, startTime);
+    CHECK_AND_RETURN_RET_LOG(extension != nullptr, {}, "Register VRR extension fail!");
     std::shared_ptr<VideoRefreshratePredictionExtension> vrrExtension =
             std::static_pointer_cast<VideoRefreshratePredictionExtension>(extension);
     auto impl = vrrExtension->creator();
@@ -171,26 +435,34 @@ std::shared_ptr<AihdrEnhancerBase> ExtensionManager::CreateAihdrEnhancer(const F
 int32_t ExtensionManager::NewInstanceId(const ExtensionManager::InstanceVariableType& instance)
 {
     std::lock_guard<std::mutex> lock(instanceManagementMtx_);
-    int32_t newId = currentId_;
-    do {
-        currentId_ = (currentId_ == MAX_INSTANCE_NUM) ? 0 : currentId_;
-        if (instanceList_[currentId_] == std::nullopt) {
-            instanceList_[currentId_] = instance;
-            newId = currentId_;
-            ++currentId_;
-            return newId;
-        }
-        ++currentId_;
-    } while (currentId_ != newId);
-
-    return -1;
+    int32_t index;
+    if (!freeSlotIndexes_.empty()) {
+        index = freeSlotIndexes_.back();
+        freeSlotIndexes_.pop_back();
+    } else if (unusedSlotIndex_ < MAX_INSTANCE_NUM) {
+        index = unusedSlotIndex_++;
+    } else {
+        return -1;
+    }
+    auto& slot = instanceSlots_[index];
+    std::atomic_store(&slot.instance, std::make_shared<const InstanceVariableType>(instance));
+    auto generation = slot.generation.load();
+    return static_cast<int32_t>((generation << INSTANCE_INDEX_BITS) | static_cast<uint32_t>(index));
 }
 
 int32_t ExtensionManager::RemoveInstanceReference(int32_t& id)
 {
     std::lock_guard<std::mutex> lock(instanceManagementMtx_);
-    CHECK_AND_RETURN_RET_LOG(id >= 0 && id < MAX_INSTANCE_NUM, VPE_ALGO_ERR_INVALID_VAL, "invalid instance id");
-    instanceList_[id].reset() ;
+    CHECK_AND_RETURN_RET_LOG(id >= 0, VPE_ALGO_ERR_INVALID_VAL, "invalid instance id");
+    int32_t index = id & (MAX_INSTANCE_NUM - 1);
+    uint32_t generation = static_cast<uint32_t>(id) >> INSTANCE_INDEX_BITS;
+    auto& slot = instanceSlots_[index];
+    CHECK_AND_RETURN_RET_LOG(slot.generation.load() == generation && std::atomic_load(&slot.instance) != nullptr,
+        VPE_ALGO_ERR_INVALID_VAL, "invalid instance id:%{public}d, it may be removed", id);
+    // Invalidate the ID before releasing the instance, then the readers which see the new generation get nothing.
+    slot.generation.store((generation + 1) & INSTANCE_GENERATION_MASK);
+    std::atomic_store(&slot.instance, std::shared_ptr<const InstanceVariableType>(nullptr));
+    freeSlotIndexes_.push_back(index);
     id = -1;
 
     return VPE_ALGO_ERR_OK;
@@ -198,15 +470,21 @@ int32_t ExtensionManager::RemoveInstanceReference(int32_t& id)
 
 std::optional<ExtensionManager::InstanceVariableType> ExtensionManager::GetInstance(int32_t id)
 {
-    std::lock_guard<std::mutex> lock(instanceManagementMtx_);
-    CHECK_AND_RETURN_RET_LOG(id >= 0 && id < MAX_INSTANCE_NUM, std::nullopt, "invalid instance id");
-    return instanceList_[id];
+    CHECK_AND_RETURN_RET_LOG(id >= 0, std::nullopt, "invalid instance id");
+    const auto& slot = instanceSlots_[id & (MAX_INSTANCE_NUM - 1)];
+    uint32_t generation = static_cast<uint32_t>(id) >> INSTANCE_INDEX_BITS;
+    CHECK_AND_RETURN_RET_LOG(slot.generation.load() == generation, std::nullopt, "stale instance id:%{public}d", id);
+    auto instance = std::atomic_load(&slot.instance);
+    // Check again in case the instance is removed and the slot is reused between the two loads.
+    CHECK_AND_RETURN_RET_LOG(instance != nullptr && slot.generation.load() == generation, std::nullopt,
+        "stale instance id:%{public}d", id);
+    return *instance;
 }
 
-std::shared_ptr<DetailEnhancerBase> ExtensionManager::CreateDetailEnhancer(uint32_t level) const
+std::shared_ptr<DetailEnhancerBase> ExtensionManager::CreateDetailEnhancer(uint32_t level, uint32_t bucket) const
 {
     CHECK_AND_RETURN_RET_LOG(initialized_ == true, nullptr, "Not initialized");
-    auto extension = FindDetailEnhancerExtension(level);
+    auto extension = FindDetailEnhancerExtension(level, bucket);
     CHECK_AND_RETURN_RET_LOG(extension != nullptr, nullptr,
         "Create failed, get an empty extension. level: %{public}d", level);
     auto impl = extension->creator();
@@ -229,12 +507,114 @@ std::shared_ptr<ContrastEnhancerBase> ExtensionManager::CreateContrastEnhancer(C
     return impl;
 }
 
+std::shared_ptr<const ExtensionManager::ExtensionIndex> ExtensionManager::GetExtensionIndex(
+    ExtensionSet extensionSet, bool needExtensions) const
+{
+    auto& cachedIndex = extensionIndexes_[static_cast<size_t>(extensionSet)];
+    auto index = std::atomic_load(&cachedIndex);
+    auto isValid = [this, needExtensions](const std::shared_ptr<const ExtensionIndex>& cached) {
+        return cached != nullptr && (!needExtensions || !cached->extensionList.empty()) &&
+            (cached->hasDynamicExtensions || !IsLibraryLoaded());
+    };
+    if (isValid(index)) {
+        return index;
+    }
+    std::lock_guard<std::mutex> lock(extensionIndexMtx_);
+    index = std::atomic_load(&cachedIndex);
+    if (isValid(index)) {
+        return index;
+    }
+    bool wasLibraryLoaded = IsLibraryLoaded();
+    index = BuildExtensionIndex(extensionSet, needExtensions);
+    std::atomic_store(&cachedIndex, index);
+    if (needExtensions) {
+        isLibraryInUse_ = isLibraryInUse_ || IsLibraryLoaded();
+    } else if (!wasLibraryLoaded && !isLibraryInUse_) {
+        // Loaded only to answer a support query, none of its extensions is kept.
+        UnloadLibrary();
+    }
+    return index;
+}
+
+std::shared_ptr<const ExtensionManager::ExtensionIndex> ExtensionManager::BuildExtensionIndex(
+    ExtensionSet extensionSet, bool keepExtensions) const
+{
+    auto index = std::make_shared<ExtensionIndex>();
+    index->extensionList = LoadExtensionSet(extensionSet);
+    index->hasDynamicExtensions = IsLibraryLoaded();
+    auto startTime = std::chrono::steady_clock::now();
+    index->colorSpaceConverterCaps = BuildCaps<ColorSpaceConverterCapabilityMap>(index->extensionList);
+    index->metadataGeneratorCaps = BuildCaps<MetadataGeneratorCapabilityMap>(index->extensionList);
+    index->detailEnhancerCaps = BuildCaps<DetailEnhancerCapabilityMap>(index->extensionList);
+    index->aihdrEnhancerCaps = BuildCaps<AihdrEnhancerCapabilityMap>(index->extensionList);
+    index->contrastEnhancerCaps = BuildCaps<ContrastEnhancerCapabilityMap>(index->extensionList);
+    RecordLoadTime(ExtensionLoadPhase::BUILD_CAPS, startTime);
+    if (!keepExtensions) {
+        // The support queries only need the capabilities, the extensions are rebuilt when an instance needs them.
+        index->extensionList.clear();
+    }
+    VPE_LOGD("Build extension index(set:%{public}zu) with %{public}zu extensions",
+        static_cast<size_t>(extensionSet), index->extensionList.size());
+    return index;
+}
+
+void ExtensionManager::ReleaseExtensionIndexesLocked(bool keepCaps)
+{
+    for (auto& cachedIndex : extensionIndexes_) {
+        auto index = std::atomic_load(&cachedIndex);
+        if (index == nullptr) {
+            continue;
+        }
+        std::shared_ptr<ExtensionIndex> capsIndex = nullptr;
+        if (keepCaps) {
+            capsIndex = std::make_shared<ExtensionIndex>(*index);
+            capsIndex->extensionList.clear();
+        }
+        std::atomic_store(&cachedIndex, std::shared_ptr<const ExtensionIndex>(capsIndex));
+    }
+}
+
+ExtensionList ExtensionManager::LoadExtensionSet(ExtensionSet extensionSet) const
+{
+    switch (extensionSet) {
+        case ExtensionSet::ALL:
+            return LoadExtensions();
+        case ExtensionSet::IMAGE_COMPOSE:
+            return LoadDynamicComposeExtensions();
+        case ExtensionSet::IMAGE_DECOMPOSE:
+            return LoadDynamicDecomposeExtensions();
+        case ExtensionSet::IMAGE_METADATA_GEN:
+            return LoadDynamicMetadataGenExtensions();
+        default:
+            VPE_LOGE("Unknown extension set:%{public}zu", static_cast<size_t>(extensionSet));
+            return {};
+    }
+}
+
 ExtensionList ExtensionManager::LoadExtensions() const
 {
     ExtensionList extensionList {};
+    // The static extensions live in this library, so they are registered once and reused by the later builds.
+    // The first registration runs in parallel with the dynamic one, since they come from different libraries.
+    // The dynamic extensions are still put before the static ones to keep the rank order.
+    std::future<VPEAlgoErrCode> staticTask {};
+    if (!staticExtensionList_.has_value() && !staticExtensionsRegisterMap.empty()) {
+        staticTask = std::async(std::launch::async, [this]() {
+            ExtensionList staticExtensionList {};
+            VPEAlgoErrCode ret = LoadStaticExtensions(staticExtensionList);
+            if (ret == VPE_ALGO_ERR_OK) {
+                staticExtensionList_ = std::move(staticExtensionList);
+            }
+            return ret;
+        });
+    }
     LoadDynamicExtensions(extensionList);
-    VPEAlgoErrCode ret = LoadStaticExtensions(extensionList);
-    CHECK_AND_RETURN_RET_LOG(ret == VPE_ALGO_ERR_OK, {}, "Load extension failed");
+    if (staticTask.valid()) {
+        CHECK_AND_RETURN_RET_LOG(staticTask.get() == VPE_ALGO_ERR_OK, {}, "Load extension failed");
+    }
+    if (staticExtensionList_.has_value()) {
+        extensionList.insert(extensionList.end(), staticExtensionList_->begin(), staticExtensionList_->end());
+    }
     return extensionList;
 }
 
@@ -254,9 +634,9 @@ ExtensionList ExtensionManager::LoadStaticImageExtensions(
 bool ExtensionManager::FindImageConverterExtension(
     const FrameInfo &inputInfo, const FrameInfo &outputInfo) const
 {
-    auto extensionList = LoadExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), false, "No extension found");
-    auto colorSpaceConverterCapabilityMap = BuildCaps<ColorSpaceConverterCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::ALL, false);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr, false, "No extension found");
+    const auto& colorSpaceConverterCapabilityMap = index->colorSpaceConverterCaps;
     CHECK_AND_RETURN_RET_LOG(!colorSpaceConverterCapabilityMap.empty(), false, "No extension available");
     auto key =
         std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat, outputInfo.colorSpace, outputInfo.pixelFormat);
@@ -271,9 +651,9 @@ bool ExtensionManager::FindImageConverterExtension(
 bool ExtensionManager::FindImageComposeExtension(
     const FrameInfo &inputInfo, const FrameInfo &outputInfo) const
 {
-    auto extensionList = LoadDynamicComposeExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), false, "No extension found");
-    auto colorSpaceConverterCapabilityMap = BuildCaps<ColorSpaceConverterCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::IMAGE_COMPOSE, false);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr, false, "No extension found");
+    const auto& colorSpaceConverterCapabilityMap = index->colorSpaceConverterCaps;
     CHECK_AND_RETURN_RET_LOG(!colorSpaceConverterCapabilityMap.empty(), false, "No extension available");
     auto key =
         std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat, outputInfo.colorSpace, outputInfo.pixelFormat);
@@ -288,9 +668,9 @@ bool ExtensionManager::FindImageComposeExtension(
 bool ExtensionManager::FindImageDecomposeExtension(
     const FrameInfo &inputInfo, const FrameInfo &outputInfo) const
 {
-    auto extensionList = LoadDynamicDecomposeExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), false, "No extension found");
-    auto colorSpaceConverterCapabilityMap = BuildCaps<ColorSpaceConverterCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::IMAGE_DECOMPOSE, false);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr, false, "No extension found");
+    const auto& colorSpaceConverterCapabilityMap = index->colorSpaceConverterCaps;
     CHECK_AND_RETURN_RET_LOG(!colorSpaceConverterCapabilityMap.empty(), false, "No extension available");
     auto key =
         std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat, outputInfo.colorSpace, outputInfo.pixelFormat);
@@ -304,9 +684,9 @@ bool ExtensionManager::FindImageDecomposeExtension(
 
 bool ExtensionManager::FindImageMetadataGenExtension(const FrameInfo &inputInfo) const
 {
-    auto extensionList = LoadDynamicMetadataGenExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), false, "No extension found");
-    auto metadataGeneratorCapabilityMap = BuildCaps<MetadataGeneratorCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::IMAGE_METADATA_GEN, false);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr, false, "No extension found");
+    const auto& metadataGeneratorCapabilityMap = index->metadataGeneratorCaps;
     CHECK_AND_RETURN_RET_LOG(!metadataGeneratorCapabilityMap.empty(), false, "No extension available");
     auto key = std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat,
         MetadataGeneratorAlgoType::META_GEN_ALGO_TYPE_IMAGE);
@@ -376,98 +756,60 @@ bool ImageProcessing_IsMetadataGenerationSupported(const ColorSpaceInfo inputInf
 
 VPEAlgoErrCode ExtensionManager::LoadStaticExtensions(ExtensionList& extensionList) const
 {
+    auto startTime = std::chrono::steady_clock::now();
     for (auto &reg : staticExtensionsRegisterMap) {
         CHECK_AND_RETURN_RET_LOG(reg.second != nullptr, VPE_ALGO_ERR_UNKNOWN,
             "Get an empty register, extension: %{public}s", reg.first.c_str());
         VPE_LOGD("Load extension set: %{public}s", reg.first.c_str());
         reg.second(reinterpret_cast<uintptr_t>(&extensionList));
     }
+    RecordLoadTime(ExtensionLoadPhase::STATIC_REGISTER, startTime);
     return VPE_ALGO_ERR_OK;
 }
 
 void ExtensionManager::LoadDynamicExtensions(ExtensionList& extensionList) const
 {
-    CHECK_AND_RETURN_LOG(g_algoHandle != nullptr, "dlopen ext fail!");
-    GetRegisterExtensionFuncs = reinterpret_cast<LibFunctionGetRegisters>
-        (dlsym(g_algoHandle, "GetRegisterExtensionFuncs"));
-    CHECK_AND_RETURN_LOG(GetRegisterExtensionFuncs != nullptr, "dlsym GetRegisterExtensionFuncs fail!");
-    auto dynamicExtensionsRegisterMapPtr = GetRegisterExtensionFuncs();
-    CHECK_AND_RETURN_LOG(dynamicExtensionsRegisterMapPtr != nullptr, "get dynamicExtensionsRegisterMap fail!!");
-    auto dynamicExtensionsRegisterMap = *dynamicExtensionsRegisterMapPtr;
-    for (auto &reg : dynamicExtensionsRegisterMap) {
-        if (reg.second != nullptr) {
-            VPE_LOGD("Load extension set: %{public}s", reg.first.c_str());
-            reg.second(reinterpret_cast<uintptr_t>(&extensionList));
-        }
-    }
+    auto dynamicExtensionList =
+        LoadDynamicExtensionSet("GetRegisterExtensionFuncs", ExtensionLoadPhase::DYNAMIC_REGISTER);
+    extensionList.insert(extensionList.end(), dynamicExtensionList.begin(), dynamicExtensionList.end());
 }
 
 ExtensionList ExtensionManager::LoadDynamicMetadataGenExtensions() const
 {
-    ExtensionList extensionList {};
-    CHECK_AND_RETURN_RET_LOG(g_algoHandle != nullptr, {}, "dlopen ext fail!");
-
-    GetRegisterMetdataGenExtensionFuncs = reinterpret_cast<LibFunctionGetRegisters>
-        (dlsym(g_algoHandle, "GetRegisterMetdataGenExtensionFuncs"));
-    CHECK_AND_RETURN_RET_LOG(GetRegisterMetdataGenExtensionFuncs != nullptr, {},
-        "dlsym GetRegisterMetdataGenExtensionFuncs fail!");
-
-    auto dynamicExtensionsRegisterMapPtr = GetRegisterMetdataGenExtensionFuncs();
-    CHECK_AND_RETURN_RET_LOG(dynamicExtensionsRegisterMapPtr != nullptr, {},
-        "get dynamicMetadataGenExtensions fail!!");
-    auto dynamicExtensionsRegisterMap = *dynamicExtensionsRegisterMapPtr;
-    for (auto &reg : dynamicExtensionsRegisterMap) {
-        if (reg.second != nullptr) {
-            VPE_LOGD("Load extension set: %{public}s", reg.first.c_str());
-            reg.second(reinterpret_cast<uintptr_t>(&extensionList));
-        }
-    }
-    return extensionList;
+    return LoadDynamicExtensionSet("GetRegisterMetdataGenExtensionFuncs", ExtensionLoadPhase::METADATA_GEN_REGISTER);
 }
 
 ExtensionList ExtensionManager::LoadDynamicComposeExtensions() const
 {
-    ExtensionList extensionList {};
-    CHECK_AND_RETURN_RET_LOG(g_algoHandle != nullptr, {}, "dlopen ext fail!");
-
-    GetRegisterComposeExtensionFuncs = reinterpret_cast<LibFunctionGetRegisters>
-        (dlsym(g_algoHandle, "GetRegisterComposeExtensionFuncs"));
-    CHECK_AND_RETURN_RET_LOG(GetRegisterComposeExtensionFuncs != nullptr, {},
-        "dlsym GetRegisterComposeExtensionFuncs fail!");
-
-    auto dynamicExtensionsRegisterMapPtr = GetRegisterComposeExtensionFuncs();
-    CHECK_AND_RETURN_RET_LOG(dynamicExtensionsRegisterMapPtr != nullptr, {},
-        "get dynamicMetadataGenExtensions fail!!");
-    auto dynamicExtensionsRegisterMap = *dynamicExtensionsRegisterMapPtr;
-    for (auto &reg : dynamicExtensionsRegisterMap) {
-        if (reg.second != nullptr) {
-            VPE_LOGD("Load extension set: %{public}s", reg.first.c_str());
-            reg.second(reinterpret_cast<uintptr_t>(&extensionList));
-        }
-    }
-    return extensionList;
+    return LoadDynamicExtensionSet("GetRegisterComposeExtensionFuncs", ExtensionLoadPhase::COMPOSE_REGISTER);
 }
 
 ExtensionList ExtensionManager::LoadDynamicDecomposeExtensions() const
+{
+    return LoadDynamicExtensionSet("GetRegisterDecomposeExtensionFuncs", ExtensionLoadPhase::DECOMPOSE_REGISTER);
+}
+
+ExtensionList ExtensionManager::LoadDynamicExtensionSet(const char* getRegistersSymbol,
+    ExtensionLoadPhase phase) const
 {
     ExtensionList extensionList {};
-    CHECK_AND_RETURN_RET_LOG(g_algoHandle != nullptr, {}, "dlopen ext fail, g_algoHandle null!");
+    auto handle = LoadLibrary();
+    CHECK_AND_RETURN_RET_LOG(handle != nullptr, {}, "dlopen ext fail!");
 
-    GetRegisterDecomposeExtensionFuncs = reinterpret_cast<LibFunctionGetRegisters>
-        (dlsym(g_algoHandle, "GetRegisterDecomposeExtensionFuncs"));
-    CHECK_AND_RETURN_RET_LOG(GetRegisterDecomposeExtensionFuncs != nullptr, {},
-        "dlsym GetRegisterDecomposeExtensionFuncs fail!");
+    auto startTime = std::chrono::steady_clock::now();
+    auto getRegisters = reinterpret_cast<LibFunctionGetRegisters>(dlsym(handle, getRegistersSymbol));
+    CHECK_AND_RETURN_RET_LOG(getRegisters != nullptr, {}, "dlsym %{public}s fail!", getRegistersSymbol);
 
-    auto dynamicExtensionsRegisterMapPtr = GetRegisterDecomposeExtensionFuncs();
+    auto dynamicExtensionsRegisterMapPtr = getRegisters();
     CHECK_AND_RETURN_RET_LOG(dynamicExtensionsRegisterMapPtr != nullptr, {},
-        "get dynamicMetadataGenExtensions fail!!");
-    auto dynamicExtensionsRegisterMap = *dynamicExtensionsRegisterMapPtr;
-    for (auto &reg : dynamicExtensionsRegisterMap) {
+        "get %{public}s register map fail!!", getRegistersSymbol);
+    for (auto &reg : *dynamicExtensionsRegisterMapPtr) {
         if (reg.second != nullptr) {
             VPE_LOGD("Load extension set: %{public}s", reg.first.c_str());
             reg.second(reinterpret_cast<uintptr_t>(&extensionList));
         }
     }
+    RecordLoadTime(phase, startTime);
     return extensionList;
 }
 
@@ -528,9 +870,9 @@ std::shared_ptr<ColorSpaceConverterExtension> ExtensionManager::FindColorSpaceCo
 {
     VPE_LOG_PRINT_COLOR_SPACE_CAPBILITY(inputInfo.colorSpace.colorSpaceInfo, inputInfo.pixelFormat);
     VPE_LOG_PRINT_COLOR_SPACE_CAPBILITY(outputInfo.colorSpace.colorSpaceInfo, outputInfo.pixelFormat);
-    auto extensionList = LoadExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), nullptr, "No extension found");
-    auto colorSpaceConverterCapabilityMap = BuildCaps<ColorSpaceConverterCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::ALL, true);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr && !index->extensionList.empty(), nullptr, "No extension found");
+    const auto& colorSpaceConverterCapabilityMap = index->colorSpaceConverterCaps;
     CHECK_AND_RETURN_RET_LOG(!colorSpaceConverterCapabilityMap.empty(), nullptr, "No extension available");
     auto key =
         std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat, outputInfo.colorSpace, outputInfo.pixelFormat);
@@ -554,15 +896,15 @@ std::shared_ptr<ColorSpaceConverterExtension> ExtensionManager::FindColorSpaceCo
             break;
         }
     }
-    return std::static_pointer_cast<ColorSpaceConverterExtension>(extensionList[idx]);
+    return std::static_pointer_cast<ColorSpaceConverterExtension>(index->extensionList[idx]);
 }
 
 ColorSpaceConverterDisplayExtensionSet ExtensionManager::FindColorSpaceConverterDisplayExtension() const
 {
-    auto extensionList = LoadExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), {}, "No extension found");
+    auto index = GetExtensionIndex(ExtensionSet::ALL, true);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr && !index->extensionList.empty(), {}, "No extension found");
     ColorSpaceConverterDisplayExtensionSet extensions {};
-    for (const auto &extension : extensionList) {
+    for (const auto &extension : index->extensionList) {
         CHECK_AND_CONTINUE_LOG(extension != nullptr, "Get an empty extension");
         if (extension->info.type != ExtensionType::COLORSPACE_CONVERTER_DISPLAY) {
             continue;
@@ -575,9 +917,9 @@ ColorSpaceConverterDisplayExtensionSet ExtensionManager::FindColorSpaceConverter
 std::shared_ptr<MetadataGeneratorExtension> ExtensionManager::FindMetadataGeneratorExtension(const FrameInfo &inputInfo,
     MetadataGeneratorAlgoType algoType) const
 {
-    auto extensionList = LoadExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), nullptr, "No extension found");
-    auto metadataGeneratorCapabilityMap = BuildCaps<MetadataGeneratorCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::ALL, true);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr && !index->extensionList.empty(), nullptr, "No extension found");
+    const auto& metadataGeneratorCapabilityMap = index->metadataGeneratorCaps;
     CHECK_AND_RETURN_RET_LOG(!metadataGeneratorCapabilityMap.empty(), nullptr, "No extension available");
     auto key = std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat, algoType);
     VPE_LOG_PRINT_METADATA_GEN_CAPBILITY(inputInfo.colorSpace.colorSpaceInfo, inputInfo.pixelFormat, algoType);
@@ -591,7 +933,7 @@ std::shared_ptr<MetadataGeneratorExtension> ExtensionManager::FindMetadataGenera
             break;
         }
     }
-    return std::static_pointer_cast<MetadataGeneratorExtension>(extensionList[idx]);
+    return std::static_pointer_cast<MetadataGeneratorExtension>(index->extensionList[idx]);
 }
 
 VPEAlgoErrCode ExtensionManager::BuildColorSpaceConverterCaps(const std::shared_ptr<ExtensionBase> &ext, size_t idx,
@@ -606,24 +948,32 @@ VPEAlgoErrCode ExtensionManager::BuildColorSpaceConverterCaps(const std::shared_
     return err;
 }
 
-std::shared_ptr<DetailEnhancerExtension> ExtensionManager::FindDetailEnhancerExtension(uint32_t level) const
+std::shared_ptr<DetailEnhancerExtension> ExtensionManager::FindDetailEnhancerExtension(uint32_t level,
+    uint32_t bucket) const
 {
-    auto extensionList = LoadExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), nullptr, "No extension found");
-    auto detailEnhancerCapabilityMap = BuildCaps<DetailEnhancerCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::ALL, true);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr && !index->extensionList.empty(), nullptr, "No extension found");
+    const auto& detailEnhancerCapabilityMap = index->detailEnhancerCaps;
     CHECK_AND_RETURN_RET_LOG(!detailEnhancerCapabilityMap.empty(), nullptr, "No extension available");
     const auto iter = detailEnhancerCapabilityMap.find(level);
-    CHECK_AND_RETURN_RET_LOG(iter != detailEnhancerCapabilityMap.cend(), nullptr,
+    CHECK_AND_RETURN_RET_LOG(iter != detailEnhancerCapabilityMap.cend() && !iter->second.empty(), nullptr,
         "Detail enhancer Extension is not found");
-    size_t idx = iter->second;
-    return std::static_pointer_cast<DetailEnhancerExtension>(extensionList[idx]);
+    // The last RANK_HIGH extension wins by default, otherwise the first one.
+    size_t idx = std::get<2>(*(iter->second.cbegin()));
+    for (const auto &cap : iter->second) {
+        if (std::get<0>(cap) == Rank::RANK_HIGH) {
+            idx = std::get<2>(cap); // 2
+        }
+    }
+    idx = SelectCandidate(*index, DetailEnhancerRankKey(level), bucket, iter->second, idx);
+    return std::static_pointer_cast<DetailEnhancerExtension>(index->extensionList[idx]);
 }
 
 std::shared_ptr<AihdrEnhancerExtension> ExtensionManager::FindAihdrEnhancerExtension(const FrameInfo &inputInfo) const
 {
-    auto extensionList = LoadExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), nullptr, "No extension found");
-    auto aihdrEnhancerCapabilityMap = BuildCaps<AihdrEnhancerCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::ALL, true);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr && !index->extensionList.empty(), nullptr, "No extension found");
+    const auto& aihdrEnhancerCapabilityMap = index->aihdrEnhancerCaps;
     CHECK_AND_RETURN_RET_LOG(!aihdrEnhancerCapabilityMap.empty(), nullptr, "No extension available");
     auto key = std::make_tuple(inputInfo.colorSpace, inputInfo.pixelFormat);
     const auto iter = aihdrEnhancerCapabilityMap.find(key);
@@ -636,21 +986,23 @@ std::shared_ptr<AihdrEnhancerExtension> ExtensionManager::FindAihdrEnhancerExten
             break;
         }
     }
-    return std::static_pointer_cast<AihdrEnhancerExtension>(extensionList[idx]);
+    idx = SelectCandidate(*index, AihdrEnhancerRankKey(inputInfo.colorSpace, inputInfo.pixelFormat),
+        ExtensionRankCalibration::GetResolutionBucket(inputInfo.width, inputInfo.height), iter->second, idx);
+    return std::static_pointer_cast<AihdrEnhancerExtension>(index->extensionList[idx]);
 }
 
 std::shared_ptr<ContrastEnhancerExtension> ExtensionManager::FindContrastEnhancerExtension(
     ContrastEnhancerType type) const
 {
-    auto extensionList = LoadExtensions();
-    CHECK_AND_RETURN_RET_LOG(!extensionList.empty(), nullptr, "No extension found");
-    auto contrastEnhancerCapabilityMap = BuildCaps<ContrastEnhancerCapabilityMap>(extensionList);
+    auto index = GetExtensionIndex(ExtensionSet::ALL, true);
+    CHECK_AND_RETURN_RET_LOG(index != nullptr && !index->extensionList.empty(), nullptr, "No extension found");
+    const auto& contrastEnhancerCapabilityMap = index->contrastEnhancerCaps;
     CHECK_AND_RETURN_RET_LOG(!contrastEnhancerCapabilityMap.empty(), nullptr, "No extension available");
     const auto iter = contrastEnhancerCapabilityMap.find(type);
     CHECK_AND_RETURN_RET_LOG(iter != contrastEnhancerCapabilityMap.cend(), nullptr,
         "Contrast enhancer Extension is not found");
     size_t idx = iter->second;
-    return std::static_pointer_cast<ContrastEnhancerExtension>(extensionList[idx]);
+    return std::static_pointer_cast<ContrastEnhancerExtension>(index->extensionList[idx]);
 }
 
 VPEAlgoErrCode ExtensionManager::ExtractColorSpaceConverterCap(const ColorSpaceConverterCapability& cap, size_t idx,
@@ -718,14 +1070,7 @@ VPEAlgoErrCode ExtensionManager::BuildDetailEnhancerCaps(const std::shared_ptr<E
     auto realExtension = std::static_pointer_cast<DetailEnhancerExtension>(ext);
     auto capabilities = realExtension->capabilitiesBuilder();
     for (const auto &level : capabilities.levels) {
-        auto itr = detailEnhancerCapabilityMap.find(level);
-        if (itr == detailEnhancerCapabilityMap.end()) {
-            detailEnhancerCapabilityMap.emplace(level, idx);
-        } else {
-            if (capabilities.rank == Rank::RANK_HIGH) {
-                itr->second = idx;
-            }
-        }
+        detailEnhancerCapabilityMap[level].emplace_back(capabilities.rank, capabilities.version, idx);
     }
     return VPE_ALGO_ERR_OK;
 }
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "extension_rank_calibration.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "vpe_log.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+namespace Extension {
+namespace {
+constexpr char FIELD_SEPARATOR = '\t';
+constexpr const char* TEMP_FILE_SUFFIX = ".tmp";
+}
+
+uint32_t ExtensionRankCalibration::GetResolutionBucket(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0) {
+        return RESOLUTION_BUCKET_ANY;
+    }
+    uint64_t pixels = static_cast<uint64_t>(width) * height;
+    for (uint32_t bucket = 0; bucket < RESOLUTION_BUCKETS.size(); bucket++) {
+        const auto& [bucketWidth, bucketHeight] = RESOLUTION_BUCKETS[bucket];
+        if (pixels <= static_cast<uint64_t>(bucketWidth) * bucketHeight) {
+            return bucket;
+        }
+    }
+    return RESOLUTION_BUCKETS.size() - 1;
+}
+
+void ExtensionRankCalibration::Record(const std::string& capabilityKey, uint32_t bucket,
+    const std::string& extensionName, int64_t latencyUs)
+{
+    CHECK_AND_RETURN_LOG(bucket < RESOLUTION_BUCKETS.size() && latencyUs >= 0,
+        "Invalid bucket:%{public}u or latency:%{public}lld", bucket, static_cast<long long>(latencyUs));
+    latencies_[{ capabilityKey, bucket }][extensionName] = latencyUs;
+}
+
+std::optional<size_t> ExtensionRankCalibration::SelectFastest(const std::string& capabilityKey, uint32_t bucket,
+    const std::vector<std::string>& candidateNames) const
+{
+    if (bucket < RESOLUTION_BUCKETS.size()) {
+        auto it = latencies_.find({ capabilityKey, bucket });
+        if (it != latencies_.end()) {
+            auto selected = SelectFastestInBucket(it->second, candidateNames);
+            if (selected.has_value()) {
+                return selected;
+            }
+        }
+    }
+    // The bucket is unknown or not measured, the large frames dominate the cost so they decide.
+    for (auto bucketIndex = RESOLUTION_BUCKETS.size(); bucketIndex > 0; bucketIndex--) {
+        auto it = latencies_.find({ capabilityKey, static_cast<uint32_t>(bucketIndex - 1) });
+        if (it == latencies_.end()) {
+            continue;
+        }
+        auto selected = SelectFastestInBucket(it->second, candidateNames);
+        if (selected.has_value()) {
+            return selected;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<size_t> ExtensionRankCalibration::SelectFastestInBucket(const LatencyMap& latencies,
+    const std::vector<std::string>& candidateNames) const
+{
+    std::optional<size_t> selected = std::nullopt;
+    int64_t fastest = INT64_MAX;
+    for (size_t i = 0; i < candidateNames.size(); i++) {
+        auto it = latencies.find(candidateNames[i]);
+        if (it != latencies.end() && it->second < fastest) {
+            fastest = it->second;
+            selected = i;
+        }
+    }
+    return selected;
+}
+
+bool ExtensionRankCalibration::IsEmpty() const
+{
+    return latencies_.empty();
+}
+
+VPEAlgoErrCode ExtensionRankCalibration::Load(const std::string& path)
+{
+    std::ifstream file(path);
+    CHECK_AND_RETURN_RET_LOG(file.is_open(), VPE_ALGO_ERR_INVALID_VAL, "Open %{public}s failed", path.c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string capabilityKey;
+        std::string bucket;
+        std::string extensionName;
+        std::string latencyUs;
+        if (!std::getline(fields, capabilityKey, FIELD_SEPARATOR) || !std::getline(fields, bucket, FIELD_SEPARATOR) ||
+            !std::getline(fields, extensionName, FIELD_SEPARATOR) || !std::getline(fields, latencyUs)) {
+            VPE_LOGW("Skip the broken line of %{public}s", path.c_str());
+            continue;
+        }
+        char* end = nullptr;
+        auto bucketValue = std::strtoul(bucket.c_str(), &end, 10); // 10: decimal
+        CHECK_AND_CONTINUE_LOG(end != bucket.c_str() && *end == '\0', "Invalid bucket:%{public}s", bucket.c_str());
+        auto latencyValue = std::strtoll(latencyUs.c_str(), &end, 10); // 10: decimal
+        CHECK_AND_CONTINUE_LOG(end != latencyUs.c_str() && *end == '\0', "Invalid latency:%{public}s",
+            latencyUs.c_str());
+        Record(capabilityKey, static_cast<uint32_t>(bucketValue), extensionName, latencyValue);
+    }
+    VPE_LOGI("Load %{public}zu calibrated capabilities from %{public}s", latencies_.size(), path.c_str());
+    return VPE_ALGO_ERR_OK;
+}
+
+VPEAlgoErrCode ExtensionRankCalibration::Save(const std::string& path) const
+{
+    // Write a temporary file and rename it, so a reader never sees a partial result.
+    std::string tempPath = path + TEMP_FILE_SUFFIX;
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::trunc);
+        CHECK_AND_RETURN_RET_LOG(file.is_open(), VPE_ALGO_ERR_INVALID_VAL, "Open %{public}s failed",
+            tempPath.c_str());
+        for (const auto& [key, latencies] : latencies_) {
+            for (const auto& [extensionName, latencyUs] : latencies) {
+                file << key.first << FIELD_SEPARATOR << key.second << FIELD_SEPARATOR << extensionName <<
+                    FIELD_SEPARATOR << latencyUs << '\n';
+            }
+        }
+        file.flush();
+        CHECK_AND_RETURN_RET_LOG(file.good(), VPE_ALGO_ERR_UNKNOWN, "Write %{public}s failed", tempPath.c_str());
+    }
+    CHECK_AND_RETURN_RET_LOG(std::rename(tempPath.c_str(), path.c_str()) == 0, VPE_ALGO_ERR_UNKNOWN,
+        "Rename %{public}s failed", tempPath.c_str());
+    return VPE_ALGO_ERR_OK;
+}
+} // namespace Extension
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_INSTANCE_POOL_H
+#define FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_INSTANCE_POOL_H
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+#include "extension_manager.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+namespace Extension {
+/**
+ * Process-wide pool of the initialized algorithm instances which are created by the extensions.
+ * A Fwk object checks an instance out by {@link Acquire} instead of creating and initializing a new one,
+ * and gives it back by {@link Release} when the Fwk object is destroyed.
+ *
+ * The idle instances are bounded by the capacity, the least recently released one is dropped first.
+ * The idle instances which are not used for IDLE_TIMEOUT are dropped on the next Acquire or Release.
+ * The pool holds an instance reference of {@link ExtensionManager} while it has idle instances,
+ * because the code of the dynamic extensions must stay loaded until they are destroyed.
+ * All the idle instances are dropped when the extension ranks change, since another extension may be selected.
+ */
+template<typename Key, typename T>
+class ExtensionInstancePool {
+public:
+    static constexpr auto IDLE_TIMEOUT = std::chrono::seconds(30);
+
+    explicit ExtensionInstancePool(size_t capacity) : capacity_(capacity)
+    {
+        // Make sure the ExtensionManager is destroyed after the pool.
+        rankListenerId_ = ExtensionManager::GetInstance().AddRankChangeListener([this]() { Clear(); });
+    }
+    ~ExtensionInstancePool()
+    {
+        ExtensionManager::GetInstance().RemoveRankChangeListener(rankListenerId_);
+        Clear();
+    }
+    ExtensionInstancePool(const ExtensionInstancePool&) = delete;
+    ExtensionInstancePool& operator=(const ExtensionInstancePool&) = delete;
+    ExtensionInstancePool(ExtensionInstancePool&&) = delete;
+    ExtensionInstancePool& operator=(ExtensionInstancePool&&) = delete;
+
+    // Check out an idle instance of the key, or create a new one by the creator if there is none.
+    std::shared_ptr<T> Acquire(const Key& key, const std::function<std::shared_ptr<T>()>& creator)
+    {
+        std::shared_ptr<T> instance = nullptr;
+        std::deque<IdleInstance> expired;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            TakeExpiredLocked(expired);
+            for (auto it = idleInstances_.rbegin(); it != idleInstances_.rend(); ++it) {
+                if (std::get<0>(*it) == key) {
+                    instance = std::move(std::get<1>(*it));
+                    idleInstances_.erase(std::next(it).base());
+                    break;
+                }
+            }
+        }
+        DropIdleInstances(expired);
+        if (instance != nullptr) {
+            return instance;
+        }
+        return creator();
+    }
+
+    // Give back an instance which is still usable, it may be dropped if the pool is full.
+    void Release(const Key& key, std::shared_ptr<T>&& instance)
+    {
+        if (instance == nullptr || capacity_ == 0) {
+            return;
+        }
+        std::deque<IdleInstance> expired;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            TakeExpiredLocked(expired);
+            if (idleInstances_.size() >= capacity_) {
+                expired.push_back(std::move(idleInstances_.front()));
+                idleInstances_.pop_front();
+            }
+            idleInstances_.emplace_back(key, std::move(instance), std::chrono::steady_clock::now());
+        }
+        DropIdleInstances(expired);
+    }
+
+    // Drop all the idle instances.
+    void Clear()
+    {
+        std::deque<IdleInstance> expired;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            idleInstances_.swap(expired);
+        }
+        DropIdleInstances(expired);
+    }
+
+private:
+    using IdleInstance = std::tuple<Key, std::shared_ptr<T>, std::chrono::steady_clock::time_point>;
+
+    void TakeExpiredLocked(std::deque<IdleInstance>& expired)
+    {
+        auto now = std::chrono::steady_clock::now();
+        while (!idleInstances_.empty() && now - std::get<2>(idleInstances_.front()) > IDLE_TIMEOUT) {
+            expired.push_back(std::move(idleInstances_.front()));
+            idleInstances_.pop_front();
+        }
+    }
+
+    // Destroy the instances out of the lock, and release the library reference once the pool is empty.
+    void DropIdleInstances(std::deque<IdleInstance>& expired)
+    {
+        expired.clear();
+        bool needDecrease = false;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            if (!idleInstances_.empty() && !hasLibraryReference_) {
+                hasLibraryReference_ = true;
+                ExtensionManager::GetInstance().IncreaseInstance();
+            } else if (idleInstances_.empty() && hasLibraryReference_) {
+                hasLibraryReference_ = false;
+                needDecrease = true;
+            }
+        }
+        if (needDecrease) {
+            ExtensionManager::GetInstance().DecreaseInstance();
+        }
+    }
+
+    const size_t capacity_;
+    int32_t rankListenerId_{-1};
+    std::mutex lock_{};
+    // Guarded by lock_ begin
+    std::deque<IdleInstance> idleInstances_{};
+    bool hasLibraryReference_{false};
+    // Guarded by lock_ end
+};
+} // namespace Extension
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_INSTANCE_POOL_H
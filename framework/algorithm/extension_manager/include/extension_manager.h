@@ -16,13 +16,18 @@
 #ifndef FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_MANAGER_H
 #define FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_MANAGER_H
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <set>
+#include <string>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <variant>
 #include <vector>
@@ -31,6 +36,7 @@
 #include "aihdr_enhancer_extension.h"
 #include "static_extension_list.h"
 #include "extension_base.h"
+#include "extension_rank_calibration.h"
 #include "frame_info.h"
 #include "colorspace_converter.h"
 #include "metadata_generator.h"
@@ -52,6 +58,41 @@ namespace Media {
 namespace VideoProcessingEngine {
 namespace Extension {
 namespace {
+template<typename T>
+size_t ToCapabilityHashValue(const T& value)
+{
+    return static_cast<size_t>(value);
+}
+
+inline size_t ToCapabilityHashValue(const ColorSpaceDescription& desc)
+{
+    // Keep consistent with ColorSpaceDescription::operator<, which only compares these two fields.
+    return (static_cast<size_t>(GetColorSpaceType(desc.colorSpaceInfo)) << 8) ^ // 8: bits of the metadata type
+        static_cast<size_t>(desc.metadataType);
+}
+
+// Hash and equality of the capability keys, the equality is derived from operator< as std::map did before.
+struct CapabilityKeyHash {
+    template<typename... Args>
+    size_t operator()(const std::tuple<Args...>& key) const
+    {
+        constexpr size_t hashPrime = 31;
+        size_t seed = 0;
+        std::apply([&seed](const auto&... item) {
+            ((seed = seed * hashPrime + ToCapabilityHashValue(item)), ...);
+        }, key);
+        return seed;
+    }
+};
+
+struct CapabilityKeyEqual {
+    template<typename... Args>
+    bool operator()(const std::tuple<Args...>& lhs, const std::tuple<Args...>& rhs) const
+    {
+        return !(lhs < rhs) && !(rhs < lhs);
+    }
+};
+
 /*
 {
     (inputColorSpaceDesc, inputPixelFormat, outputColorSpaceDesc, outputPixelFormat): [
@@ -61,9 +102,9 @@ namespace {
     ]
 }*/
 using ColorSpaceConverterCapabilityMap =
-    std::map<
+    std::unordered_map<
         std::tuple<ColorSpaceDescription, GraphicPixelFormat, ColorSpaceDescription, GraphicPixelFormat>,
-        std::vector<std::tuple<Rank, int32_t, size_t>>>;
+        std::vector<std::tuple<Rank, int32_t, size_t>>, CapabilityKeyHash, CapabilityKeyEqual>;
 using ColorSpaceConverterDisplayCapabilityMap = ColorSpaceConverterCapabilityMap;
 /*
 {
@@ -75,20 +116,41 @@ using ColorSpaceConverterDisplayCapabilityMap = ColorSpaceConverterCapabilityMap
 }
 */
 using MetadataGeneratorCapabilityMap =
-    std::map<
+    std::unordered_map<
         std::tuple<ColorSpaceDescription, GraphicPixelFormat, MetadataGeneratorAlgoType>,
-        std::vector<std::tuple<Rank, int32_t, size_t>>>;
-using DetailEnhancerCapabilityMap = std::map<uint32_t, size_t>;
+        std::vector<std::tuple<Rank, int32_t, size_t>>, CapabilityKeyHash, CapabilityKeyEqual>;
+/*
+{
+    level: [
+        (rank, version, extensionListIndex),
+        ......
+    ]
+}
+*/
+using DetailEnhancerCapabilityMap = std::unordered_map<uint32_t, std::vector<std::tuple<Rank, int32_t, size_t>>>;
 using AihdrEnhancerCapabilityMap =
-    std::map<
+    std::unordered_map<
         std::tuple<ColorSpaceDescription, GraphicPixelFormat>,
-        std::vector<std::tuple<Rank, int32_t, size_t>>>;
-using ContrastEnhancerCapabilityMap = std::map<ContrastEnhancerType, size_t>;
+        std::vector<std::tuple<Rank, int32_t, size_t>>, CapabilityKeyHash, CapabilityKeyEqual>;
+using ContrastEnhancerCapabilityMap = std::unordered_map<ContrastEnhancerType, size_t>;
 
 using ColorSpaceConverterDisplaySet = std::set<std::shared_ptr<ColorSpaceConverterDisplayBase>>;
 using ColorSpaceConverterDisplayExtensionSet = std::set<std::shared_ptr<ColorSpaceConverterDisplayExtension>>;
 }
 
+// The phases of loading the extensions, each dynamic category is loaded on its first use.
+enum class ExtensionLoadPhase : size_t {
+    DLOPEN = 0,
+    STATIC_REGISTER,
+    DYNAMIC_REGISTER,
+    COMPOSE_REGISTER,
+    DECOMPOSE_REGISTER,
+    METADATA_GEN_REGISTER,
+    VRR_REGISTER,
+    BUILD_CAPS,
+    NUM,
+};
+
 class ExtensionManager {
 public:
     static ExtensionManager& GetInstance();
@@ -101,7 +163,9 @@ public:
         Extension::ExtensionInfo &extensionInfo, MetadataGeneratorAlgoType algoType) const;
     std::shared_ptr<AihdrEnhancerBase> CreateAihdrEnhancer(const FrameInfo &inputInfo,
         Extension::ExtensionInfo &extensionInfo) const;
-    std::shared_ptr<DetailEnhancerBase> CreateDetailEnhancer(uint32_t level) const;
+    // The bucket is the resolution bucket of the frames, it picks the extension by the calibrated ranks.
+    std::shared_ptr<DetailEnhancerBase> CreateDetailEnhancer(uint32_t level,
+        uint32_t bucket = ExtensionRankCalibration::RESOLUTION_BUCKET_ANY) const;
     std::shared_ptr<VideoRefreshRatePredictionBase> CreateVideoRefreshRatePredictor() const;
     std::shared_ptr<ContrastEnhancerBase> CreateContrastEnhancer(ContrastEnhancerType type) const;
 
@@ -118,7 +182,45 @@ public:
     bool FindImageComposeExtension(const FrameInfo &inputInfo, const FrameInfo &outputInfo) const;
     bool FindImageDecomposeExtension(const FrameInfo &inputInfo, const FrameInfo &outputInfo) const;
     bool FindImageMetadataGenExtension(const FrameInfo &inputInfo) const;
+    // Return the duration in microseconds of the last load of the phase, 0 if it has not been loaded.
+    int64_t GetLoadTime(ExtensionLoadPhase phase) const;
+    // Measure the candidate extensions of each capability on synthetic frames and save the result to the path,
+    // the fastest candidate is preferred to the static rank afterwards. Only the detail enhancer and the aihdr
+    // enhancer are measured, the others need the GPU context of their Fwk objects.
+    VPEAlgoErrCode CalibrateExtensionRanks(const std::string& path);
+    // Prefer the extensions by the result which is saved by a previous calibration.
+    VPEAlgoErrCode LoadExtensionRanks(const std::string& path);
+    // Return the resolution bucket of the frame size which the ranks depend on, RESOLUTION_BUCKET_ANY if no rank
+    // is calibrated or loaded, so the callers need only one instance for all sizes.
+    uint32_t GetRankBucket(uint32_t width, uint32_t height) const;
+    // The listener is called without any lock of the manager after the ranks are calibrated or loaded, so the
+    // instances which are created by the previous selection can be dropped. Return the ID to remove it.
+    int32_t AddRankChangeListener(const std::function<void()>& listener);
+    void RemoveRankChangeListener(int32_t id);
 private:
+    using CandidateList = std::vector<std::tuple<Rank, int32_t, size_t>>;
+
+    // The sets of extensions which are registered together.
+    enum class ExtensionSet : size_t {
+        ALL = 0,            // Static extensions and the common dynamic extensions
+        IMAGE_COMPOSE,      // Dynamic image compose extensions
+        IMAGE_DECOMPOSE,    // Dynamic image decompose extensions
+        IMAGE_METADATA_GEN, // Dynamic image metadata generator extensions
+        NUM,
+    };
+
+    // Capability index of an extension set, it is immutable once built.
+    struct ExtensionIndex {
+        bool hasDynamicExtensions{false};
+        // Empty after the dynamic library is unloaded, the capabilities are still valid for the support queries.
+        ExtensionList extensionList{};
+        ColorSpaceConverterCapabilityMap colorSpaceConverterCaps{};
+        MetadataGeneratorCapabilityMap metadataGeneratorCaps{};
+        DetailEnhancerCapabilityMap detailEnhancerCaps{};
+        AihdrEnhancerCapabilityMap aihdrEnhancerCaps{};
+        ContrastEnhancerCapabilityMap contrastEnhancerCaps{};
+    };
+
     VPEAlgoErrCode Init();
     ExtensionManager();
     ~ExtensionManager();
@@ -131,8 +233,21 @@ private:
     std::shared_ptr<MetadataGeneratorExtension> FindMetadataGeneratorExtension(const FrameInfo &inputInfo,
         MetadataGeneratorAlgoType algoType) const;
     std::shared_ptr<AihdrEnhancerExtension> FindAihdrEnhancerExtension(const FrameInfo &inputInfo) const;
-    std::shared_ptr<DetailEnhancerExtension> FindDetailEnhancerExtension(uint32_t level) const;
+    std::shared_ptr<DetailEnhancerExtension> FindDetailEnhancerExtension(uint32_t level, uint32_t bucket) const;
     std::shared_ptr<ContrastEnhancerExtension> FindContrastEnhancerExtension(ContrastEnhancerType type) const;
+    std::shared_ptr<const ExtensionIndex> GetExtensionIndex(ExtensionSet extensionSet, bool needExtensions) const;
+    std::shared_ptr<const ExtensionIndex> BuildExtensionIndex(ExtensionSet extensionSet, bool keepExtensions) const;
+    void ReleaseExtensionIndexesLocked(bool keepCaps);
+    void* LoadLibrary() const;
+    void UnloadLibrary() const;
+    bool IsLibraryLoaded() const;
+    void RecordLoadTime(ExtensionLoadPhase phase, const std::chrono::steady_clock::time_point& startTime) const;
+    size_t SelectCandidate(const ExtensionIndex& index, const std::string& capabilityKey, uint32_t bucket,
+        const CandidateList& candidates, size_t defaultIdx) const;
+    void CalibrateDetailEnhancers(const ExtensionIndex& index, ExtensionRankCalibration& calibration) const;
+    void CalibrateAihdrEnhancers(const ExtensionIndex& index, ExtensionRankCalibration& calibration) const;
+    void NotifyRankChange() const;
+    ExtensionList LoadExtensionSet(ExtensionSet extensionSet) const;
     ExtensionList LoadExtensions() const;
     VPEAlgoErrCode LoadStaticExtensions(ExtensionList& extensionList) const;
     ExtensionList LoadStaticImageExtensions(
@@ -140,6 +255,7 @@ private:
     ExtensionList LoadDynamicMetadataGenExtensions() const;
     ExtensionList LoadDynamicComposeExtensions() const;
     ExtensionList LoadDynamicDecomposeExtensions() const;
+    ExtensionList LoadDynamicExtensionSet(const char* getRegistersSymbol, ExtensionLoadPhase phase) const;
     void LoadDynamicExtensions(ExtensionList& extensionList) const;
     template<typename T> T BuildCaps(const ExtensionList& extensionList) const;
     VPEAlgoErrCode BuildColorSpaceConverterCaps(const std::shared_ptr<ExtensionBase>& ext, size_t idx,
@@ -163,12 +279,43 @@ private:
 
     std::atomic<bool> initialized_ {false};
 
-    static constexpr int32_t MAX_INSTANCE_NUM { 1024 };
+    // Built on the first lookup, and rebuilt only when the loaded extensions change.
+    mutable std::mutex extensionIndexMtx_;
+    mutable std::array<std::shared_ptr<const ExtensionIndex>, static_cast<size_t>(ExtensionSet::NUM)>
+        extensionIndexes_ {};
+    // Guarded by extensionIndexMtx_. The static extensions, registered on the first build of the index.
+    mutable std::optional<ExtensionList> staticExtensionList_ {};
+    // Guarded by extensionIndexMtx_. True if some extensions of the dynamic library are kept, then it is unloaded
+    // only when the last instance is released instead of after a support query.
+    mutable bool isLibraryInUse_ {false};
+
+    // Guard the handle of the dynamic library, it is loaded on the first use of the dynamic extensions.
+    mutable std::mutex libraryMtx_;
+    mutable std::atomic<bool> isLibraryLoaded_ {false};
+    mutable std::array<std::atomic<int64_t>, static_cast<size_t>(ExtensionLoadPhase::NUM)> loadTimeUs_ {};
+    // Null until the ranks are calibrated or loaded, accessed by std::atomic_load and std::atomic_store.
+    std::shared_ptr<const ExtensionRankCalibration> rankCalibration_ {nullptr};
+    mutable std::mutex rankListenerMtx_;
+    int32_t nextRankListenerId_ {0};
+    std::map<int32_t, std::function<void()>> rankListeners_ {};
+
+    // Instance ID is (generation << INSTANCE_INDEX_BITS) | slot index. The generation of a slot is increased when
+    // its instance is removed, so a stale ID never reaches the instance which reuses the slot.
+    static constexpr int32_t INSTANCE_INDEX_BITS { 10 };
+    static constexpr int32_t MAX_INSTANCE_NUM { 1 << INSTANCE_INDEX_BITS };
+    static constexpr uint32_t INSTANCE_GENERATION_MASK { 0x1FFFFF }; // Keep the ID non-negative
+    struct InstanceSlot {
+        std::atomic<uint32_t> generation { 0 };
+        // Accessed by std::atomic_load and std::atomic_store, so GetInstance needs no lock.
+        std::shared_ptr<const InstanceVariableType> instance { nullptr };
+    };
+    // Guard the free slots and the writers of the slots, the readers do NOT acquire it.
     std::mutex instanceManagementMtx_;
     std::mutex instanceCountMtx_;
-    int32_t currentId_ { 0 };
     int32_t usedInstance_ { 0 };
-    std::array<std::optional<InstanceVariableType>, MAX_INSTANCE_NUM> instanceList_ { std::nullopt };
+    int32_t unusedSlotIndex_ { 0 };
+    std::vector<int32_t> freeSlotIndexes_ {};
+    std::array<InstanceSlot, MAX_INSTANCE_NUM> instanceSlots_ {};
 };
     extern "C" bool ImageProcessing_IsColorSpaceConversionSupported(const ColorSpaceInfo inputInfo,
         const ColorSpaceInfo outputInfo);
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_RANK_CALIBRATION_H
+#define FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_RANK_CALIBRATION_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "algorithm_errors.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+namespace Extension {
+/**
+ * Measured latencies of the extensions which share a capability key, grouped by resolution bucket.
+ * It is filled by the calibration of {@link ExtensionManager} and used to prefer the fastest extension
+ * instead of the static Rank. The extensions which are not measured never win over a measured one.
+ */
+class ExtensionRankCalibration {
+public:
+    // Used when the resolution is unknown, the largest measured bucket decides.
+    static constexpr uint32_t RESOLUTION_BUCKET_ANY = UINT32_MAX;
+    // The synthetic frame size of each bucket, a bucket covers the frames which are not larger than its size.
+    static constexpr std::array<std::pair<uint32_t, uint32_t>, 5> RESOLUTION_BUCKETS = {{
+        { 640, 480 },   // VGA
+        { 1280, 720 },  // 720p
+        { 1920, 1080 }, // 1080p
+        { 3840, 2160 }, // 4K
+        { 7680, 4320 }, // 8K and above
+    }};
+
+    static uint32_t GetResolutionBucket(uint32_t width, uint32_t height);
+
+    void Record(const std::string& capabilityKey, uint32_t bucket, const std::string& extensionName,
+        int64_t latencyUs);
+    // Return the position in candidateNames of the fastest measured extension, nullopt if none is measured.
+    std::optional<size_t> SelectFastest(const std::string& capabilityKey, uint32_t bucket,
+        const std::vector<std::string>& candidateNames) const;
+    bool IsEmpty() const;
+    VPEAlgoErrCode Load(const std::string& path);
+    VPEAlgoErrCode Save(const std::string& path) const;
+
+private:
+    using LatencyMap = std::map<std::string, int64_t>;
+
+    std::optional<size_t> SelectFastestInBucket(const LatencyMap& latencies,
+        const std::vector<std::string>& candidateNames) const;
+
+    // {(capabilityKey, bucket): {extensionName: latencyUs}}
+    std::map<std::pair<std::string, uint32_t>, LatencyMap> latencies_ {};
+};
+} // namespace Extension
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // FRAMEWORK_ALGORITHM_EXTENSION_MANAGER_EXTENSION_RANK_CALIBRATION_H
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SKIA_CONVERT_SCALE_H
+#define SKIA_CONVERT_SCALE_H
+
+#include <cstdint>
+
+#include "surface_buffer.h"
+
+#include "algorithm_errors.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+// Return true if the formats are a pair of 8-bit YUV420 (NV12/NV21/YU12/YV12) and RGBA/BGRA in either direction.
+bool IsConvertScaleSupported(int32_t inputFormat, int32_t outputFormat);
+// Scale by bilinear filter and convert the pixel format in one pass, the YUV matrix and range come from the
+// color space of the YUV buffer, BT.709 full range if it is not set. The rows are split among workerNum threads.
+VPEAlgoErrCode ConvertScale(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output,
+    uint32_t workerNum);
+} // VideoProcessingEngine
+} // Media
+} // OHOS
+
+#endif // SKIA_CONVERT_SCALE_H
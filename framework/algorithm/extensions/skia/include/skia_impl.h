@@ -16,6 +16,8 @@
 #ifndef SKIA_IMPL_H
 #define SKIA_IMPL_H
 
+#include <atomic>
+
 #include "surface_buffer.h"
 #include "include/core/SkYUVAPixmaps.h"
 
@@ -37,12 +39,23 @@ public:
 
     static std::unique_ptr<DetailEnhancerBase> Create();
     static DetailEnhancerCapability BuildCapabilities();
+    // The number of threads which scale one image of this instance, including the caller.
+    // 1 scales the whole planes on the calling thread only.
+    void SetWorkerNum(uint32_t workerNum);
+    uint32_t GetWorkerNum() const;
     VPEAlgoErrCode Init() override;
     VPEAlgoErrCode Deinit() override;
     VPEAlgoErrCode SetParameter(const DetailEnhancerParameters& parameter) override;
     VPEAlgoErrCode Process(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output) override;
     VPEAlgoErrCode EnableProtection(bool enable) override;
     VPEAlgoErrCode ResetProtectionStatus() override;
+
+private:
+    static constexpr uint32_t DEFAULT_WORKER_NUM = 4;
+
+    // Chosen by the level of the last SetParameter, the default matches the default level LOW.
+    SkSamplingOptions samplingOptions_ {SkFilterMode::kLinear};
+    std::atomic<uint32_t> workerNum_ {DEFAULT_WORKER_NUM};
 };
 
 void RegisterSkiaExtensions(uintptr_t extensionListAddr);
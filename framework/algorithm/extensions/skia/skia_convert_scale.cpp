@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "skia_convert_scale.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "securec.h"
+
+#include "algorithm_common.h"
+#include "vpe_log.h"
+#include "vpe_task_executor.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+namespace {
+using namespace HDI::Display::Graphic::Common::V1_0;
+
+constexpr int FRACTION_BITS = 8; // Bits of the bilinear weights
+constexpr int FRACTION_ONE = 1 << FRACTION_BITS;
+constexpr int BILINEAR_SHIFT = FRACTION_BITS * 2; // Horizontal and vertical weights
+constexpr int BILINEAR_ROUND = 1 << (BILINEAR_SHIFT - 1);
+constexpr int COEFFICIENT_BITS = 16; // Bits of the fixed-point YUV matrix
+constexpr int COEFFICIENT_ROUND = 1 << (COEFFICIENT_BITS - 1);
+constexpr int CHROMA_OFFSET = 128;
+constexpr int LIMITED_LUMA_OFFSET = 16;
+constexpr float LIMITED_LUMA_RANGE = 219.0f / 255.0f;
+constexpr float LIMITED_CHROMA_RANGE = 224.0f / 255.0f;
+constexpr int MAX_COMPONENT = 255;
+constexpr int RGBA_BYTES = 4;
+constexpr int CHANNEL_R = 0;
+constexpr int CHANNEL_G = 1;
+constexpr int CHANNEL_B = 2;
+constexpr int CHANNEL_A = 3;
+constexpr int PLANE_U = 1;
+constexpr int PLANE_V = 2;
+constexpr int PLANE_NUM_YUV = 3;
+constexpr int SEMI_PLANAR_STEP = 2; // U and V are interleaved
+constexpr int PLANAR_STEP = 1;
+constexpr int CHROMA_SUBSAMPLE = 2; // 420 halves the chroma in both directions
+// A band smaller than that costs more to schedule than to convert.
+constexpr int MIN_BAND_ROWS = 32;
+constexpr int BANDS_PER_WORKER = 2;
+
+struct YuvLayout {
+    const uint8_t* y;
+    const uint8_t* u;
+    const uint8_t* v;
+    uint8_t* writableY;
+    uint8_t* writableU;
+    uint8_t* writableV;
+    int yStride;
+    int uvStride;
+    int uvStep;
+    int width;
+    int height;
+};
+
+struct RgbLayout {
+    uint8_t* addr;
+    int stride;
+    int width;
+    int height;
+    int rIndex;
+    int bIndex;
+};
+
+// Fixed-point coefficients of both directions, the range scaling is folded in.
+struct YuvMatrix {
+    int yOffset;
+    int yScale;
+    int crToR;
+    int cbToG;
+    int crToG;
+    int cbToB;
+    int rToY;
+    int gToY;
+    int bToY;
+    int rToCb;
+    int gToCb;
+    int bToCb;
+    int rToCr;
+    int gToCr;
+    int bToCr;
+};
+
+// The two source neighbours of a destination pixel and the weight of the second one. The positions are
+// premultiplied by the pixel step, so the kernels index the rows directly.
+struct FilterTap {
+    int first;
+    int second;
+    int weight;
+};
+
+// The coefficient tables of one call, built once and shared by all the rows.
+struct ScalePlan {
+    std::vector<FilterTap> columns;
+    std::vector<FilterTap> rows;
+    std::vector<FilterTap> chromaColumns;
+    std::vector<FilterTap> chromaRows;
+};
+
+bool IsYuv420(int32_t format)
+{
+    return format == GRAPHIC_PIXEL_FMT_YCBCR_420_SP || format == GRAPHIC_PIXEL_FMT_YCRCB_420_SP ||
+        format == GRAPHIC_PIXEL_FMT_YCBCR_420_P || format == GRAPHIC_PIXEL_FMT_YCRCB_420_P;
+}
+
+bool IsRgba8(int32_t format)
+{
+    return format == GRAPHIC_PIXEL_FMT_RGBA_8888 || format == GRAPHIC_PIXEL_FMT_BGRA_8888;
+}
+
+// pos = (i + 0.5) * scale - 0.5 maps the pixel centers, the same as the filters of Skia.
+std::vector<FilterTap> BuildFilterTaps(int srcSize, int dstSize, float scale, int step)
+{
+    std::vector<FilterTap> taps(dstSize);
+    float maxPos = static_cast<float>(srcSize - 1);
+    for (int i = 0; i < dstSize; i++) {
+        float pos = std::clamp((static_cast<float>(i) + 0.5f) * scale - 0.5f, 0.0f, maxPos); // 0.5: pixel center
+        int first = static_cast<int>(pos);
+        int second = std::min(first + 1, srcSize - 1);
+        int weight = static_cast<int>(std::lround((pos - static_cast<float>(first)) * FRACTION_ONE));
+        taps[i] = { first * step, second * step, weight };
+    }
+    return taps;
+}
+
+inline int Bilinear(const uint8_t* row0, const uint8_t* row1, const FilterTap& column, int rowWeight)
+{
+    int top = row0[column.first] * (FRACTION_ONE - column.weight) + row0[column.second] * column.weight;
+    int bottom = row1[column.first] * (FRACTION_ONE - column.weight) + row1[column.second] * column.weight;
+    return (top * (FRACTION_ONE - rowWeight) + bottom * rowWeight + BILINEAR_ROUND) >> BILINEAR_SHIFT;
+}
+
+inline uint8_t ToComponent(int fixedValue)
+{
+    return static_cast<uint8_t>(std::clamp(fixedValue >> COEFFICIENT_BITS, 0, MAX_COMPONENT));
+}
+
+bool GetYuvLayout(const sptr<SurfaceBuffer>& buffer, YuvLayout& layout)
+{
+    void* planesInfoPtr = nullptr;
+    buffer->GetPlanesInfo(&planesInfoPtr);
+    auto planesInfo = static_cast<OH_NativeBuffer_Planes*>(planesInfoPtr);
+    CHECK_AND_RETURN_RET_LOG(planesInfo != nullptr && planesInfo->planeCount >= PLANE_NUM_YUV &&
+        buffer->GetVirAddr() != nullptr, false, "Invalid planes info!");
+    auto addr = static_cast<uint8_t*>(buffer->GetVirAddr());
+    layout.writableY = addr + planesInfo->planes[0].offset;
+    layout.writableU = addr + planesInfo->planes[PLANE_U].offset;
+    layout.writableV = addr + planesInfo->planes[PLANE_V].offset;
+    layout.y = layout.writableY;
+    layout.u = layout.writableU;
+    layout.v = layout.writableV;
+    layout.yStride = static_cast<int>(planesInfo->planes[0].columnStride);
+    layout.uvStride = static_cast<int>(planesInfo->planes[PLANE_U].columnStride);
+    bool isSemiPlanar = buffer->GetFormat() == GRAPHIC_PIXEL_FMT_YCBCR_420_SP ||
+        buffer->GetFormat() == GRAPHIC_PIXEL_FMT_YCRCB_420_SP;
+    layout.uvStep = isSemiPlanar ? SEMI_PLANAR_STEP : PLANAR_STEP;
+    layout.width = buffer->GetWidth();
+    layout.height = buffer->GetHeight();
+    return layout.width > 0 && layout.height > 0;
+}
+
+bool GetRgbLayout(const sptr<SurfaceBuffer>& buffer, RgbLayout& layout)
+{
+    CHECK_AND_RETURN_RET_LOG(buffer->GetVirAddr() != nullptr, false, "Invalid address!");
+    layout.addr = static_cast<uint8_t*>(buffer->GetVirAddr());
+    layout.stride = buffer->GetStride();
+    layout.width = buffer->GetWidth();
+    layout.height = buffer->GetHeight();
+    bool isBgra = buffer->GetFormat() == GRAPHIC_PIXEL_FMT_BGRA_8888;
+    layout.rIndex = isBgra ? CHANNEL_B : CHANNEL_R;
+    layout.bIndex = isBgra ? CHANNEL_R : CHANNEL_B;
+    return layout.width > 0 && layout.height > 0;
+}
+
+YuvMatrix GetYuvMatrix(const sptr<SurfaceBuffer>& yuvBuffer)
+{
+    // Same as the YUV pixmaps of the scaling path, BT.709 full range if the buffer does not tell.
+    float kr = 0.2126f; // BT.709
+    float kb = 0.0722f; // BT.709
+    bool isLimited = false;
+    std::vector<uint8_t> vec;
+    CM_ColorSpaceInfo colorSpaceInfo {};
+    if (yuvBuffer->GetMetadata(ATTRKEY_COLORSPACE_INFO, vec) == GSERROR_OK && vec.size() == sizeof(colorSpaceInfo) &&
+        memcpy_s(&colorSpaceInfo, sizeof(colorSpaceInfo), vec.data(), vec.size()) == EOK) {
+        if (colorSpaceInfo.matrix == CM_Matrix::MATRIX_BT601_P || colorSpaceInfo.matrix == CM_Matrix::MATRIX_BT601_N) {
+            kr = 0.299f; // BT.601
+            kb = 0.114f; // BT.601
+        } else if (colorSpaceInfo.matrix == CM_Matrix::MATRIX_BT2020) {
+            kr = 0.2627f; // BT.2020
+            kb = 0.0593f; // BT.2020
+        }
+        isLimited = colorSpaceInfo.range == CM_Range::RANGE_LIMITED;
+    }
+    float kg = 1.0f - kr - kb;
+    float yRange = isLimited ? LIMITED_LUMA_RANGE : 1.0f;
+    float cRange = isLimited ? LIMITED_CHROMA_RANGE : 1.0f;
+    auto toFixed = [](float value) { return static_cast<int>(std::lround(value * (1 << COEFFICIENT_BITS))); };
+    YuvMatrix matrix {};
+    matrix.yOffset = isLimited ? LIMITED_LUMA_OFFSET : 0;
+    matrix.yScale = toFixed(1.0f / yRange);
+    matrix.crToR = toFixed(2.0f * (1.0f - kr) / cRange); // 2: Cr = (R - Y) / (2 * (1 - Kr))
+    matrix.cbToG = toFixed(2.0f * kb * (1.0f - kb) / kg / cRange); // 2: G = (Y - Kr * R - Kb * B) / Kg
+    matrix.crToG = toFixed(2.0f * kr * (1.0f - kr) / kg / cRange); // 2: G = (Y - Kr * R - Kb * B) / Kg
+    matrix.cbToB = toFixed(2.0f * (1.0f - kb) / cRange); // 2: Cb = (B - Y) / (2 * (1 - Kb))
+    matrix.rToY = toFixed(kr * yRange);
+    matrix.gToY = toFixed(kg * yRange);
+    matrix.bToY = toFixed(kb * yRange);
+    matrix.rToCb = toFixed(-kr / (2.0f * (1.0f - kb)) * cRange); // 2: Cb = (B - Y) / (2 * (1 - Kb))
+    matrix.gToCb = toFixed(-kg / (2.0f * (1.0f - kb)) * cRange); // 2: Cb = (B - Y) / (2 * (1 - Kb))
+    matrix.bToCb = toFixed(0.5f * cRange); // 0.5: (1 - Kb) / (2 * (1 - Kb))
+    matrix.rToCr = toFixed(0.5f * cRange); // 0.5: (1 - Kr) / (2 * (1 - Kr))
+    matrix.gToCr = toFixed(-kg / (2.0f * (1.0f - kr)) * cRange); // 2: Cr = (R - Y) / (2 * (1 - Kr))
+    matrix.bToCr = toFixed(-kb / (2.0f * (1.0f - kr)) * cRange); // 2: Cr = (R - Y) / (2 * (1 - Kr))
+    return matrix;
+}
+
+void ConvertYuvRowToRgb(const YuvLayout& src, const RgbLayout& dst, const ScalePlan& plan, const YuvMatrix& matrix,
+    int row)
+{
+    const auto& lumaRow = plan.rows[row];
+    const auto& chromaRow = plan.chromaRows[row];
+    const uint8_t* y0 = src.y + lumaRow.first * src.yStride;
+    const uint8_t* y1 = src.y + lumaRow.second * src.yStride;
+    const uint8_t* u0 = src.u + chromaRow.first * src.uvStride;
+    const uint8_t* u1 = src.u + chromaRow.second * src.uvStride;
+    const uint8_t* v0 = src.v + chromaRow.first * src.uvStride;
+    const uint8_t* v1 = src.v + chromaRow.second * src.uvStride;
+    uint8_t* out = dst.addr + row * dst.stride;
+    for (int x = 0; x < dst.width; x++, out += RGBA_BYTES) {
+        int luma = Bilinear(y0, y1, plan.columns[x], lumaRow.weight);
+        int cb = Bilinear(u0, u1, plan.chromaColumns[x], chromaRow.weight) - CHROMA_OFFSET;
+        int cr = Bilinear(v0, v1, plan.chromaColumns[x], chromaRow.weight) - CHROMA_OFFSET;
+        int yTerm = (luma - matrix.yOffset) * matrix.yScale + COEFFICIENT_ROUND;
+        out[dst.rIndex] = ToComponent(yTerm + matrix.crToR * cr);
+        out[CHANNEL_G] = ToComponent(yTerm - matrix.cbToG * cb - matrix.crToG * cr);
+        out[dst.bIndex] = ToComponent(yTerm + matrix.cbToB * cb);
+        out[CHANNEL_A] = MAX_COMPONENT;
+    }
+}
+
+void ConvertRgbRowToLuma(const RgbLayout& src, const YuvLayout& dst, const ScalePlan& plan, const YuvMatrix& matrix,
+    int row)
+{
+    const auto& rgbRow = plan.rows[row];
+    const uint8_t* row0 = src.addr + rgbRow.first * src.stride;
+    const uint8_t* row1 = src.addr + rgbRow.second * src.stride;
+    uint8_t* out = dst.writableY + row * dst.yStride;
+    for (int x = 0; x < dst.width; x++) {
+        const auto& column = plan.columns[x];
+        int r = Bilinear(row0 + src.rIndex, row1 + src.rIndex, column, rgbRow.weight);
+        int g = Bilinear(row0 + CHANNEL_G, row1 + CHANNEL_G, column, rgbRow.weight);
+        int b = Bilinear(row0 + src.bIndex, row1 + src.bIndex, column, rgbRow.weight);
+        out[x] = ToComponent(matrix.rToY * r + matrix.gToY * g + matrix.bToY * b +
+            (matrix.yOffset << COEFFICIENT_BITS) + COEFFICIENT_ROUND);
+    }
+}
+
+void ConvertRgbRowToChroma(const RgbLayout& src, const YuvLayout& dst, const ScalePlan& plan,
+    const YuvMatrix& matrix, int chromaRow)
+{
+    const auto& rgbRow = plan.chromaRows[chromaRow];
+    const uint8_t* row0 = src.addr + rgbRow.first * src.stride;
+    const uint8_t* row1 = src.addr + rgbRow.second * src.stride;
+    uint8_t* outU = dst.writableU + chromaRow * dst.uvStride;
+    uint8_t* outV = dst.writableV + chromaRow * dst.uvStride;
+    int chromaWidth = static_cast<int>(plan.chromaColumns.size());
+    constexpr int chromaOffset = (CHROMA_OFFSET << COEFFICIENT_BITS) + COEFFICIENT_ROUND;
+    for (int x = 0; x < chromaWidth; x++) {
+        const auto& column = plan.chromaColumns[x];
+        int r = Bilinear(row0 + src.rIndex, row1 + src.rIndex, column, rgbRow.weight);
+        int g = Bilinear(row0 + CHANNEL_G, row1 + CHANNEL_G, column, rgbRow.weight);
+        int b = Bilinear(row0 + src.bIndex, row1 + src.bIndex, column, rgbRow.weight);
+        outU[x * dst.uvStep] = ToComponent(matrix.rToCb * r + matrix.gToCb * g + matrix.bToCb * b + chromaOffset);
+        outV[x * dst.uvStep] = ToComponent(matrix.rToCr * r + matrix.gToCr * g + matrix.bToCr * b + chromaOffset);
+    }
+}
+
+// Run func on [begin, end) of the rows, the rows are split into bands which are processed in parallel.
+template<typename RowFunc>
+void ForEachRowBand(int rows, uint32_t workerNum, RowFunc&& func)
+{
+    int workers = static_cast<int>(std::max(workerNum, 1u));
+    int bandNum = std::clamp(rows / MIN_BAND_ROWS, 1, workers * BANDS_PER_WORKER);
+    VpeTaskExecutor::GetInstance().ParallelFor(static_cast<size_t>(bandNum), static_cast<size_t>(workers),
+        [rows, bandNum, &func](size_t band) {
+            int bandIndex = static_cast<int>(band);
+            func(rows * bandIndex / bandNum, rows * (bandIndex + 1) / bandNum);
+        });
+}
+
+void YuvToRgb(const YuvLayout& src, const RgbLayout& dst, const YuvMatrix& matrix, uint32_t workerNum)
+{
+    float scaleX = static_cast<float>(src.width) / static_cast<float>(dst.width);
+    float scaleY = static_cast<float>(src.height) / static_cast<float>(dst.height);
+    int chromaWidth = (src.width + 1) / CHROMA_SUBSAMPLE;
+    int chromaHeight = (src.height + 1) / CHROMA_SUBSAMPLE;
+    ScalePlan plan;
+    plan.columns = BuildFilterTaps(src.width, dst.width, scaleX, 1);
+    plan.rows = BuildFilterTaps(src.height, dst.height, scaleY, 1);
+    plan.chromaColumns = BuildFilterTaps(chromaWidth, dst.width, scaleX / CHROMA_SUBSAMPLE, src.uvStep);
+    plan.chromaRows = BuildFilterTaps(chromaHeight, dst.height, scaleY / CHROMA_SUBSAMPLE, 1);
+    ForEachRowBand(dst.height, workerNum, [&src, &dst, &plan, &matrix](int begin, int end) {
+        for (int row = begin; row < end; row++) {
+            ConvertYuvRowToRgb(src, dst, plan, matrix, row);
+        }
+    });
+}
+
+void RgbToYuv(const RgbLayout& src, const YuvLayout& dst, const YuvMatrix& matrix, uint32_t workerNum)
+{
+    float scaleX = static_cast<float>(src.width) / static_cast<float>(dst.width);
+    float scaleY = static_cast<float>(src.height) / static_cast<float>(dst.height);
+    int chromaWidth = (dst.width + 1) / CHROMA_SUBSAMPLE;
+    int chromaHeight = (dst.height + 1) / CHROMA_SUBSAMPLE;
+    ScalePlan plan;
+    plan.columns = BuildFilterTaps(src.width, dst.width, scaleX, RGBA_BYTES);
+    plan.rows = BuildFilterTaps(src.height, dst.height, scaleY, 1);
+    plan.chromaColumns = BuildFilterTaps(src.width, chromaWidth, scaleX * CHROMA_SUBSAMPLE, RGBA_BYTES);
+    plan.chromaRows = BuildFilterTaps(src.height, chromaHeight, scaleY * CHROMA_SUBSAMPLE, 1);
+    // Each band owns the chroma rows and the two luma rows of each, so the source is read once per band.
+    ForEachRowBand(chromaHeight, workerNum, [&src, &dst, &plan, &matrix](int begin, int end) {
+        for (int chromaRow = begin; chromaRow < end; chromaRow++) {
+            int lumaRow = chromaRow * CHROMA_SUBSAMPLE;
+            ConvertRgbRowToLuma(src, dst, plan, matrix, lumaRow);
+            if (lumaRow + 1 < dst.height) {
+                ConvertRgbRowToLuma(src, dst, plan, matrix, lumaRow + 1);
+            }
+            ConvertRgbRowToChroma(src, dst, plan, matrix, chromaRow);
+        }
+    });
+}
+} // namespace
+
+bool IsConvertScaleSupported(int32_t inputFormat, int32_t outputFormat)
+{
+    return (IsYuv420(inputFormat) && IsRgba8(outputFormat)) || (IsRgba8(inputFormat) && IsYuv420(outputFormat));
+}
+
+VPEAlgoErrCode ConvertScale(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output,
+    uint32_t workerNum)
+{
+    CHECK_AND_RETURN_RET_LOG(input != nullptr && output != nullptr &&
+        IsConvertScaleSupported(input->GetFormat(), output->GetFormat()), VPE_ALGO_ERR_INVALID_VAL,
+        "Unsupported conversion!");
+    bool isYuvToRgb = IsYuv420(input->GetFormat());
+    const auto& yuvBuffer = isYuvToRgb ? input : output;
+    const auto& rgbBuffer = isYuvToRgb ? output : input;
+    YuvLayout yuv {};
+    RgbLayout rgb {};
+    CHECK_AND_RETURN_RET_LOG(GetYuvLayout(yuvBuffer, yuv) && GetRgbLayout(rgbBuffer, rgb), VPE_ALGO_ERR_INVALID_VAL,
+        "Invalid buffer layout!");
+    auto matrix = GetYuvMatrix(yuvBuffer);
+    if (isYuvToRgb) {
+        YuvToRgb(yuv, rgb, matrix, workerNum);
+    } else {
+        RgbToYuv(rgb, yuv, matrix, workerNum);
+    }
+    return VPE_ALGO_ERR_OK;
+}
+} // VideoProcessingEngine
+} // Media
+} // OHOS
@@ -15,12 +15,23 @@
 
 #include "skia_impl.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <dlfcn.h>
+#include <vector>
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkShader.h"
 
 #include "detail_enhancer_extension.h"
+#include "skia_convert_scale.h"
 #include "utils.h"
+#include "vpe_task_executor.h"
 
 #include "vpe_log.h"
 
@@ -33,6 +44,7 @@ enum ImageFormatType {
     IMAGE_FORMAT_TYPE_UNKNOWN = 0,
     IMAGE_FORMAT_TYPE_RGB,
     IMAGE_FORMAT_TYPE_YUV,
+    IMAGE_FORMAT_TYPE_CONVERT, // Scale and convert between YUV and RGB in one pass
 };
 
 constexpr int CHANNEL_Y = 0;
@@ -40,10 +52,18 @@ constexpr int CHANNEL_UV1 = 1;
 constexpr int CHANNEL_UV2 = 2;
 constexpr int CHANNEL_NUM_NV12_NV21 = 2;
 constexpr int CHANNEL_NUM_YU12_YV12 = 3;
+constexpr int RGB_PLANE_NUM = 1;
+// A band smaller than that costs more to schedule than to scale.
+constexpr int MIN_BAND_ROWS = 64;
+// More bands than workers balance the planes of different heights.
+constexpr int BANDS_PER_WORKER = 2;
 
 ImageFormatType GetImageType(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
 {
     if (input->GetFormat() != output->GetFormat()) {
+        if (IsConvertScaleSupported(input->GetFormat(), output->GetFormat())) {
+            return IMAGE_FORMAT_TYPE_CONVERT;
+        }
         VPE_LOGE("Different format for input and output!");
         return IMAGE_FORMAT_TYPE_UNKNOWN;
     }
@@ -52,12 +72,15 @@ ImageFormatType GetImageType(const sptr<SurfaceBuffer>& input, const sptr<Surfac
     switch (input->GetFormat()) {
         case OHOS::GRAPHIC_PIXEL_FMT_RGBA_8888:
         case OHOS::GRAPHIC_PIXEL_FMT_BGRA_8888:
+        case OHOS::GRAPHIC_PIXEL_FMT_RGBA_1010102:
             imageType = IMAGE_FORMAT_TYPE_RGB;
             break;
         case OHOS::GRAPHIC_PIXEL_FMT_YCBCR_420_SP: // NV12
         case OHOS::GRAPHIC_PIXEL_FMT_YCRCB_420_SP: // NV21
         case OHOS::GRAPHIC_PIXEL_FMT_YCBCR_420_P:  // YU12
         case OHOS::GRAPHIC_PIXEL_FMT_YCRCB_420_P:  // YV12
+        case OHOS::GRAPHIC_PIXEL_FMT_YCBCR_P010:   // NV12 10bit
+        case OHOS::GRAPHIC_PIXEL_FMT_YCRCB_P010:   // NV21 10bit
             imageType = IMAGE_FORMAT_TYPE_YUV;
             break;
         default:
@@ -77,6 +100,9 @@ SkColorType GetRGBImageFormat(const sptr<SurfaceBuffer>& surfaceBuffer)
         case OHOS::GRAPHIC_PIXEL_FMT_BGRA_8888:
             imageFormat = kBGRA_8888_SkColorType;
             break;
+        case OHOS::GRAPHIC_PIXEL_FMT_RGBA_1010102:
+            imageFormat = kRGBA_1010102_SkColorType;
+            break;
         default:
             imageFormat = kRGBA_8888_SkColorType;
             break;
@@ -84,29 +110,135 @@ SkColorType GetRGBImageFormat(const sptr<SurfaceBuffer>& surfaceBuffer)
     return imageFormat;
 }
 
-VPEAlgoErrCode PixmapScale(const SkPixmap& inputPixmap, SkPixmap& outputPixmap, SkSamplingOptions options)
+// Scale the output rows [top, bottom) as SkPixmap::scalePixels does for the whole plane. Every band draws the whole
+// input by the same matrix and only the clip differs, so the filter sees the rows outside of the band and the result
+// is bit-exact no matter how the plane is split.
+bool ScaleBand(const SkPixmap& inputPixmap, const SkPixmap& outputPixmap, const SkSamplingOptions& options,
+    int top, int bottom)
 {
-    if (!inputPixmap.scalePixels(outputPixmap, options)) {
+    SkIRect band = SkIRect::MakeLTRB(0, top, outputPixmap.width(), bottom);
+    if (inputPixmap.width() == outputPixmap.width() && inputPixmap.height() == outputPixmap.height()) {
+        SkPixmap inputBand;
+        SkPixmap outputBand;
+        return inputPixmap.extractSubset(&inputBand, band) && outputPixmap.extractSubset(&outputBand, band) &&
+            inputBand.readPixels(outputBand);
+    }
+    SkPixmap input = inputPixmap;
+    SkPixmap output = outputPixmap;
+    if (input.alphaType() == kUnpremul_SkAlphaType && output.alphaType() == kUnpremul_SkAlphaType) {
+        // Like scalePixels, treat both as premul so the unpremul pixels and the alpha are kept as they are.
+        input.reset(input.info().makeAlphaType(kPremul_SkAlphaType), input.addr(), input.rowBytes());
+        output.reset(output.info().makeAlphaType(kPremul_SkAlphaType), output.addr(), output.rowBytes());
+    }
+    SkBitmap bitmap;
+    if (!bitmap.installPixels(input)) {
+        return false;
+    }
+    bitmap.setImmutable(); // Do not copy the pixels when the shader is made
+    SkMatrix scale = SkMatrix::Scale(static_cast<float>(output.width()) / input.width(),
+        static_cast<float>(output.height()) / input.height());
+    auto shader = bitmap.makeShader(SkTileMode::kClamp, SkTileMode::kClamp, options, &scale);
+    auto canvas = SkCanvas::MakeRasterDirect(output.info(), output.writable_addr(), output.rowBytes());
+    if (shader == nullptr || canvas == nullptr) {
+        return false;
+    }
+    canvas->clipRect(SkRect::Make(band));
+    SkPaint paint;
+    paint.setBlendMode(SkBlendMode::kSrc);
+    paint.setShader(std::move(shader));
+    canvas->drawPaint(paint);
+    return true;
+}
+
+// Split the planes into horizontal bands and scale them in parallel, the Y and UV planes are scaled concurrently.
+// A single worker scales the whole planes by scalePixels, which needs no band setup.
+VPEAlgoErrCode PixmapScale(const std::array<SkPixmap, SkYUVAInfo::kMaxPlanes>& inputPixmap,
+    const std::array<SkPixmap, SkYUVAInfo::kMaxPlanes>& outputPixmap, const SkSamplingOptions& options,
+    int numPlanes, uint32_t workerNum)
+{
+    if (workerNum <= 1) {
+        for (int i = 0; i < numPlanes; i++) {
+            if (!inputPixmap[i].scalePixels(outputPixmap[i], options)) {
+                VPE_LOGE("Scale failed!");
+                return VPE_ALGO_ERR_EXTENSION_PROCESS_FAILED;
+            }
+        }
+        return VPE_ALGO_ERR_OK;
+    }
+    struct Band {
+        int plane;
+        int top;
+        int bottom;
+    };
+    int maxBandNum = static_cast<int>(workerNum) * BANDS_PER_WORKER;
+    std::vector<Band> bands;
+    for (int i = 0; i < numPlanes; i++) {
+        int rows = outputPixmap[i].height();
+        int bandNum = std::clamp(rows / MIN_BAND_ROWS, 1, maxBandNum);
+        for (int band = 0; band < bandNum; band++) {
+            bands.push_back({ i, rows * band / bandNum, rows * (band + 1) / bandNum });
+        }
+    }
+    std::atomic<bool> isSuccessful{true};
+    VpeTaskExecutor::GetInstance().ParallelFor(bands.size(), workerNum,
+        [&bands, &inputPixmap, &outputPixmap, &options, &isSuccessful](size_t index) {
+            const auto& band = bands[index];
+            if (!ScaleBand(inputPixmap[band.plane], outputPixmap[band.plane], options, band.top, band.bottom)) {
+                isSuccessful = false;
+            }
+        });
+    if (!isSuccessful) {
+        VPE_LOGE("Scale failed!");
         return VPE_ALGO_ERR_EXTENSION_PROCESS_FAILED;
     }
     return VPE_ALGO_ERR_OK;
 }
 
-VPEAlgoErrCode RGBScale(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+SkSamplingOptions GetSamplingOptions(DetailEnhancerLevel level)
+{
+    // Skia runs the filters by its SIMD raster pipeline, a higher level trades speed for quality.
+    switch (level) {
+        case DETAIL_ENH_LEVEL_NONE:
+            return SkSamplingOptions(SkFilterMode::kNearest);
+        case DETAIL_ENH_LEVEL_LOW:
+            return SkSamplingOptions(SkFilterMode::kLinear);
+        case DETAIL_ENH_LEVEL_MEDIUM:
+            return SkSamplingOptions(SkCubicResampler::Mitchell());
+        default:
+            // The high levels come here only when no vendor extension is available, use the sharpest kernel.
+            return SkSamplingOptions(SkCubicResampler::CatmullRom());
+    }
+}
+
+SkAlphaType GetRGBAlphaType(const sptr<SurfaceBuffer>& surfaceBuffer)
+{
+    // The 2-bit alpha of the HDR images is often left 0, premultiplying by it would lose the colors.
+    return surfaceBuffer->GetFormat() == OHOS::GRAPHIC_PIXEL_FMT_RGBA_1010102 ? kUnpremul_SkAlphaType :
+        kPremul_SkAlphaType;
+}
+
+bool Is10BitYUV(const sptr<SurfaceBuffer>& buffer)
+{
+    return buffer->GetFormat() == OHOS::GRAPHIC_PIXEL_FMT_YCBCR_P010 ||
+        buffer->GetFormat() == OHOS::GRAPHIC_PIXEL_FMT_YCRCB_P010;
+}
+
+VPEAlgoErrCode RGBScale(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output,
+    const SkSamplingOptions& scaleOption, uint32_t workerNum)
 {
     if (input->GetWidth() <= 0 || input->GetHeight() <= 0 || output->GetWidth() <= 0 || output->GetHeight() <= 0) {
         VPE_LOGE("Invalid input or output size!");
         return VPE_ALGO_ERR_INVALID_VAL;
     }
     SkImageInfo inputInfo = SkImageInfo::Make(input->GetWidth(), input->GetHeight(), GetRGBImageFormat(input),
-        kPremul_SkAlphaType);
+        GetRGBAlphaType(input));
     SkImageInfo outputInfo = SkImageInfo::Make(output->GetWidth(), output->GetHeight(), GetRGBImageFormat(output),
-        kPremul_SkAlphaType);
-    SkPixmap inputPixmap(inputInfo, input->GetVirAddr(), input->GetStride());
-    SkPixmap outputPixmap(outputInfo, output->GetVirAddr(), output->GetStride());
-
-    SkSamplingOptions scaleOption(SkFilterMode::kNearest);
-    return PixmapScale(inputPixmap, outputPixmap, scaleOption);
+        GetRGBAlphaType(output));
+    std::array<SkPixmap, SkYUVAInfo::kMaxPlanes> inputPixmap;
+    std::array<SkPixmap, SkYUVAInfo::kMaxPlanes> outputPixmap;
+    inputPixmap[0].reset(inputInfo, input->GetVirAddr(), input->GetStride());
+    outputPixmap[0].reset(outputInfo, output->GetVirAddr(), output->GetStride());
+    return PixmapScale(inputPixmap, outputPixmap, scaleOption, RGB_PLANE_NUM, workerNum);
 }
 
 int ConfigYUVFormat(const sptr<SurfaceBuffer>& buffer, SkYUVAInfo::PlaneConfig& planeConfig, size_t* rowbyte,
@@ -118,6 +250,7 @@ int ConfigYUVFormat(const sptr<SurfaceBuffer>& buffer, SkYUVAInfo::PlaneConfig&
     auto planesInfo = static_cast<OH_NativeBuffer_Planes*>(planesInfoPtr);
     switch (buffer->GetFormat()) {
         case OHOS::GRAPHIC_PIXEL_FMT_YCBCR_420_SP: // NV12
+        case OHOS::GRAPHIC_PIXEL_FMT_YCBCR_P010:   // NV12 10bit
             planeConfig = SkYUVAInfo::PlaneConfig::kY_UV;
             rowbyte[CHANNEL_UV1] = planesInfo->planes[CHANNEL_UV1].columnStride;
             pixmapAddr[CHANNEL_UV1] = pixmapAddr[CHANNEL_Y] +
@@ -125,6 +258,7 @@ int ConfigYUVFormat(const sptr<SurfaceBuffer>& buffer, SkYUVAInfo::PlaneConfig&
             numPlanes = CHANNEL_NUM_NV12_NV21;
             break;
         case OHOS::GRAPHIC_PIXEL_FMT_YCRCB_420_SP: // NV21
+        case OHOS::GRAPHIC_PIXEL_FMT_YCRCB_P010:   // NV21 10bit
             planeConfig = SkYUVAInfo::PlaneConfig::kY_VU;
             rowbyte[CHANNEL_UV1] = planesInfo->planes[CHANNEL_UV2].columnStride;
             pixmapAddr[CHANNEL_UV1] = pixmapAddr[CHANNEL_Y] +
@@ -196,7 +330,10 @@ int CreateYUVPixmap(const sptr<SurfaceBuffer>& buffer, std::array<SkPixmap, SkYU
     int numPlanes = ConfigYUVFormat(buffer, planeConfig, rowbyte, pixmapAddr);
 
     const SkYUVAInfo yuvInfo = SkYUVAInfo(imageSize, planeConfig, subsampling, yuvColorSpace);
-    const SkYUVAPixmapInfo pixmapInfo = SkYUVAPixmapInfo(yuvInfo, SkYUVAPixmapInfo::DataType::kUnorm8, rowbyte);
+    // P010 keeps 10 bits in the high bits of 16-bit samples, so it is scaled as 16-bit unorm planes.
+    // The filters may leave the low 6 bits nonzero, which the P010 readers ignore.
+    auto dataType = Is10BitYUV(buffer) ? SkYUVAPixmapInfo::DataType::kUnorm16 : SkYUVAPixmapInfo::DataType::kUnorm8;
+    const SkYUVAPixmapInfo pixmapInfo = SkYUVAPixmapInfo(yuvInfo, dataType, rowbyte);
 
     for (int i = 0; i < numPlanes; i++) {
         pixmaps[i].reset(pixmapInfo.planeInfo(i), pixmapAddr[i], rowbyte[i]);
@@ -204,19 +341,8 @@ int CreateYUVPixmap(const sptr<SurfaceBuffer>& buffer, std::array<SkPixmap, SkYU
     return numPlanes;
 }
 
-VPEAlgoErrCode YUVPixmapScale(const std::array<SkPixmap, SkYUVAInfo::kMaxPlanes>& inputPixmap,
-    std::array<SkPixmap, SkYUVAInfo::kMaxPlanes>& outputPixmap, SkSamplingOptions opt, int numPlanes)
-{
-    for (int i = 0; i < numPlanes; i++) {
-        if (!inputPixmap[i].scalePixels(outputPixmap[i], opt)) {
-            VPE_LOGE("YUV scale failed!");
-            return VPE_ALGO_ERR_EXTENSION_PROCESS_FAILED;
-        }
-    }
-    return VPE_ALGO_ERR_OK;
-}
-
-VPEAlgoErrCode YUVScale(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output)
+VPEAlgoErrCode YUVScale(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuffer>& output,
+    const SkSamplingOptions& scaleOption, uint32_t workerNum)
 {
     std::array<SkPixmap, SkYUVAInfo::kMaxPlanes> inputPixmap;
     std::array<SkPixmap, SkYUVAInfo::kMaxPlanes> outputPixmap;
@@ -226,8 +352,7 @@ VPEAlgoErrCode YUVScale(const sptr<SurfaceBuffer>& input, const sptr<SurfaceBuff
         VPE_LOGE("Wrong YUV settings!");
         return VPE_ALGO_ERR_INVALID_VAL;
     }
-    SkSamplingOptions scaleOption(SkFilterMode::kNearest);
-    return YUVPixmapScale(inputPixmap, outputPixmap, scaleOption, numPlanesInput);
+    return PixmapScale(inputPixmap, outputPixmap, scaleOption, numPlanesInput, workerNum);
 }
 
 constexpr Extension::Rank RANK = Extension::Rank::RANK_DEFAULT;
@@ -239,6 +364,16 @@ std::unique_ptr<DetailEnhancerBase> Skia::Create()
     return std::make_unique<Skia>();
 }
 
+void Skia::SetWorkerNum(uint32_t workerNum)
+{
+    workerNum_ = std::max(workerNum, 1u);
+}
+
+uint32_t Skia::GetWorkerNum() const
+{
+    return workerNum_.load();
+}
+
 DetailEnhancerCapability Skia::BuildCapabilities()
 {
     std::vector<uint32_t> levels = { DETAIL_ENH_LEVEL_NONE, DETAIL_ENH_LEVEL_LOW, DETAIL_ENH_LEVEL_MEDIUM,
@@ -257,8 +392,9 @@ VPEAlgoErrCode Skia::Deinit()
     return VPE_ALGO_ERR_OK;
 }
 
-VPEAlgoErrCode Skia::SetParameter([[maybe_unused]] const DetailEnhancerParameters& parameter)
+VPEAlgoErrCode Skia::SetParameter(const DetailEnhancerParameters& parameter)
 {
+    samplingOptions_ = GetSamplingOptions(parameter.level);
     return VPE_ALGO_ERR_OK;
 }
 
@@ -277,9 +413,12 @@ VPEAlgoErrCode Skia::Process(const sptr<SurfaceBuffer>& input, const sptr<Surfac
     VPEAlgoErrCode errCode;
     ImageFormatType imageType = GetImageType(input, output);
     if (imageType == IMAGE_FORMAT_TYPE_RGB) {
-        errCode = RGBScale(input, output);
+        errCode = RGBScale(input, output, samplingOptions_, workerNum_.load());
     } else if (imageType == IMAGE_FORMAT_TYPE_YUV) {
-        errCode = YUVScale(input, output);
+        errCode = YUVScale(input, output, samplingOptions_, workerNum_.load());
+    } else if (imageType == IMAGE_FORMAT_TYPE_CONVERT) {
+        // Skia has no raster path which writes YUV, so the conversion uses its own bilinear kernels.
+        errCode = ConvertScale(input, output, workerNum_.load());
     } else {
         VPE_LOGE("Unknown image format!");
         errCode = VPE_ALGO_ERR_INVALID_VAL;
@@ -302,6 +302,27 @@ std::unique_ptr<PixelMap> VpeNapi::CreateDstPixelMap(PixelMap& source, const Ini
     return dstPixelMap;
 }
 
+static GraphicPixelFormat GetSurfaceBufferFormat(PixelFormat format)
+{
+    switch (format) {
+        case PixelFormat::BGRA_8888:
+            return GraphicPixelFormat::GRAPHIC_PIXEL_FMT_BGRA_8888;
+        case PixelFormat::RGBA_1010102:
+            return GraphicPixelFormat::GRAPHIC_PIXEL_FMT_RGBA_1010102;
+        case PixelFormat::YCBCR_P010:
+            return GraphicPixelFormat::GRAPHIC_PIXEL_FMT_YCBCR_P010;
+        case PixelFormat::YCRCB_P010:
+            return GraphicPixelFormat::GRAPHIC_PIXEL_FMT_YCRCB_P010;
+        default:
+            return GraphicPixelFormat::GRAPHIC_PIXEL_FMT_RGBA_8888;
+    }
+}
+
+static bool IsP010(PixelFormat format)
+{
+    return format == PixelFormat::YCBCR_P010 || format == PixelFormat::YCRCB_P010;
+}
+
 bool VpeNapi::ConvertPixelmapToSurfaceBuffer(const std::shared_ptr<OHOS::Media::PixelMap>& pixelmap,
     sptr<SurfaceBuffer>& bufferImpl)
 {
@@ -310,7 +331,7 @@ bool VpeNapi::ConvertPixelmapToSurfaceBuffer(const std::shared_ptr<OHOS::Media::
     bfConfig.height = pixelmap->GetHeight();
     bfConfig.usage = BUFFER_USAGE_CPU_READ | BUFFER_USAGE_CPU_WRITE | BUFFER_USAGE_MEM_DMA | BUFFER_USAGE_MEM_MMZ_CACHE;
     bfConfig.strideAlignment = bfConfig.width;
-    bfConfig.format = GraphicPixelFormat::GRAPHIC_PIXEL_FMT_RGBA_8888;
+    bfConfig.format = GetSurfaceBufferFormat(pixelmap->GetPixelFormat());
     bfConfig.timeout = 0;
     bfConfig.colorGamut = GraphicColorGamut::GRAPHIC_COLOR_GAMUT_SRGB;
     bfConfig.transform = GraphicTransformType::GRAPHIC_ROTATE_NONE;
@@ -369,11 +390,20 @@ std::shared_ptr<PixelMap> VpeNapi::PrepareDstPixelMap(napi_env env, DetailEnhanc
     VPE_LOGD("res:w %{public}d, h %{public}d, -> w %{public}d, h %{public}d",
         context->inputPixelMap->GetWidth(), context->inputPixelMap->GetHeight(),
         static_cast<int>(context->xArg), static_cast<int>(context->yArg));
-    std::unique_ptr<PixelMap> outputPtr = context->inputPixelMap->Create(*context->inputPixelMap, opts);
+    // The P010 output must share a DMA buffer of the same format, the default pixel map is heap-backed.
+    bool isP010 = IsP010(context->inputPixelMap->GetPixelFormat());
+    std::unique_ptr<PixelMap> outputPtr = isP010 ? CreateDstPixelMap(*context->inputPixelMap, opts) :
+        context->inputPixelMap->Create(*context->inputPixelMap, opts);
     if (outputPtr == nullptr) {
         ThrowExceptionError(env, IMAGE_PROCESSING_ERROR_INVALID_VALUE, "create failed");
         return nullptr;
     }
+    if (isP010 && (outputPtr->GetAllocatorType() != AllocatorType::DMA_ALLOC ||
+        outputPtr->GetPixelFormat() != context->inputPixelMap->GetPixelFormat())) {
+        VPE_LOGE("the P010 output is not a DMA pixel map of the same format");
+        ThrowExceptionError(env, IMAGE_PROCESSING_ERROR_INVALID_VALUE, "create failed");
+        return nullptr;
+    }
     std::shared_ptr<PixelMap> dstPixelMap{std::move(outputPtr)};
     return dstPixelMap;
 }
@@ -410,9 +440,10 @@ std::shared_ptr<PixelMap> VpeNapi::DetailEnhanceImpl(napi_env env, DetailEnhance
         VPE_LOGE("context == nullptr");
         return nullptr;
     }
-    if (context->inputPixelMap->GetPixelFormat() == PixelFormat::YCBCR_P010 ||
-        context->inputPixelMap->GetPixelFormat() == PixelFormat::YCRCB_P010) {
-        VPE_LOGI("not support P010");
+    // Only the DMA pixel maps share their buffer, the P010 planes can not be copied to a new one.
+    if (IsP010(context->inputPixelMap->GetPixelFormat()) &&
+        context->inputPixelMap->GetAllocatorType() != AllocatorType::DMA_ALLOC) {
+        VPE_LOGI("not support P010 without DMA");
         return context->inputPixelMap;
     }
     if (!InitDetailAlgo(env)) {
@@ -194,6 +194,78 @@ enum DetailEnhancerQualityLevel {
     DETAIL_ENHANCER_LEVEL_HIGH,
 };
 
+/**
+ * @brief The action on the frame which misses its deadline.
+ *
+ * It is the value of the key parameter {@link ParameterKey::VIDEO_LATE_FRAME_ACTION}.
+ *
+ * @see VpeVideo::SetParameter
+ * @see VpeVideo::GetParameter
+ * @since 6.0
+ */
+enum VpeLateFrameAction {
+    /**
+     * Copy the input frame to the output surface without processing. The frame is dropped if the input and output
+     * buffers differ in format or size. It's the default action
+     */
+    VPE_LATE_FRAME_BYPASS = 0,
+    /** Drop the input frame */
+    VPE_LATE_FRAME_DROP,
+};
+
+/**
+ * @brief Histogram of the durations of a video processing stage.
+ *
+ * The durations in bucket i are less than 2^i milliseconds, except that the last bucket counts all the longer ones.
+ *
+ * @see VpeVideoStatistics
+ * @since 6.0
+ */
+struct VpeDurationHistogram {
+    static constexpr uint32_t BUCKET_COUNT = 8;
+    /** Number of durations in each bucket */
+    uint64_t buckets[BUCKET_COUNT]{};
+    /** Number of durations */
+    uint64_t count{};
+    /** Sum of the durations in microseconds */
+    uint64_t totalUs{};
+    /** The longest duration in microseconds */
+    uint64_t maxUs{};
+};
+
+/**
+ * @brief Latency and throughput statistics of a video processing object since it is created.
+ *
+ * It is the value of the key parameter {@link ParameterKey::VIDEO_STATISTICS}.
+ *
+ * @see VpeVideo::GetParameter
+ * @since 6.0
+ */
+struct VpeVideoStatistics {
+    /** Time from the input buffer being acquired to the start of its processing */
+    VpeDurationHistogram inputWait{};
+    /** Time to process one frame */
+    VpeDurationHistogram process{};
+    /** Time from {@link VpeVideoCallback::OnOutputBufferAvailable} to the output buffer being rendered */
+    VpeDurationHistogram render{};
+    /** Number of input buffers waiting to be processed */
+    uint32_t inputQueueDepth{};
+    /** Number of free output buffers */
+    uint32_t outputQueueDepth{};
+    /** Number of output buffers waiting to be rendered or released */
+    uint32_t renderQueueDepth{};
+    /** Number of frames sent by {@link VpeVideoCallback::OnOutputBufferAvailable} */
+    uint64_t outputFrames{};
+    /** Number of frames failed to be processed or released without rendering */
+    uint64_t droppedFrames{};
+    /** Number of frames sent without processing because the feature is disabled */
+    uint64_t bypassedFrames{};
+    /** Output frame rate of the last second */
+    double fps{};
+    /** Number of times the buffer engine waited for one of its internal locks held by another thread */
+    uint64_t lockContentions{};
+};
+
 /**
  * @brief Contains the key corresponding to each paramter value.
  *
@@ -250,6 +322,92 @@ public:
      */
     static constexpr std::string_view DETAIL_ENHANCER_NODE_ID{"NodeId"};
 
+    /**
+     * @brief The key is used to specify the maximum number of processed frames waiting to be output.
+     *
+     * The value ranges from 1 to 3 and the default value is 1, which means frames are received, processed and output
+     * one at a time. A greater value allows the next frame to be received and the previous frames to be output while
+     * a frame is being processed.
+     * Use {@link VpeVideo::SetParameter} and {@link Format::SetIntValue} to set the pipeline depth.
+     * Use {@link VpeVideo::GetParameter} and {@link Format::GetIntValue} to get the current pipeline depth.
+     *
+     * @since 6.0
+     */
+    static constexpr std::string_view VIDEO_PIPELINE_DEPTH{"PipelineDepth"};
+
+    /**
+     * @brief The key is used to specify whether adapt the queue size of the output surface or not.
+     * Default value is 0.
+     *
+     * 0 means the queue size is fixed. 1 means the queue size starts shallow for low latency and grows when the
+     * processing is stalled because there is no free output buffer, see {@link VIDEO_BUFFER_MEMORY_LIMIT}.
+     * It takes effect on the output surface set after it.
+     * Use {@link VpeVideo::SetParameter} and {@link Format::SetIntValue} to set whether adapt the queue size or not.
+     * Use {@link VpeVideo::GetParameter} and {@link Format::GetIntValue} to get whether adapt the queue size or not.
+     *
+     * @since 6.0
+     */
+    static constexpr std::string_view VIDEO_ADAPTIVE_QUEUE_SIZE{"AdaptiveQueueSize"};
+
+    /**
+     * @brief The key is used to specify the limit of the total memory of output buffers in bytes when the queue size
+     * of the output surface is adaptive. Default value is 0, which means no limit.
+     *
+     * Use {@link VpeVideo::SetParameter} and {@link Format::SetLongValue} to set the memory limit.
+     * Use {@link VpeVideo::GetParameter} and {@link Format::GetLongValue} to get the current memory limit.
+     *
+     * @since 6.0
+     */
+    static constexpr std::string_view VIDEO_BUFFER_MEMORY_LIMIT{"BufferMemoryLimit"};
+
+    /**
+     * @brief The key is used to get the latency and throughput statistics. It is read-only.
+     *
+     * See {@link VpeVideoStatistics} for its values.
+     * Use {@link VpeVideo::GetParameter} and {@link Format::GetBuffer} to get the current statistics.
+     *
+     * @since 6.0
+     */
+    static constexpr std::string_view VIDEO_STATISTICS{"Statistics"};
+
+    /**
+     * @brief The key is used to specify the latency budget of a frame in milliseconds.
+     *
+     * The value ranges from 0 to 1000 and the default value is 0, which means no deadline.
+     * A frame misses its deadline if it waits in the input queue and then takes the recent processing time longer
+     * than the budget. Such frame is handled by {@link VIDEO_LATE_FRAME_ACTION} instead of being processed.
+     * Use {@link VpeVideo::SetParameter} and {@link Format::SetIntValue} to set the latency budget.
+     * Use {@link VpeVideo::GetParameter} and {@link Format::GetIntValue} to get the current latency budget.
+     *
+     * @since 6.0
+     */
+    static constexpr std::string_view VIDEO_LATENCY_BUDGET{"LatencyBudget"};
+
+    /**
+     * @brief The key is used to specify the action on the frame which misses its deadline.
+     *
+     * See {@link VpeLateFrameAction} for its values.
+     * Use {@link VpeVideo::SetParameter} and {@link Format::SetIntValue} to set the action.
+     * Use {@link VpeVideo::GetParameter} and {@link Format::GetIntValue} to get the current action.
+     *
+     * @since 6.0
+     */
+    static constexpr std::string_view VIDEO_LATE_FRAME_ACTION{"LateFrameAction"};
+
+    /**
+     * @brief The key is used to specify whether {@link VpeVideo::Enable} and {@link VpeVideo::Disable} switch
+     * seamlessly or not. Default value is 0.
+     *
+     * 0 means the output buffers are reallocated when the processing is enabled again. 1 means the processed output
+     * buffers replaced by the input buffers during bypass are kept, and they are put back to the output surface on
+     * enable, so toggling frequently has no allocation and no frame gap at the cost of keeping both sets of buffers.
+     * Use {@link VpeVideo::SetParameter} and {@link Format::SetIntValue} to set whether switch seamlessly or not.
+     * Use {@link VpeVideo::GetParameter} and {@link Format::GetIntValue} to get whether switch seamlessly or not.
+     *
+     * @since 6.0
+     */
+    static constexpr std::string_view VIDEO_SEAMLESS_TOGGLE{"SeamlessToggle"};
+
 private:
     ParameterKey() = delete;
     ~ParameterKey() = delete;
@@ -19,6 +19,8 @@
 #include <atomic>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 #include "external_window.h"
 #include "algorithm_common.h"
 
@@ -107,6 +109,19 @@ public:
     virtual VPEAlgoErrCode DecomposeImage(const sptr<SurfaceBuffer> &inputImage,
         const sptr<SurfaceBuffer> &outputSdrImage, const sptr<SurfaceBuffer> &outputGainmap) = 0;
 
+    /* *
+     * @brief 批量转换多组图片，与逐个调用Process的结果相同。色彩空间和像素格式相同的图片
+     * 共用一次算法查找和参数设置。
+     * 默认实现逐个调用Process。
+     * @syscap
+     * @param images 输入和输出图片对
+     * @param results 输出每组图片的错误码，与images一一对应
+     * @return 全部成功返回VPE_ALGO_ERR_OK，否则返回第一个失败的错误码
+     * @since 6.0
+     */
+    virtual VPEAlgoErrCode ProcessBatch(const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>> &images,
+        std::vector<VPEAlgoErrCode> &results);
+
 protected:
     virtual ~ColorSpaceConverter() = default;
 };
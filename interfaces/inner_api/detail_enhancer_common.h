@@ -16,6 +16,7 @@
 #ifndef DETAIL_ENHANCER_COMMON_H
 #define DETAIL_ENHANCER_COMMON_H
 
+#include <cstdint>
 #include <string>
 
 namespace OHOS {
@@ -42,6 +43,9 @@ struct DetailEnhancerParameters {
     std::string uri{};
     DetailEnhancerLevel level{DETAIL_ENH_LEVEL_LOW};
     int contentId;
+    // The memory in bytes which an image Process may use besides the input and output, 0 means no limit.
+    // A larger image is processed in overlapping tiles.
+    uint64_t memoryBudget{};
 };
 } // namespace VideoProcessingEngine
 } // namespace Media
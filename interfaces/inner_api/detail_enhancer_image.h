@@ -17,6 +17,8 @@
 #define INTERFACES_INNER_API_VPE_DETAIL_ENHANCER_IMAGE_H
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "algorithm_errors.h"
 #include "detail_enhancer_common.h"
@@ -78,6 +80,19 @@ public:
     virtual VPEAlgoErrCode EnableProtection(bool enable) = 0;
     virtual VPEAlgoErrCode ResetProtectionStatus() = 0;
 
+    /**
+     * @brief 批量处理多组图片，与逐个调用Process的结果相同。尺寸和格式相同的图片共用一次校验和
+     * 算法选择，软件缩放的图片会并行处理。
+     * 默认实现逐个调用Process。
+     * @syscap
+     * @param images 输入和输出图片对
+     * @param results 输出每组图片的错误码，与images一一对应
+     * @return 全部成功返回VPE_ALGO_ERR_OK，否则返回第一个失败的错误码
+     * @since 6.0
+     */
+    virtual VPEAlgoErrCode ProcessBatch(const std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>>& images,
+        std::vector<VPEAlgoErrCode>& results);
+
 protected:
     DetailEnhancerImage() = default;
     virtual ~DetailEnhancerImage() = default;
@@ -88,6 +103,8 @@ protected:
 };
 
 extern "C" __attribute__((visibility("default"))) int32_t DetailEnhancerCreate(int32_t* instance);
+// Unlike DetailEnhancerCreate, every call creates an instance of its own, so the callers process concurrently.
+extern "C" __attribute__((visibility("default"))) int32_t DetailEnhancerCreateExclusive(int32_t* instance);
 extern "C" __attribute__((visibility("default"))) int32_t DetailEnhancerProcessImage(int32_t instance,
     OHNativeWindowBuffer* inputImage, OHNativeWindowBuffer* outputImage, int32_t level);
 extern "C" __attribute__((visibility("default"))) int32_t DetailEnhancerDestroy(int32_t* instance);
@@ -14,8 +14,11 @@
  */
 
 #include <gtest/gtest.h>
+#include <cstring>
 #include <fstream>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "csc_sample.h"
 #include "csc_sample_define.h"
 #include "refbase.h"
@@ -206,6 +209,90 @@ HWTEST_F(CSCModuleTest, Process_0404, TestSize.Level1)
     ASSERT_EQ(VPE_ALGO_ERR_OK, ret);
 }
 
+/**
+ * @tc.number    : 0405
+ * @tc.func      : ProcessBatch
+ * @tc.desc      : Call after SetParameter, the null pair fails and the others succeed
+ */
+HWTEST_F(CSCModuleTest, ProcessBatch_0405, TestSize.Level1)
+{
+    auto plugin = ColorSpaceConverter::Create();
+    ASSERT_NE(nullptr, plugin);
+
+    SetParameter(plugin);
+
+    constexpr size_t validNum = 2;
+    std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>> images;
+    for (size_t i = 0; i < validNum; i++) {
+        auto input = PrepareOneFrame();
+        ASSERT_NE(nullptr, input);
+        auto output = CreateSurfaceBuffer(OUTPUT_PIXEL_FORMAT, WIDTH, HEIGHT);
+        ASSERT_NE(nullptr, output);
+        SetMeatadata(output, OUTPUT_COLORSPACE_INFO);
+        images.emplace_back(input, output);
+    }
+    images.emplace_back(nullptr, nullptr);
+
+    std::vector<VPEAlgoErrCode> results;
+    int32_t ret = plugin->ProcessBatch(images, results);
+    ASSERT_NE(VPE_ALGO_ERR_OK, ret);
+    ASSERT_EQ(images.size(), results.size());
+    for (size_t i = 0; i < validNum; i++) {
+        ASSERT_EQ(VPE_ALGO_ERR_OK, results[i]);
+    }
+    ASSERT_NE(VPE_ALGO_ERR_OK, results[validNum]);
+}
+
+/**
+ * @tc.number    : 0406
+ * @tc.func      : ProcessBatch
+ * @tc.desc      : Interleave two conversions with null pairs, the results are the same as calling Process one by one
+ */
+HWTEST_F(CSCModuleTest, ProcessBatch_0406, TestSize.Level1)
+{
+    auto plugin = ColorSpaceConverter::Create();
+    ASSERT_NE(nullptr, plugin);
+    SetParameter(plugin);
+    auto reference = ColorSpaceConverter::Create();
+    ASSERT_NE(nullptr, reference);
+    SetParameter(reference);
+
+    auto input = PrepareOneFrame();
+    ASSERT_NE(nullptr, input);
+    const std::vector<int32_t> outputFormats = { OUTPUT_PIXEL_FORMAT, GRAPHIC_PIXEL_FMT_RGBA_8888,
+        OUTPUT_PIXEL_FORMAT, GRAPHIC_PIXEL_FMT_RGBA_8888 };
+    std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>> images;
+    std::vector<sptr<SurfaceBuffer>> expectedOutputs;
+    std::vector<VPEAlgoErrCode> expectedResults;
+    for (auto format : outputFormats) {
+        auto output = CreateSurfaceBuffer(format, WIDTH, HEIGHT);
+        ASSERT_NE(nullptr, output);
+        SetMeatadata(output, OUTPUT_COLORSPACE_INFO);
+        auto expectedOutput = CreateSurfaceBuffer(format, WIDTH, HEIGHT);
+        ASSERT_NE(nullptr, expectedOutput);
+        SetMeatadata(expectedOutput, OUTPUT_COLORSPACE_INFO);
+        images.emplace_back(input, output);
+        expectedOutputs.push_back(expectedOutput);
+        expectedResults.push_back(reference->Process(input, expectedOutput));
+        // Put a null pair or a pair without the output after each pair.
+        images.emplace_back((images.size() % 4 == 1) ? nullptr : input, nullptr); // 4: every other null pair
+        expectedOutputs.push_back(nullptr);
+        expectedResults.push_back(VPE_ALGO_ERR_INVALID_VAL);
+    }
+
+    std::vector<VPEAlgoErrCode> results;
+    int32_t ret = plugin->ProcessBatch(images, results);
+    ASSERT_NE(VPE_ALGO_ERR_OK, ret);
+    ASSERT_EQ(images.size(), results.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        ASSERT_EQ(expectedResults[i], results[i]);
+        if (results[i] == VPE_ALGO_ERR_OK) {
+            ASSERT_EQ(0, memcmp(expectedOutputs[i]->GetVirAddr(), images[i].second->GetVirAddr(),
+                expectedOutputs[i]->GetSize()));
+        }
+    }
+}
+
 /**
  * @tc.number    : 0501
  * @tc.func      : ComposeImage
@@ -13,13 +13,18 @@
  * limitations under the License.
  */
  
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstdio>
 #include <ctime>
 #include <dlfcn.h>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
  
 #include "algorithm_common.h"
@@ -27,6 +32,9 @@
 #include "colorspace_converter_video_impl.h"
 #include "colorspace_converter_video.h"
 #include "colorspace_converter_video_description.h"
+#include "detail_enhancer_video_fwk.h"
+#include "meta/meta_key.h"
+#include "vpe_video_pipeline.h"
  
 using namespace std;
 using namespace testing::ext;
@@ -53,6 +61,158 @@ struct CallbackT : public ColorSpaceConverterVideoCallback {
     }
 };
  
+// Record the EOS buffer, so the test releases it on its own thread.
+class EosCallback : public ColorSpaceConverterVideoCallback {
+public:
+    void OnError(int32_t errorCode) override
+    {
+        (void)errorCode;
+    }
+
+    void OnState(int32_t state) override
+    {
+        (void)state;
+    }
+
+    void OnOutputBufferAvailable(uint32_t index, CscvBufferFlag flag) override
+    {
+        if (flag != CSCV_BUFFER_FLAG_EOS) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(lock_);
+        eosIndex_ = index;
+        isEos_ = true;
+        cv_.notify_all();
+    }
+
+    void OnOutputFormatChanged(const Format& format) override
+    {
+        (void)format;
+    }
+
+    bool WaitForEos(uint32_t& index)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        if (!cv_.wait_for(lock, std::chrono::seconds(1), [this] { return isEos_; })) {
+            return false;
+        }
+        index = eosIndex_;
+        return true;
+    }
+
+private:
+    std::mutex lock_;
+    std::condition_variable cv_;
+    bool isEos_{false};
+    uint32_t eosIndex_{0};
+};
+
+// Count the buffers flushed to the output surface.
+class FlushCounter : public IBufferConsumerListener {
+public:
+    explicit FlushCounter(std::atomic<int32_t>& count) : count_(count) {}
+
+    void OnBufferAvailable() override
+    {
+        count_++;
+    }
+
+private:
+    std::atomic<int32_t>& count_;
+};
+
+// Record the output formats of a pipeline and render its output buffers.
+class PipelineRecorder : public VpeVideoCallback {
+public:
+    void SetVideo(const std::shared_ptr<VpeVideo>& video)
+    {
+        video_ = video;
+    }
+
+    void OnOutputFormatChanged(const Format& format) final
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        formats_.push_back(format);
+    }
+
+    void OnOutputBufferAvailable(uint32_t index, const VpeBufferInfo& info) final
+    {
+        auto video = video_.lock();
+        if (video != nullptr) {
+            video->ReleaseOutputBuffer(index, info.flag != VPE_BUFFER_FLAG_EOS);
+        }
+    }
+
+    std::vector<Format> GetFormats()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return formats_;
+    }
+
+private:
+    std::weak_ptr<VpeVideo> video_;
+    std::mutex lock_;
+    std::vector<Format> formats_;
+};
+
+// Acquire the frames flushed to the output surface and record their sizes and formats.
+class FrameSink : public IBufferConsumerListener {
+public:
+    struct Frame {
+        int32_t width;
+        int32_t height;
+        int32_t format;
+    };
+
+    explicit FrameSink(const sptr<Surface>& consumer) : consumer_(consumer) {}
+
+    void OnBufferAvailable() override
+    {
+        sptr<SurfaceBuffer> buffer;
+        sptr<SyncFence> fence;
+        int64_t timestamp = 0;
+        Rect damage{};
+        if (consumer_->AcquireBuffer(buffer, fence, timestamp, damage) != GSERROR_OK || buffer == nullptr) {
+            return;
+        }
+        Frame frame{ buffer->GetWidth(), buffer->GetHeight(), buffer->GetFormat() };
+        consumer_->ReleaseBuffer(buffer, -1);
+        std::lock_guard<std::mutex> lock(lock_);
+        frames_.push_back(frame);
+        cv_.notify_all();
+    }
+
+    bool WaitFrames(size_t frameNum)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        return cv_.wait_for(lock, std::chrono::seconds(1), [this, frameNum] { return frames_.size() >= frameNum; });
+    }
+
+    std::vector<Frame> GetFrames()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return frames_;
+    }
+
+private:
+    sptr<Surface> consumer_;
+    std::mutex lock_;
+    std::condition_variable cv_;
+    std::vector<Frame> frames_;
+};
+
+Format GetDefaultConfiguration()
+{
+    Format parameter;
+    parameter.PutIntValue(CscVDescriptionKey::CSCV_KEY_PIXEL_FORMAT, GRAPHIC_PIXEL_FMT_YCBCR_420_SP);
+    parameter.PutIntValue(CscVDescriptionKey::CSCV_KEY_HDR_METADATA_TYPE, CM_METADATA_NONE);
+    parameter.PutIntValue(CscVDescriptionKey::CSCV_KEY_COLORSPACE_RANGE, RANGE_LIMITED);
+    parameter.PutIntValue(CscVDescriptionKey::CSCV_KEY_COLORSPACE_MATRIX, MATRIX_BT709);
+    parameter.PutIntValue(CscVDescriptionKey::CSCV_KEY_COLORSPACE_TRANS_FUNC, TRANSFUNC_BT709);
+    parameter.PutIntValue(CscVDescriptionKey::CSCV_KEY_COLORSPACE_PRIMARIES, COLORPRIMARIES_BT709);
+    return parameter;
+}
+
 class ColorSpaceConverterVideoUnitTest : public testing::Test {
 public:
     static void SetUpTestCase(void) {};
@@ -357,6 +517,142 @@ HWTEST_F(ColorSpaceConverterVideoUnitTest, cscv_flush_02, TestSize.Level1)
     EXPECT_NE(ret, VPE_ALGO_ERR_OK);
 }
 
+// the EOS buffer is not flushed to the output surface even if it is rendered
+HWTEST_F(ColorSpaceConverterVideoUnitTest, cscv_notifyEos_03, TestSize.Level1)
+{
+    std::atomic<int32_t> flushCount = 0;
+    auto consumer = Surface::CreateSurfaceAsConsumer("CscvTestSink");
+    ASSERT_NE(consumer, nullptr);
+    sptr<IBufferConsumerListener> listener = new FlushCounter(flushCount);
+    EXPECT_EQ(consumer->RegisterConsumerListener(listener), GSERROR_OK);
+    sptr<IBufferProducer> producer = consumer->GetProducer();
+    auto output = Surface::CreateSurfaceAsProducer(producer);
+
+    auto csc = ColorSpaceConverterVideo::Create();
+    ASSERT_NE(csc, nullptr);
+    auto cb = std::make_shared<EosCallback>();
+    EXPECT_EQ(csc->SetCallback(cb), VPE_ALGO_ERR_OK);
+    EXPECT_NE(csc->CreateInputSurface(), nullptr);
+    EXPECT_EQ(csc->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Configure(GetDefaultConfiguration()), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Prepare(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Start(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->NotifyEos(), VPE_ALGO_ERR_OK);
+    uint32_t index = 0;
+    ASSERT_EQ(cb->WaitForEos(index), true);
+    EXPECT_EQ(csc->ReleaseOutputBuffer(index, true), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Release(), VPE_ALGO_ERR_OK);
+    consumer->UnregisterConsumerListener();
+    EXPECT_EQ(flushCount.load(), 0);
+}
+
+// the converter can be configured and started again after reset
+HWTEST_F(ColorSpaceConverterVideoUnitTest, cscv_reset_03, TestSize.Level1)
+{
+    auto consumer = Surface::CreateSurfaceAsConsumer("CscvTestSink");
+    ASSERT_NE(consumer, nullptr);
+    sptr<IBufferProducer> producer = consumer->GetProducer();
+    auto output = Surface::CreateSurfaceAsProducer(producer);
+
+    auto csc = ColorSpaceConverterVideo::Create();
+    ASSERT_NE(csc, nullptr);
+    auto cb = std::make_shared<EosCallback>();
+    EXPECT_EQ(csc->SetCallback(cb), VPE_ALGO_ERR_OK);
+    EXPECT_NE(csc->CreateInputSurface(), nullptr);
+    EXPECT_EQ(csc->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Configure(GetDefaultConfiguration()), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Prepare(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Start(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Reset(), VPE_ALGO_ERR_OK);
+    EXPECT_NE(csc->Start(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->SetCallback(cb), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Configure(GetDefaultConfiguration()), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Prepare(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Start(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Release(), VPE_ALGO_ERR_OK);
+}
+
+// chain the converter and the detail enhancer, the output format is reported by the last stage only
+HWTEST_F(ColorSpaceConverterVideoUnitTest, cscv_pipeline_01, TestSize.Level1)
+{
+    constexpr int32_t inputWidth = 1280;
+    constexpr int32_t inputHeight = 720;
+    constexpr uint32_t frameNum = 5;
+    VpeBufferSize targetSize{ 640, 360 };
+
+    auto consumer = Surface::CreateSurfaceAsConsumer("CscvTestSink");
+    ASSERT_NE(consumer, nullptr);
+    sptr<FrameSink> sink = new FrameSink(consumer);
+    sptr<IBufferConsumerListener> listener = sink;
+    EXPECT_EQ(consumer->RegisterConsumerListener(listener), GSERROR_OK);
+    sptr<IBufferProducer> producer = consumer->GetProducer();
+    auto output = Surface::CreateSurfaceAsProducer(producer);
+
+    auto csc = std::make_shared<ColorSpaceConverterVideoImpl>();
+    ASSERT_EQ(csc->Init(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Configure(GetDefaultConfiguration()), VPE_ALGO_ERR_OK);
+    auto detailEnh = DetailEnhancerVideoFwk::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    Format parameter;
+    EXPECT_EQ(parameter.PutBuffer(ParameterKey::DETAIL_ENHANCER_TARGET_SIZE,
+        reinterpret_cast<uint8_t*>(&targetSize), sizeof(targetSize)), true);
+    EXPECT_EQ(detailEnh->SetParameter(parameter), VPE_ALGO_ERR_OK);
+    auto pipeline = VpeVideoPipeline::Create({ csc->GetPipelineStage(), detailEnh });
+    ASSERT_NE(pipeline, nullptr);
+    auto recorder = std::make_shared<PipelineRecorder>();
+    recorder->SetVideo(pipeline);
+    EXPECT_EQ(pipeline->RegisterCallback(recorder), VPE_ALGO_ERR_OK);
+    auto input = pipeline->GetInputSurface();
+    ASSERT_NE(input, nullptr);
+    EXPECT_EQ(pipeline->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(pipeline->Start(), VPE_ALGO_ERR_OK);
+
+    BufferRequestConfig requestCfg{};
+    requestCfg.width = inputWidth;
+    requestCfg.height = inputHeight;
+    requestCfg.format = GRAPHIC_PIXEL_FMT_YCBCR_420_SP;
+    requestCfg.usage = BUFFER_USAGE_CPU_READ | BUFFER_USAGE_CPU_WRITE | BUFFER_USAGE_MEM_DMA;
+    requestCfg.strideAlignment = 32; // 32 byte alignment
+    for (uint32_t i = 0; i < frameNum; i++) {
+        sptr<SurfaceBuffer> buffer;
+        sptr<SyncFence> fence;
+        ASSERT_EQ(input->RequestBuffer(buffer, fence, requestCfg), GSERROR_OK);
+        BufferFlushConfig flushCfg{};
+        flushCfg.damage.w = inputWidth;
+        flushCfg.damage.h = inputHeight;
+        flushCfg.timestamp = i;
+        ASSERT_EQ(input->FlushBuffer(buffer, -1, flushCfg), GSERROR_OK);
+    }
+    EXPECT_EQ(sink->WaitFrames(frameNum), true);
+    EXPECT_EQ(pipeline->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(pipeline->Release(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(csc->Release(), VPE_ALGO_ERR_OK);
+    consumer->UnregisterConsumerListener();
+
+    auto frames = sink->GetFrames();
+    EXPECT_EQ(frames.size(), frameNum);
+    for (const auto& frame : frames) {
+        EXPECT_EQ(frame.width, targetSize.width);
+        EXPECT_EQ(frame.height, targetSize.height);
+        EXPECT_EQ(frame.format, GRAPHIC_PIXEL_FMT_YCBCR_420_SP);
+    }
+    auto formats = recorder->GetFormats();
+    ASSERT_EQ(formats.empty(), false);
+    for (auto& format : formats) {
+        int32_t width = 0;
+        EXPECT_EQ(format.GetIntValue(Media::Tag::VIDEO_WIDTH, width), false);
+    }
+    uint8_t* addr = nullptr;
+    size_t addrSize = 0;
+    ASSERT_EQ(formats.back().GetBuffer(ParameterKey::DETAIL_ENHANCER_TARGET_SIZE, &addr, addrSize), true);
+    ASSERT_EQ(addrSize, sizeof(VpeBufferSize));
+    auto size = reinterpret_cast<VpeBufferSize*>(addr);
+    EXPECT_EQ(size->width, targetSize.width);
+    EXPECT_EQ(size->height, targetSize.height);
+}
+
 } // namespace VideoProcessingEngine
 } // namespace Media
 } // namespace OHOS
\ No newline at end of file
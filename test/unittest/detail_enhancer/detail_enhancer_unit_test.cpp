@@ -13,13 +13,19 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <dlfcn.h>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -28,7 +34,13 @@
 #include "graphic_common_c.h"
 #include "detailEnh_sample.h"
 #include "detailEnh_sample_define.h"
+#include "detail_enhancer_circuit_breaker.h"
 #include "detail_enhancer_image.h"
+#include "extension_instance_pool.h"
+#include "extension_manager.h"
+#ifdef SKIA_ENABLE
+#include "skia_impl.h"
+#endif
 
 using namespace std;
 using namespace testing::ext;
@@ -1395,6 +1407,554 @@ HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_60, TestSize.Level1)
     EXPECT_NE(ret, VPE_ALGO_ERR_OK);
 }
 
+// check extern c interface, process and destroy with a stale instance id
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_61, TestSize.Level1)
+{
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 4096, 3072);
+    auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 2048, 1536);
+    void* lib = dlopen("/system/lib64/libvideoprocessingengine.z.so", RTLD_LAZY);
+    if (lib == nullptr) {
+        printf("cannot load vpe lib\n");
+        return;
+    }
+
+    typedef int32_t (*DetailEnhancerCreate)(int32_t*);
+    typedef int32_t (*DetailEnhancerProcessImage)(int32_t,
+        OHNativeWindowBuffer*, OHNativeWindowBuffer*, int32_t);
+    typedef int32_t (*DetailEnhancerDestroy)(int32_t*);
+
+    auto detailEnhCreate = reinterpret_cast<DetailEnhancerCreate>(dlsym(lib, "DetailEnhancerCreate"));
+    auto detailEnhProcessImage =
+        reinterpret_cast<DetailEnhancerProcessImage>(dlsym(lib, "DetailEnhancerProcessImage"));
+    auto detailEnhDestroy = reinterpret_cast<DetailEnhancerDestroy>(dlsym(lib, "DetailEnhancerDestroy"));
+
+    int32_t instanceSrId = -1;
+    int32_t res = detailEnhCreate(&instanceSrId);
+    if (res != 0 || instanceSrId == -1 || input == nullptr || output == nullptr) {
+        detailEnhDestroy(&instanceSrId);
+        dlclose(lib);
+        return;
+    }
+    int32_t staleId = instanceSrId;
+    EXPECT_EQ(detailEnhDestroy(&instanceSrId), VPE_ALGO_ERR_OK);
+    int32_t newId = -1;
+    EXPECT_EQ(detailEnhCreate(&newId), VPE_ALGO_ERR_OK);
+    EXPECT_NE(newId, staleId);
+    OHNativeWindowBuffer* srIn = OH_NativeWindow_CreateNativeWindowBufferFromSurfaceBuffer(&input);
+    OHNativeWindowBuffer* srOut = OH_NativeWindow_CreateNativeWindowBufferFromSurfaceBuffer(&output);
+    EXPECT_NE(detailEnhProcessImage(staleId, srIn, srOut, static_cast<int>(DETAIL_ENH_LEVEL_HIGH)), VPE_ALGO_ERR_OK);
+    EXPECT_NE(detailEnhDestroy(&staleId), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnhDestroy(&newId), VPE_ALGO_ERR_OK);
+    dlclose(lib);
+}
+
+// process by short-lived objects one after another, the later ones reuse the pooled algorithms,
+// and the pooled algorithms are dropped when the extension ranks change
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_62, TestSize.Level1)
+{
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_MEDIUM,
+    };
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 1024, 768);
+    auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 2048, 1536);
+    for (int i = 0; i < 3; i++) { // 3: create and destroy several times
+        auto detailEnh = DetailEnhancerImage::Create();
+        ASSERT_NE(detailEnh, nullptr);
+        EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+    }
+
+    auto& manager = Extension::ExtensionManager::GetInstance();
+    Extension::ExtensionInstancePool<int, DetailEnhancerBase> pool(1);
+    int createdNum = 0;
+    auto creator = [&manager, &createdNum]() {
+        createdNum++;
+        return manager.CreateDetailEnhancer(DETAIL_ENH_LEVEL_MEDIUM);
+    };
+    auto algo = pool.Acquire(DETAIL_ENH_LEVEL_MEDIUM, creator);
+    ASSERT_NE(algo, nullptr);
+    auto pooledAlgo = algo.get();
+    pool.Release(DETAIL_ENH_LEVEL_MEDIUM, std::move(algo));
+    algo = pool.Acquire(DETAIL_ENH_LEVEL_MEDIUM, creator);
+    EXPECT_EQ(algo.get(), pooledAlgo);
+    EXPECT_EQ(createdNum, 1);
+    pool.Release(DETAIL_ENH_LEVEL_MEDIUM, std::move(algo));
+
+    const std::string path = "/data/test/media/vpe_pool_rank.txt";
+    Extension::ExtensionRankCalibration calibration;
+    calibration.Record("DetailEnhancer/level=0", 0, "pool_test", 1); // 0: a level the test never processes
+    ASSERT_EQ(calibration.Save(path), VPE_ALGO_ERR_OK);
+    ASSERT_EQ(manager.LoadExtensionRanks(path), VPE_ALGO_ERR_OK);
+    algo = pool.Acquire(DETAIL_ENH_LEVEL_MEDIUM, creator);
+    EXPECT_NE(algo, nullptr);
+    EXPECT_EQ(createdNum, 2); // 2: created again after the ranks change
+}
+
+// calibrate the extension ranks, then process by the extension ranked for the resolution of the frame
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_63, TestSize.Level1)
+{
+    const std::string path = "/data/test/media/vpe_extension_rank.txt";
+    auto& manager = Extension::ExtensionManager::GetInstance();
+    EXPECT_NE(manager.LoadExtensionRanks("/data/test/media/not_exist_rank.txt"), VPE_ALGO_ERR_OK);
+    // The static extensions are always there, so the calibration has something to measure.
+    ASSERT_EQ(manager.CalibrateExtensionRanks(path), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(manager.LoadExtensionRanks(path), VPE_ALGO_ERR_OK);
+
+    uint32_t bucket = Extension::ExtensionRankCalibration::GetResolutionBucket(2048, 1536);
+    ASSERT_NE(bucket, Extension::ExtensionRankCalibration::RESOLUTION_BUCKET_ANY);
+    Extension::ExtensionRankCalibration calibration;
+    calibration.Record("DetailEnhancer/level=" + std::to_string(DETAIL_ENH_LEVEL_MEDIUM), bucket, "rank_test", 1);
+    ASSERT_EQ(calibration.Save(path), VPE_ALGO_ERR_OK);
+    ASSERT_EQ(manager.LoadExtensionRanks(path), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(manager.GetRankBucket(2048, 1536), bucket);
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_MEDIUM,
+    };
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 2048, 1536);
+    auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 1024, 768);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+}
+
+// process RGBA and NV12 by each filter level of the CPU fallback
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_64, TestSize.Level1)
+{
+    for (auto format : { DEFAULT_FORMAT_RGBAEIGHT, DEFAULT_FORMAT_YCBCRSP }) {
+        auto input = CreateSurfaceBuffer(format, 1024, 768);
+        auto output = CreateSurfaceBuffer(format, 512, 384);
+        for (auto level : { DETAIL_ENH_LEVEL_NONE, DETAIL_ENH_LEVEL_LOW, DETAIL_ENH_LEVEL_MEDIUM }) {
+            auto detailEnh = DetailEnhancerImage::Create();
+            ASSERT_NE(detailEnh, nullptr);
+            DetailEnhancerParameters param {
+                .uri = "",
+                .level = level,
+            };
+            EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+            EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+        }
+    }
+}
+
+#ifdef SKIA_ENABLE
+// scale large images by parallel bands and by the whole planes on the calling thread, the results are the same
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_65, TestSize.Level1)
+{
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_MEDIUM,
+    };
+    Skia serial;
+    Skia banded;
+    serial.SetWorkerNum(1);
+    banded.SetWorkerNum(4); // 4: split into bands for several threads
+    ASSERT_EQ(serial.SetParameter(param), VPE_ALGO_ERR_OK);
+    ASSERT_EQ(banded.SetParameter(param), VPE_ALGO_ERR_OK);
+    for (auto format : { DEFAULT_FORMAT_YCBCRSP, DEFAULT_FORMAT_RGBAEIGHT }) {
+        auto input = CreateSurfaceBuffer(format, 4096, 3072);
+        auto serialOutput = CreateSurfaceBuffer(format, 1920, 1440);
+        auto bandedOutput = CreateSurfaceBuffer(format, 1920, 1440);
+        ASSERT_NE(input, nullptr);
+        ASSERT_NE(serialOutput, nullptr);
+        ASSERT_NE(bandedOutput, nullptr);
+        auto inputAddr = static_cast<uint8_t*>(input->GetVirAddr());
+        for (uint32_t i = 0; i < input->GetSize(); i++) {
+            inputAddr[i] = static_cast<uint8_t>((i * 7) ^ (i >> 12)); // 7, 12: any pattern which is not flat
+        }
+        EXPECT_EQ(serial.Process(input, serialOutput), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(banded.Process(input, bandedOutput), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(memcmp(serialOutput->GetVirAddr(), bandedOutput->GetVirAddr(), serialOutput->GetSize()), 0);
+    }
+}
+
+// scale flat 10-bit images, P010 keeps its 10 bits and RGBA_1010102 keeps its colors and its zero alpha
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_74, TestSize.Level1)
+{
+    constexpr uint16_t p010Sample = 512 << 6; // 512: mid gray, 6: P010 keeps the 10 bits in the high bits
+    constexpr uint32_t red = 512;
+    constexpr uint32_t green = 256;
+    constexpr uint32_t blue = 768;
+    constexpr uint32_t rgbaPixel = red | (green << 10) | (blue << 20); // 10, 20: channel shifts, alpha is 0
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_MEDIUM,
+    };
+    Skia skia;
+    ASSERT_EQ(skia.SetParameter(param), VPE_ALGO_ERR_OK);
+    for (auto format : { OHOS::GRAPHIC_PIXEL_FMT_YCBCR_P010, OHOS::GRAPHIC_PIXEL_FMT_YCRCB_P010 }) {
+        auto input = CreateSurfaceBuffer(format, 1920, 1080);
+        auto output = CreateSurfaceBuffer(format, 1280, 720);
+        ASSERT_NE(input, nullptr);
+        ASSERT_NE(output, nullptr);
+        std::fill_n(static_cast<uint16_t*>(input->GetVirAddr()), input->GetSize() / sizeof(uint16_t), p010Sample);
+        ASSERT_EQ(skia.Process(input, output), VPE_ALGO_ERR_OK);
+        auto outputAddr = static_cast<uint16_t*>(output->GetVirAddr());
+        EXPECT_EQ(outputAddr[0] >> 6, p010Sample >> 6); // 6: compare the 10 bits
+        EXPECT_EQ(outputAddr[output->GetWidth() - 1] >> 6, p010Sample >> 6); // 6: compare the 10 bits
+    }
+    auto input = CreateSurfaceBuffer(OHOS::GRAPHIC_PIXEL_FMT_RGBA_1010102, 1920, 1080);
+    auto output = CreateSurfaceBuffer(OHOS::GRAPHIC_PIXEL_FMT_RGBA_1010102, 1280, 720);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(output, nullptr);
+    std::fill_n(static_cast<uint32_t*>(input->GetVirAddr()), input->GetSize() / sizeof(uint32_t), rgbaPixel);
+    ASSERT_EQ(skia.Process(input, output), VPE_ALGO_ERR_OK);
+    uint32_t outputPixel = static_cast<uint32_t*>(output->GetVirAddr())[0];
+    EXPECT_EQ(outputPixel >> 30, 0U); // 30: alpha
+    EXPECT_NEAR(static_cast<int>(outputPixel & 0x3FF), static_cast<int>(red), 1);
+    EXPECT_NEAR(static_cast<int>((outputPixel >> 10) & 0x3FF), static_cast<int>(green), 1); // 10: green
+    EXPECT_NEAR(static_cast<int>((outputPixel >> 20) & 0x3FF), static_cast<int>(blue), 1); // 20: blue
+}
+#endif
+
+// scale and convert NV12 to RGBA and back, a gray image stays gray
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_66, TestSize.Level1)
+{
+    constexpr uint8_t gray = 128;
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 1920, 1080);
+    auto rgbOutput = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 1280, 720);
+    auto yuvOutput = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 640, 360);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(rgbOutput, nullptr);
+    ASSERT_NE(yuvOutput, nullptr);
+    memset(input->GetVirAddr(), gray, input->GetSize());
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_MEDIUM,
+    };
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    ASSERT_EQ(detailEnh->Process(input, rgbOutput), VPE_ALGO_ERR_OK);
+    auto rgbAddr = static_cast<uint8_t*>(rgbOutput->GetVirAddr());
+    EXPECT_EQ(rgbAddr[0], gray);
+    EXPECT_EQ(rgbAddr[1], gray);
+    EXPECT_EQ(rgbAddr[2], gray); // 2: B
+    EXPECT_EQ(rgbAddr[3], UINT8_MAX); // 3: A
+    ASSERT_EQ(detailEnh->Process(rgbOutput, yuvOutput), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(static_cast<uint8_t*>(yuvOutput->GetVirAddr())[0], gray);
+}
+
+// scale the 10-bit formats by the CPU fallback
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_67, TestSize.Level1)
+{
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_LOW,
+    };
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    for (auto format : { OHOS::GRAPHIC_PIXEL_FMT_RGBA_1010102, OHOS::GRAPHIC_PIXEL_FMT_YCBCR_P010,
+        OHOS::GRAPHIC_PIXEL_FMT_YCRCB_P010 }) {
+        auto input = CreateSurfaceBuffer(format, 1920, 1080);
+        auto output = CreateSurfaceBuffer(format, 1280, 720);
+        ASSERT_NE(input, nullptr);
+        ASSERT_NE(output, nullptr);
+        EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+    }
+}
+
+// check extern c interface, create shares one instance, every exclusive create returns its own instance and the
+// instances process concurrently
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_68, TestSize.Level1)
+{
+    void* lib = dlopen("/system/lib64/libvideoprocessingengine.z.so", RTLD_LAZY);
+    if (lib == nullptr) {
+        printf("cannot load vpe lib\n");
+        return;
+    }
+    typedef int32_t (*DetailEnhancerCreate)(int32_t*);
+    typedef int32_t (*DetailEnhancerProcessImage)(int32_t,
+        OHNativeWindowBuffer*, OHNativeWindowBuffer*, int32_t);
+    typedef int32_t (*DetailEnhancerDestroy)(int32_t*);
+    auto detailEnhCreate = reinterpret_cast<DetailEnhancerCreate>(dlsym(lib, "DetailEnhancerCreate"));
+    auto detailEnhCreateExclusive =
+        reinterpret_cast<DetailEnhancerCreate>(dlsym(lib, "DetailEnhancerCreateExclusive"));
+    auto detailEnhProcessImage =
+        reinterpret_cast<DetailEnhancerProcessImage>(dlsym(lib, "DetailEnhancerProcessImage"));
+    auto detailEnhDestroy = reinterpret_cast<DetailEnhancerDestroy>(dlsym(lib, "DetailEnhancerDestroy"));
+
+    constexpr int instanceNum = 2;
+    int32_t sharedInstances[instanceNum] = { -1, -1 };
+    ASSERT_EQ(detailEnhCreate(&sharedInstances[0]), VPE_ALGO_ERR_OK);
+    ASSERT_EQ(detailEnhCreate(&sharedInstances[1]), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(sharedInstances[0], sharedInstances[1]);
+    EXPECT_EQ(detailEnhDestroy(&sharedInstances[0]), VPE_ALGO_ERR_OK);
+    int32_t instances[instanceNum] = { -1, -1 };
+    ASSERT_EQ(detailEnhCreateExclusive(&instances[0]), VPE_ALGO_ERR_OK);
+    ASSERT_EQ(detailEnhCreateExclusive(&instances[1]), VPE_ALGO_ERR_OK);
+    EXPECT_NE(instances[0], instances[1]);
+    int32_t results[instanceNum] = { VPE_ALGO_ERR_UNKNOWN, VPE_ALGO_ERR_UNKNOWN };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < instanceNum; i++) {
+        threads.emplace_back([i, &instances, &results, detailEnhProcessImage]() {
+            auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 1920, 1080);
+            auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 1280, 720);
+            if (input == nullptr || output == nullptr) {
+                return;
+            }
+            OHNativeWindowBuffer* srIn = OH_NativeWindow_CreateNativeWindowBufferFromSurfaceBuffer(&input);
+            OHNativeWindowBuffer* srOut = OH_NativeWindow_CreateNativeWindowBufferFromSurfaceBuffer(&output);
+            results[i] = detailEnhProcessImage(instances[i], srIn, srOut, DETAIL_ENH_LEVEL_MEDIUM);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < instanceNum; i++) {
+        EXPECT_EQ(results[i], VPE_ALGO_ERR_OK);
+        EXPECT_EQ(detailEnhDestroy(&instances[i]), VPE_ALGO_ERR_OK);
+    }
+    dlclose(lib);
+}
+
+// check extern c interface, concurrent creates share one instance and a new one is shared after it is destroyed
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_76, TestSize.Level1)
+{
+    void* lib = dlopen("/system/lib64/libvideoprocessingengine.z.so", RTLD_LAZY);
+    if (lib == nullptr) {
+        printf("cannot load vpe lib\n");
+        return;
+    }
+    typedef int32_t (*DetailEnhancerCreate)(int32_t*);
+    typedef int32_t (*DetailEnhancerProcessImage)(int32_t,
+        OHNativeWindowBuffer*, OHNativeWindowBuffer*, int32_t);
+    typedef int32_t (*DetailEnhancerDestroy)(int32_t*);
+    auto detailEnhCreate = reinterpret_cast<DetailEnhancerCreate>(dlsym(lib, "DetailEnhancerCreate"));
+    auto detailEnhProcessImage =
+        reinterpret_cast<DetailEnhancerProcessImage>(dlsym(lib, "DetailEnhancerProcessImage"));
+    auto detailEnhDestroy = reinterpret_cast<DetailEnhancerDestroy>(dlsym(lib, "DetailEnhancerDestroy"));
+
+    constexpr int callerNum = 4;
+    int32_t instances[callerNum] = { -1, -1, -1, -1 };
+    int32_t results[callerNum] = { VPE_ALGO_ERR_UNKNOWN, VPE_ALGO_ERR_UNKNOWN, VPE_ALGO_ERR_UNKNOWN,
+        VPE_ALGO_ERR_UNKNOWN };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < callerNum; i++) {
+        threads.emplace_back([i, &instances, &results, detailEnhCreate]() {
+            results[i] = detailEnhCreate(&instances[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < callerNum; i++) {
+        EXPECT_EQ(results[i], VPE_ALGO_ERR_OK);
+        EXPECT_EQ(instances[i], instances[0]);
+    }
+    ASSERT_EQ(detailEnhDestroy(&instances[0]), VPE_ALGO_ERR_OK);
+
+    int32_t instance = -1;
+    ASSERT_EQ(detailEnhCreate(&instance), VPE_ALGO_ERR_OK);
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 1920, 1080);
+    auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 1280, 720);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(output, nullptr);
+    OHNativeWindowBuffer* srIn = OH_NativeWindow_CreateNativeWindowBufferFromSurfaceBuffer(&input);
+    OHNativeWindowBuffer* srOut = OH_NativeWindow_CreateNativeWindowBufferFromSurfaceBuffer(&output);
+    EXPECT_EQ(detailEnhProcessImage(instance, srIn, srOut, DETAIL_ENH_LEVEL_MEDIUM), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnhDestroy(&instance), VPE_ALGO_ERR_OK);
+    dlclose(lib);
+}
+
+// process 1.0x, the visible rows are copied and processing in place needs no copy
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_69, TestSize.Level1)
+{
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 1920, 1080);
+    auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_YCBCRSP, 1920, 1080);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(output, nullptr);
+    auto inputAddr = static_cast<uint8_t*>(input->GetVirAddr());
+    for (uint32_t i = 0; i < input->GetSize(); i++) {
+        inputAddr[i] = static_cast<uint8_t>(i * 7); // 7: any pattern which is not flat
+    }
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_LOW,
+    };
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+    auto outputAddr = static_cast<uint8_t*>(output->GetVirAddr());
+    int32_t lastRow = input->GetHeight() - 1;
+    EXPECT_EQ(memcmp(outputAddr, inputAddr, input->GetWidth()), 0);
+    EXPECT_EQ(memcmp(outputAddr + lastRow * output->GetStride(), inputAddr + lastRow * input->GetStride(),
+        input->GetWidth()), 0);
+    EXPECT_EQ(detailEnh->Process(input, input), VPE_ALGO_ERR_OK);
+}
+
+// process a batch of two shapes, the result is the same as processing one by one
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_70, TestSize.Level1)
+{
+    constexpr int batchNum = 6;
+    std::vector<std::pair<sptr<SurfaceBuffer>, sptr<SurfaceBuffer>>> images;
+    for (int i = 0; i < batchNum; i++) {
+        bool isThumbnail = (i % 2 == 0); // 2: alternate the shapes
+        auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 1024, 768);
+        auto output = isThumbnail ? CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 256, 192) :
+            CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 1024, 768);
+        ASSERT_NE(input, nullptr);
+        ASSERT_NE(output, nullptr);
+        auto inputAddr = static_cast<uint8_t*>(input->GetVirAddr());
+        for (uint32_t j = 0; j < input->GetSize(); j++) {
+            inputAddr[j] = static_cast<uint8_t>(j * (i + 3)); // 3: any pattern which is not flat
+        }
+        images.emplace_back(input, output);
+    }
+    images.emplace_back(nullptr, nullptr);
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_MEDIUM,
+    };
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    std::vector<VPEAlgoErrCode> results;
+    EXPECT_NE(detailEnh->ProcessBatch(images, results), VPE_ALGO_ERR_OK);
+    ASSERT_EQ(results.size(), images.size());
+    for (int i = 0; i < batchNum; i++) {
+        EXPECT_EQ(results[i], VPE_ALGO_ERR_OK);
+        auto output = CreateSurfaceBuffer(images[i].second->GetFormat(), images[i].second->GetWidth(),
+            images[i].second->GetHeight());
+        ASSERT_NE(output, nullptr);
+        EXPECT_EQ(detailEnh->Process(images[i].first, output), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(memcmp(output->GetVirAddr(), images[i].second->GetVirAddr(), output->GetSize()), 0);
+    }
+    EXPECT_NE(results[batchNum], VPE_ALGO_ERR_OK);
+}
+
+// process a large image in tiles under the memory budget, the result is close to processing it at once
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_71, TestSize.Level1)
+{
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 4096, 3072);
+    auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 2048, 1536);
+    auto tiledOutput = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 2048, 1536);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(output, nullptr);
+    ASSERT_NE(tiledOutput, nullptr);
+    constexpr int bytesPerPixel = 4;
+    auto inputAddr = static_cast<uint8_t*>(input->GetVirAddr());
+    for (int y = 0; y < input->GetHeight(); y++) {
+        for (int x = 0; x < input->GetWidth() * bytesPerPixel; x++) {
+            // A smooth gradient, so the seams of the tiles would show up as differences.
+            inputAddr[y * input->GetStride() + x] = static_cast<uint8_t>((x / bytesPerPixel + y) >> 5); // 5: slope
+        }
+    }
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_MEDIUM,
+    };
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+    param.memoryBudget = 8 * 1024 * 1024; // 8MB, far less than the whole image needs
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Process(input, tiledOutput), VPE_ALGO_ERR_OK);
+    auto outputAddr = static_cast<uint8_t*>(output->GetVirAddr());
+    auto tiledOutputAddr = static_cast<uint8_t*>(tiledOutput->GetVirAddr());
+    int maxDiff = 0;
+    for (int y = 0; y < output->GetHeight(); y++) {
+        for (int x = 0; x < output->GetWidth() * bytesPerPixel; x++) {
+            int offset = y * output->GetStride() + x;
+            maxDiff = std::max(maxDiff, std::abs(outputAddr[offset] - tiledOutputAddr[offset]));
+        }
+    }
+    EXPECT_LE(maxDiff, 2); // 2: rounding of the blending
+}
+
+// process at the high level repeatedly, the levels which keep failing are skipped but the process still succeeds
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_72, TestSize.Level1)
+{
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    DetailEnhancerParameters param {
+        .uri = "",
+        .level = DETAIL_ENH_LEVEL_HIGH,
+    };
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    constexpr int processNum = 8; // More than the failures which open the breaker of a level
+    for (int i = 0; i < processNum; i++) {
+        auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 1024, 768);
+        auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 2048, 1536);
+        ASSERT_NE(input, nullptr);
+        ASSERT_NE(output, nullptr);
+        EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+    }
+}
+
+// process the shapes and levels in turn, the cached plans give the same result as a new instance
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_73, TestSize.Level1)
+{
+    auto input = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, 1024, 768);
+    ASSERT_NE(input, nullptr);
+    auto inputAddr = static_cast<uint8_t*>(input->GetVirAddr());
+    for (uint32_t i = 0; i < input->GetSize(); i++) {
+        inputAddr[i] = static_cast<uint8_t>(i * 7); // 7: any pattern which is not flat
+    }
+    const std::vector<std::pair<int, int>> shapes = { {512, 384}, {2048, 1536} };
+    const std::vector<DetailEnhancerLevel> levels = { DETAIL_ENH_LEVEL_LOW, DETAIL_ENH_LEVEL_MEDIUM };
+    auto detailEnh = DetailEnhancerImage::Create();
+    ASSERT_NE(detailEnh, nullptr);
+    constexpr int roundNum = 2;
+    for (int round = 0; round < roundNum; round++) {
+        for (const auto& [width, height] : shapes) {
+            for (auto level : levels) {
+                DetailEnhancerParameters param {
+                    .uri = "",
+                    .level = level,
+                };
+                auto output = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, width, height);
+                auto expected = CreateSurfaceBuffer(DEFAULT_FORMAT_RGBAEIGHT, width, height);
+                ASSERT_NE(output, nullptr);
+                ASSERT_NE(expected, nullptr);
+                EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+                EXPECT_EQ(detailEnh->Process(input, output), VPE_ALGO_ERR_OK);
+                auto newDetailEnh = DetailEnhancerImage::Create();
+                ASSERT_NE(newDetailEnh, nullptr);
+                EXPECT_EQ(newDetailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+                EXPECT_EQ(newDetailEnh->Process(input, expected), VPE_ALGO_ERR_OK);
+                EXPECT_EQ(memcmp(output->GetVirAddr(), expected->GetVirAddr(), output->GetSize()), 0);
+            }
+        }
+    }
+}
+
+// a level is skipped after FAILURE_THRESHOLD failures, it is probed after the cool-down and a success recovers it
+HWTEST_F(DetailEnhancerUnitTest, detailenhancer_process_75, TestSize.Level1)
+{
+    constexpr auto coolDown = std::chrono::milliseconds(100);
+    constexpr auto maxCoolDown = std::chrono::milliseconds(200);
+    constexpr uint32_t bucket = 1;
+    LevelCircuitBreaker breaker(coolDown, maxCoolDown);
+    for (int i = 0; i < LevelCircuitBreaker::FAILURE_THRESHOLD; i++) {
+        EXPECT_TRUE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket));
+        breaker.Report(DETAIL_ENH_LEVEL_HIGH, bucket, VPE_ALGO_ERR_UNKNOWN);
+    }
+    EXPECT_FALSE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket));
+    EXPECT_TRUE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket + 1));
+    EXPECT_TRUE(breaker.IsAllowed(DETAIL_ENH_LEVEL_MEDIUM, bucket));
+
+    // A failed probe doubles the cool-down.
+    std::this_thread::sleep_for(coolDown + std::chrono::milliseconds(50)); // 50: margin
+    EXPECT_TRUE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket));
+    EXPECT_FALSE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket));
+    breaker.Report(DETAIL_ENH_LEVEL_HIGH, bucket, VPE_ALGO_ERR_UNKNOWN);
+    std::this_thread::sleep_for(coolDown + std::chrono::milliseconds(50)); // 50: margin
+    EXPECT_FALSE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket));
+    std::this_thread::sleep_for(maxCoolDown - coolDown);
+
+    // A successful probe closes the breaker, the next failure does not open it again.
+    EXPECT_TRUE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket));
+    breaker.Report(DETAIL_ENH_LEVEL_HIGH, bucket, VPE_ALGO_ERR_OK);
+    breaker.Report(DETAIL_ENH_LEVEL_HIGH, bucket, VPE_ALGO_ERR_UNKNOWN);
+    EXPECT_TRUE(breaker.IsAllowed(DETAIL_ENH_LEVEL_HIGH, bucket));
+}
+
 // check extension extream vision engine, process YCRCB_420_SP, aisr MOVED TO VPE_EXT
 HWTEST_F(DetailEnhancerUnitTest, extream_vision_engine_process_01, TestSize.Level1)
 {
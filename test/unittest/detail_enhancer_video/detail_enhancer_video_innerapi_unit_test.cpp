@@ -13,12 +13,18 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <dlfcn.h>
 
@@ -30,6 +36,12 @@
 #include "algorithm_errors.h"
 #include "algorithm_utils.h"
 #include "algorithm_video.h"
+#include "algorithm_video_impl.h"
+#include "buffer_queue_size_controller.h"
+#include "detail_enhancer_video_fwk.h"
+#include "vpe_ring_buffer.h"
+#include "vpe_task_executor.h"
+#include "vpe_video_pipeline.h"
 
 using namespace testing::ext;
 
@@ -38,6 +50,9 @@ constexpr int64_t NANOS_IN_SECOND = 1000000000L;
 constexpr int64_t NANOS_IN_MICRO = 1000L;
 constexpr uint32_t DEFAULT_WIDTH = 1920;
 constexpr uint32_t DEFAULT_HEIGHT = 1080;
+constexpr int32_t REQUEST_TIMEOUT_MS = 1000;
+constexpr int32_t STRIDE_ALIGNMENT = 32;
+constexpr auto WAIT_TIMEOUT = std::chrono::seconds(5);
 
 int64_t GetSystemTime()
 {
@@ -100,6 +115,273 @@ void DetailEnhancerVideoCallbackImpl::OnOutputBufferAvailable(uint32_t index, co
         " pts=" << info.presentationTimestamp << std::endl;
 }
 
+// Video processing object which only takes some time in Process, so the tests check the buffer engine alone.
+// The output size is fixed, so the processed frames can be told from the bypassed ones by the size.
+class EngineTestVideo : public VpeVideoImpl {
+public:
+    static std::shared_ptr<EngineTestVideo> Create(int32_t width, int32_t height)
+    {
+        auto obj = std::make_shared<EngineTestVideo>(width, height);
+        if (obj->Initialize() != VPE_ALGO_ERR_OK) {
+            return nullptr;
+        }
+        return obj;
+    }
+
+    EngineTestVideo(int32_t width, int32_t height)
+        : VpeVideoImpl(VIDEO_TYPE_DETAIL_ENHANCER), width_(width), height_(height) {}
+    ~EngineTestVideo() = default;
+    EngineTestVideo(const EngineTestVideo&) = delete;
+    EngineTestVideo& operator=(const EngineTestVideo&) = delete;
+    EngineTestVideo(EngineTestVideo&&) = delete;
+    EngineTestVideo& operator=(EngineTestVideo&&) = delete;
+
+    VPEAlgoErrCode SetParameter(const Format& parameter) final
+    {
+        return SetCommonParameter(parameter) > 0 ? VPE_ALGO_ERR_OK : VPE_ALGO_ERR_INVALID_VAL;
+    }
+
+    VPEAlgoErrCode GetParameter(Format& parameter) final
+    {
+        GetCommonParameter(parameter);
+        return VPE_ALGO_ERR_OK;
+    }
+
+    void SetProcessTime(std::chrono::milliseconds processTime)
+    {
+        processTime_ = processTime;
+    }
+
+protected:
+    VPEAlgoErrCode Process([[maybe_unused]] const sptr<SurfaceBuffer>& sourceImage,
+        [[maybe_unused]] sptr<SurfaceBuffer>& destinationImage) final
+    {
+        std::this_thread::sleep_for(processTime_.load());
+        return VPE_ALGO_ERR_OK;
+    }
+
+    bool IsDisableAfterProcessFail() final
+    {
+        return false;
+    }
+
+    VPEAlgoErrCode UpdateRequestCfg([[maybe_unused]] const sptr<Surface>& surface,
+        BufferRequestConfig& requestCfg) final
+    {
+        requestCfg.width = width_;
+        requestCfg.height = height_;
+        return VPE_ALGO_ERR_OK;
+    }
+
+    void UpdateRequestCfg(const sptr<SurfaceBuffer>& consumerBuffer, BufferRequestConfig& requestCfg) final
+    {
+        requestCfg.width = width_;
+        requestCfg.height = height_;
+        requestCfg.format = consumerBuffer->GetFormat();
+    }
+
+private:
+    const int32_t width_{};
+    const int32_t height_{};
+    std::atomic<std::chrono::milliseconds> processTime_{};
+};
+
+// Record the output frames and render them at once, like a display which never blocks.
+class FrameRecorder : public VpeVideoCallback {
+public:
+    FrameRecorder() = default;
+    ~FrameRecorder() override = default;
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+    FrameRecorder(FrameRecorder&&) = delete;
+    FrameRecorder& operator=(FrameRecorder&&) = delete;
+
+    void SetVideo(const std::shared_ptr<VpeVideo>& video)
+    {
+        video_ = video;
+    }
+
+    void OnOutputFormatChanged(const Format& format) final
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        formats_.push_back(format);
+    }
+
+    void OnOutputBufferAvailable(uint32_t index, const VpeBufferInfo& info) final
+    {
+        auto video = video_.lock();
+        if (video != nullptr) {
+            video->ReleaseOutputBuffer(index, info.flag != VPE_BUFFER_FLAG_EOS);
+        }
+        std::lock_guard<std::mutex> lock(lock_);
+        if (info.flag == VPE_BUFFER_FLAG_EOS) {
+            isEos_ = true;
+        } else {
+            timestamps_.push_back(info.presentationTimestamp);
+        }
+        cv_.notify_all();
+    }
+
+    bool WaitForEos()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        return cv_.wait_for(lock, WAIT_TIMEOUT, [this] { return isEos_; });
+    }
+
+    std::vector<int64_t> GetTimestamps()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return timestamps_;
+    }
+
+    std::vector<Format> GetFormats()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return formats_;
+    }
+
+private:
+    std::weak_ptr<VpeVideo> video_;
+    std::mutex lock_{};
+    std::condition_variable cv_{};
+    // Guarded by lock_ begin
+    bool isEos_{false};
+    std::vector<int64_t> timestamps_{};
+    std::vector<Format> formats_{};
+    // Guarded by lock_ end
+};
+
+// In-memory stand-in of the display: the rendered buffers are acquired, recorded and released at once.
+class OutputSink {
+public:
+    struct Frame {
+        int64_t timestamp;
+        int32_t width;
+        int32_t height;
+        int32_t format;
+    };
+
+    OutputSink() = default;
+    ~OutputSink()
+    {
+        if (consumer_ != nullptr) {
+            consumer_->UnregisterConsumerListener();
+        }
+    }
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    OutputSink(OutputSink&&) = delete;
+    OutputSink& operator=(OutputSink&&) = delete;
+
+    sptr<Surface> Create()
+    {
+        consumer_ = Surface::CreateSurfaceAsConsumer("VpeTestSink");
+        if (consumer_ == nullptr) {
+            return nullptr;
+        }
+        sptr<IBufferConsumerListener> listener = new Listener(*this);
+        if (consumer_->RegisterConsumerListener(listener) != GSERROR_OK) {
+            return nullptr;
+        }
+        sptr<IBufferProducer> producer = consumer_->GetProducer();
+        return Surface::CreateSurfaceAsProducer(producer);
+    }
+
+    bool WaitFrames(size_t frames)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        return cv_.wait_for(lock, WAIT_TIMEOUT, [this, frames] { return frames_.size() >= frames; });
+    }
+
+    std::vector<Frame> GetFrames()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return frames_;
+    }
+
+private:
+    class Listener : public IBufferConsumerListener {
+    public:
+        explicit Listener(OutputSink& owner) : owner_(owner) {}
+        ~Listener() = default;
+        Listener(const Listener&) = delete;
+        Listener& operator=(const Listener&) = delete;
+        Listener(Listener&&) = delete;
+        Listener& operator=(Listener&&) = delete;
+
+        void OnBufferAvailable() final
+        {
+            owner_.OnBufferAvailable();
+        }
+
+    private:
+        OutputSink& owner_;
+    };
+
+    void OnBufferAvailable()
+    {
+        sptr<SurfaceBuffer> buffer;
+        sptr<SyncFence> fence;
+        int64_t timestamp = 0;
+        Rect damage{};
+        if (consumer_->AcquireBuffer(buffer, fence, timestamp, damage) != GSERROR_OK || buffer == nullptr) {
+            return;
+        }
+        Frame frame{ timestamp, buffer->GetWidth(), buffer->GetHeight(), buffer->GetFormat() };
+        consumer_->ReleaseBuffer(buffer, -1);
+        std::lock_guard<std::mutex> lock(lock_);
+        frames_.push_back(frame);
+        cv_.notify_all();
+    }
+
+    sptr<Surface> consumer_{};
+    std::mutex lock_{};
+    std::condition_variable cv_{};
+    // Guarded by lock_ begin
+    std::vector<Frame> frames_{};
+    // Guarded by lock_ end
+};
+
+// Flush the frames with the timestamps [firstTimestamp, firstTimestamp + frameNum) to the input surface.
+bool FeedFrames(const sptr<Surface>& input, int32_t width, int32_t height, int64_t firstTimestamp,
+    uint32_t frameNum)
+{
+    BufferRequestConfig requestCfg{};
+    requestCfg.width = width;
+    requestCfg.height = height;
+    requestCfg.format = GRAPHIC_PIXEL_FMT_YCBCR_420_SP;
+    requestCfg.usage = BUFFER_USAGE_CPU_READ | BUFFER_USAGE_CPU_WRITE | BUFFER_USAGE_MEM_DMA;
+    requestCfg.timeout = REQUEST_TIMEOUT_MS;
+    requestCfg.strideAlignment = STRIDE_ALIGNMENT;
+    for (uint32_t i = 0; i < frameNum; i++) {
+        sptr<SurfaceBuffer> buffer;
+        sptr<SyncFence> fence;
+        if (input->RequestBuffer(buffer, fence, requestCfg) != GSERROR_OK || buffer == nullptr) {
+            return false;
+        }
+        if (fence != nullptr) {
+            fence->Wait(REQUEST_TIMEOUT_MS);
+        }
+        BufferFlushConfig flushCfg{};
+        flushCfg.damage.w = width;
+        flushCfg.damage.h = height;
+        flushCfg.timestamp = firstTimestamp + i;
+        if (input->FlushBuffer(buffer, -1, flushCfg) != GSERROR_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<int64_t> GetTimestamps(int64_t firstTimestamp, uint32_t frameNum)
+{
+    std::vector<int64_t> timestamps(frameNum);
+    for (uint32_t i = 0; i < frameNum; i++) {
+        timestamps[i] = firstTimestamp + i;
+    }
+    return timestamps;
+}
+
 class DetailEnhancerVideoInnerAPIUnitTest : public testing::Test {
 public:
     static void SetUpTestCase(void);
@@ -418,6 +700,575 @@ HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_23, TestSize.Level1
     ASSERT_EQ(ret, VPE_ALGO_ERR_OK);
     OH_NativeWindow_DestroyNativeWindow(nativeWindow);
 }
+
+// set pipeline depth
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_24, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, 2), true);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    Format result{};
+    EXPECT_EQ(detailEnh->GetParameter(result), VPE_ALGO_ERR_OK);
+    int depth = 0;
+    EXPECT_EQ(result.GetIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, depth), true);
+    EXPECT_EQ(depth, 2);
+}
+
+// set invalid pipeline depth
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_25, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, 0), true);
+    EXPECT_NE(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    Format param2{};
+    EXPECT_EQ(param2.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, 4), true);
+    EXPECT_NE(detailEnh->SetParameter(param2), VPE_ALGO_ERR_OK);
+}
+
+// set adaptive queue size and buffer memory limit
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_26, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_ADAPTIVE_QUEUE_SIZE, 1), true);
+    EXPECT_EQ(param.PutLongValue(ParameterKey::VIDEO_BUFFER_MEMORY_LIMIT, 64 * 1024 * 1024), true);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    Format result{};
+    EXPECT_EQ(detailEnh->GetParameter(result), VPE_ALGO_ERR_OK);
+    int isAdaptive = 0;
+    EXPECT_EQ(result.GetIntValue(ParameterKey::VIDEO_ADAPTIVE_QUEUE_SIZE, isAdaptive), true);
+    EXPECT_EQ(isAdaptive, 1);
+    int64_t memoryLimit = 0;
+    EXPECT_EQ(result.GetLongValue(ParameterKey::VIDEO_BUFFER_MEMORY_LIMIT, memoryLimit), true);
+    EXPECT_EQ(memoryLimit, 64 * 1024 * 1024);
+}
+
+// set invalid adaptive queue size and buffer memory limit
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_27, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_ADAPTIVE_QUEUE_SIZE, 2), true);
+    EXPECT_NE(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    Format param2{};
+    EXPECT_EQ(param2.PutLongValue(ParameterKey::VIDEO_BUFFER_MEMORY_LIMIT, -1), true);
+    EXPECT_NE(detailEnh->SetParameter(param2), VPE_ALGO_ERR_OK);
+}
+
+// get statistics before processing
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_28, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format result{};
+    EXPECT_EQ(detailEnh->GetParameter(result), VPE_ALGO_ERR_OK);
+    uint8_t* addr = nullptr;
+    size_t addrSize = 0;
+    EXPECT_EQ(result.GetBuffer(ParameterKey::VIDEO_STATISTICS, &addr, addrSize), true);
+    ASSERT_NE(addr, nullptr);
+    ASSERT_EQ(addrSize, sizeof(VpeVideoStatistics));
+    auto statistics = reinterpret_cast<VpeVideoStatistics*>(addr);
+    EXPECT_EQ(statistics->outputFrames, 0);
+    EXPECT_EQ(statistics->process.count, 0);
+    EXPECT_EQ(statistics->inputQueueDepth, 0);
+}
+
+// set latency budget and late frame action
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_29, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_LATENCY_BUDGET, 33), true);
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_LATE_FRAME_ACTION, VPE_LATE_FRAME_DROP), true);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    Format result{};
+    EXPECT_EQ(detailEnh->GetParameter(result), VPE_ALGO_ERR_OK);
+    int budget = 0;
+    EXPECT_EQ(result.GetIntValue(ParameterKey::VIDEO_LATENCY_BUDGET, budget), true);
+    EXPECT_EQ(budget, 33);
+    int action = VPE_LATE_FRAME_BYPASS;
+    EXPECT_EQ(result.GetIntValue(ParameterKey::VIDEO_LATE_FRAME_ACTION, action), true);
+    EXPECT_EQ(action, VPE_LATE_FRAME_DROP);
+}
+
+// set invalid latency budget and late frame action
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_30, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_LATENCY_BUDGET, -1), true);
+    EXPECT_NE(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    Format param2{};
+    EXPECT_EQ(param2.PutIntValue(ParameterKey::VIDEO_LATE_FRAME_ACTION, 2), true);
+    EXPECT_NE(detailEnh->SetParameter(param2), VPE_ALGO_ERR_OK);
+}
+
+// start and stop many instances which share the processing threads
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_31, TestSize.Level1)
+{
+    constexpr int instanceNum = 8;
+    std::vector<std::shared_ptr<VpeVideo>> detailEnhs;
+    std::vector<std::shared_ptr<VpeVideo>> outputs;
+    for (int i = 0; i < instanceNum; i++) {
+        auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+        ASSERT_NE(detailEnh, nullptr);
+        std::shared_ptr<VpeVideoCallback> cb = std::make_shared<DetailEnhancerVideoCallbackImpl>();
+        EXPECT_EQ(detailEnh->RegisterCallback(cb), VPE_ALGO_ERR_OK);
+        EXPECT_NE(detailEnh->GetInputSurface(), nullptr);
+        auto output = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+        ASSERT_NE(output, nullptr);
+        EXPECT_EQ(detailEnh->SetOutputSurface(output->GetInputSurface()), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(detailEnh->Start(), VPE_ALGO_ERR_OK);
+        detailEnhs.push_back(detailEnh);
+        outputs.push_back(output);
+    }
+    for (auto& detailEnh : detailEnhs) {
+        EXPECT_EQ(detailEnh->Stop(), VPE_ALGO_ERR_OK);
+    }
+    for (auto& detailEnh : detailEnhs) {
+        EXPECT_EQ(detailEnh->Release(), VPE_ALGO_ERR_OK);
+    }
+}
+
+// create pipeline with invalid stages
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_32, TestSize.Level1)
+{
+    EXPECT_EQ(VpeVideoPipeline::Create({}), nullptr);
+    EXPECT_EQ(VpeVideoPipeline::Create({ DetailEnhancerVideoFwk::Create(), nullptr }), nullptr);
+}
+
+// process by pipeline which only uses the surfaces at both ends
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_33, TestSize.Level1)
+{
+    OHNativeWindowBuffer* ohNativeWindowBuffer;
+    auto stage1 = DetailEnhancerVideoFwk::Create();
+    auto stage2 = DetailEnhancerVideoFwk::Create();
+    ASSERT_NE(stage1, nullptr);
+    ASSERT_NE(stage2, nullptr);
+    Format stageParam{};
+    EXPECT_EQ(stageParam.PutIntValue(ParameterKey::DETAIL_ENHANCER_QUALITY_LEVEL, DETAIL_ENHANCER_LEVEL_HIGH), true);
+    EXPECT_EQ(stage1->SetParameter(stageParam), VPE_ALGO_ERR_OK);
+    auto pipeline = VpeVideoPipeline::Create({ stage1, stage2 });
+    ASSERT_NE(pipeline, nullptr);
+    EXPECT_EQ(pipeline->GetType(), static_cast<uint32_t>(VIDEO_TYPE_DETAIL_ENHANCER));
+    std::shared_ptr<VpeVideoCallback> cb = std::make_shared<DetailEnhancerVideoCallbackImpl>();
+    EXPECT_EQ(pipeline->RegisterCallback(cb), VPE_ALGO_ERR_OK);
+    auto surface = pipeline->GetInputSurface();
+    auto output = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    EXPECT_EQ(pipeline->SetOutputSurface(output->GetInputSurface()), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(pipeline->Start(), VPE_ALGO_ERR_OK);
+
+    int fenceFd = -1;
+    nativeWindow = CreateNativeWindowFromSurface(&surface);
+    auto ret = OH_NativeWindow_NativeWindowHandleOpt(nativeWindow, SET_FORMAT, GRAPHIC_PIXEL_FMT_YCBCR_420_SP);
+    ASSERT_EQ(ret, VPE_ALGO_ERR_OK);
+    ret = OH_NativeWindow_NativeWindowHandleOpt(nativeWindow, SET_BUFFER_GEOMETRY, DEFAULT_WIDTH, DEFAULT_HEIGHT);
+    ASSERT_EQ(ret, VPE_ALGO_ERR_OK);
+    ret = OH_NativeWindow_NativeWindowRequestBuffer(nativeWindow, &ohNativeWindowBuffer, &fenceFd);
+    ASSERT_EQ(ret, VPE_ALGO_ERR_OK);
+    ret = FlushSurf(ohNativeWindowBuffer);
+    ASSERT_EQ(ret, VPE_ALGO_ERR_OK);
+    EXPECT_EQ(pipeline->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(pipeline->Release(), VPE_ALGO_ERR_OK);
+    OH_NativeWindow_DestroyNativeWindow(nativeWindow);
+}
+
+// toggle enable and disable seamlessly
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_34, TestSize.Level1)
+{
+    auto detailEnh = VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_SEAMLESS_TOGGLE, 1), true);
+    EXPECT_EQ(detailEnh->SetParameter(param), VPE_ALGO_ERR_OK);
+    Format result{};
+    EXPECT_EQ(detailEnh->GetParameter(result), VPE_ALGO_ERR_OK);
+    int isSeamless = 0;
+    EXPECT_EQ(result.GetIntValue(ParameterKey::VIDEO_SEAMLESS_TOGGLE, isSeamless), true);
+    EXPECT_EQ(isSeamless, 1);
+    EXPECT_EQ(detailEnh->Disable(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Enable(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Disable(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Enable(), VPE_ALGO_ERR_OK);
+    Format invalidParam{};
+    EXPECT_EQ(invalidParam.PutIntValue(ParameterKey::VIDEO_SEAMLESS_TOGGLE, 2), true);
+    EXPECT_NE(detailEnh->SetParameter(invalidParam), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(detailEnh->Release(), VPE_ALGO_ERR_OK);
+}
+
+// keep all the parameters if one of them is invalid, and keep the frame order at pipeline depth 2
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_35, TestSize.Level1)
+{
+    constexpr uint32_t frameNum = 30;
+    auto video = EngineTestVideo::Create(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+    ASSERT_NE(video, nullptr);
+    Format invalidParam{};
+    EXPECT_EQ(invalidParam.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, 2), true);
+    EXPECT_EQ(invalidParam.PutIntValue(ParameterKey::VIDEO_ADAPTIVE_QUEUE_SIZE, 1), true);
+    EXPECT_EQ(invalidParam.PutIntValue(ParameterKey::VIDEO_LATENCY_BUDGET, -1), true);
+    EXPECT_NE(video->SetParameter(invalidParam), VPE_ALGO_ERR_OK);
+    Format result{};
+    EXPECT_EQ(video->GetParameter(result), VPE_ALGO_ERR_OK);
+    int depth = 0;
+    EXPECT_EQ(result.GetIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, depth), true);
+    EXPECT_EQ(depth, 1);
+    int isAdaptive = 1;
+    EXPECT_EQ(result.GetIntValue(ParameterKey::VIDEO_ADAPTIVE_QUEUE_SIZE, isAdaptive), true);
+    EXPECT_EQ(isAdaptive, 0);
+
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, 2), true);
+    EXPECT_EQ(video->SetParameter(param), VPE_ALGO_ERR_OK);
+    video->SetProcessTime(std::chrono::milliseconds(2));
+    auto recorder = std::make_shared<FrameRecorder>();
+    recorder->SetVideo(video);
+    EXPECT_EQ(video->RegisterCallback(recorder), VPE_ALGO_ERR_OK);
+    auto input = video->GetInputSurface();
+    ASSERT_NE(input, nullptr);
+    OutputSink sink;
+    auto output = sink.Create();
+    ASSERT_NE(output, nullptr);
+    EXPECT_EQ(video->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Start(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(FeedFrames(input, DEFAULT_WIDTH, DEFAULT_HEIGHT, 0, frameNum), true);
+    EXPECT_EQ(video->NotifyEos(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(recorder->WaitForEos(), true);
+    EXPECT_EQ(sink.WaitFrames(frameNum), true);
+    EXPECT_EQ(recorder->GetTimestamps(), GetTimestamps(0, frameNum));
+    auto frames = sink.GetFrames();
+    ASSERT_EQ(frames.size(), frameNum);
+    for (uint32_t i = 0; i < frameNum; i++) {
+        EXPECT_EQ(frames[i].timestamp, static_cast<int64_t>(i));
+    }
+    EXPECT_EQ(video->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Release(), VPE_ALGO_ERR_OK);
+}
+
+// push and pop the ring queue across the end of its storage, and when it is full or empty
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_36, TestSize.Level1)
+{
+    constexpr size_t capacity = 4;
+    RingQueue<int, capacity> queue;
+    EXPECT_EQ(queue.Empty(), true);
+    EXPECT_EQ(queue.Full(), false);
+    queue.Pop();
+    EXPECT_EQ(queue.Size(), 0u);
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 3; round++) {
+        while (!queue.Full()) {
+            EXPECT_EQ(queue.Push(next++), true);
+        }
+        EXPECT_EQ(queue.Size(), capacity);
+        EXPECT_EQ(queue.Push(next), false);
+        EXPECT_EQ(queue.Front(), expected);
+        // Pop a part of the items, so the next pushes wrap around the end of the storage.
+        for (int i = 0; i < round + 1; i++) {
+            EXPECT_EQ(queue.Front(), expected++);
+            queue.Pop();
+        }
+    }
+    std::vector<int> items;
+    queue.ForEach([&items](int item) { items.push_back(item); });
+    ASSERT_EQ(items.size(), queue.Size());
+    for (size_t i = 0; i < items.size(); i++) {
+        EXPECT_EQ(items[i], expected + static_cast<int>(i));
+    }
+    while (!queue.Empty()) {
+        EXPECT_EQ(queue.Front(), expected++);
+        queue.Pop();
+    }
+    EXPECT_EQ(expected, next);
+    EXPECT_EQ(queue.Push(next), true);
+    queue.Clear();
+    EXPECT_EQ(queue.Empty(), true);
+    EXPECT_EQ(queue.Push(next), true);
+    EXPECT_EQ(queue.Front(), next);
+}
+
+// keep the sequence numbers reachable after erasing items of a wrapped probe sequence, and when it is full
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_37, TestSize.Level1)
+{
+    constexpr size_t capacity = 4;
+    SeqNumMap<int, capacity> map;
+    EXPECT_EQ(map.Empty(), true);
+    EXPECT_EQ(map.Find(0), nullptr);
+    EXPECT_EQ(map.Erase(0), false);
+    // All of them have the same home slot 3, so the probe sequence wraps around to slots 0, 1 and 2.
+    constexpr uint32_t seqNums[] = { 3, 7, 11, 15 };
+    for (auto seqNum : seqNums) {
+        EXPECT_EQ(map.Insert(seqNum, static_cast<int>(seqNum) * 10), true);
+    }
+    EXPECT_EQ(map.Size(), capacity);
+    EXPECT_EQ(map.Insert(19, 190), false);
+    EXPECT_EQ(map.Contains(19), false);
+    EXPECT_EQ(map.Insert(7, 71), true);
+    EXPECT_EQ(map.Size(), capacity);
+    ASSERT_NE(map.Find(7), nullptr);
+    EXPECT_EQ(*map.Find(7), 71);
+
+    EXPECT_EQ(map.Erase(3), true);
+    EXPECT_EQ(map.Contains(3), false);
+    for (auto seqNum : { 7u, 11u, 15u }) {
+        EXPECT_EQ(map.Contains(seqNum), true);
+    }
+    EXPECT_EQ(map.Insert(19, 190), true);
+    EXPECT_EQ(map.Erase(11), true);
+    for (auto seqNum : { 7u, 15u, 19u }) {
+        EXPECT_EQ(map.Contains(seqNum), true);
+    }
+    size_t count = 0;
+    map.ForEach([&count](uint32_t seqNum, int value) {
+        EXPECT_EQ(value, seqNum == 7 ? 71 : static_cast<int>(seqNum) * 10);
+        count++;
+    });
+    EXPECT_EQ(count, map.Size());
+    map.Clear();
+    EXPECT_EQ(map.Empty(), true);
+    EXPECT_EQ(map.Contains(7), false);
+}
+
+// grow the queue size on stalls, shrink it when the buffers do not fit the memory limit, and never exceed the limit
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_38, TestSize.Level1)
+{
+    constexpr uint32_t defaultSize = 5;
+    constexpr uint64_t bufferSize = 1000;
+    constexpr auto growInterval = std::chrono::milliseconds(600);
+    BufferQueueSizeController controller(defaultSize);
+    uint32_t newSize = 0;
+    EXPECT_EQ(controller.ResetSize(bufferSize), defaultSize);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), false);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), false);
+    EXPECT_EQ(controller.SetMemoryLimit(-1), false);
+
+    // Fixed size mode
+    EXPECT_EQ(controller.SetMemoryLimit(3 * bufferSize), true);
+    EXPECT_EQ(controller.ResetSize(bufferSize), 3u);
+    EXPECT_EQ(controller.ResetSize(0), defaultSize);
+    EXPECT_EQ(controller.ShrinkToLimit(bufferSize, newSize), true);
+    EXPECT_EQ(newSize, 3u);
+    EXPECT_EQ(controller.ShrinkToLimit(bufferSize, newSize), false);
+    EXPECT_EQ(controller.SetMemoryLimit(bufferSize / 2), true);
+    EXPECT_EQ(controller.ShrinkToLimit(bufferSize, newSize), true);
+    EXPECT_EQ(newSize, 1u);
+    EXPECT_EQ(controller.GetSize(), 1u);
+
+    // Adaptive mode
+    EXPECT_EQ(controller.SetMemoryLimit(0), true);
+    controller.SetAdaptive(true);
+    EXPECT_EQ(controller.ResetSize(bufferSize), 3u);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), false);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), true);
+    EXPECT_EQ(newSize, 4u);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), false);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), false);
+    std::this_thread::sleep_for(growInterval);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), true);
+    EXPECT_EQ(newSize, 5u);
+    EXPECT_EQ(controller.SetMemoryLimit(defaultSize * bufferSize), true);
+    std::this_thread::sleep_for(growInterval);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), false);
+    EXPECT_EQ(controller.OnStall(bufferSize, newSize), false);
+    EXPECT_EQ(controller.GetSize(), defaultSize);
+    EXPECT_EQ(controller.SetMemoryLimit(4 * bufferSize), true);
+    EXPECT_EQ(controller.ShrinkToLimit(bufferSize, newSize), true);
+    EXPECT_EQ(newSize, 4u);
+    EXPECT_EQ(controller.ShrinkToLimit(2 * bufferSize, newSize), true);
+    EXPECT_EQ(newSize, 2u);
+    EXPECT_EQ(controller.ResetSize(2 * bufferSize), 2u);
+}
+
+// bypass the late frames without changing the size of the outputs, or drop them if they can not be copied
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_39, TestSize.Level1)
+{
+    auto run = [](int32_t outputWidth, int32_t outputHeight, bool canCopy) {
+        constexpr uint32_t frameNum = 30;
+        auto video = EngineTestVideo::Create(outputWidth, outputHeight);
+        ASSERT_NE(video, nullptr);
+        Format param{};
+        EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_LATENCY_BUDGET, 1), true);
+        EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_LATE_FRAME_ACTION, VPE_LATE_FRAME_BYPASS), true);
+        EXPECT_EQ(video->SetParameter(param), VPE_ALGO_ERR_OK);
+        video->SetProcessTime(std::chrono::milliseconds(5));
+        auto recorder = std::make_shared<FrameRecorder>();
+        recorder->SetVideo(video);
+        EXPECT_EQ(video->RegisterCallback(recorder), VPE_ALGO_ERR_OK);
+        auto input = video->GetInputSurface();
+        ASSERT_NE(input, nullptr);
+        OutputSink sink;
+        auto output = sink.Create();
+        ASSERT_NE(output, nullptr);
+        EXPECT_EQ(video->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(video->Start(), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(FeedFrames(input, DEFAULT_WIDTH, DEFAULT_HEIGHT, 0, frameNum), true);
+        EXPECT_EQ(video->NotifyEos(), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(recorder->WaitForEos(), true);
+        auto timestamps = recorder->GetTimestamps();
+        EXPECT_EQ(sink.WaitFrames(timestamps.size()), true);
+        auto frames = sink.GetFrames();
+        ASSERT_EQ(frames.size(), timestamps.size());
+        if (canCopy) {
+            EXPECT_EQ(timestamps, GetTimestamps(0, frameNum));
+        } else {
+            EXPECT_LT(frames.size(), frameNum);
+        }
+        for (size_t i = 0; i < frames.size(); i++) {
+            EXPECT_EQ(frames[i].timestamp, timestamps[i]);
+            EXPECT_EQ(frames[i].width, outputWidth);
+            EXPECT_EQ(frames[i].height, outputHeight);
+            EXPECT_EQ(frames[i].format, GRAPHIC_PIXEL_FMT_YCBCR_420_SP);
+            if (i > 0) {
+                EXPECT_GT(frames[i].timestamp, frames[i - 1].timestamp);
+            }
+        }
+        EXPECT_EQ(video->Stop(), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(video->Release(), VPE_ALGO_ERR_OK);
+    };
+    run(DEFAULT_WIDTH, DEFAULT_HEIGHT, true);
+    run(DEFAULT_WIDTH / 2, DEFAULT_HEIGHT / 2, false);
+}
+
+// share the threads with the queues which keep requeueing their tasks, and stop these queues at last
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_40, TestSize.Level1)
+{
+    constexpr int busyQueueNum = 8;
+    constexpr uint32_t frameNum = 30;
+    std::function<void(VpeSerialQueue*)> spin = [&spin](VpeSerialQueue* queue) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        queue->Post([&spin, queue]() { spin(queue); });
+    };
+    std::vector<std::unique_ptr<VpeSerialQueue>> busyQueues;
+    for (int i = 0; i < busyQueueNum; i++) {
+        auto queue = std::make_unique<VpeSerialQueue>();
+        queue->Start();
+        auto rawQueue = queue.get();
+        EXPECT_EQ(queue->Post([&spin, rawQueue]() { spin(rawQueue); }), true);
+        busyQueues.push_back(std::move(queue));
+    }
+
+    auto video = EngineTestVideo::Create(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+    ASSERT_NE(video, nullptr);
+    video->SetProcessTime(std::chrono::milliseconds(1));
+    auto recorder = std::make_shared<FrameRecorder>();
+    recorder->SetVideo(video);
+    EXPECT_EQ(video->RegisterCallback(recorder), VPE_ALGO_ERR_OK);
+    auto input = video->GetInputSurface();
+    ASSERT_NE(input, nullptr);
+    OutputSink sink;
+    auto output = sink.Create();
+    ASSERT_NE(output, nullptr);
+    EXPECT_EQ(video->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Start(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(FeedFrames(input, DEFAULT_WIDTH, DEFAULT_HEIGHT, 0, frameNum), true);
+    EXPECT_EQ(sink.WaitFrames(frameNum), true);
+    EXPECT_EQ(video->NotifyEos(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(recorder->WaitForEos(), true);
+    EXPECT_EQ(recorder->GetTimestamps(), GetTimestamps(0, frameNum));
+    EXPECT_EQ(video->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Release(), VPE_ALGO_ERR_OK);
+
+    for (auto& queue : busyQueues) {
+        queue->Stop();
+    }
+}
+
+// toggle enable and disable seamlessly while the frames are flowing, no frame is dropped or output twice
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_41, TestSize.Level1)
+{
+    constexpr uint32_t toggleNum = 6;
+    constexpr uint32_t framesPerToggle = 5;
+    constexpr uint32_t frameNum = toggleNum * framesPerToggle;
+    constexpr int32_t outputWidth = DEFAULT_WIDTH / 2;
+    constexpr int32_t outputHeight = DEFAULT_HEIGHT / 2;
+    auto video = EngineTestVideo::Create(outputWidth, outputHeight);
+    ASSERT_NE(video, nullptr);
+    Format param{};
+    EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_SEAMLESS_TOGGLE, 1), true);
+    EXPECT_EQ(video->SetParameter(param), VPE_ALGO_ERR_OK);
+    video->SetProcessTime(std::chrono::milliseconds(1));
+    auto recorder = std::make_shared<FrameRecorder>();
+    recorder->SetVideo(video);
+    EXPECT_EQ(video->RegisterCallback(recorder), VPE_ALGO_ERR_OK);
+    auto input = video->GetInputSurface();
+    ASSERT_NE(input, nullptr);
+    OutputSink sink;
+    auto output = sink.Create();
+    ASSERT_NE(output, nullptr);
+    EXPECT_EQ(video->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Start(), VPE_ALGO_ERR_OK);
+    for (uint32_t i = 0; i < toggleNum; i++) {
+        // Toggle without waiting for the frames fed before, so some of them are in the engine at the time.
+        EXPECT_EQ((i % 2 == 0) ? video->Disable() : video->Enable(), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(FeedFrames(input, DEFAULT_WIDTH, DEFAULT_HEIGHT, i * framesPerToggle, framesPerToggle), true);
+    }
+    EXPECT_EQ(sink.WaitFrames(frameNum), true);
+    EXPECT_EQ(video->NotifyEos(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(recorder->WaitForEos(), true);
+    auto frames = sink.GetFrames();
+    ASSERT_EQ(frames.size(), frameNum);
+    uint32_t processedNum = 0;
+    for (uint32_t i = 0; i < frameNum; i++) {
+        EXPECT_EQ(frames[i].timestamp, static_cast<int64_t>(i));
+        if (frames[i].width == outputWidth && frames[i].height == outputHeight) {
+            processedNum++;
+        } else {
+            EXPECT_EQ(frames[i].width, static_cast<int32_t>(DEFAULT_WIDTH));
+            EXPECT_EQ(frames[i].height, static_cast<int32_t>(DEFAULT_HEIGHT));
+        }
+    }
+    EXPECT_GT(processedNum, 0u);
+    EXPECT_LT(processedNum, frameNum);
+    Format result{};
+    EXPECT_EQ(video->GetParameter(result), VPE_ALGO_ERR_OK);
+    size_t size = 0;
+    uint8_t* addr = nullptr;
+    ASSERT_EQ(result.GetBuffer(ParameterKey::VIDEO_STATISTICS, &addr, size), true);
+    ASSERT_EQ(size, sizeof(VpeVideoStatistics));
+    EXPECT_EQ(reinterpret_cast<VpeVideoStatistics*>(addr)->droppedFrames, 0u);
+    EXPECT_EQ(video->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Release(), VPE_ALGO_ERR_OK);
+}
+
+// keep the frame order when the pipeline depth changes while some frames are in the input and output stages
+HWTEST_F(DetailEnhancerVideoInnerAPIUnitTest, detailenhancer_42, TestSize.Level1)
+{
+    constexpr int depths[] = { 2, 1, 3, 1, 2 };
+    constexpr uint32_t framesPerDepth = 6;
+    constexpr uint32_t frameNum = sizeof(depths) / sizeof(depths[0]) * framesPerDepth;
+    auto video = EngineTestVideo::Create(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+    ASSERT_NE(video, nullptr);
+    video->SetProcessTime(std::chrono::milliseconds(2));
+    auto recorder = std::make_shared<FrameRecorder>();
+    recorder->SetVideo(video);
+    EXPECT_EQ(video->RegisterCallback(recorder), VPE_ALGO_ERR_OK);
+    auto input = video->GetInputSurface();
+    ASSERT_NE(input, nullptr);
+    OutputSink sink;
+    auto output = sink.Create();
+    ASSERT_NE(output, nullptr);
+    EXPECT_EQ(video->SetOutputSurface(output), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Start(), VPE_ALGO_ERR_OK);
+    int64_t firstTimestamp = 0;
+    for (int depth : depths) {
+        Format param{};
+        EXPECT_EQ(param.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, depth), true);
+        EXPECT_EQ(video->SetParameter(param), VPE_ALGO_ERR_OK);
+        EXPECT_EQ(FeedFrames(input, DEFAULT_WIDTH, DEFAULT_HEIGHT, firstTimestamp, framesPerDepth), true);
+        firstTimestamp += framesPerDepth;
+    }
+    EXPECT_EQ(video->NotifyEos(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(recorder->WaitForEos(), true);
+    EXPECT_EQ(sink.WaitFrames(frameNum), true);
+    EXPECT_EQ(recorder->GetTimestamps(), GetTimestamps(0, frameNum));
+    auto frames = sink.GetFrames();
+    ASSERT_EQ(frames.size(), frameNum);
+    for (uint32_t i = 0; i < frameNum; i++) {
+        EXPECT_EQ(frames[i].timestamp, static_cast<int64_t>(i));
+    }
+    EXPECT_EQ(video->Stop(), VPE_ALGO_ERR_OK);
+    EXPECT_EQ(video->Release(), VPE_ALGO_ERR_OK);
+}
+
 } // namespace VideoProcessingEngine
 } // namespace Media
 } // namespace OHOS
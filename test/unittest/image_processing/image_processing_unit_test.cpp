@@ -151,6 +151,21 @@ HWTEST(VpeImageApiTest, VPE_IMAGE_API_TEST_0142, TestSize.Level0)
     bool ret = OH_ImageProcessing_IsColorSpaceConversionSupported(&SRC_INFO, &DST_INFO);
     ASSERT_TRUE(ret);
 }
+HWTEST(VpeImageApiTest, VPE_IMAGE_API_TEST_0144, TestSize.Level0)
+{
+    ImageProcessing_ColorSpaceInfo SRC_INFO;
+    ImageProcessing_ColorSpaceInfo DST_INFO;
+    SRC_INFO.colorSpace = 3;
+    SRC_INFO.metadataType = 0;
+    SRC_INFO.pixelFormat = 3;
+    DST_INFO.colorSpace = 4;
+    DST_INFO.metadataType = 0;
+    DST_INFO.pixelFormat = 3;
+    bool ret = OH_ImageProcessing_IsColorSpaceConversionSupported(&SRC_INFO, &DST_INFO);
+    for (int i = 0; i < 10; i++) { // 10: query repeatedly with the cached capability index
+        ASSERT_EQ(OH_ImageProcessing_IsColorSpaceConversionSupported(&SRC_INFO, &DST_INFO), ret);
+    }
+}
 HWTEST(VpeImageApiTest, VPE_IMAGE_API_TEST_0143, TestSize.Level0)
 {
     ImageProcessing_ColorSpaceInfo SRC_INFO;
@@ -0,0 +1,541 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vpe_bench_surface.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+namespace {
+constexpr uint32_t DEFAULT_QUEUE_SIZE = 3;
+
+uint64_t GetNextUniqueId()
+{
+    static std::atomic<uint64_t> uniqueId{1};
+    return uniqueId.fetch_add(1);
+}
+
+bool IsMatched(const sptr<SurfaceBuffer>& buffer, const BufferRequestConfig& config)
+{
+    return buffer->GetWidth() == config.width && buffer->GetHeight() == config.height &&
+        buffer->GetFormat() == config.format && buffer->GetUsage() == config.usage;
+}
+
+// The consumer created last by Surface::CreateSurfaceAsConsumer on this thread, see Surface::CreateSurfaceAsProducer.
+thread_local wptr<VpeBenchSurface> g_lastConsumer;
+}
+
+class VpeBenchBufferQueue {
+public:
+    enum class State : int {
+        FREE = 0,
+        REQUESTED,
+        FLUSHED,
+        ACQUIRED,
+    };
+
+    struct Slot {
+        sptr<SurfaceBuffer> buffer{};
+        State state{State::FREE};
+        int64_t timestamp{};
+        Rect damage{};
+    };
+
+    explicit VpeBenchBufferQueue(const std::string& name) : name_(name), uniqueId_(GetNextUniqueId())
+    {
+        dispatcher_ = std::thread([this] { Dispatch(); });
+    }
+
+    ~VpeBenchBufferQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(taskLock_);
+            isExiting_ = true;
+        }
+        cvTask_.notify_all();
+        // The last reference may be dropped by a listener called on the dispatcher thread.
+        if (dispatcher_.get_id() == std::this_thread::get_id()) {
+            dispatcher_.detach();
+        } else {
+            dispatcher_.join();
+        }
+    }
+
+    VpeBenchBufferQueue(const VpeBenchBufferQueue&) = delete;
+    VpeBenchBufferQueue& operator=(const VpeBenchBufferQueue&) = delete;
+    VpeBenchBufferQueue(VpeBenchBufferQueue&&) = delete;
+    VpeBenchBufferQueue& operator=(VpeBenchBufferQueue&&) = delete;
+
+    const std::string& GetName() const
+    {
+        return name_;
+    }
+
+    uint64_t GetUniqueId() const
+    {
+        return uniqueId_;
+    }
+
+    GSError RequestBuffer(sptr<SurfaceBuffer>& buffer, BufferRequestConfig& config)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.timeout);
+        while (true) {
+            auto freeSlot = slots_.end();
+            for (auto it = slots_.begin(); it != slots_.end(); ++it) {
+                if (it->second.state != State::FREE) {
+                    continue;
+                }
+                if (IsMatched(it->second.buffer, config)) {
+                    it->second.state = State::REQUESTED;
+                    buffer = it->second.buffer;
+                    return GSERROR_OK;
+                }
+                freeSlot = it;
+            }
+            if (freeSlot != slots_.end() || slots_.size() < queueSize_) {
+                if (freeSlot != slots_.end()) {
+                    slots_.erase(freeSlot);
+                }
+                return AllocBufferLocked(buffer, config);
+            }
+            if (cvFree_.wait_until(lock, deadline) == std::cv_status::timeout) {
+                return GSERROR_NO_BUFFER;
+            }
+        }
+    }
+
+    GSError CancelBuffer(const sptr<SurfaceBuffer>& buffer)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return ChangeStateLocked(buffer, State::REQUESTED, State::FREE);
+    }
+
+    GSError FlushBuffer(const sptr<SurfaceBuffer>& buffer, const BufferFlushConfig& config)
+    {
+        sptr<IBufferConsumerListener> listener;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            GSError err = ChangeStateLocked(buffer, State::REQUESTED, State::FLUSHED);
+            if (err != GSERROR_OK) {
+                return err;
+            }
+            auto& slot = slots_[buffer->GetSeqNum()];
+            slot.timestamp = config.timestamp;
+            slot.damage = config.damage;
+            dirtyList_.push_back(buffer->GetSeqNum());
+            listener = consumerListener_;
+        }
+        if (listener != nullptr) {
+            Post([listener] { listener->OnBufferAvailable(); });
+        }
+        return GSERROR_OK;
+    }
+
+    GSError AcquireBuffer(sptr<SurfaceBuffer>& buffer, int64_t& timestamp, Rect& damage)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        while (!dirtyList_.empty()) {
+            auto it = slots_.find(dirtyList_.front());
+            dirtyList_.pop_front();
+            if (it == slots_.end() || it->second.state != State::FLUSHED) {
+                continue;
+            }
+            it->second.state = State::ACQUIRED;
+            buffer = it->second.buffer;
+            timestamp = it->second.timestamp;
+            damage = it->second.damage;
+            return GSERROR_OK;
+        }
+        return GSERROR_NO_BUFFER;
+    }
+
+    GSError ReleaseBuffer(const sptr<SurfaceBuffer>& buffer)
+    {
+        OnReleaseFunc releaseFunc;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            GSError err = ChangeStateLocked(buffer, State::ACQUIRED, State::FREE);
+            if (err != GSERROR_OK) {
+                return err;
+            }
+            cvFree_.notify_all();
+            releaseFunc = releaseFunc_;
+        }
+        if (releaseFunc != nullptr) {
+            Post([releaseFunc, releasedBuffer = buffer]() mutable { releaseFunc(releasedBuffer); });
+        }
+        return GSERROR_OK;
+    }
+
+    GSError AttachBuffer(const sptr<SurfaceBuffer>& buffer, bool isConsumer)
+    {
+        if (buffer == nullptr) {
+            return GSERROR_INVALID_ARGUMENTS;
+        }
+        std::lock_guard<std::mutex> lock(lock_);
+        if (slots_.find(buffer->GetSeqNum()) != slots_.end()) {
+            return GSERROR_BUFFER_IS_INCACHE;
+        }
+        if (slots_.size() >= queueSize_) {
+            return GSERROR_BUFFER_QUEUE_FULL;
+        }
+        Slot slot{};
+        slot.buffer = buffer;
+        slot.state = isConsumer ? State::ACQUIRED : State::REQUESTED;
+        slots_[buffer->GetSeqNum()] = slot;
+        return GSERROR_OK;
+    }
+
+    GSError DetachBuffer(const sptr<SurfaceBuffer>& buffer, bool isConsumer)
+    {
+        if (buffer == nullptr) {
+            return GSERROR_INVALID_ARGUMENTS;
+        }
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = slots_.find(buffer->GetSeqNum());
+        if (it == slots_.end()) {
+            return GSERROR_BUFFER_NOT_INCACHE;
+        }
+        if (it->second.state != (isConsumer ? State::ACQUIRED : State::REQUESTED)) {
+            return GSERROR_BUFFER_STATE_INVALID;
+        }
+        slots_.erase(it);
+        cvFree_.notify_all();
+        return GSERROR_OK;
+    }
+
+    GSError CleanCache()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        slots_.clear();
+        dirtyList_.clear();
+        cvFree_.notify_all();
+        return GSERROR_OK;
+    }
+
+    uint32_t GetQueueSize()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return queueSize_;
+    }
+
+    GSError SetQueueSize(uint32_t queueSize)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        queueSize_ = queueSize;
+        for (auto it = slots_.begin(); it != slots_.end() && slots_.size() > queueSize_;) {
+            it = (it->second.state == State::FREE) ? slots_.erase(it) : std::next(it);
+        }
+        cvFree_.notify_all();
+        return GSERROR_OK;
+    }
+
+    void SetConsumerListener(const sptr<IBufferConsumerListener>& listener)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        consumerListener_ = listener;
+    }
+
+    void SetReleaseFunc(const OnReleaseFunc& func)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        releaseFunc_ = func;
+    }
+
+private:
+    GSError AllocBufferLocked(sptr<SurfaceBuffer>& buffer, const BufferRequestConfig& config)
+    {
+        auto newBuffer = SurfaceBuffer::Create();
+        if (newBuffer == nullptr) {
+            return GSERROR_NO_MEM;
+        }
+        GSError err = newBuffer->Alloc(config);
+        if (err != GSERROR_OK) {
+            return err;
+        }
+        Slot slot{};
+        slot.buffer = newBuffer;
+        slot.state = State::REQUESTED;
+        slots_[newBuffer->GetSeqNum()] = slot;
+        buffer = newBuffer;
+        return GSERROR_OK;
+    }
+
+    GSError ChangeStateLocked(const sptr<SurfaceBuffer>& buffer, State from, State to)
+    {
+        if (buffer == nullptr) {
+            return GSERROR_INVALID_ARGUMENTS;
+        }
+        auto it = slots_.find(buffer->GetSeqNum());
+        if (it == slots_.end()) {
+            return GSERROR_BUFFER_NOT_INCACHE;
+        }
+        if (it->second.state != from) {
+            return GSERROR_BUFFER_STATE_INVALID;
+        }
+        it->second.state = to;
+        return GSERROR_OK;
+    }
+
+    void Post(std::function<void(void)>&& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(taskLock_);
+            tasks_.push_back(std::move(task));
+        }
+        cvTask_.notify_one();
+    }
+
+    void Dispatch()
+    {
+        while (true) {
+            std::function<void(void)> task;
+            {
+                std::unique_lock<std::mutex> lock(taskLock_);
+                cvTask_.wait(lock, [this] { return isExiting_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    const std::string name_;
+    const uint64_t uniqueId_;
+
+    std::mutex lock_{};
+    std::condition_variable cvFree_{};
+    // Guarded by lock_ begin
+    uint32_t queueSize_{DEFAULT_QUEUE_SIZE};
+    std::map<uint32_t, Slot> slots_{};
+    std::deque<uint32_t> dirtyList_{};
+    sptr<IBufferConsumerListener> consumerListener_{};
+    OnReleaseFunc releaseFunc_{};
+    // Guarded by lock_ end
+
+    std::mutex taskLock_{};
+    std::condition_variable cvTask_{};
+    // Guarded by taskLock_ begin
+    bool isExiting_{false};
+    std::deque<std::function<void(void)>> tasks_{};
+    // Guarded by taskLock_ end
+    std::thread dispatcher_{};
+};
+
+sptr<VpeBenchSurface> VpeBenchSurface::CreateConsumer(const std::string& name)
+{
+    return new VpeBenchSurface(std::make_shared<VpeBenchBufferQueue>(name), true);
+}
+
+sptr<Surface> VpeBenchSurface::CreateProducer() const
+{
+    return new VpeBenchSurface(queue_, false);
+}
+
+VpeBenchSurface::VpeBenchSurface(const std::shared_ptr<VpeBenchBufferQueue>& queue, bool isConsumer)
+    : queue_(queue), isConsumer_(isConsumer)
+{
+}
+
+bool VpeBenchSurface::IsConsumer() const
+{
+    return isConsumer_;
+}
+
+sptr<IBufferProducer> VpeBenchSurface::GetProducer() const
+{
+    return nullptr;
+}
+
+uint64_t VpeBenchSurface::GetUniqueId() const
+{
+    return queue_->GetUniqueId();
+}
+
+const std::string& VpeBenchSurface::GetName()
+{
+    return queue_->GetName();
+}
+
+GSError VpeBenchSurface::Connect()
+{
+    return GSERROR_OK;
+}
+
+GSError VpeBenchSurface::RequestBuffer(sptr<SurfaceBuffer>& buffer, sptr<SyncFence>& fence,
+    BufferRequestConfig& config)
+{
+    fence = SyncFence::InvalidFence();
+    return queue_->RequestBuffer(buffer, config);
+}
+
+GSError VpeBenchSurface::CancelBuffer(sptr<SurfaceBuffer>& buffer)
+{
+    return queue_->CancelBuffer(buffer);
+}
+
+GSError VpeBenchSurface::FlushBuffer(sptr<SurfaceBuffer>& buffer, int32_t fence, BufferFlushConfig& config)
+{
+    (void)fence;
+    return queue_->FlushBuffer(buffer, config);
+}
+
+GSError VpeBenchSurface::AcquireBuffer(sptr<SurfaceBuffer>& buffer, sptr<SyncFence>& fence, int64_t& timestamp,
+    Rect& damage)
+{
+    fence = SyncFence::InvalidFence();
+    return queue_->AcquireBuffer(buffer, timestamp, damage);
+}
+
+GSError VpeBenchSurface::ReleaseBuffer(sptr<SurfaceBuffer>& buffer, int32_t fence)
+{
+    (void)fence;
+    return queue_->ReleaseBuffer(buffer);
+}
+
+GSError VpeBenchSurface::AttachBufferToQueue(sptr<SurfaceBuffer> buffer)
+{
+    return queue_->AttachBuffer(buffer, isConsumer_);
+}
+
+GSError VpeBenchSurface::DetachBufferFromQueue(sptr<SurfaceBuffer> buffer, bool isReserveSlot)
+{
+    (void)isReserveSlot;
+    return queue_->DetachBuffer(buffer, isConsumer_);
+}
+
+GSError VpeBenchSurface::CleanCache(bool cleanAll)
+{
+    (void)cleanAll;
+    return queue_->CleanCache();
+}
+
+uint32_t VpeBenchSurface::GetQueueSize()
+{
+    return queue_->GetQueueSize();
+}
+
+GSError VpeBenchSurface::SetQueueSize(uint32_t queueSize)
+{
+    return queue_->SetQueueSize(queueSize);
+}
+
+GSError VpeBenchSurface::SetDefaultUsage(uint64_t usage)
+{
+    (void)usage;
+    return GSERROR_OK;
+}
+
+int32_t VpeBenchSurface::GetDefaultWidth()
+{
+    return 0;
+}
+
+int32_t VpeBenchSurface::GetDefaultHeight()
+{
+    return 0;
+}
+
+int32_t VpeBenchSurface::GetRequestWidth()
+{
+    return 0;
+}
+
+int32_t VpeBenchSurface::GetRequestHeight()
+{
+    return 0;
+}
+
+GraphicTransformType VpeBenchSurface::GetTransform() const
+{
+    return GRAPHIC_ROTATE_NONE;
+}
+
+GSError VpeBenchSurface::SetTransform(GraphicTransformType transform)
+{
+    (void)transform;
+    return GSERROR_OK;
+}
+
+GSError VpeBenchSurface::GetScalingMode(uint32_t sequence, ScalingMode& scalingMode)
+{
+    (void)sequence;
+    scalingMode = SCALING_MODE_SCALE_TO_WINDOW;
+    return GSERROR_OK;
+}
+
+GSError VpeBenchSurface::SetScalingMode(ScalingMode scalingMode)
+{
+    (void)scalingMode;
+    return GSERROR_OK;
+}
+
+GSError VpeBenchSurface::RegisterConsumerListener(sptr<IBufferConsumerListener>& listener)
+{
+    queue_->SetConsumerListener(listener);
+    return GSERROR_OK;
+}
+
+GSError VpeBenchSurface::UnregisterConsumerListener()
+{
+    queue_->SetConsumerListener(nullptr);
+    return GSERROR_OK;
+}
+
+GSError VpeBenchSurface::RegisterReleaseListener(OnReleaseFunc func)
+{
+    queue_->SetReleaseFunc(func);
+    return GSERROR_OK;
+}
+
+GSError VpeBenchSurface::UnRegisterReleaseListener()
+{
+    queue_->SetReleaseFunc(nullptr);
+    return GSERROR_OK;
+}
+} // namespace VideoProcessingEngine
+} // namespace Media
+
+// Replace the surfaces of the graphic BufferQueue with the in-memory ones for the whole process, including the input
+// surface created by the buffer engine. The definitions in the executable take precedence over the surface library.
+sptr<Surface> Surface::CreateSurfaceAsConsumer(std::string name)
+{
+    auto consumer = Media::VideoProcessingEngine::VpeBenchSurface::CreateConsumer(name);
+    Media::VideoProcessingEngine::g_lastConsumer = consumer;
+    return consumer;
+}
+
+// The in-memory consumer has no IPC producer, so the producer is created for the consumer created last on the thread,
+// which is how the buffer engine pairs them.
+sptr<Surface> Surface::CreateSurfaceAsProducer(sptr<IBufferProducer>& producer)
+{
+    (void)producer;
+    auto consumer = Media::VideoProcessingEngine::g_lastConsumer.promote();
+    return consumer == nullptr ? nullptr : consumer->CreateProducer();
+}
+} // namespace OHOS
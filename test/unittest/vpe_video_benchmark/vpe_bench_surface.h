@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VPE_BENCH_SURFACE_H
+#define VPE_BENCH_SURFACE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "refbase.h"
+#include "surface.h"
+#include "surface_buffer.h"
+#include "sync_fence.h"
+
+namespace OHOS {
+namespace Media {
+namespace VideoProcessingEngine {
+class VpeBenchBufferQueue;
+
+/**
+ * In-memory stand-in of a surface for the benchmark, the buffers are passed between the producer and the consumer
+ * through a queue in the process instead of the graphic BufferQueue. The listeners are called by a dispatcher thread
+ * of the queue, like they are called by the other process in the real system.
+ *
+ * The benchmark also replaces Surface::CreateSurfaceAsConsumer and Surface::CreateSurfaceAsProducer with this class,
+ * so the input surface created by the buffer engine is in memory too.
+ */
+class VpeBenchSurface : public Surface {
+public:
+    // Create the consumer of a new queue, the producer is created by CreateProducer.
+    static sptr<VpeBenchSurface> CreateConsumer(const std::string& name);
+    sptr<Surface> CreateProducer() const;
+
+    VpeBenchSurface(const std::shared_ptr<VpeBenchBufferQueue>& queue, bool isConsumer);
+    ~VpeBenchSurface() override = default;
+    VpeBenchSurface(const VpeBenchSurface&) = delete;
+    VpeBenchSurface& operator=(const VpeBenchSurface&) = delete;
+    VpeBenchSurface(VpeBenchSurface&&) = delete;
+    VpeBenchSurface& operator=(VpeBenchSurface&&) = delete;
+
+    bool IsConsumer() const override;
+    // There is no IPC producer of the in-memory queue, use CreateProducer instead.
+    sptr<IBufferProducer> GetProducer() const override;
+    uint64_t GetUniqueId() const override;
+    const std::string& GetName() override;
+    GSError Connect() override;
+
+    GSError RequestBuffer(sptr<SurfaceBuffer>& buffer, sptr<SyncFence>& fence, BufferRequestConfig& config) override;
+    GSError CancelBuffer(sptr<SurfaceBuffer>& buffer) override;
+    GSError FlushBuffer(sptr<SurfaceBuffer>& buffer, int32_t fence, BufferFlushConfig& config) override;
+    GSError AcquireBuffer(sptr<SurfaceBuffer>& buffer, sptr<SyncFence>& fence, int64_t& timestamp,
+        Rect& damage) override;
+    GSError ReleaseBuffer(sptr<SurfaceBuffer>& buffer, int32_t fence) override;
+    GSError AttachBufferToQueue(sptr<SurfaceBuffer> buffer) override;
+    GSError DetachBufferFromQueue(sptr<SurfaceBuffer> buffer, bool isReserveSlot) override;
+    GSError CleanCache(bool cleanAll) override;
+
+    uint32_t GetQueueSize() override;
+    GSError SetQueueSize(uint32_t queueSize) override;
+    GSError SetDefaultUsage(uint64_t usage) override;
+    int32_t GetDefaultWidth() override;
+    int32_t GetDefaultHeight() override;
+    int32_t GetRequestWidth() override;
+    int32_t GetRequestHeight() override;
+    GraphicTransformType GetTransform() const override;
+    GSError SetTransform(GraphicTransformType transform) override;
+    GSError GetScalingMode(uint32_t sequence, ScalingMode& scalingMode) override;
+    GSError SetScalingMode(ScalingMode scalingMode) override;
+
+    GSError RegisterConsumerListener(sptr<IBufferConsumerListener>& listener) override;
+    GSError UnregisterConsumerListener() override;
+    GSError RegisterReleaseListener(OnReleaseFunc func) override;
+    GSError UnRegisterReleaseListener() override;
+
+private:
+    std::shared_ptr<VpeBenchBufferQueue> queue_{};
+    const bool isConsumer_{};
+};
+} // namespace VideoProcessingEngine
+} // namespace Media
+} // namespace OHOS
+
+#endif // VPE_BENCH_SURFACE_H
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "surface.h"
+#include "surface_buffer.h"
+
+#include "algorithm_errors.h"
+#include "algorithm_video.h"
+#include "algorithm_video_impl.h"
+#include "vpe_bench_surface.h"
+
+using namespace OHOS;
+using namespace OHOS::Media;
+using namespace OHOS::Media::VideoProcessingEngine;
+using namespace std::chrono_literals;
+
+namespace {
+constexpr uint32_t DEFAULT_FRAME_NUM = 300;
+constexpr uint32_t WARM_UP_FRAME_NUM = 10;
+constexpr int32_t REQUEST_TIMEOUT_MS = 100;
+constexpr int32_t STRIDE_ALIGNMENT = 32;
+constexpr auto DRAIN_TIMEOUT = 5s;
+constexpr double NANOS_IN_MILLI = 1000000.0;
+constexpr double NANOS_IN_SECOND = 1000000000.0;
+constexpr double P50 = 0.5;
+constexpr double P99 = 0.99;
+// Target size of the detail enhancer, it must NOT be greater than 2000x2000.
+constexpr VpeBufferSize DETAIL_ENHANCER_TARGET_SIZE{1920, 1080};
+
+struct BenchResolution {
+    const char* name;
+    int32_t width;
+    int32_t height;
+};
+
+constexpr BenchResolution RESOLUTIONS[] = {
+    { "720p", 1280, 720 },
+    { "1080p", 1920, 1080 },
+    { "2160p", 3840, 2160 },
+};
+constexpr int32_t QUEUE_SIZES[] = { 3, 5, 8 };
+constexpr int32_t PIPELINE_DEPTHS[] = { 1, 2, 3 };
+
+struct BenchResult {
+    uint32_t frames{};
+    double fps{};
+    double p50Ms{};
+    double p99Ms{};
+    uint64_t lockContentions{};
+    uint64_t droppedFrames{};
+};
+
+int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double GetPercentileMs(std::vector<int64_t>& latencies, double percentile)
+{
+    if (latencies.empty()) {
+        return 0.0;
+    }
+    auto index = static_cast<size_t>(percentile * (latencies.size() - 1));
+    std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+    return latencies[index] / NANOS_IN_MILLI;
+}
+
+// Video processing object which does nothing in Process, so only the cost of the buffer engine is measured.
+class BenchVideo : public VpeVideoImpl {
+public:
+    static std::shared_ptr<VpeVideo> Create()
+    {
+        auto obj = std::make_shared<BenchVideo>();
+        if (obj->Initialize() != VPE_ALGO_ERR_OK) {
+            return nullptr;
+        }
+        return obj;
+    }
+
+    BenchVideo() : VpeVideoImpl(VIDEO_TYPE_DETAIL_ENHANCER) {}
+    ~BenchVideo() = default;
+    BenchVideo(const BenchVideo&) = delete;
+    BenchVideo& operator=(const BenchVideo&) = delete;
+    BenchVideo(BenchVideo&&) = delete;
+    BenchVideo& operator=(BenchVideo&&) = delete;
+
+    VPEAlgoErrCode SetParameter(const Format& parameter) final
+    {
+        return SetCommonParameter(parameter) > 0 ? VPE_ALGO_ERR_OK : VPE_ALGO_ERR_INVALID_VAL;
+    }
+
+    VPEAlgoErrCode GetParameter(Format& parameter) final
+    {
+        GetCommonParameter(parameter);
+        return VPE_ALGO_ERR_OK;
+    }
+};
+
+// Render every output buffer as soon as it is available, like a display which never blocks.
+class BenchCallback : public VpeVideoCallback {
+public:
+    BenchCallback() = default;
+    ~BenchCallback() override = default;
+    BenchCallback(const BenchCallback&) = delete;
+    BenchCallback& operator=(const BenchCallback&) = delete;
+    BenchCallback(BenchCallback&&) = delete;
+    BenchCallback& operator=(BenchCallback&&) = delete;
+
+    void SetVideo(const std::shared_ptr<VpeVideo>& video)
+    {
+        video_ = video;
+    }
+
+    void OnOutputBufferAvailable(uint32_t index, const VpeBufferInfo& info) final
+    {
+        (void)info;
+        auto video = video_.lock();
+        if (video != nullptr) {
+            video->ReleaseOutputBuffer(index, true);
+        }
+    }
+
+private:
+    std::weak_ptr<VpeVideo> video_;
+};
+
+// In-memory stand-in of the display: the rendered buffers are acquired and released at once,
+// and the latency of each frame is measured from the timestamp set by the feeder.
+// It uses the in-memory surface directly, so no graphic BufferQueue is involved on the output path.
+class BenchSink {
+public:
+    BenchSink() = default;
+    ~BenchSink()
+    {
+        if (consumer_ != nullptr) {
+            consumer_->UnregisterConsumerListener();
+        }
+    }
+    BenchSink(const BenchSink&) = delete;
+    BenchSink& operator=(const BenchSink&) = delete;
+    BenchSink(BenchSink&&) = delete;
+    BenchSink& operator=(BenchSink&&) = delete;
+
+    sptr<Surface> Create()
+    {
+        consumer_ = VpeBenchSurface::CreateConsumer("VpeBenchmarkSink");
+        if (consumer_ == nullptr) {
+            return nullptr;
+        }
+        sptr<IBufferConsumerListener> listener = new Listener(*this);
+        if (consumer_->RegisterConsumerListener(listener) != GSERROR_OK) {
+            return nullptr;
+        }
+        return consumer_->CreateProducer();
+    }
+
+    bool WaitFrames(uint32_t frames)
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        return cvFrame_.wait_for(lock, DRAIN_TIMEOUT, [this, frames] { return latencies_.size() >= frames; });
+    }
+
+    // Return the latencies of the frames after the first skipFrames, and the time when the last frame arrived.
+    std::vector<int64_t> GetLatencies(uint32_t skipFrames, int64_t& lastArrivalNs)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        lastArrivalNs = lastArrivalNs_;
+        if (latencies_.size() <= skipFrames) {
+            return {};
+        }
+        return std::vector<int64_t>(latencies_.begin() + skipFrames, latencies_.end());
+    }
+
+private:
+    class Listener : public IBufferConsumerListener {
+    public:
+        explicit Listener(BenchSink& owner) : owner_(owner) {}
+        ~Listener() = default;
+        Listener(const Listener&) = delete;
+        Listener& operator=(const Listener&) = delete;
+        Listener(Listener&&) = delete;
+        Listener& operator=(Listener&&) = delete;
+
+        void OnBufferAvailable() final
+        {
+            owner_.OnBufferAvailable();
+        }
+
+    private:
+        BenchSink& owner_;
+    };
+
+    void OnBufferAvailable()
+    {
+        sptr<SurfaceBuffer> buffer;
+        sptr<SyncFence> fence;
+        int64_t timestamp = 0;
+        Rect damage{};
+        if (consumer_->AcquireBuffer(buffer, fence, timestamp, damage) != GSERROR_OK) {
+            return;
+        }
+        int64_t now = NowNs();
+        consumer_->ReleaseBuffer(buffer, -1);
+        std::lock_guard<std::mutex> lock(lock_);
+        latencies_.push_back(now - timestamp);
+        lastArrivalNs_ = now;
+        cvFrame_.notify_all();
+    }
+
+    sptr<VpeBenchSurface> consumer_{};
+    std::mutex lock_{};
+    std::condition_variable cvFrame_{};
+    // Guarded by lock_ begin
+    std::vector<int64_t> latencies_{};
+    int64_t lastArrivalNs_{};
+    // Guarded by lock_ end
+};
+
+bool FeedFrame(const sptr<Surface>& input, BufferRequestConfig& requestCfg, int64_t& flushedNs)
+{
+    sptr<SurfaceBuffer> buffer;
+    sptr<SyncFence> fence;
+    if (input->RequestBuffer(buffer, fence, requestCfg) != GSERROR_OK || buffer == nullptr) {
+        return false;
+    }
+    if (fence != nullptr) {
+        fence->Wait(REQUEST_TIMEOUT_MS);
+    }
+    BufferFlushConfig flushCfg{};
+    flushCfg.damage.w = requestCfg.width;
+    flushCfg.damage.h = requestCfg.height;
+    flushedNs = NowNs();
+    flushCfg.timestamp = flushedNs;
+    return input->FlushBuffer(buffer, -1, flushCfg) == GSERROR_OK;
+}
+
+bool Configure(const std::shared_ptr<VpeVideo>& video, int32_t pipelineDepth, bool isDetailEnhancer)
+{
+    Format parameter;
+    parameter.PutIntValue(ParameterKey::VIDEO_PIPELINE_DEPTH, pipelineDepth);
+    if (isDetailEnhancer) {
+        // The low level is processed by the Skia extension on CPU.
+        parameter.PutIntValue(ParameterKey::DETAIL_ENHANCER_QUALITY_LEVEL, DETAIL_ENHANCER_LEVEL_LOW);
+        VpeBufferSize size = DETAIL_ENHANCER_TARGET_SIZE;
+        parameter.PutBuffer(ParameterKey::DETAIL_ENHANCER_TARGET_SIZE, reinterpret_cast<uint8_t*>(&size),
+            sizeof(size));
+    }
+    return video->SetParameter(parameter) == VPE_ALGO_ERR_OK;
+}
+
+bool GetStatistics(const std::shared_ptr<VpeVideo>& video, VpeVideoStatistics& statistics)
+{
+    Format parameter;
+    if (video->GetParameter(parameter) != VPE_ALGO_ERR_OK) {
+        return false;
+    }
+    size_t size = 0;
+    uint8_t* addr = nullptr;
+    if (!parameter.GetBuffer(ParameterKey::VIDEO_STATISTICS, &addr, size) || addr == nullptr ||
+        size != sizeof(statistics)) {
+        return false;
+    }
+    statistics = *reinterpret_cast<VpeVideoStatistics*>(addr);
+    return true;
+}
+
+bool Run(const std::shared_ptr<VpeVideo>& video, const BenchResolution& resolution, int32_t queueSize,
+    uint32_t frameNum, BenchResult& result)
+{
+    BenchSink sink;
+    auto output = sink.Create();
+    auto input = video->GetInputSurface();
+    if (output == nullptr || input == nullptr || video->SetOutputSurface(output) != VPE_ALGO_ERR_OK) {
+        return false;
+    }
+    // SetOutputSurface sets the queue size of the output surface, so the swept size is applied after it.
+    output->SetQueueSize(static_cast<uint32_t>(queueSize));
+    input->SetQueueSize(static_cast<uint32_t>(queueSize));
+    if (video->Start() != VPE_ALGO_ERR_OK) {
+        return false;
+    }
+
+    BufferRequestConfig requestCfg{};
+    requestCfg.width = resolution.width;
+    requestCfg.height = resolution.height;
+    requestCfg.format = GRAPHIC_PIXEL_FMT_YCBCR_420_SP;
+    requestCfg.usage = BUFFER_USAGE_CPU_READ | BUFFER_USAGE_CPU_WRITE | BUFFER_USAGE_MEM_DMA;
+    requestCfg.timeout = REQUEST_TIMEOUT_MS;
+    requestCfg.strideAlignment = STRIDE_ALIGNMENT;
+    uint32_t totalFrames = WARM_UP_FRAME_NUM + frameNum;
+    uint32_t fedFrames = 0;
+    int64_t startNs = 0;
+    for (uint32_t i = 0; i < totalFrames; i++) {
+        int64_t flushedNs = 0;
+        if (!FeedFrame(input, requestCfg, flushedNs)) {
+            continue;
+        }
+        fedFrames++;
+        if (fedFrames == WARM_UP_FRAME_NUM + 1) {
+            startNs = flushedNs;
+        }
+    }
+    sink.WaitFrames(fedFrames);
+
+    int64_t lastArrivalNs = 0;
+    auto latencies = sink.GetLatencies(WARM_UP_FRAME_NUM, lastArrivalNs);
+    result.frames = static_cast<uint32_t>(latencies.size());
+    if (!latencies.empty() && lastArrivalNs > startNs) {
+        result.fps = latencies.size() * NANOS_IN_SECOND / (lastArrivalNs - startNs);
+    }
+    result.p50Ms = GetPercentileMs(latencies, P50);
+    result.p99Ms = GetPercentileMs(latencies, P99);
+    VpeVideoStatistics statistics{};
+    if (GetStatistics(video, statistics)) {
+        result.lockContentions = statistics.lockContentions;
+        result.droppedFrames = statistics.droppedFrames;
+    }
+    video->Stop();
+    return true;
+}
+
+void RunCase(const char* name, bool isDetailEnhancer, const BenchResolution& resolution, int32_t queueSize,
+    int32_t pipelineDepth, uint32_t frameNum)
+{
+    auto video = isDetailEnhancer ? VpeVideo::Create(VIDEO_TYPE_DETAIL_ENHANCER) : BenchVideo::Create();
+    auto callback = std::make_shared<BenchCallback>();
+    if (video == nullptr || video->RegisterCallback(callback) != VPE_ALGO_ERR_OK ||
+        !Configure(video, pipelineDepth, isDetailEnhancer)) {
+        printf("%-8s %-6s %5d %5d  FAILED to create or configure\n", name, resolution.name, queueSize, pipelineDepth);
+        return;
+    }
+    callback->SetVideo(video);
+    BenchResult result{};
+    if (!Run(video, resolution, queueSize, frameNum, result)) {
+        printf("%-8s %-6s %5d %5d  FAILED to run\n", name, resolution.name, queueSize, pipelineDepth);
+    } else {
+        printf("%-8s %-6s %5d %5d %7u %9.1f %9.3f %9.3f %11" PRIu64 " %8" PRIu64 "\n", name, resolution.name,
+            queueSize, pipelineDepth, result.frames, result.fps, result.p50Ms, result.p99Ms, result.lockContentions,
+            result.droppedFrames);
+    }
+    video->Release();
+}
+} // namespace
+
+int32_t main(int argc, char* argv[])
+{
+    printf("USAGE: vpe_video_benchmark [frames per case, default %u] [engine|detail|all, default all]\n",
+        DEFAULT_FRAME_NUM);
+    uint32_t frameNum = DEFAULT_FRAME_NUM;
+    if (argc > 1 && atoi(argv[1]) > 0) {
+        frameNum = static_cast<uint32_t>(atoi(argv[1]));
+    }
+    std::string target = argc > 2 ? argv[2] : "all";
+    bool runEngine = target == "all" || target == "engine";
+    bool runDetail = target == "all" || target == "detail";
+
+    printf("%-8s %-6s %5s %5s %7s %9s %9s %9s %11s %8s\n", "target", "res", "queue", "depth", "frames", "fps",
+        "p50(ms)", "p99(ms)", "contentions", "dropped");
+    for (const auto& resolution : RESOLUTIONS) {
+        for (auto queueSize : QUEUE_SIZES) {
+            for (auto pipelineDepth : PIPELINE_DEPTHS) {
+                if (runEngine) {
+                    RunCase("engine", false, resolution, queueSize, pipelineDepth, frameNum);
+                }
+                if (runDetail) {
+                    RunCase("detail", true, resolution, queueSize, pipelineDepth, frameNum);
+                }
+            }
+        }
+    }
+    return 0;
+}